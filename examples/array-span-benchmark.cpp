@@ -0,0 +1,57 @@
+#include <Array.h>
+#include <chrono>
+#include <cstdio>
+
+// Compares element-wise updates of Array<double> through operator[], mutableSpan() and UniqueArray
+
+using namespace metacpp;
+
+static const int Iterations = 2000;
+static const size_t Size = 10000;
+
+template<typename TFunc>
+static void measure(const char *name, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    double checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / Iterations;
+    printf("%-28s %8.2f us/op (checksum %g)\n", name, us, checksum);
+}
+
+int main()
+{
+    Array<double> prices, weights;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        prices.push_back(i * 0.5);
+        weights.push_back(1.0 / (i + 1));
+    }
+    const Array<double>& w = weights;
+
+    measure("Array::operator[]", [&] {
+        Array<double> result = prices;
+        for (int it = 0; it < Iterations; ++it)
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] = result[i] * 0.999 + w[i];
+        return result[Size - 1];
+    });
+    measure("Array::mutableSpan", [&] {
+        Array<double> result = prices;
+        for (int it = 0; it < Iterations; ++it)
+        {
+            ArraySpan<double> span = result.mutableSpan();
+            for (size_t i = 0; i < span.size(); ++i)
+                span[i] = span[i] * 0.999 + w[i];
+        }
+        return result[Size - 1];
+    });
+    measure("UniqueArray::operator[]", [&] {
+        UniqueArray<double> result(prices.data(), prices.size());
+        for (int it = 0; it < Iterations; ++it)
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] = result[i] * 0.999 + w[i];
+        return result[Size - 1];
+    });
+    return 0;
+}
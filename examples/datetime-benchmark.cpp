@@ -0,0 +1,116 @@
+#include <DateTime.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+
+// Measures construction, field extraction, calendar arithmetic and ISO-8601 conversions of DateTime
+
+using namespace metacpp;
+
+static const int Iterations = 1000000;
+
+template<typename TFunc>
+static void measure(const char *name, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+    printf("%-28s %8.2f ns/op (checksum %lld)\n", name, ns, static_cast<long long>(checksum));
+}
+
+int main()
+{
+    measure("DateTime(y, m, d, h, m, s)", [] {
+        int64_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += DateTime(2000 + i % 50, static_cast<EMonth>(i % 12), 1 + i % 28, i % 24, i % 60, i % 60).toMicrosecondsSinceEpoch();
+        return sum;
+    });
+    measure("year/month/day", [] {
+        int64_t sum = 0;
+        DateTime dt(2015, June, 1);
+        for (int i = 0; i < Iterations; ++i)
+        {
+            dt.addSeconds(3607);
+            sum += dt.year() + dt.month() + dt.day();
+        }
+        return sum;
+    });
+    measure("addMonths", [] {
+        int64_t sum = 0;
+        DateTime dt(1970, January, 31);
+        for (int i = 0; i < Iterations; ++i)
+            sum += dt.addMonths(i % 2 ? 7 : -5).day();
+        return sum;
+    });
+    measure("setHMS", [] {
+        int64_t sum = 0;
+        DateTime dt(2015, June, 1);
+        for (int i = 0; i < Iterations; ++i)
+            sum += dt.setHMS(i % 24, i % 60, i % 60).toMicrosecondsSinceEpoch();
+        return sum;
+    });
+    measure("DateTime(time_t)", [] {
+        int64_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += DateTime(static_cast<time_t>(1433162096 + i % 100000 * 3607)).hours();
+        return sum;
+    });
+    measure("DateTime::toStdTime", [] {
+        int64_t sum = 0;
+        DateTime dt(2015, June, 1);
+        for (int i = 0; i < Iterations; ++i)
+            sum += dt.addSeconds(3607).toStdTime();
+        return sum;
+    });
+    measure("strptime", [] {
+        int64_t sum = 0;
+        struct tm tm;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            memset(&tm, 0, sizeof(tm));
+            strptime("2015-06-01 12:34:56", "%Y-%m-%d %H:%M:%S", &tm);
+            sum += tm.tm_sec;
+        }
+        return sum;
+    });
+    measure("parseDateTime", [] {
+        static const char str[] = "2015-06-01 12:34:56";
+        int64_t sum = 0;
+        DateTime dt;
+        int offset;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            parseDateTime(str, str + sizeof(str) - 1, dt, offset);
+            sum += dt.toMicrosecondsSinceEpoch();
+        }
+        return sum;
+    });
+    measure("DateTime::fromString", [] {
+        int64_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += DateTime::fromString("2015-06-01 12:34:56").toMicrosecondsSinceEpoch();
+        return sum;
+    });
+    measure("strftime", [] {
+        int64_t sum = 0;
+        char buf[DateTimeBufferSize];
+        time_t t = 1433162096;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        for (int i = 0; i < Iterations; ++i)
+            sum += strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        return sum;
+    });
+    measure("formatDateTime", [] {
+        int64_t sum = 0;
+        char buf[DateTimeBufferSize];
+        DateTime dt(2015, June, 1, 12, 34, 56);
+        for (int i = 0; i < Iterations; ++i)
+            sum += formatDateTime(buf, dt);
+        return sum;
+    });
+    return 0;
+}
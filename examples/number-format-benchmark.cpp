@@ -0,0 +1,85 @@
+#include <StringBase.h>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+// Compares String::fromValue/toValue with the equivalent iostream based conversions
+
+using namespace metacpp;
+
+static const int Iterations = 1000000;
+
+template<typename TFunc>
+static void measure(const char *name, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+    printf("%-24s %8.1f ns/op (checksum %zu)\n", name, ns, checksum);
+}
+
+template<typename T>
+static String streamFormat(const T& value)
+{
+    OutputStringStream ss;
+    ss << value;
+    return ss.str();
+}
+
+template<typename T>
+static T streamParse(const String& str)
+{
+    T res;
+    InputStringStream ss(str);
+    ss.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+    ss >> res;
+    return res;
+}
+
+template<typename T>
+static void benchmark(const char *typeName, T (*generate)(int))
+{
+    char name[64];
+    snprintf(name, sizeof(name), "format %s (stream)", typeName);
+    measure(name, [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += streamFormat(generate(i)).length();
+        return sum;
+    });
+    snprintf(name, sizeof(name), "format %s", typeName);
+    measure(name, [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += String::fromValue(generate(i)).length();
+        return sum;
+    });
+
+    StringArray strings;
+    for (int i = 0; i < 1000; ++i)
+        strings.push_back(String::fromValue(generate(i)));
+    snprintf(name, sizeof(name), "parse %s (stream)", typeName);
+    measure(name, [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += static_cast<size_t>(static_cast<int64_t>(streamParse<T>(strings[i % strings.size()])));
+        return sum;
+    });
+    snprintf(name, sizeof(name), "parse %s", typeName);
+    measure(name, [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += static_cast<size_t>(static_cast<int64_t>(strings[i % strings.size()].toValue<T>()));
+        return sum;
+    });
+}
+
+int main()
+{
+    benchmark<int32_t>("int32", [](int i) { return static_cast<int32_t>(i * 7919 - 3000000); });
+    benchmark<uint64_t>("uint64", [](int i) { return static_cast<uint64_t>(i) * 2654435761u * 1000003u; });
+    benchmark<double>("double", [](int i) { return i / 7.0 - 1000.0; });
+    benchmark<double>("double (integral)", [](int i) { return static_cast<double>(i * 13); });
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <StringBase.h>
+#include <chrono>
+#include <cstdio>
+
+// Compares chained String concatenation with a StringBuilder reused across iterations on a sql-like text
+
+using namespace metacpp;
+
+static const int Iterations = 200000;
+
+template<typename TFunc>
+static void measure(const char *name, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+    printf("%-40s %8.1f ns/op (checksum %zu)\n", name, ns, checksum);
+}
+
+int main()
+{
+    static const char *columns[] = { "id", "name", "email", "created", "updated", "status" };
+    static const size_t nColumns = sizeof(columns) / sizeof(columns[0]);
+    String table = "users", quote = "\"";
+
+    measure("operator+", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            String query = "SELECT ";
+            for (size_t j = 0; j < nColumns; ++j)
+            {
+                if (j) query += ", ";
+                query += quote + table + quote + "." + quote + columns[j] + quote;
+            }
+            query += " FROM " + quote + table + quote + " WHERE " + quote + "id" + quote + " = " +
+                    String::fromValue(i) + " LIMIT " + String::fromValue(10);
+            sum += query.size();
+        }
+        return sum;
+    });
+    measure("StringBuilder", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            StringBuilder query;
+            query.append("SELECT ");
+            for (size_t j = 0; j < nColumns; ++j)
+            {
+                if (j) query.append(", ");
+                query.append('"').append(table).append("\".\"").append(columns[j]).append('"');
+            }
+            query.append(" FROM \"").append(table).append("\" WHERE \"id\" = ").append(i).append(" LIMIT ").append(10);
+            sum += query.take().size();
+        }
+        return sum;
+    });
+    measure("StringBuilder reused", [&] {
+        size_t sum = 0;
+        StringBuilder query;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            query.clear();
+            query.append("SELECT ");
+            for (size_t j = 0; j < nColumns; ++j)
+            {
+                if (j) query.append(", ");
+                query.append('"').append(table).append("\".\"").append(columns[j]).append('"');
+            }
+            query.append(" FROM \"").append(table).append("\" WHERE \"id\" = ").append(i).append(" LIMIT ").append(10);
+            sum += query.size();
+        }
+        return sum;
+    });
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <StringBase.h>
+#include <Unicode.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#ifdef HAVE_ICONV
+#include <iconv.h>
+#endif
+
+// Compares string_cast between String and WString with memcpy and a per-call iconv conversion (if available)
+
+using namespace metacpp;
+
+static const int Iterations = 20000;
+
+template<typename TFunc>
+static void measure(const char *name, size_t bytes, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("%-32s %8.2f us/op %8.0f MB/s (checksum %zu)\n", name, seconds * 1e6 / Iterations,
+           bytes * (double)Iterations / seconds / 1e6, checksum);
+}
+
+#ifdef HAVE_ICONV
+static size_t iconvConvert(const char *to, const char *from, const char *src, size_t srcBytes, char *dst, size_t dstBytes)
+{
+    iconv_t cd = iconv_open(to, from);
+    char *in = const_cast<char *>(src), *out = dst;
+    iconv(cd, &in, &srcBytes, &out, &dstBytes);
+    iconv_close(cd);
+    return out - dst;
+}
+#endif
+
+static void benchmark(const char *title, const String& utf8)
+{
+    WString utf16 = string_cast<WString>(utf8);
+    printf("%s: %zu bytes of UTF-8, %zu UTF-16 code units\n", title, utf8.size(), utf16.size());
+    std::vector<char> buffer(utf8.size() * 4 + 16);
+
+    measure("memcpy", utf8.size(), [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            memcpy(buffer.data(), utf8.data(), utf8.size());
+            sum += buffer[i % utf8.size()];
+        }
+        return sum;
+    });
+#ifdef HAVE_ICONV
+    measure("iconv UTF-8 -> UTF-16", utf8.size(), [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += iconvConvert("UTF-16LE", "UTF-8", utf8.data(), utf8.size(), buffer.data(), buffer.size());
+        return sum;
+    });
+#endif
+    measure("string_cast<WString>", utf8.size(), [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += string_cast<WString>(utf8).size();
+        return sum;
+    });
+#ifdef HAVE_ICONV
+    measure("iconv UTF-16 -> UTF-8", utf8.size(), [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += iconvConvert("UTF-8", "UTF-16LE", reinterpret_cast<const char *>(utf16.data()),
+                                utf16.size() * sizeof(char16_t), buffer.data(), buffer.size());
+        return sum;
+    });
+#endif
+    measure("string_cast<String>", utf8.size(), [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += string_cast<String>(utf16).size();
+        return sum;
+    });
+}
+
+int main()
+{
+    String ascii, mixed;
+    for (int i = 0; i < 100; ++i)
+    {
+        ascii += "{\"id\": 42, \"name\": \"Some object name\", \"tags\": [\"a\", \"b\"]}\n";
+        mixed += i % 4 ? "{\"id\": 42, \"name\": \"Some object name\"}\n" : "{\"id\": 42, \"name\": \"\xD0\x98\xD0\xBC\xD1\x8F \xE2\x82\xAC\"}\n";
+    }
+    benchmark("ascii", ascii);
+    benchmark("mixed", mixed);
+    return 0;
+}
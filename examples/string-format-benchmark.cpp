@@ -0,0 +1,93 @@
+#include <StringBase.h>
+#include <Variant.h>
+#include <chrono>
+#include <cstdio>
+
+// Compares String::format with the precompiled String::Formatter and plain snprintf on log lines and keys
+
+using namespace metacpp;
+
+static const int Iterations = 200000;
+
+template<typename TFunc>
+static void measure(const char *name, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+    printf("%-40s %8.1f ns/op (checksum %zu)\n", name, ns, checksum);
+}
+
+int main()
+{
+    static const char *logFormat = "%s [%-5s] request id=%d user=%s status=%u elapsed=%.3f";
+    static const char *keyFormat = "user:%s:session:%08x";
+    String user = "administrator";
+
+    measure("log line: snprintf", [&] {
+        size_t sum = 0;
+        char buffer[256];
+        for (int i = 0; i < Iterations; ++i)
+            sum += snprintf(buffer, sizeof(buffer), logFormat, "2015-06-01 12:00:00", "INFO", i, user.c_str(), 200u, i * 0.001);
+        return sum;
+    });
+    measure("log line: String::format(VariantArray)", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += String::format(logFormat, VariantArray { "2015-06-01 12:00:00", "INFO", i, user, 200u, i * 0.001 }).size();
+        return sum;
+    });
+    measure("log line: String::format", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += String::format(logFormat, "2015-06-01 12:00:00", "INFO", i, user, 200u, i * 0.001).size();
+        return sum;
+    });
+    String::Formatter logFormatter(logFormat);
+    measure("log line: String::Formatter", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += logFormatter("2015-06-01 12:00:00", "INFO", i, user, 200u, i * 0.001).size();
+        return sum;
+    });
+
+    measure("key: snprintf", [&] {
+        size_t sum = 0;
+        char buffer[64];
+        for (int i = 0; i < Iterations; ++i)
+            sum += snprintf(buffer, sizeof(buffer), keyFormat, user.c_str(), i);
+        return sum;
+    });
+    measure("key: String::format(VariantArray)", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += String::format(keyFormat, VariantArray { user, i }).size();
+        return sum;
+    });
+    measure("key: String::format", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += String::format(keyFormat, user, i).size();
+        return sum;
+    });
+    String::Formatter keyFormatter(keyFormat);
+    measure("key: String::Formatter", [&] {
+        size_t sum = 0;
+        for (int i = 0; i < Iterations; ++i)
+            sum += keyFormatter(user, i).size();
+        return sum;
+    });
+    measure("key: String::Formatter::appendTo", [&] {
+        size_t sum = 0;
+        String key;
+        for (int i = 0; i < Iterations; ++i)
+        {
+            key.resize(0);
+            keyFormatter.appendTo(key, user, i);
+            sum += key.size();
+        }
+        return sum;
+    });
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <StringBase.h>
+#include <StringSearch.h>
+#include <chrono>
+#include <cstdio>
+
+// Compares the string scanning kernels dispatched to each supported instruction set
+
+using namespace metacpp;
+using namespace metacpp::detail;
+
+static const int Iterations = 20000;
+
+template<typename TFunc>
+static void measure(const char *name, TFunc func)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / Iterations;
+    printf("%-36s %8.2f us/op (checksum %zu)\n", name, us, checksum);
+}
+
+static String makeLogPayload()
+{
+    String payload;
+    for (int i = 0; i < 64; ++i)
+    {
+        payload += "2015-06-01 12:00:";
+        payload += String::fromValue(i % 60);
+        payload += " INFO request id=";
+        payload += String::fromValue(i * 7919);
+        payload += " path=/api/v1/objects?name=Some+Name&limit=100 status=200\n";
+    }
+    payload += "2015-06-01 12:01:00 ERROR connection reset by peer";
+    return payload;
+}
+
+int main()
+{
+    static const char *levelNames[] = { "scalar", "sse2", "avx2" };
+    String payload = makeLogPayload();
+    WString wpayload = string_cast<WString>(payload);
+    String upper = payload;
+    for (auto& ch : upper)
+        ch = toupper(ch);
+    String encoded = payload.urlencode();
+    printf("payload: %zu characters\n", payload.size());
+
+    ESimdLevel supported = simdLevel();
+    for (int level = eSimdScalar; level <= supported; ++level)
+    {
+        setSimdLevel(static_cast<ESimdLevel>(level));
+        char name[64];
+        snprintf(name, sizeof(name), "String::firstIndexOf (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += payload.firstIndexOf("connection reset");
+            return sum;
+        });
+        snprintf(name, sizeof(name), "WString::firstIndexOf (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += wpayload.firstIndexOf(U16("connection reset"));
+            return sum;
+        });
+        snprintf(name, sizeof(name), "WString::lastIndexOf (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += wpayload.lastIndexOf(U16("2015-06-01 12:00:0"));
+            return sum;
+        });
+        snprintf(name, sizeof(name), "WString::split (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += wpayload.split('\n').size();
+            return sum;
+        });
+        snprintf(name, sizeof(name), "String::equals nocase (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += payload.equals(upper, false);
+            return sum;
+        });
+        snprintf(name, sizeof(name), "String::urlencode (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += payload.urlencode().size();
+            return sum;
+        });
+        snprintf(name, sizeof(name), "String::urldecode (%s)", levelNames[level]);
+        measure(name, [&] {
+            size_t sum = 0;
+            for (int i = 0; i < Iterations; ++i)
+                sum += encoded.urldecode().size();
+            return sum;
+        });
+    }
+    return 0;
+}
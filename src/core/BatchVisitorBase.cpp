@@ -0,0 +1,106 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "BatchVisitorBase.h"
+#include "Object.h"
+
+namespace metacpp
+{
+
+BatchVisitorBase::BatchVisitorBase(EBatchOrder order)
+    : m_order(order)
+{
+}
+
+BatchVisitorBase::~BatchVisitorBase()
+{
+}
+
+EBatchOrder BatchVisitorBase::order() const
+{
+    return m_order;
+}
+
+const std::vector<BatchField> &BatchVisitorBase::fields(const MetaObject *metaObject)
+{
+    auto it = m_fields.find(metaObject);
+    if (it != m_fields.end())
+        return it->second;
+    std::vector<BatchField>& result = m_fields[metaObject];
+    result.reserve(metaObject->totalFields());
+    for (size_t i = 0; i < metaObject->totalFields(); ++i)
+    {
+        const MetaFieldBase *field = metaObject->field(i);
+        result.push_back(BatchField { field, field->offset(), field->size(), field->type(), field->nullable() });
+    }
+    return result;
+}
+
+void BatchVisitorBase::visit(Object *first, size_t count, size_t stride)
+{
+    if (!count)
+        return;
+    const MetaObject *metaObject = first->metaObject();
+    const std::vector<BatchField>& batchFields = fields(metaObject);
+    char *base = reinterpret_cast<char *>(first);
+    previsitBatch(metaObject, count);
+    if (m_order == eBatchFieldMajor)
+    {
+        for (const BatchField& field : batchFields)
+            visitColumn(BatchColumn(field, first, count, stride));
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Object *obj = reinterpret_cast<Object *>(base + i * stride);
+            previsitStruct(obj);
+            for (const BatchField& field : batchFields)
+                visitField(obj, field);
+            postvisitStruct(obj);
+        }
+    }
+    postvisitBatch(metaObject, count);
+}
+
+void BatchVisitorBase::previsitBatch(const MetaObject *metaObject, size_t count)
+{
+    (void)metaObject;
+    (void)count;
+}
+
+void BatchVisitorBase::previsitStruct(Object *obj)
+{
+    (void)obj;
+}
+
+void BatchVisitorBase::visitColumn(const BatchColumn &column)
+{
+    for (size_t i = 0; i < column.size(); ++i)
+        visitField(column.object(i), column.field());
+}
+
+void BatchVisitorBase::postvisitStruct(Object *obj)
+{
+    (void)obj;
+}
+
+void BatchVisitorBase::postvisitBatch(const MetaObject *metaObject, size_t count)
+{
+    (void)metaObject;
+    (void)count;
+}
+
+} // namespace metacpp
@@ -0,0 +1,133 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef BATCH_VISITOR_BASE_H
+#define BATCH_VISITOR_BASE_H
+#include "config.h"
+#include "MetaObject.h"
+#include "Array.h"
+#include <vector>
+#include <unordered_map>
+
+namespace metacpp
+{
+
+class Object;
+
+/** \brief Order of traversal used by BatchVisitorBase */
+enum EBatchOrder
+{
+    eBatchObjectMajor,      /**< all fields of the object are visited before the next object */
+    eBatchFieldMajor        /**< values of the single field are visited in all objects before the next field */
+};
+
+/** \brief Field reflection info resolved once per batch */
+struct BatchField
+{
+    const MetaFieldBase *field;     /**< reflection info of the field */
+    ptrdiff_t offset;               /**< offset of the field in Object */
+    size_t size;                    /**< size of the field */
+    EFieldType type;                /**< type of the field */
+    bool nullable;                  /**< whether field is Nullable<T> */
+};
+
+/** \brief Strided view over the values of a single field in contiguous same-typed objects */
+class BatchColumn
+{
+public:
+    /** \brief Constructs a new column starting at the first object of the batch */
+    BatchColumn(const BatchField& field, Object *first, size_t count, size_t stride)
+        : m_field(field), m_first(reinterpret_cast<char *>(first)), m_count(count), m_stride(stride)
+    {
+    }
+
+    /** \brief Gets resolved field info */
+    const BatchField& field() const { return m_field; }
+    /** \brief Gets number of values in this column */
+    size_t size() const { return m_count; }
+    /** \brief Gets the distance in bytes between consecutive values */
+    size_t stride() const { return m_stride; }
+    /** \brief Gets the object holding i-th value */
+    Object *object(size_t i) const { return reinterpret_cast<Object *>(m_first + i * m_stride); }
+    /** \brief Gets the address of the first value */
+    void *data() const { return m_first + m_field.offset; }
+    /** \brief Accesses i-th value, T must match the type of the field */
+    template<typename T>
+    T& at(size_t i) const { return *reinterpret_cast<T *>(m_first + i * m_stride + m_field.offset); }
+private:
+    const BatchField& m_field;
+    char *m_first;
+    size_t m_count;
+    size_t m_stride;
+};
+
+/**
+ * \brief Base class for visitors introspecting contiguous ranges of same-typed objects
+ *
+ * Unlike VisitorBase field reflection info is resolved once per MetaObject and reused for
+ * every object in the range. Field-major order passes each field as a strided BatchColumn,
+ * so values of a single column may be processed together.
+ */
+class BatchVisitorBase
+{
+public:
+    /** \brief Constructs a new instance of the BatchVisitorBase with the given order of traversal */
+    explicit BatchVisitorBase(EBatchOrder order = eBatchObjectMajor);
+    virtual ~BatchVisitorBase();
+
+    /** \brief Gets the order of traversal */
+    EBatchOrder order() const;
+
+    /** \brief Introspects count objects of the same type placed stride bytes apart starting from first */
+    void visit(Object *first, size_t count, size_t stride);
+
+    /** \brief Introspects count objects of the same type in the plain array */
+    template<typename TObj>
+    void visit(TObj *objects, size_t count)
+    {
+        if (count)
+            visit(static_cast<Object *>(objects), count, sizeof(TObj));
+    }
+
+    /** \brief Introspects all objects in the array */
+    template<typename TObj>
+    void visit(Array<TObj>& objects)
+    {
+        if (!objects.empty())
+            visit(objects.data(), objects.size());
+    }
+protected:
+    /** \brief Gets field reflection info of the given class, resolved on the first call */
+    const std::vector<BatchField>& fields(const MetaObject *metaObject);
+
+    /** \brief Method called before introspection of the batch */
+    virtual void previsitBatch(const MetaObject *metaObject, size_t count);
+    /** \brief Method called before introspection of every object in eBatchObjectMajor order */
+    virtual void previsitStruct(Object *obj);
+    /** \brief Method called on each field of each object */
+    virtual void visitField(Object *obj, const BatchField& field) = 0;
+    /** \brief Method called on each field in eBatchFieldMajor order, calls visitField for every value by default */
+    virtual void visitColumn(const BatchColumn& column);
+    /** \brief Method called after introspection of every object in eBatchObjectMajor order */
+    virtual void postvisitStruct(Object *obj);
+    /** \brief Method called at the end of introspection of the batch */
+    virtual void postvisitBatch(const MetaObject *metaObject, size_t count);
+private:
+    EBatchOrder m_order;
+    std::unordered_map<const MetaObject *, std::vector<BatchField> > m_fields;
+};
+
+} // namespace metacpp
+#endif // BATCH_VISITOR_BASE_H
@@ -0,0 +1,52 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef FIELDRUN_H
+#define FIELDRUN_H
+#include "config.h"
+#include "MetaObject.h"
+#include <vector>
+
+namespace metacpp
+{
+
+namespace detail
+{
+
+/** \brief Adds the field to the last run if it directly follows it, otherwise starts a new run
+ *
+ * Fields of MetaObject are ordered by offset, so adjacent scalars form contiguous runs
+ * which are processed with a single memcpy or memcmp. TRun should have offset and size members,
+ * other members of a new run are value-initialized.
+ * \returns true if a new run was started
+ */
+template<typename TRun>
+bool addToRuns(std::vector<TRun>& runs, const MetaFieldBase *field)
+{
+    bool started = runs.empty() || runs.back().offset + (ptrdiff_t)runs.back().size != field->offset();
+    if (started)
+    {
+        runs.push_back(TRun());
+        runs.back().offset = field->offset();
+    }
+    runs.back().size += field->size();
+    return started;
+}
+
+} // namespace detail
+
+} // namespace metacpp
+
+#endif // FIELDRUN_H
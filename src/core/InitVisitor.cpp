@@ -15,6 +15,10 @@
 ****************************************************************************/
 #include "InitVisitor.h"
 #include "Object.h"
+#include "FieldRun.h"
+#include <cstddef>
+#include <cstring>
+#include <new>
 
 namespace metacpp
 {
@@ -159,4 +163,158 @@ void InitVisitor::visitField(Object *obj, const MetaFieldBase *field)
     }
 }
 
+namespace detail
+{
+
+template<typename T>
+static bool putDefault(std::vector<char>& image, const MetaFieldBase *field, const T& value, size_t& imageOffset)
+{
+    // values are aligned in the image the same way as in the object, so fields adjacent in the object
+    // remain adjacent in the image and each run is still copied at once
+    const size_t alignMask = alignof(std::max_align_t) - 1;
+    imageOffset = image.size() + ((static_cast<size_t>(field->offset()) - image.size()) & alignMask);
+    if (field->nullable())
+    {
+        if (field->size() != sizeof(Nullable<T>))
+            return false;
+        image.resize(imageOffset + sizeof(Nullable<T>));
+        Nullable<T> *dest = new (&image[imageOffset]) Nullable<T>();
+        if (eOptional != field->mandatoriness())
+            *dest = value;
+    }
+    else
+    {
+        if (field->size() != sizeof(T))
+            return false;
+        image.resize(imageOffset + sizeof(T));
+        new (&image[imageOffset]) T(value);
+    }
+    return true;
+}
+
+ObjectInitPlan::ObjectInitPlan(const MetaObject *metaObject)
+{
+    for (size_t i = 0; i < metaObject->totalFields(); ++i)
+    {
+        const MetaFieldBase *field = metaObject->field(i);
+        if (addScalar(field))
+            continue;
+        InitField init { field, field->offset(), InitGeneric, field->nullable(),
+                         eOptional == field->mandatoriness(), 0 };
+        switch (field->type())
+        {
+        case eFieldString:
+            init.kind = InitString;
+            init.slot = m_strings.size();
+            m_strings.push_back(reinterpret_cast<const MetaFieldString *>(field)->defaultValue());
+            break;
+        case eFieldDateTime:
+            init.kind = InitDateTime;
+            break;
+        case eFieldArray:
+            init.kind = InitArray;
+            break;
+        case eFieldVariant:
+            init.kind = InitVariant;
+            break;
+        case eFieldObject:
+            init.kind = InitObject;
+            break;
+        default:
+            break;
+        }
+        m_fields.push_back(init);
+    }
+}
+
+bool ObjectInitPlan::addScalar(const MetaFieldBase *field)
+{
+    size_t imageOffset;
+    bool added;
+    switch (field->type())
+    {
+    case eFieldBool:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldBool *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldInt:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldInt *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldUint:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldUint *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldInt64:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldInt64 *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldUint64:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldUint64 *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldFloat:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldFloat *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldDouble:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldDouble *>(field)->defaultValue(), imageOffset);
+        break;
+    case eFieldEnum:
+        added = putDefault(m_image, field, reinterpret_cast<const MetaFieldEnum *>(field)->defaultValue(), imageOffset);
+        break;
+    default:
+        return false;
+    }
+    if (!added)
+        return false;
+    if (addToRuns(m_runs, field))
+        m_runs.back().imageOffset = imageOffset;
+    return true;
+}
+
+void ObjectInitPlan::apply(Object *obj) const
+{
+    char *base = reinterpret_cast<char *>(obj);
+    for (auto& run : m_runs)
+        std::memcpy(base + run.offset, m_image.data() + run.imageOffset, run.size);
+    InitVisitor fallback;
+    for (auto& init : m_fields)
+    {
+        void *p = base + init.offset;
+        switch (init.kind)
+        {
+        case InitString:
+            if (!init.nullable)
+                *reinterpret_cast<String *>(p) = m_strings[init.slot];
+            else if (init.optional)
+                reinterpret_cast<Nullable<String> *>(p)->reset();
+            else
+                *reinterpret_cast<Nullable<String> *>(p) = m_strings[init.slot];
+            break;
+        case InitDateTime:
+            if (!init.nullable)
+                *reinterpret_cast<DateTime *>(p) = DateTime();
+            else if (init.optional)
+                reinterpret_cast<Nullable<DateTime> *>(p)->reset();
+            else
+                *reinterpret_cast<Nullable<DateTime> *>(p) = DateTime();
+            break;
+        case InitArray:
+            reinterpret_cast<Array<char> *>(p)->clear();
+            break;
+        case InitVariant:
+            if (!init.nullable)
+                *reinterpret_cast<Variant *>(p) = Variant();
+            else if (init.optional)
+                reinterpret_cast<Nullable<Variant> *>(p)->reset();
+            else
+                *reinterpret_cast<Nullable<Variant> *>(p) = Variant();
+            break;
+        case InitObject:
+            reinterpret_cast<Object *>(p)->init();
+            break;
+        case InitGeneric:
+            fallback.visitField(obj, init.field);
+            break;
+        }
+    }
+}
+
+} // namespace detail
+
 } // namespace metacpp
@@ -17,6 +17,8 @@
 #define INITVISITOR_H
 #include "config.h"
 #include "VisitorBase.h"
+#include "MetaObject.h"
+#include <vector>
 
 namespace metacpp
 {
@@ -34,6 +36,63 @@ public:
     void visitField(Object *obj, const MetaFieldBase *field) override;
 };
 
+namespace detail
+{
+
+/** \brief Precomputed way of initializing objects of the single class with default values
+ *
+ * Scalar fields (including Nullable scalars) are initialized by copying contiguous runs from
+ * the image prepared once per class, other fields are initialized one by one with their
+ * typed default values. Built lazily by MetaObject and used by Object::init.
+ */
+class ObjectInitPlan
+{
+public:
+    explicit ObjectInitPlan(const MetaObject *metaObject);
+
+    /** \brief Initializes all reflected fields of the object */
+    void apply(Object *obj) const;
+private:
+    /** \brief Contiguous range of scalar fields copied from the image */
+    struct ImageRun
+    {
+        ptrdiff_t   offset;
+        size_t      size;
+        size_t      imageOffset;
+    };
+
+    enum InitKind
+    {
+        InitString,
+        InitDateTime,
+        InitArray,
+        InitVariant,
+        InitObject,
+        InitGeneric
+    };
+
+    /** \brief Field which needs to be constructed from it's typed default value */
+    struct InitField
+    {
+        const MetaFieldBase     *field;
+        ptrdiff_t               offset;
+        InitKind                kind;
+        bool                    nullable;
+        bool                    optional;
+        size_t                  slot;
+    };
+
+    /** \brief Puts default value of the scalar field into the image, returns false if not possible */
+    bool addScalar(const MetaFieldBase *field);
+
+    std::vector<char> m_image;
+    std::vector<ImageRun> m_runs;
+    std::vector<InitField> m_fields;
+    std::vector<String> m_strings;
+};
+
+} // namespace detail
+
 } // namespace metacpp
 
 #endif // INITVISITOR_H
@@ -25,6 +25,7 @@
 #include <mutex>
 #include <ctime>
 #include <memory>
+#include <typeinfo>
 #include "Array.h"
 #include "StringBase.h"
 #include "Nullable.h"
@@ -126,12 +127,14 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs default Extension */
         explicit Extension()
+            : ext()
         {
             mandatoriness = eOptional;
         }
 
         /** \brief Constructs bool Extension with default value v */
         explicit Extension(bool v)
+            : ext()
         {
             ext.m_bool.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -139,6 +142,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs int32_t Extension with default value v */
         explicit Extension(int32_t v)
+            : ext()
         {
             ext.m_int.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -146,6 +150,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs uint32_t Extension with default value v */
         explicit Extension(uint32_t v)
+            : ext()
         {
             ext.m_uint.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -153,6 +158,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs int64_t Extension with default value v */
         explicit Extension(int64_t v)
+            : ext()
         {
             ext.m_int64.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -160,6 +166,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs uint64_t Extension with default value v */
         explicit Extension(uint64_t v)
+            : ext()
         {
             ext.m_uint64.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -167,6 +174,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs float Extension with default value v */
         explicit Extension(float v)
+            : ext()
         {
             ext.m_float.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -174,6 +182,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs double Extension with default value v */
         explicit Extension(double v)
+            : ext()
         {
             ext.m_double.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -181,6 +190,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs metacpp::String Extension with default value v */
         explicit Extension(const char *v)
+            : ext()
         {
             ext.m_string.defaultValue = v;
             mandatoriness = eDefaultable;
@@ -188,6 +198,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs metacpp::DateTime Extension with default value v */
         explicit Extension(const metacpp::DateTime& v)
+            : ext()
         {
             ext.m_datetime.defaultValue = v.toStdTime();
             mandatoriness = eDefaultable;
@@ -195,12 +206,14 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs Extension with given mandatoriness m */
         explicit Extension(EMandatoriness m)
+            : ext()
         {
             mandatoriness = m;
         }
 
         /** \brief Constructs enum Extension with given enumInfo */
         explicit Extension(const EnumInfoDescriptor *enumInfo)
+            : ext()
         {
             ext.m_enum.enumInfo = enumInfo;
             mandatoriness = eDefaultable;
@@ -208,6 +221,7 @@ struct FieldInfoDescriptor
 
         /** \brief Constructs metacpp::Array Extension with given elemType and elemSize */
         explicit Extension(EFieldType elemType, size_t elemSize)
+            : ext()
         {
             ext.m_array.elemType = elemType;
             ext.m_array.elemSize = elemSize;
@@ -215,6 +229,7 @@ struct FieldInfoDescriptor
         }
         /** \brief Constructs metacpp::Object Extension with given metaObject */
         explicit Extension(const metacpp::MetaObject *metaObject)
+            : ext()
         {
             ext.m_obj.metaObject = metaObject;
             mandatoriness = eDefaultable;
@@ -340,6 +355,184 @@ namespace detail
     };
 } // namespace detail
 
+/** \brief Tag type used for argument-dependent lookup of compile-time field lists
+ *
+ * Being declared in the global namespace it makes the lists found regardless of
+ * the namespace of the reflected structure.
+ */
+struct StaticFieldInfoTag {};
+
+namespace detail
+{
+    /** \brief Compile-time field entry carrying a pointer to the member as a template argument */
+    template<typename TMemberPtr, TMemberPtr Member>
+    struct StaticField
+    {
+        FieldInfoDescriptor m_descriptor;
+
+        template<typename TObj, typename TFunc>
+        static void apply(const FieldInfoDescriptor& descriptor, TObj& obj, TFunc& func)
+        {
+            func(descriptor, obj.*Member);
+        }
+    };
+
+    /** \brief Terminating entry of the compile-time field list */
+    struct StaticFieldEnd
+    {
+        FieldInfoDescriptor m_descriptor;
+
+        StaticFieldEnd()
+            : m_descriptor { 0, 0, 0, eFieldVoid, false, FieldInfoDescriptor::Extension() }
+        {
+        }
+    };
+
+    template<typename... TFields>
+    struct StaticFieldWalker;
+
+    template<>
+    struct StaticFieldWalker<StaticFieldEnd>
+    {
+        template<typename TObj, typename TFunc>
+        static void walk(const FieldInfoDescriptor *, TObj&, TFunc&)
+        {
+        }
+    };
+
+    template<typename TField, typename... TRest>
+    struct StaticFieldWalker<TField, TRest...>
+    {
+        template<typename TObj, typename TFunc>
+        static void walk(const FieldInfoDescriptor *descriptors, TObj& obj, TFunc& func)
+        {
+            TField::apply(*descriptors, obj, func);
+            StaticFieldWalker<TRest...>::walk(descriptors + 1, obj, func);
+        }
+    };
+
+    /** \brief Compile-time list of reflected fields of TObj
+     *
+     * Holds the runtime descriptors (including the terminating one) in the same layout
+     * the MetaInfoDescriptor expects, while the field types and member pointers are
+     * kept in the type itself.
+     */
+    template<typename TObj, typename... TFields>
+    struct StaticFieldList
+    {
+        typedef TObj ObjectType;
+
+        explicit StaticFieldList(const TFields&... fields)
+            : m_descriptors { fields.m_descriptor... }
+        {
+        }
+
+        template<typename T, typename TFunc>
+        void forEach(T& obj, TFunc& func) const
+        {
+            StaticFieldWalker<TFields...>::walk(m_descriptors, obj, func);
+        }
+
+        FieldInfoDescriptor m_descriptors[sizeof...(TFields)];
+    };
+
+    template<typename TObj, typename... TFields>
+    StaticFieldList<TObj, TFields...> makeStaticFieldList(const TFields&... fields)
+    {
+        return StaticFieldList<TObj, TFields...>(fields...);
+    }
+
+    template<typename T>
+    struct HasStaticFieldList
+    {
+        template<typename U>
+        static auto test(int) -> decltype(_staticFieldList(static_cast<const U *>(nullptr),
+                                                           static_cast<StaticFieldInfoTag *>(nullptr)), std::true_type());
+        template<typename U>
+        static std::false_type test(...);
+
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<typename T>
+    struct HasStaticFieldSuper
+    {
+        template<typename U>
+        static auto test(int) -> decltype(_staticFieldSuper(static_cast<const U *>(nullptr),
+                                                            static_cast<StaticFieldInfoTag *>(nullptr)), std::true_type());
+        template<typename U>
+        static std::false_type test(...);
+
+        static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    template<typename T, bool HasSuper = HasStaticFieldSuper<T>::value>
+    struct StaticFieldVisitor
+    {
+        template<typename TObj, typename TFunc>
+        static void visit(TObj& obj, TFunc& func)
+        {
+            static_assert(HasStaticFieldList<T>::value,
+                          "Compile-time field list is not visible, STRUCT_INFO of the class should be in this translation unit");
+            const auto& list = _staticFieldList(static_cast<const T *>(nullptr), static_cast<StaticFieldInfoTag *>(nullptr));
+            static_assert(std::is_same<typename std::remove_reference<decltype(list)>::type::ObjectType, T>::value,
+                          "Compile-time field list belongs to another class");
+            list.forEach(obj, func);
+        }
+    };
+
+    template<typename T>
+    struct StaticFieldVisitor<T, true>
+    {
+        typedef typename std::remove_cv<typename std::remove_pointer<
+            decltype(_staticFieldSuper(static_cast<const T *>(nullptr), static_cast<StaticFieldInfoTag *>(nullptr)))>::type>::type SuperType;
+
+        template<typename TObj, typename TFunc>
+        static void visit(TObj& obj, TFunc& func)
+        {
+            // metacpp::Object has no reflected fields, so its list is not needed
+            StaticFieldVisitor<SuperType, std::is_same<SuperType, metacpp::Object>::value ||
+                HasStaticFieldSuper<SuperType>::value>::visit(obj, func);
+            StaticFieldVisitor<T, false>::visit(obj, func);
+        }
+    };
+
+    template<>
+    struct StaticFieldVisitor<metacpp::Object, true>
+    {
+        template<typename TObj, typename TFunc>
+        static void visit(TObj&, TFunc&)
+        {
+        }
+    };
+} // namespace detail
+
+namespace metacpp
+{
+
+/** \brief Calls func(const FieldInfoDescriptor&, field) for each reflected field of obj
+ *
+ * Unlike MetaObject this expands at compile time to direct member accesses, so func should
+ * be a functor with a templated call operator. Fields of the super classes are visited first.
+ * Available only in translation units where STRUCT_INFO of T (and its super classes) is defined.
+ */
+template<typename T, typename TFunc>
+void for_each_field(T& obj, TFunc func)
+{
+    ::detail::StaticFieldVisitor<typename std::remove_cv<T>::type>::visit(obj, func);
+}
+
+/** \brief Calls func(const FieldInfoDescriptor&, const field&) for each reflected field of obj
+ * \see for_each_field(T&, TFunc)
+ */
+template<typename T, typename TFunc>
+void for_each_field(const T& obj, TFunc func)
+{
+    ::detail::StaticFieldVisitor<typename std::remove_cv<T>::type>::visit(obj, func);
+}
+
+} // namespace metacpp
+
 /** \brief Exception thrown internally during invokation of reflection methods */
 class BindArgumentException : public std::invalid_argument
 {
@@ -467,15 +660,85 @@ namespace
         {
         }
     };
+
+    /** \brief Checks whether the variant holds exactly the type T, so unpacking it cannot fail whatever the value is */
+    template<typename T>
+    struct exact_arg
+    {
+        static bool matches(const metacpp::Variant&) { return false; }
+    };
+
+    template<>
+    struct exact_arg<metacpp::Variant>
+    {
+        static bool matches(const metacpp::Variant&) { return true; }
+    };
+
+#define EXACT_ARG(T, fieldType) \
+    template<> \
+    struct exact_arg<T> \
+    { \
+        static bool matches(const metacpp::Variant& v) { return v.valid() && fieldType == v.type(); } \
+    };
+
+    EXACT_ARG(bool, eFieldBool)
+    EXACT_ARG(int32_t, eFieldInt)
+    EXACT_ARG(uint32_t, eFieldUint)
+    EXACT_ARG(int64_t, eFieldInt64)
+    EXACT_ARG(uint64_t, eFieldUint64)
+    EXACT_ARG(float, eFieldFloat)
+    EXACT_ARG(double, eFieldDouble)
+    EXACT_ARG(metacpp::String, eFieldString)
+    EXACT_ARG(metacpp::DateTime, eFieldDateTime)
+#undef EXACT_ARG
+
+    template<typename... TArgs>
+    struct exact_args;
+
+    template<>
+    struct exact_args<>
+    {
+        static bool matches(const metacpp::Array<metacpp::Variant>&, size_t) { return true; }
+    };
+
+    template<typename TArg, typename... TArgs>
+    struct exact_args<TArg, TArgs...>
+    {
+        static bool matches(const metacpp::Array<metacpp::Variant>& argList, size_t i)
+        {
+            return exact_arg<typename std::remove_cv<typename std::remove_reference<TArg>::type>::type>::matches(argList[i]) &&
+                    exact_args<TArgs...>::matches(argList, i + 1);
+        }
+    };
+
+    template<typename... TArgs>
+    bool exact_match(const metacpp::Array<metacpp::Variant>& argList)
+    {
+        return sizeof...(TArgs) == argList.size() && exact_args<TArgs...>::matches(argList, 0);
+    }
 }
 
 /** \brief Base helper class for invokation of reflection methods */
 class MetaInvokerBase
 {
 public:
+    /** \brief Type-erased pointer to the native call thunk */
+    typedef void (*NativeThunk)();
+
     virtual ~MetaInvokerBase() { }
     /** \brief Invokes method with the given context and arguments */
     virtual metacpp::Variant invoke(const void *contextObj, const metacpp::Array<metacpp::Variant>& argList) const = 0;
+    /** \brief Gets the signature TRes(TArgs...) of the invoked function */
+    virtual const std::type_info& signature() const = 0;
+    /** \brief Gets the native call thunk of type TRes (*)(const MetaInvokerBase *, const void *contextObj, TArgs...),
+     * which calls the function directly, without Variant conversions
+     * \see metacpp::MethodHandle
+     */
+    virtual NativeThunk nativeThunk() const = 0;
+    /** \brief Checks whether types of the arguments are exactly the ones of the function,
+     * so the invokation never fails because of argument conversion whatever the values are
+     */
+    virtual bool exactMatch(const metacpp::Array<metacpp::Variant>& argList) const = 0;
 };
 
 /** \brief Helper class for invokation of static methods
@@ -527,7 +790,30 @@ public:
         return doInvoke(argList);
     }
 
+    /** \brief Overrides MetaInvokerBase::signature */
+    const std::type_info& signature() const override
+    {
+        return typeid(TRes (TArgs...));
+    }
+
+    /** \brief Overrides MetaInvokerBase::nativeThunk */
+    NativeThunk nativeThunk() const override
+    {
+        return reinterpret_cast<NativeThunk>(&FunctionInvoker::nativeCall);
+    }
+
+    /** \brief Overrides MetaInvokerBase::exactMatch */
+    bool exactMatch(const metacpp::Array<metacpp::Variant>& argList) const override
+    {
+        return exact_match<TArgs...>(argList);
+    }
+
 private:
+    static TRes nativeCall(const MetaInvokerBase *self, const void *, TArgs... args)
+    {
+        return static_cast<const FunctionInvoker *>(self)->m_function(std::forward<TArgs>(args)...);
+    }
+
     TFunction m_function;
 };
 
@@ -579,7 +865,31 @@ public:
         return doInvoke(reinterpret_cast<TObj *>(const_cast<void *>(obj)), argList);
     }
 
+    /** \brief Overrides MetaInvokerBase::signature */
+    const std::type_info& signature() const override
+    {
+        return typeid(TRes (TArgs...));
+    }
+
+    /** \brief Overrides MetaInvokerBase::nativeThunk */
+    NativeThunk nativeThunk() const override
+    {
+        return reinterpret_cast<NativeThunk>(&MethodInvoker::nativeCall);
+    }
+
+    /** \brief Overrides MetaInvokerBase::exactMatch */
+    bool exactMatch(const metacpp::Array<metacpp::Variant>& argList) const override
+    {
+        return exact_match<TArgs...>(argList);
+    }
+
 private:
+    static TRes nativeCall(const MetaInvokerBase *self, const void *obj, TArgs... args)
+    {
+        return (reinterpret_cast<TObj *>(const_cast<void *>(obj))->*static_cast<const MethodInvoker *>(self)->m_method)
+                (std::forward<TArgs>(args)...);
+    }
+
     TFunction m_method;
 };
 
@@ -631,7 +941,31 @@ public:
         return doInvoke(reinterpret_cast<const TObj *>(obj), argList);
     }
 
+    /** \brief Overrides MetaInvokerBase::signature */
+    const std::type_info& signature() const override
+    {
+        return typeid(TRes (TArgs...));
+    }
+
+    /** \brief Overrides MetaInvokerBase::nativeThunk */
+    NativeThunk nativeThunk() const override
+    {
+        return reinterpret_cast<NativeThunk>(&ConstMethodInvoker::nativeCall);
+    }
+
+    /** \brief Overrides MetaInvokerBase::exactMatch */
+    bool exactMatch(const metacpp::Array<metacpp::Variant>& argList) const override
+    {
+        return exact_match<TArgs...>(argList);
+    }
+
 private:
+    static TRes nativeCall(const MetaInvokerBase *self, const void *obj, TArgs... args)
+    {
+        return (reinterpret_cast<const TObj *>(obj)->*static_cast<const ConstMethodInvoker *>(self)->m_method)
+                (std::forward<TArgs>(args)...);
+    }
+
     TFunction m_method;
 };
 
@@ -664,6 +998,30 @@ public:
     {
         return doInvoke(const_cast<void *>(mem), argList);
     }
+
+    /** \brief Overrides MetaInvokerBase::signature */
+    const std::type_info& signature() const override
+    {
+        return typeid(TObj *(TArgs...));
+    }
+
+    /** \brief Overrides MetaInvokerBase::nativeThunk */
+    NativeThunk nativeThunk() const override
+    {
+        return reinterpret_cast<NativeThunk>(&ConstructorInvoker::nativeCall);
+    }
+
+    /** \brief Overrides MetaInvokerBase::exactMatch */
+    bool exactMatch(const metacpp::Array<metacpp::Variant>& argList) const override
+    {
+        return exact_match<TArgs...>(argList);
+    }
+
+private:
+    static TObj *nativeCall(const MetaInvokerBase *, const void *mem, TArgs... args)
+    {
+        return new (const_cast<void *>(mem)) TObj(std::forward<TArgs>(args)...);
+    }
 };
 
 namespace detail
@@ -827,30 +1185,35 @@ struct MetaInfoDescriptor
     },
 
 /** \brief Starts a list of property descriptors
+ *
+ * Besides the runtime descriptors the list also keeps the compile-time information
+ * used by metacpp::for_each_field.
  * \relates MetaInfoDescriptor
  */
 #define STRUCT_INFO_BEGIN(struc) \
-    const FieldInfoDescriptor _fieldInfos_##struc[] = {
+    static const auto _fieldList_##struc = ::detail::makeStaticFieldList<struc>(
 
 /** \brief Terminates a list of property descriptors
  * \relates MetaInfoDescriptor
  */
 #define STRUCT_INFO_END(struc) \
-        { 0, 0, 0, eFieldVoid, false, FieldInfoDescriptor::Extension() } \
-    };
+        ::detail::StaticFieldEnd()); \
+    static const auto& _fieldInfos_##struc = _fieldList_##struc.m_descriptors; \
+    static inline const decltype(_fieldList_##struc)& _staticFieldList(const struc *, StaticFieldInfoTag *) \
+        { return _fieldList_##struc; }
 
 /** \brief Puts a property descriptor into the list
  * \relates MetaInfoDescriptor
  * \see STRUCT_INFO_BEGIN, STRUCT_INFO_END
  */
-#define FIELD(struc, field, ...) { \
+#define FIELD(struc, field, ...) ::detail::StaticField<decltype(&struc::field), &struc::field> { { \
     /* name */      #field, \
     /* size */      sizeof(decltype(struc::field)), \
     /* offset */    offsetof(struc, field), \
     /* type */      ::detail::FullFieldInfoHelper<std::remove_cv<decltype(struc::field)>::type>::type(), \
     /* nullable */  ::detail::FullFieldInfoHelper<std::remove_cv<decltype(struc::field)>::type>::nullable(), \
     /* extension */ ::detail::FullFieldInfoHelper<std::remove_cv<decltype(struc::field)>::type>::extension(__VA_ARGS__) \
-    },
+    } },
 
 /** \brief Macro used for accessing previously declared MetaInfoDescriptor for the struc
   \relates MetaInfoDescriptor
@@ -873,6 +1236,7 @@ struct MetaInfoDescriptor
  */
 #define REFLECTIBLE_DERIVED_F(struc, superStruc) \
     const MetaInfoDescriptor _descriptor_##struc = { #struc, sizeof(struc), &REFLECTIBLE_DESCRIPTOR(superStruc), _fieldInfos_##struc, nullptr  }; \
+    static inline const superStruc *_staticFieldSuper(const struc *, StaticFieldInfoTag *) { return nullptr; }
 
 /** \brief Defines MetaInfoDescriptor for the struc with method reflection info
   \relates MetaInfoDescriptor
@@ -897,6 +1261,7 @@ struct MetaInfoDescriptor
  */
 #define REFLECTIBLE_DERIVED_FM(struc, superStruc) \
     const MetaInfoDescriptor _descriptor_##struc = { #struc, sizeof(struc), &REFLECTIBLE_DESCRIPTOR(superStruc), _fieldInfos_##struc, _methodInfos_##struc }; \
+    static inline const superStruc *_staticFieldSuper(const struc *, StaticFieldInfoTag *) { return nullptr; }
 
 /** \brief Starts a list of enumeration value descriptors
  * \relates EnumInfoDescriptor
@@ -15,20 +15,169 @@
 ****************************************************************************/
 #include "MetaObject.h"
 #include "Object.h"
+#include "MetaObjectRegistry.h"
+#include "ObjectSnapshot.h"
+#include "ObjectArena.h"
+#include "InitVisitor.h"
+#include "ObjectOperations.h"
 #include <algorithm>
 #include <iostream>
 #include <mutex>
+#include <cstring>
+#include <cassert>
 
 namespace metacpp
 {
 
+namespace detail
+{
+
+static inline char foldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+void NameIndex::build(const std::vector<const char *> &names, bool caseSensetive)
+{
+    m_caseSensetive = caseSensetive;
+    // keep load factor below 0.5, table size is a power of two
+    size_t capacity = 4;
+    while (capacity < names.size() * 2) capacity <<= 1;
+    m_slots.assign(capacity, Slot { nullptr, 0, 0, npos });
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        size_t length = strlen(names[i]);
+        uint32_t h = hash(names[i], length, caseSensetive);
+        for (size_t j = h & (capacity - 1);; j = (j + 1) & (capacity - 1))
+        {
+            Slot& slot = m_slots[j];
+            if (!slot.name)
+            {
+                slot = Slot { names[i], h, (uint32_t)length, i };
+                break;
+            }
+            if (slot.hash == h && equals(slot, names[i], length))
+                break; // first occurrence wins
+        }
+    }
+}
+
+size_t NameIndex::find(const char *name, size_t length) const
+{
+    if (m_slots.empty())
+        return npos;
+    const size_t mask = m_slots.size() - 1;
+    uint32_t h = hash(name, length, m_caseSensetive);
+    for (size_t j = h & mask;; j = (j + 1) & mask)
+    {
+        const Slot& slot = m_slots[j];
+        if (!slot.name)
+            return npos;
+        if (slot.hash == h && equals(slot, name, length))
+            return slot.position;
+    }
+}
+
+uint32_t NameIndex::hash(const char *name, size_t length, bool caseSensetive)
+{
+    uint32_t h = Fnv1a<uint32_t>::basis();
+    for (size_t i = 0; i < length; ++i)
+        h = fnv1aMix<uint32_t>(h, (unsigned char)(caseSensetive ? name[i] : foldCase(name[i])));
+    return h;
+}
+
+bool NameIndex::equals(const Slot &slot, const char *name, size_t length) const
+{
+    if (slot.length != length)
+        return false;
+    if (m_caseSensetive)
+        return 0 == memcmp(slot.name, name, length);
+    for (size_t i = 0; i < length; ++i)
+        if (foldCase(slot.name[i]) != foldCase(name[i]))
+            return false;
+    return true;
+}
+
+OverloadCache::OverloadCache()
+{
+    for (size_t i = 0; i < NumSlots; ++i)
+        m_slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+OverloadCache::~OverloadCache()
+{
+}
+
+const MetaCallBase *OverloadCache::find(char kind, const String &name, const VariantArray &args) const
+{
+    if (args.size() > MaxArgs)
+        return nullptr;
+    uint32_t h = hash(kind, name, args);
+    const Entry *entry = m_slots[h % NumSlots].load(std::memory_order_acquire);
+    return matches(entry, h, kind, name, args) ? entry->method : nullptr;
+}
+
+void OverloadCache::insert(char kind, const String &name, const VariantArray &args, const MetaCallBase *method)
+{
+    if (args.size() > MaxArgs)
+        return;
+    uint32_t h = hash(kind, name, args);
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    if (m_entries.size() >= MaxEntries)
+        return;
+    std::unique_ptr<Entry> entry(new Entry);
+    entry->hash = h;
+    entry->kind = kind;
+    entry->name = name;
+    entry->numArgs = args.size();
+    for (size_t i = 0; i < args.size(); ++i)
+        entry->argTypes[i] = args[i].valid() ? static_cast<char>(args[i].type()) : static_cast<char>(eFieldVoid);
+    entry->method = method;
+    // replaced entries are kept alive since concurrent readers may still hold them
+    m_slots[h % NumSlots].store(entry.get(), std::memory_order_release);
+    m_entries.push_back(std::move(entry));
+}
+
+uint32_t OverloadCache::hash(char kind, const String &name, const VariantArray &args)
+{
+    uint32_t h = Fnv1a<uint32_t>::basis();
+    auto mix = [&](char c) { h = fnv1aMix<uint32_t>(h, (unsigned char)c); };
+    mix(kind);
+    for (size_t i = 0; i < name.length(); ++i)
+        mix(name[i]);
+    for (size_t i = 0; i < args.size(); ++i)
+        mix(args[i].valid() ? static_cast<char>(args[i].type()) : static_cast<char>(eFieldVoid));
+    return h;
+}
+
+bool OverloadCache::matches(const Entry *entry, uint32_t hash, char kind, const String &name, const VariantArray &args)
+{
+    if (!entry || entry->hash != hash || entry->kind != kind || entry->numArgs != args.size())
+        return false;
+    for (size_t i = 0; i < args.size(); ++i)
+        if (entry->argTypes[i] != (args[i].valid() ? static_cast<char>(args[i].type()) : static_cast<char>(eFieldVoid)))
+            return false;
+    return entry->name == name;
+}
+
+} // namespace detail
+
 MetaObject::MetaObject(const MetaInfoDescriptor *descriptor)
-    : m_descriptor(descriptor), m_initialized(false)
+    : MetaObject(descriptor, true)
+{
+}
+
+MetaObject::MetaObject(const MetaInfoDescriptor *descriptor, bool registered)
+    : m_descriptor(descriptor), m_registered(registered), m_initialized(false), m_super(nullptr)
 {
+    if (m_registered)
+        MetaObjectRegistry::instance().registerMetaObject(this);
 }
 
 MetaObject::~MetaObject(void)
 {
+    if (m_registered)
+        MetaObjectRegistry::instance().unregisterMetaObject(this);
 }
 
 const char *MetaObject::name() const
@@ -54,15 +203,16 @@ const MetaFieldBase *MetaObject::fieldByOffset(ptrdiff_t offset) const
     return it ==  m_fields.end() ? nullptr : it->get();
 }
 
-const MetaFieldBase *MetaObject::fieldByName(const String &name, bool caseSensetive) const
+const MetaFieldBase *MetaObject::fieldByName(const StringView &name, bool caseSensetive) const
 {
     prepare();
-    auto it = std::find_if(m_fields.begin(), m_fields.end(),
-        [=](const std::unique_ptr<MetaFieldBase>& field)
-        {
-            return name.equals(field->name(), caseSensetive);
-        });
-    return it == m_fields.end() ? nullptr : it->get();
+    size_t pos = (caseSensetive ? m_fieldIndex : m_fieldIndexNoCase).find(name.data(), name.length());
+    return pos == detail::NameIndex::npos ? nullptr : m_fields[pos].get();
+}
+
+const MetaFieldBase *MetaObject::fieldByName(const char *name, bool caseSensetive) const
+{
+    return fieldByName(StringView(name, strlen(name)), caseSensetive);
 }
 
 size_t MetaObject::totalFields() const
@@ -77,15 +227,16 @@ const MetaCallBase *MetaObject::method(size_t i) const
     return m_methods[i].get();
 }
 
-const MetaCallBase *MetaObject::methodByName(const String &name, bool caseSensetive) const
+const MetaCallBase *MetaObject::methodByName(const StringView &name, bool caseSensetive) const
 {
     prepare();
-    auto it = std::find_if(m_methods.begin(), m_methods.end(),
-        [=](const std::unique_ptr<MetaCallBase>& method)
-        {
-            return name.equals(method->name(), caseSensetive);
-        });
-    return it == m_methods.end() ? nullptr : it->get();
+    size_t pos = (caseSensetive ? m_methodIndex : m_methodIndexNoCase).find(name.data(), name.length());
+    return pos == detail::NameIndex::npos ? nullptr : m_methods[pos].get();
+}
+
+const MetaCallBase *MetaObject::methodByName(const char *name, bool caseSensetive) const
+{
+    return methodByName(StringView(name, strlen(name)), caseSensetive);
 }
 
 size_t MetaObject::totalMethods() const
@@ -97,9 +248,8 @@ size_t MetaObject::totalMethods() const
 const MetaObject *MetaObject::superMetaObject() const
 {
     if (!m_descriptor->m_superDescriptor) return nullptr;
-    if (!m_super)
-        m_super.reset(new MetaObject(m_descriptor->m_superDescriptor));
-    return m_super.get();
+    prepare();
+    return m_super;
 }
 
 size_t MetaObject::size() const
@@ -107,62 +257,134 @@ size_t MetaObject::size() const
     return m_descriptor->m_dwSize;
 }
 
+const detail::ObjectDiffPlan *MetaObject::diffPlan() const
+{
+    std::call_once(m_diffPlanOnce, [this]() { m_diffPlan.reset(new detail::ObjectDiffPlan(this)); });
+    return m_diffPlan.get();
+}
+
+const detail::ObjectInitPlan *MetaObject::initPlan() const
+{
+    std::call_once(m_initPlanOnce, [this]() { m_initPlan.reset(new detail::ObjectInitPlan(this)); });
+    return m_initPlan.get();
+}
+
+detail::ObjectPool *MetaObject::pool() const
+{
+    std::call_once(m_poolOnce, [this]() { m_pool.reset(new detail::ObjectPool(size())); });
+    return m_pool.get();
+}
+
+Object *MetaObject::constructInstance(void *mem, const VariantArray &args) const
+{
+    Variant result;
+    if (dispatch(eMethodConstructor, false, String(), mem, args, result))
+        return result.extractObject();
+    throw MethodNotFoundException(String("Cannot find appropriate constructor").c_str());
+}
+
 Object *MetaObject::createInstance(const VariantArray &args) const
 {
-    prepare();
     void *pMem = ::operator new(size());
-    for (auto& method : m_methods)
+    try
     {
-        if (eMethodConstructor == method->type() && args.size() == method->numArguments())
-        {
-            try
-            {
-                return method->invoker()->invoke(pMem, args).extractObject();
-            }
-            catch (const BindArgumentException& /*ex*/)
-            {
-                continue;
-            }
-        }
+        return constructInstance(pMem, args);
     }
-    ::operator delete(pMem);
-    throw MethodNotFoundException(String("Cannot find appropriate constructor").c_str());
+    catch (...)
+    {
+        ::operator delete(pMem);
+        throw;
+    }
+}
+
+Object *MetaObject::createInstance(ObjectArena &arena, const VariantArray &args) const
+{
+    return arena.create(this, args);
 }
 
 void MetaObject::destroyInstance(Object *object) const
 {
+    // instances allocated from the pool are owned by an arena and destroyed only by it
+    assert(!m_pool || !m_pool->owns(object));
     // delete using virtual destructor
     if (object)
         delete object;
 }
 
 Variant MetaObject::invoke(const String &methodName, const VariantArray &args) const
+{
+    Variant result;
+    if (dispatch(eMethodStatic, false, methodName, this, args, result))
+        return result;
+    throw MethodNotFoundException(String("Cannot find static method " + methodName + " compatible with arguments provided").c_str());
+}
+
+const MetaCallBase *MetaObject::findMethod(const String &name, const std::type_info &signature) const
 {
     prepare();
     for (auto& method : m_methods)
     {
-        if (eMethodStatic == method->type() && args.size() == method->numArguments() && methodName.equals(method->name()))
+        if (eMethodConstructor != method->type() && name.equals(method->name()) &&
+                method->invoker()->signature() == signature)
+            return method.get();
+    }
+    return nullptr;
+}
+
+static bool tryInvoke(const MetaCallBase *method, const void *context, const VariantArray &args, Variant &result)
+{
+    try
+    {
+        result = method->invoker()->invoke(context, args);
+        return true;
+    }
+    catch (const BindArgumentException& /*ex*/)
+    {
+        return false;
+    }
+}
+
+bool MetaObject::dispatch(EMethodType type, bool constness, const String &methodName,
+                          const void *context, const VariantArray &args, Variant &result) const
+{
+    prepare();
+    const char kind = static_cast<char>(2 * type + (constness ? 1 : 0));
+    // Overload previously resolved for the same argument types.
+    // Only value-independent choices are cached, so the cached method is the one the full scan would pick
+    const MetaCallBase *cached = m_overloadCache.find(kind, methodName, args);
+    if (cached && tryInvoke(cached, context, args, result))
+        return true;
+
+    bool tried = false;
+    for (auto& method : m_methods)
+    {
+        if (type != method->type() || args.size() != method->numArguments() || method.get() == cached)
+            continue;
+        if (eMethodConstructor != type && !methodName.equals(method->name()))
+            continue;
+        // cannot call non-const methods on const objects
+        if (constness && !method->constness())
+            continue;
+        if (tryInvoke(method.get(), context, args, result))
         {
-            try
-            {
-                return method->invoker()->invoke(this, args);
-            }
-            catch (const BindArgumentException& /*ex*/)
-            {
-                continue;
-            }
+            // the first candidate taking exactly these argument types is chosen whatever the values are,
+            // while the choice after a failed conversion of some value (i.e. "abc" to int) is not
+            if (!tried && !cached && method->invoker()->exactMatch(args))
+                m_overloadCache.insert(kind, methodName, args, method.get());
+            return true;
         }
+        tried = true;
     }
-    throw MethodNotFoundException(String("Cannot find static method " + methodName + " compatible with arguments provided").c_str());
+    return false;
 }
 
 void MetaObject::prepare() const
 {
     // double checked lock
-    if (m_initialized) return;
+    if (m_initialized.load(std::memory_order_acquire)) return;
     {
         std::lock_guard<std::mutex> _guard(m_mutex);
-        if (m_initialized) return;
+        if (m_initialized.load(std::memory_order_relaxed)) return;
         MetaFieldFactory fieldFactory;
         MetaCallFactory methodFactory;
         for (const MetaInfoDescriptor *desc = m_descriptor; desc; desc = desc->m_superDescriptor)
@@ -184,7 +406,31 @@ void MetaObject::prepare() const
         }
         std::sort(m_fields.begin(), m_fields.end(), [](const std::unique_ptr<MetaFieldBase>& a, const std::unique_ptr<MetaFieldBase>& b)
             {return a->offset() < b->offset(); });
-        m_initialized.store(true);
+
+        std::vector<const char *> names;
+        names.reserve(m_fields.size());
+        for (auto& field : m_fields)
+            names.push_back(field->name());
+        m_fieldIndex.build(names, true);
+        m_fieldIndexNoCase.build(names, false);
+        names.clear();
+        for (auto& method : m_methods)
+            names.push_back(method->name());
+        m_methodIndex.build(names, true);
+        m_methodIndexNoCase.build(names, false);
+
+        if (m_descriptor->m_superDescriptor)
+        {
+            m_super = MetaObjectRegistry::instance().findByDescriptor(m_descriptor->m_superDescriptor);
+            if (!m_super)
+            {
+                // super class has no META_INFO of it's own
+                m_ownedSuper.reset(new MetaObject(m_descriptor->m_superDescriptor, false));
+                m_super = m_ownedSuper.get();
+            }
+        }
+
+        m_initialized.store(true, std::memory_order_release);
     }
 }
 
@@ -364,6 +610,21 @@ void MetaFieldObject::setValue(const Variant &, Object *) const
     throw std::runtime_error("MetaFieldObject::setValue() not implemented");
 }
 
+void MetaFieldObject::visitValue(const Object *, FieldValueVisitor &) const
+{
+    throw std::runtime_error("MetaFieldObject::visitValue() not implemented");
+}
+
+bool MetaFieldObject::readInto(const Object *, void *) const
+{
+    throw std::runtime_error("MetaFieldObject::readInto() not implemented");
+}
+
+void MetaFieldObject::writeFrom(Object *, const void *) const
+{
+    throw std::runtime_error("MetaFieldObject::writeFrom() not implemented");
+}
+
 const MetaObject *MetaFieldObject::fieldMetaObject() const
 {
     return m_descriptor->valueInfo.ext.m_obj.metaObject;
@@ -384,6 +645,21 @@ void MetaFieldArray::setValue(const Variant &, Object *) const
     throw std::runtime_error("MetaFieldArray::setValue() not implemented");
 }
 
+void MetaFieldArray::visitValue(const Object *, FieldValueVisitor &) const
+{
+    throw std::runtime_error("MetaFieldArray::visitValue() not implemented");
+}
+
+bool MetaFieldArray::readInto(const Object *, void *) const
+{
+    throw std::runtime_error("MetaFieldArray::readInto() not implemented");
+}
+
+void MetaFieldArray::writeFrom(Object *, const void *) const
+{
+    throw std::runtime_error("MetaFieldArray::writeFrom() not implemented");
+}
+
 EFieldType MetaFieldArray::arrayElementType() const
 {
     return m_descriptor->valueInfo.ext.m_array.elemType;
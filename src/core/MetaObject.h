@@ -21,6 +21,7 @@
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <cassert>
 #include "Utils.h"
 #include "Variant.h"
 
@@ -29,6 +30,90 @@ namespace metacpp
 
 class MetaFieldBase;
 class MetaCallBase;
+class ObjectArena;
+template<typename TSignature> class MethodHandle;
+
+namespace detail
+{
+
+class ObjectDiffPlan;
+class ObjectInitPlan;
+class ObjectComparePlan;
+class ObjectPool;
+
+/** \brief Open-addressing hash index mapping reflection info names to their positions
+ *
+ * Built once when MetaObject is prepared and never modified afterwards,
+ * so lookups require no synchronization. If the same name occurs several
+ * times (e.g. overloaded methods), the first position is kept.
+ */
+class NameIndex
+{
+public:
+    static const size_t npos = (size_t)-1;
+
+    /** \brief Rebuilds the index from the given names, folding ASCII case if caseSensetive is false */
+    void build(const std::vector<const char *>& names, bool caseSensetive);
+    /** \brief Gets a position of the name or npos if it's not present in the index */
+    size_t find(const char *name, size_t length) const;
+private:
+    struct Slot
+    {
+        const char *name;
+        uint32_t hash;
+        uint32_t length;
+        size_t position;
+    };
+
+    static uint32_t hash(const char *name, size_t length, bool caseSensetive);
+    bool equals(const Slot& slot, const char *name, size_t length) const;
+
+    std::vector<Slot> m_slots;
+    bool m_caseSensetive;
+};
+
+/** \brief Cache of dynamic overload resolution results keyed by method name and argument types
+ *
+ * Lookups are lock-free: slots hold pointers to immutable entries which are owned by the cache
+ * and released only together with it.
+ */
+class OverloadCache
+{
+public:
+    OverloadCache();
+    ~OverloadCache();
+
+    OverloadCache(const OverloadCache&)=delete;
+    OverloadCache& operator=(const OverloadCache&)=delete;
+
+    /** \brief Finds previously resolved method, returns nullptr if there's no such entry */
+    const MetaCallBase *find(char kind, const String& name, const VariantArray& args) const;
+    /** \brief Remembers the method resolved for the given name and argument types */
+    void insert(char kind, const String& name, const VariantArray& args, const MetaCallBase *method);
+private:
+    static const size_t NumSlots = 64;
+    static const size_t MaxArgs = 8;
+    static const size_t MaxEntries = 4 * NumSlots;
+
+    struct Entry
+    {
+        uint32_t hash;
+        char kind;
+        String name;
+        size_t numArgs;
+        char argTypes[MaxArgs];
+        const MetaCallBase *method;
+    };
+
+    static uint32_t hash(char kind, const String& name, const VariantArray& args);
+    static bool matches(const Entry *entry, uint32_t hash, char kind, const String& name, const VariantArray& args);
+
+    std::atomic<const Entry *> m_slots[NumSlots];
+    std::vector<std::unique_ptr<Entry> > m_entries;
+    std::mutex m_mutex;
+};
+
+} // namespace detail
 
 /**
   * \brief Class represents meta-information about classes
@@ -47,15 +132,19 @@ public:
     const MetaFieldBase *field(size_t i) const;
     /** \brief Gets a field reflection info at specified offset in class */
     const MetaFieldBase *fieldByOffset(ptrdiff_t offset) const;
-    /** \brief Gets a field reflection info by it's name */
-    const MetaFieldBase *fieldByName(const String& name, bool caseSensetive = true) const;
+    /** \brief Gets a field reflection info by it's name, the name does not have to be null-terminated */
+    const MetaFieldBase *fieldByName(const StringView& name, bool caseSensetive = true) const;
+    /** \brief Gets a field reflection info by it's null-terminated name */
+    const MetaFieldBase *fieldByName(const char *name, bool caseSensetive = true) const;
     /** \brief Gets a total number of field reflection infos */
     size_t totalFields() const;
 
     /** \brief Gets a method reflection info at the specified position */
     const MetaCallBase *method(size_t i) const;
-    /** \brief Gets a method reflection info by it's name */
-    const MetaCallBase *methodByName(const String& name, bool caseSensetive = true) const;
+    /** \brief Gets a method reflection info by it's name, the name does not have to be null-terminated */
+    const MetaCallBase *methodByName(const StringView& name, bool caseSensetive = true) const;
+    /** \brief Gets a method reflection info by it's null-terminated name */
+    const MetaCallBase *methodByName(const char *name, bool caseSensetive = true) const;
     /** \brief Gets a total number of method reflection infos for this class */
     size_t totalMethods() const;
 
@@ -68,6 +157,14 @@ public:
      *  with given arguments passed to it's constructor via VariantArray */
     Object *createInstance(const VariantArray& args) const;
 
+    /** \brief Creates a new instance of the object of corresponding class owned by the arena
+     *
+     * Memory for the instance is taken from the slab pool of this class.
+     * Such instances are destroyed only by the arena and must not be passed to destroyInstance.
+     * \see ObjectArena
+     */
+    Object *createInstance(ObjectArena& arena, const VariantArray& args = VariantArray()) const;
+
     /** \brief Creates a new instance of the object of corresponding class
      * with specified arguments passed to it's constructor
     */
@@ -88,15 +185,90 @@ public:
     {
         return variant_cast<TRet>(invoke(methodName, { args... }));
     }
+
+    /** \brief Resolves static or own method with the exact signature TSignature, e.g. int (int, const float&)
+     *
+     * Returned handle can be reused for multiple calls, which are performed without Variant conversions.
+     * If there's no such method, invalid handle is returned.
+     */
+    template<typename TSignature>
+    MethodHandle<TSignature> resolveMethod(const String& name) const;
 private:
+    MetaObject(const MetaInfoDescriptor *descriptor, bool registered);
+
     void prepare() const;
+    const MetaCallBase *findMethod(const String& name, const std::type_info& signature) const;
+    /** \brief Finds an overload suitable for args (using the overload cache) and invokes it with given context */
+    bool dispatch(EMethodType type, bool constness, const String& methodName,
+                  const void *context, const VariantArray& args, Variant& result) const;
+    /** \brief Gets comparison plan used by ObjectSnapshot, built on first use */
+    const detail::ObjectDiffPlan *diffPlan() const;
+    /** \brief Gets default value initialization plan used by Object::init, built on first use */
+    const detail::ObjectInitPlan *initPlan() const;
+    /** \brief Gets slab pool for the arena-owned instances of this class, created on first use */
+    detail::ObjectPool *pool() const;
+    /** \brief Constructs an instance in the preallocated memory */
+    Object *constructInstance(void *mem, const VariantArray& args) const;
 
     const MetaInfoDescriptor *m_descriptor;
+    bool m_registered;
     mutable std::atomic<bool> m_initialized;
     mutable std::vector<std::unique_ptr<MetaFieldBase> > m_fields;
     mutable std::vector<std::unique_ptr<MetaCallBase> > m_methods;
-    mutable std::unique_ptr<const MetaObject> m_super;
+    mutable detail::NameIndex m_fieldIndex, m_fieldIndexNoCase;
+    mutable detail::NameIndex m_methodIndex, m_methodIndexNoCase;
+    mutable const MetaObject *m_super;
+    mutable std::unique_ptr<const MetaObject> m_ownedSuper;
+    mutable detail::OverloadCache m_overloadCache;
+    mutable std::unique_ptr<detail::ObjectDiffPlan> m_diffPlan;
+    mutable std::once_flag m_diffPlanOnce;
+    mutable std::unique_ptr<detail::ObjectInitPlan> m_initPlan;
+    mutable std::once_flag m_initPlanOnce;
+    mutable std::unique_ptr<detail::ObjectComparePlan> m_comparePlan;
+    mutable std::once_flag m_comparePlanOnce;
+    mutable std::unique_ptr<detail::ObjectPool> m_pool;
+    mutable std::once_flag m_poolOnce;
     mutable std::mutex m_mutex;
+
+    friend class MetaObjectRegistry;
+    friend class Object;
+    friend class ObjectSnapshot;
+    friend class ObjectArena;
+    friend class detail::ObjectComparePlan;
+};
+
+/** \brief Abstract visitor receiving field values with their native types
+ *
+ * Allows moving values out of objects without constructing intermediate metacpp::Variant.
+ * \see MetaFieldBase::visitValue
+ */
+class FieldValueVisitor
+{
+public:
+    virtual ~FieldValueVisitor() { }
+
+    /** \brief Called for the unset Nullable<T> field */
+    virtual void visitNull() = 0;
+    /** \brief Called for the bool field */
+    virtual void visit(bool value) = 0;
+    /** \brief Called for the int32_t field */
+    virtual void visit(int32_t value) = 0;
+    /** \brief Called for the uint32_t or enum field */
+    virtual void visit(uint32_t value) = 0;
+    /** \brief Called for the int64_t field */
+    virtual void visit(int64_t value) = 0;
+    /** \brief Called for the uint64_t field */
+    virtual void visit(uint64_t value) = 0;
+    /** \brief Called for the float field */
+    virtual void visit(float value) = 0;
+    /** \brief Called for the double field */
+    virtual void visit(double value) = 0;
+    /** \brief Called for the metacpp::String field */
+    virtual void visit(const String& value) = 0;
+    /** \brief Called for the metacpp::DateTime field */
+    virtual void visit(const DateTime& value) = 0;
+    /** \brief Called for the metacpp::Variant field */
+    virtual void visit(const Variant& value) = 0;
 };
 
 /** \brief Abstract base class representing property reflection info */
@@ -129,6 +301,22 @@ public:
     virtual Variant getValue(const Object *object) const = 0;
     /** \brief Sets a value of the in specified object using value of metacpp::Variant (if possible) */
     virtual void setValue(const Variant& val, Object *object) const = 0;
+    /** \brief Passes a value of the field in specified object to the visitor without constructing metacpp::Variant
+     *
+     * Unset Nullable<T> fields are reported with FieldValueVisitor::visitNull
+     */
+    virtual void visitValue(const Object *object, FieldValueVisitor& visitor) const = 0;
+    /** \brief Copies a value of the field into dest, which must point to the value of the field type (T for Nullable<T>)
+     *
+     * \returns false if the field is an unset Nullable<T> and dest was left untouched
+     */
+    virtual bool readInto(const Object *object, void *dest) const = 0;
+    /** \brief Assigns a value of the field from src, which must point to the value of the field type (T for Nullable<T>)
+     *
+     * Passing nullptr as src resets a Nullable<T> field
+     * \throws std::invalid_argument if src is nullptr and the field is not nullable
+     */
+    virtual void writeFrom(Object *object, const void *src) const = 0;
     /** \brief Checks whether this field is of integral type */
     virtual bool isIntegral() const { return false; }
     /** \brief Checks whether this is field is of floating point type */
@@ -189,6 +377,54 @@ protected:
             access<T>(obj) = variant_cast<T>(val);
     }
 
+    /** \brief Overriden from MetaFieldBase::visitValue */
+    void visitValue(const Object *obj, FieldValueVisitor& visitor) const override
+    {
+        if (nullable())
+        {
+            auto& f = access<Nullable<T> >(obj);
+            if (f.isSet())
+                visitor.visit(*f);
+            else
+                visitor.visitNull();
+        }
+        else
+            visitor.visit(access<T>(obj));
+    }
+
+    /** \brief Overriden from MetaFieldBase::readInto */
+    bool readInto(const Object *obj, void *dest) const override
+    {
+        if (nullable())
+        {
+            auto& f = access<Nullable<T> >(obj);
+            if (!f.isSet())
+                return false;
+            *reinterpret_cast<T *>(dest) = *f;
+        }
+        else
+            *reinterpret_cast<T *>(dest) = access<T>(obj);
+        return true;
+    }
+
+    /** \brief Overriden from MetaFieldBase::writeFrom */
+    void writeFrom(Object *obj, const void *src) const override
+    {
+        if (nullable())
+        {
+            if (src)
+                access<Nullable<T> >(obj) = *reinterpret_cast<const T *>(src);
+            else
+                access<Nullable<T> >(obj).reset();
+        }
+        else
+        {
+            if (!src)
+                throw std::invalid_argument(String(String(name()) + " is not nullable").c_str());
+            access<T>(obj) = *reinterpret_cast<const T *>(src);
+        }
+    }
+
     /** \brief Overriden from MetaFieldBase::isIntegral */
     bool isIntegral() const override { return std::is_integral<T>::value; }
     /** \brief Overriden from MetaFieldBase::isFloatingPoint */
@@ -312,6 +548,12 @@ public:
     Variant getValue(const Object *) const override;
     /** \brief Overriden from MetaFieldBase::setValue, throws std::runtime_error */
     void setValue(const Variant&, Object *) const override;
+    /** \brief Overriden from MetaFieldBase::visitValue, throws std::runtime_error */
+    void visitValue(const Object *, FieldValueVisitor&) const override;
+    /** \brief Overriden from MetaFieldBase::readInto, throws std::runtime_error */
+    bool readInto(const Object *, void *) const override;
+    /** \brief Overriden from MetaFieldBase::writeFrom, throws std::runtime_error */
+    void writeFrom(Object *, const void *) const override;
     /** \brief Gets a metacpp::MetaObject for this object field */
     const MetaObject *fieldMetaObject() const;
 };
@@ -326,6 +568,12 @@ public:
     Variant getValue(const Object *) const override;
     /** \brief Overriden from MetaFieldBase::setValue, throws std::runtime_error */
     void setValue(const Variant&, Object *) const override;
+    /** \brief Overriden from MetaFieldBase::visitValue, throws std::runtime_error */
+    void visitValue(const Object *, FieldValueVisitor&) const override;
+    /** \brief Overriden from MetaFieldBase::readInto, throws std::runtime_error */
+    bool readInto(const Object *, void *) const override;
+    /** \brief Overriden from MetaFieldBase::writeFrom, throws std::runtime_error */
+    void writeFrom(Object *, const void *) const override;
     /** \brief Gets a type of the element of this array field */
     EFieldType arrayElementType() const;
     /** \brief Gets a size of the element of this array field */
@@ -398,6 +646,71 @@ public:
 
 };
 
+/** \brief Reusable handle to the reflection method with the known signature
+ *
+ * Obtained using MetaObject::resolveMethod. Calls are dispatched directly to the native function,
+ * no VariantArray is built and no exceptions are thrown by the call machinery itself.
+ */
+template<typename TRes, typename... TArgs>
+class MethodHandle<TRes (TArgs...)>
+{
+public:
+    /** \brief Type of the native call thunk */
+    typedef TRes (*Thunk)(const MetaInvokerBase *, const void *, TArgs...);
+
+    /** \brief Constructs an invalid handle */
+    MethodHandle()
+        : m_method(nullptr), m_invoker(nullptr), m_thunk(nullptr)
+    {
+    }
+
+    /** \brief Constructs a handle for the method, which must have a signature TRes(TArgs...) */
+    explicit MethodHandle(const MetaCallBase *method)
+        : m_method(method), m_invoker(method ? method->invoker() : nullptr),
+          m_thunk(method ? reinterpret_cast<Thunk>(method->invoker()->nativeThunk()) : nullptr)
+    {
+        assert(!method || method->invoker()->signature() == typeid(TRes (TArgs...)));
+    }
+
+    /** \brief Checks whether the handle refers to the method */
+    bool valid() const { return m_method != nullptr; }
+    /** \brief Checks whether the handle refers to the method */
+    explicit operator bool() const { return valid(); }
+    /** \brief Gets method reflection info */
+    const MetaCallBase *method() const { return m_method; }
+
+    /** \brief Calls the static method */
+    TRes operator()(TArgs... args) const
+    {
+        assert(valid() && eMethodStatic == m_method->type());
+        return m_thunk(m_invoker, nullptr, std::forward<TArgs>(args)...);
+    }
+
+    /** \brief Calls the own method on the object */
+    TRes operator()(Object *obj, TArgs... args) const
+    {
+        assert(valid() && eMethodOwn == m_method->type());
+        return m_thunk(m_invoker, obj, std::forward<TArgs>(args)...);
+    }
+
+    /** \brief Calls the const own method on the object */
+    TRes operator()(const Object *obj, TArgs... args) const
+    {
+        assert(valid() && eMethodOwn == m_method->type() && m_method->constness());
+        return m_thunk(m_invoker, obj, std::forward<TArgs>(args)...);
+    }
+private:
+    const MetaCallBase *m_method;
+    const MetaInvokerBase *m_invoker;
+    Thunk m_thunk;
+};
+
+template<typename TSignature>
+MethodHandle<TSignature> MetaObject::resolveMethod(const String& name) const
+{
+    return MethodHandle<TSignature>(findMethod(name, typeid(TSignature)));
+}
+
 /** \brief Factory class for MetaCallBase */
 class MetaCallFactory : public FactoryBase<std::unique_ptr<MetaCallBase>, const MethodInfoDescriptor *>
 {
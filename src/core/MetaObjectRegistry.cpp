@@ -0,0 +1,129 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "MetaObjectRegistry.h"
+#include <algorithm>
+#include <cstring>
+
+namespace metacpp
+{
+
+MetaObjectRegistry &MetaObjectRegistry::instance()
+{
+    static MetaObjectRegistry registry;
+    return registry;
+}
+
+MetaObjectRegistry::MetaObjectRegistry()
+    : m_snapshot(nullptr), m_frozen(false)
+{
+}
+
+MetaObjectRegistry::~MetaObjectRegistry()
+{
+}
+
+void MetaObjectRegistry::freeze()
+{
+    std::vector<const MetaObject *> metaObjects = this->metaObjects();
+    // prepare outside of the registry lock since MetaObject::prepare() queries the registry
+    for (const MetaObject *mo : metaObjects)
+        for (const MetaObject *super = mo; super; super = super->superMetaObject())
+            super->prepare();
+    snapshot();
+    m_frozen.store(true, std::memory_order_release);
+}
+
+bool MetaObjectRegistry::frozen() const
+{
+    return m_frozen.load(std::memory_order_acquire);
+}
+
+const MetaObject *MetaObjectRegistry::find(const StringView &name) const
+{
+    return find(name.data(), name.length());
+}
+
+const MetaObject *MetaObjectRegistry::find(const char *name, size_t length) const
+{
+    const Snapshot *snap = snapshot();
+    size_t pos = snap->nameIndex.find(name, length);
+    return pos == detail::NameIndex::npos ? nullptr : snap->metaObjects[pos];
+}
+
+const MetaObject *MetaObjectRegistry::findByDescriptor(const MetaInfoDescriptor *descriptor) const
+{
+    const Snapshot *snap = snapshot();
+    auto it = snap->descriptorIndex.find(descriptor);
+    return it == snap->descriptorIndex.end() ? nullptr : it->second;
+}
+
+std::vector<const MetaObject *> MetaObjectRegistry::metaObjects() const
+{
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    return m_metaObjects;
+}
+
+void MetaObjectRegistry::registerMetaObject(const MetaObject *metaObject)
+{
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    m_metaObjects.push_back(metaObject);
+    invalidate();
+}
+
+void MetaObjectRegistry::unregisterMetaObject(const MetaObject *metaObject)
+{
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    auto it = std::find(m_metaObjects.begin(), m_metaObjects.end(), metaObject);
+    if (it != m_metaObjects.end())
+    {
+        m_metaObjects.erase(it);
+        invalidate();
+    }
+}
+
+const MetaObjectRegistry::Snapshot *MetaObjectRegistry::snapshot() const
+{
+    const Snapshot *snap = m_snapshot.load(std::memory_order_acquire);
+    if (snap)
+        return snap;
+
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    snap = m_snapshot.load(std::memory_order_relaxed);
+    if (snap)
+        return snap;
+    std::unique_ptr<Snapshot> newSnap(new Snapshot());
+    newSnap->metaObjects = m_metaObjects;
+    std::vector<const char *> names;
+    names.reserve(m_metaObjects.size());
+    for (const MetaObject *mo : m_metaObjects)
+    {
+        names.push_back(mo->name());
+        newSnap->descriptorIndex.insert(std::make_pair(mo->m_descriptor, mo));
+    }
+    newSnap->nameIndex.build(names, true);
+    snap = newSnap.get();
+    m_snapshots.push_back(std::move(newSnap));
+    m_snapshot.store(snap, std::memory_order_release);
+    return snap;
+}
+
+void MetaObjectRegistry::invalidate()
+{
+    // will be rebuilt on the next lookup, the old one stays in m_snapshots for concurrent readers
+    m_snapshot.store(nullptr, std::memory_order_release);
+}
+
+} // namespace metacpp
@@ -0,0 +1,90 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef METAOBJECTREGISTRY_H
+#define METAOBJECTREGISTRY_H
+#include "config.h"
+#include "MetaObject.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+namespace metacpp
+{
+
+/**
+  * \brief Global registry of all MetaObject instances declared with META_INFO
+  *
+  * MetaObjects register themselves on construction (i.e. at static initialization time).
+  * Calling freeze() eagerly prepares field and method tables of all registered classes
+  * and resolves their super chains, so that subsequent reflection queries from any thread
+  * never have to take a lock. Lookups by class name are O(1): once the lookup table has been
+  * built (either by freeze() or by the first lookup) a lookup is a single acquire load of
+  * the published table followed by a hash probe.
+  */
+class MetaObjectRegistry
+{
+public:
+    /** \brief Gets the global registry instance */
+    static MetaObjectRegistry& instance();
+
+    /** \brief Prepares all registered MetaObjects and builds the lookup table */
+    void freeze();
+    /** \brief Checks whether freeze() has been called */
+    bool frozen() const;
+
+    /** \brief Finds registered MetaObject by the class name, returns nullptr if not found */
+    const MetaObject *find(const StringView& name) const;
+    /** \brief Finds registered MetaObject by the class name of specified length, returns nullptr if not found */
+    const MetaObject *find(const char *name, size_t length) const;
+    /** \brief Finds registered MetaObject created using specified descriptor, returns nullptr if not found */
+    const MetaObject *findByDescriptor(const MetaInfoDescriptor *descriptor) const;
+    /** \brief Gets all currently registered MetaObjects */
+    std::vector<const MetaObject *> metaObjects() const;
+private:
+    MetaObjectRegistry();
+    ~MetaObjectRegistry();
+
+    MetaObjectRegistry(const MetaObjectRegistry&)=delete;
+    MetaObjectRegistry& operator=(const MetaObjectRegistry&)=delete;
+
+    /** \brief Immutable lookup table, published atomically and never modified afterwards */
+    struct Snapshot
+    {
+        std::vector<const MetaObject *> metaObjects;
+        detail::NameIndex nameIndex;
+        std::unordered_map<const MetaInfoDescriptor *, const MetaObject *> descriptorIndex;
+    };
+
+    void registerMetaObject(const MetaObject *metaObject);
+    void unregisterMetaObject(const MetaObject *metaObject);
+    const Snapshot *snapshot() const;
+    void invalidate();
+
+    std::vector<const MetaObject *> m_metaObjects;
+    // currently published snapshot, nullptr until (re)built by the next lookup
+    mutable std::atomic<const Snapshot *> m_snapshot;
+    // every snapshot ever published, retired ones are kept alive since readers do not pin them
+    mutable std::vector<std::unique_ptr<const Snapshot> > m_snapshots;
+    std::atomic<bool> m_frozen;
+    mutable std::mutex m_mutex;
+
+    friend class MetaObject;
+};
+
+} // namespace metacpp
+#endif // METAOBJECTREGISTRY_H
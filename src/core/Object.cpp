@@ -15,6 +15,8 @@
 ****************************************************************************/
 #include "Object.h"
 #include "InitVisitor.h"
+#include <algorithm>
+#include <vector>
 
 #ifdef HAVE_JSONCPP
 #include "JsonSerializerVisitor.h"
@@ -29,13 +31,55 @@
 namespace metacpp
 {
 
+namespace detail
+{
+
+/** \brief Compact map of dynamic properties stored as a vector sorted by name */
+class DynamicProperties
+{
+public:
+    typedef std::pair<String, Variant> Entry;
+
+    const Variant *find(const String& name) const
+    {
+        auto it = lowerBound(name);
+        return it != m_entries.end() && it->first == name ? &it->second : nullptr;
+    }
+
+    void set(const String& name, const Variant& value)
+    {
+        auto it = lowerBound(name);
+        if (it != m_entries.end() && it->first == name)
+            it->second = value;
+        else
+            m_entries.insert(it, Entry(name, value));
+    }
+private:
+    std::vector<Entry>::const_iterator lowerBound(const String& name) const
+    {
+        return std::lower_bound(m_entries.begin(), m_entries.end(), name,
+                                [](const Entry& entry, const String& n) { return entry.first < n; });
+    }
+
+    std::vector<Entry>::iterator lowerBound(const String& name)
+    {
+        return std::lower_bound(m_entries.begin(), m_entries.end(), name,
+                                [](const Entry& entry, const String& n) { return entry.first < n; });
+    }
+
+    std::vector<Entry> m_entries;
+};
+
+} // namespace detail
+
 Object::Object()
 {
 
 }
 
 Object::Object(const Object &other)
-    : m_dynamicProperties(other.m_dynamicProperties)
+    : m_dynamicProperties(other.m_dynamicProperties ?
+                              new detail::DynamicProperties(*other.m_dynamicProperties) : nullptr)
 {
 }
 
@@ -50,13 +94,14 @@ void Object::deleteThis()
 
 void Object::init()
 {
-    InitVisitor vis;
-    vis.visit(this);
+    metaObject()->initPlan()->apply(this);
 }
 
 Object &Object::operator=(const Object &rhs)
 {
-    m_dynamicProperties = rhs.m_dynamicProperties;
+    if (this != &rhs)
+        m_dynamicProperties.reset(rhs.m_dynamicProperties ?
+                                      new detail::DynamicProperties(*rhs.m_dynamicProperties) : nullptr);
     return *this;
 }
 
@@ -129,7 +174,11 @@ void Object::setProperty(const String &propName, const Variant &val)
     if (field)
         field->setValue(val, this);
     else
-        m_dynamicProperties[propName] = val;
+    {
+        if (!m_dynamicProperties)
+            m_dynamicProperties.reset(new detail::DynamicProperties());
+        m_dynamicProperties->set(propName, val);
+    }
 }
 
 Variant Object::getProperty(const String &propName) const
@@ -137,10 +186,8 @@ Variant Object::getProperty(const String &propName) const
     auto field = metaObject()->fieldByName(propName);
     if (field)
         return field->getValue(this);
-    auto it = m_dynamicProperties.find(propName);
-    if (it != m_dynamicProperties.end())
-        return it->second;
-    return Variant();
+    const Variant *value = m_dynamicProperties ? m_dynamicProperties->find(propName) : nullptr;
+    return value ? *value : Variant();
 }
 
 const MetaObject *Object::staticMetaObject()
@@ -150,24 +197,9 @@ const MetaObject *Object::staticMetaObject()
 
 Variant Object::doInvoke(const String &methodName, const VariantArray &args, bool constness) const
 {
-    for (size_t i = 0; i < metaObject()->totalMethods(); ++i)
-    {
-        auto method = metaObject()->method(i);
-        if (eMethodOwn == method->type() && args.size() == method->numArguments() && methodName.equals(method->name()))
-        {
-            // cannot call non-const methods on const objects
-            if (constness && !method->constness())
-                continue;
-            try
-            {
-                return method->invoker()->invoke(const_cast<Object *>(this), args);
-            }
-            catch (const BindArgumentException& /*ex*/)
-            {
-                continue;
-            }
-        }
-    }
+    Variant result;
+    if (metaObject()->dispatch(eMethodOwn, constness, methodName, this, args, result))
+        return result;
     throw MethodNotFoundException(String("Cannot find own method " + methodName + " compatible with arguments provided").c_str());
 }
 
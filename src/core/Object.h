@@ -17,7 +17,7 @@
 #define OBJECT_H
 #include "config.h"
 #include "MetaObject.h"
-#include <map>
+#include <memory>
 
 namespace metacpp
 {
@@ -25,6 +25,7 @@ namespace metacpp
 namespace detail
 {
 class VariantData;
+class DynamicProperties;
 }
 
 /** \brief Base class for objects supporting property and method reflection via MetaObject.
@@ -126,7 +127,8 @@ protected:
 private:
     Variant doInvoke(const String& methodName, const VariantArray& args, bool constness) const;
 private:
-    std::map<String, Variant> m_dynamicProperties;
+    /** Dynamic properties are rarely used, so storage for them is allocated on first setProperty */
+    std::unique_ptr<detail::DynamicProperties> m_dynamicProperties;
     static const MetaObject ms_metaObject;
     friend class MetaObject;
     friend class detail::VariantData;
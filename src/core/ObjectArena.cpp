@@ -0,0 +1,157 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "ObjectArena.h"
+#include "Object.h"
+#include <algorithm>
+#include <cassert>
+
+namespace metacpp
+{
+
+namespace detail
+{
+
+static const size_t minSlabBlocks = 16;
+static const size_t maxSlabBlocks = 1024;
+
+ObjectPool::ObjectPool(size_t blockSize)
+    : m_blockSize(std::max(blockSize, sizeof(void *))), m_slabBlocks(minSlabBlocks),
+      m_numAllocated(0), m_freeList(nullptr)
+{
+    // keep every block aligned the same way as the memory returned by operator new
+    const size_t align = alignof(std::max_align_t);
+    m_blockSize = (m_blockSize + align - 1) / align * align;
+}
+
+ObjectPool::~ObjectPool()
+{
+    // arena owning some objects has outlived the metaobject
+    assert(!m_numAllocated);
+    for (auto& slab : m_slabs)
+        ::operator delete(const_cast<char *>(slab.first));
+}
+
+void ObjectPool::addSlab()
+{
+    char *slab = static_cast<char *>(::operator new(m_blockSize * m_slabBlocks));
+    m_slabs.insert(std::make_pair(slab, m_blockSize * m_slabBlocks));
+    // thread new blocks into the free list preserving their address order
+    for (size_t i = m_slabBlocks; i > 0; --i)
+    {
+        void *block = slab + (i - 1) * m_blockSize;
+        *reinterpret_cast<void **>(block) = m_freeList;
+        m_freeList = block;
+    }
+    m_slabBlocks = std::min(m_slabBlocks * 2, maxSlabBlocks);
+}
+
+void *ObjectPool::allocate()
+{
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    if (!m_freeList)
+        addSlab();
+    void *block = m_freeList;
+    m_freeList = *reinterpret_cast<void **>(block);
+    ++m_numAllocated;
+    return block;
+}
+
+void ObjectPool::deallocate(void *block)
+{
+    deallocate(&block, 1);
+}
+
+void ObjectPool::deallocate(void * const *blocks, size_t count)
+{
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    for (size_t i = 0; i < count; ++i)
+    {
+        *reinterpret_cast<void **>(blocks[i]) = m_freeList;
+        m_freeList = blocks[i];
+    }
+    m_numAllocated -= count;
+}
+
+bool ObjectPool::owns(const void *block) const
+{
+    const char *p = static_cast<const char *>(block);
+    std::lock_guard<std::mutex> _guard(m_mutex);
+    auto it = m_slabs.upper_bound(p);
+    if (it == m_slabs.begin())
+        return false;
+    --it;
+    return p < it->first + it->second;
+}
+
+size_t ObjectPool::blockSize() const
+{
+    return m_blockSize;
+}
+
+} // namespace detail
+
+ObjectArena::ObjectArena()
+{
+}
+
+ObjectArena::~ObjectArena()
+{
+    clear();
+}
+
+Object *ObjectArena::create(const MetaObject *metaObject, const VariantArray &args)
+{
+    detail::ObjectPool *pool = metaObject->pool();
+    void *mem = pool->allocate();
+    Object *result;
+    try
+    {
+        result = metaObject->constructInstance(mem, args);
+    }
+    catch (...)
+    {
+        pool->deallocate(mem);
+        throw;
+    }
+    m_objects.push_back(Entry { result, mem, pool });
+    return result;
+}
+
+void ObjectArena::clear()
+{
+    std::vector<void *> blocks;
+    blocks.reserve(m_objects.size());
+    for (size_t i = m_objects.size(); i > 0; --i)
+    {
+        const Entry& entry = m_objects[i - 1];
+        entry.object->~Object();
+        blocks.push_back(entry.block);
+        // return blocks in bulk, one lock per run of same-typed objects
+        if (i == 1 || m_objects[i - 2].pool != entry.pool)
+        {
+            entry.pool->deallocate(blocks.data(), blocks.size());
+            blocks.clear();
+        }
+    }
+    m_objects.clear();
+}
+
+size_t ObjectArena::size() const
+{
+    return m_objects.size();
+}
+
+} // namespace metacpp
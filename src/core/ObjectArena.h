@@ -0,0 +1,136 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef OBJECTARENA_H
+#define OBJECTARENA_H
+#include "config.h"
+#include "MetaObject.h"
+#include <vector>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <new>
+
+namespace metacpp
+{
+
+class Object;
+
+namespace detail
+{
+
+/** \brief Thread-safe slab allocator of fixed-size blocks
+ *
+ * Each MetaObject has it's own pool used for instances owned by an ObjectArena.
+ * Memory is taken from the system in slabs of growing size and is kept in the pool
+ * for reuse when blocks are freed. All blocks must be freed before the pool is destroyed.
+ */
+class ObjectPool
+{
+public:
+    /** \brief Constructs a new pool of blocks of given size */
+    explicit ObjectPool(size_t blockSize);
+    ~ObjectPool();
+
+    ObjectPool(const ObjectPool&)=delete;
+    ObjectPool& operator=(const ObjectPool&)=delete;
+
+    /** \brief Allocates a single block */
+    void *allocate();
+    /** \brief Returns previously allocated block to the pool */
+    void deallocate(void *block);
+    /** \brief Returns a number of previously allocated blocks to the pool at once */
+    void deallocate(void * const *blocks, size_t count);
+    /** \brief Checks whether block has been allocated from this pool */
+    bool owns(const void *block) const;
+    /** \brief Gets the size of blocks */
+    size_t blockSize() const;
+private:
+    void addSlab();
+
+    size_t m_blockSize;
+    size_t m_slabBlocks;
+    size_t m_numAllocated;
+    void *m_freeList;
+    std::map<const char *, size_t> m_slabs;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace detail
+
+/**
+  * \brief Scoped owner of objects allocated from the per-class pools
+  *
+  * All objects created by the arena are destroyed at once when the arena is cleared or destroyed,
+  * so it suits best for short-lived request-scoped objects. Objects owned by an arena must not
+  * be destroyed individually (i.e. using MetaObject::destroyInstance or put into Variant).
+  */
+class ObjectArena
+{
+public:
+    /** \brief Constructs a new empty arena */
+    ObjectArena();
+    /** \brief Destroys all owned objects */
+    ~ObjectArena();
+
+    ObjectArena(const ObjectArena&)=delete;
+    ObjectArena& operator=(const ObjectArena&)=delete;
+
+    /** \brief Creates a new instance of the class described by metaObject with given constructor arguments */
+    Object *create(const MetaObject *metaObject, const VariantArray& args = VariantArray());
+
+    /** \brief Creates a new instance of T directly passing args to it's constructor
+     * \throws std::invalid_argument if T has no own metainformation
+     */
+    template<typename T, typename... TArgs>
+    T *create(TArgs&&... args)
+    {
+        const MetaObject *metaObject = T::staticMetaObject();
+        if (metaObject->size() != sizeof(T))
+            throw std::invalid_argument("Class has no own metainformation");
+        detail::ObjectPool *pool = metaObject->pool();
+        void *mem = pool->allocate();
+        T *result;
+        try
+        {
+            result = new (mem) T(std::forward<TArgs>(args)...);
+        }
+        catch (...)
+        {
+            pool->deallocate(mem);
+            throw;
+        }
+        m_objects.push_back(Entry { result, mem, pool });
+        return result;
+    }
+
+    /** \brief Destroys all owned objects in reverse order of their creation */
+    void clear();
+    /** \brief Gets a number of owned objects */
+    size_t size() const;
+private:
+    struct Entry
+    {
+        Object *object;
+        void *block;
+        detail::ObjectPool *pool;
+    };
+
+    std::vector<Entry> m_objects;
+};
+
+} // namespace metacpp
+
+#endif // OBJECTARENA_H
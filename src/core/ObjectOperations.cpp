@@ -0,0 +1,453 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "ObjectOperations.h"
+#include "Object.h"
+#include "FieldRun.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace metacpp
+{
+
+namespace detail
+{
+
+namespace
+{
+
+typedef ObjectComparePlan::Field Field;
+
+size_t scalarSize(EFieldType type)
+{
+    switch (type)
+    {
+    case eFieldBool: return sizeof(bool);
+    case eFieldInt: return sizeof(int32_t);
+    case eFieldUint:
+    case eFieldEnum: return sizeof(uint32_t);
+    case eFieldInt64: return sizeof(int64_t);
+    case eFieldUint64: return sizeof(uint64_t);
+    case eFieldFloat: return sizeof(float);
+    case eFieldDouble: return sizeof(double);
+    default: return 0;
+    }
+}
+
+/** \brief Checks whether values of the type are compared by value rather than bitwise */
+bool isFloatingPoint(EFieldType type)
+{
+    return eFieldFloat == type || eFieldDouble == type;
+}
+
+bool variantEquals(const Variant& a, const Variant& b);
+uint64_t variantHash(const Variant& v, uint64_t h);
+Variant variantClone(const Variant& v);
+
+template<typename T>
+struct ScalarOps
+{
+    static bool equals(const T& a, const T& b) { return 0 == std::memcmp(&a, &b, sizeof(T)); }
+    static uint64_t hash(const T& v, uint64_t h) { return fnv1aBytes<uint64_t>(h, &v, sizeof(T)); }
+    static void copy(T& dest, const T& src) { dest = src; }
+};
+
+/** \brief Floating point values are compared by value, so that -0.0 == 0.0 and NaN != NaN */
+template<typename T>
+struct FloatOps
+{
+    static bool equals(const T& a, const T& b) { return a == b; }
+    static uint64_t hash(const T& v, uint64_t h)
+    {
+        // equal zeros of different signs should have the same hash
+        T value = v == 0 ? T(0) : v;
+        return fnv1aBytes<uint64_t>(h, &value, sizeof(T));
+    }
+    static void copy(T& dest, const T& src) { dest = src; }
+};
+
+struct StringOps
+{
+    static bool equals(const String& a, const String& b) { return a == b; }
+    static uint64_t hash(const String& v, uint64_t h) { return fnv1aMix<uint64_t>(h, v.hash()); }
+    static void copy(String& dest, const String& src) { dest = src; }
+};
+
+struct DateTimeOps
+{
+    static bool equals(const DateTime& a, const DateTime& b) { return a == b; }
+    static uint64_t hash(const DateTime& v, uint64_t h)
+    {
+        int64_t time = v.valid() ? v.toMicrosecondsSinceEpoch() : INT64_MIN;
+        return fnv1aBytes<uint64_t>(h, &time, sizeof(time));
+    }
+    static void copy(DateTime& dest, const DateTime& src) { dest = src; }
+};
+
+struct VariantOps
+{
+    static bool equals(const Variant& a, const Variant& b) { return variantEquals(a, b); }
+    static uint64_t hash(const Variant& v, uint64_t h) { return variantHash(v, h); }
+    static void copy(Variant& dest, const Variant& src) { dest = variantClone(src); }
+};
+
+struct ObjectOps
+{
+    static bool equals(const Object& a, const Object& b) { return objectEquals(a, b); }
+    static uint64_t hash(const Object& v, uint64_t h) { return fnv1aMix<uint64_t>(h, objectHash(v)); }
+    static void copy(Object& dest, const Object& src) { objectCopy(dest, src); }
+};
+
+template<typename T, typename Ops>
+struct FieldOps
+{
+    static bool equals(const Field&, const void *a, const void *b)
+    {
+        return Ops::equals(*static_cast<const T *>(a), *static_cast<const T *>(b));
+    }
+
+    static uint64_t hash(const Field&, const void *value, uint64_t h)
+    {
+        return Ops::hash(*static_cast<const T *>(value), h);
+    }
+
+    static void copy(const Field&, void *dest, const void *src)
+    {
+        Ops::copy(*static_cast<T *>(dest), *static_cast<const T *>(src));
+    }
+};
+
+template<typename T, typename Ops>
+struct NullableFieldOps
+{
+    static bool equals(const Field&, const void *a, const void *b)
+    {
+        auto& na = *static_cast<const Nullable<T> *>(a);
+        auto& nb = *static_cast<const Nullable<T> *>(b);
+        return na.isSet() == nb.isSet() && (!na.isSet() || Ops::equals(*na, *nb));
+    }
+
+    static uint64_t hash(const Field&, const void *value, uint64_t h)
+    {
+        auto& n = *static_cast<const Nullable<T> *>(value);
+        unsigned char set = n.isSet() ? 1 : 0;
+        h = fnv1aBytes<uint64_t>(h, &set, 1);
+        return n.isSet() ? Ops::hash(*n, h) : h;
+    }
+
+    static void copy(const Field&, void *dest, const void *src)
+    {
+        auto& nd = *static_cast<Nullable<T> *>(dest);
+        auto& ns = *static_cast<const Nullable<T> *>(src);
+        nd.reset(ns.isSet());
+        if (ns.isSet())
+            Ops::copy(*nd, *ns);
+    }
+};
+
+struct ArrayFieldOps
+{
+    static bool equals(const Field& field, const void *a, const void *b)
+    {
+        auto& arrA = *static_cast<const Array<char> *>(a);
+        auto& arrB = *static_cast<const Array<char> *>(b);
+        if (arrA.size() != arrB.size())
+            return false;
+        if (!arrA.size() || arrA.data() == arrB.data())
+            return true;
+        if (field.elementPod)
+            return 0 == std::memcmp(arrA.data(), arrB.data(), arrA.size() * field.elementSize);
+        for (size_t i = 0; i < arrA.size(); ++i)
+            if (!field.elementEquals(field, arrA.data() + i * field.elementSize, arrB.data() + i * field.elementSize))
+                return false;
+        return true;
+    }
+
+    static uint64_t hash(const Field& field, const void *value, uint64_t h)
+    {
+        auto& arr = *static_cast<const Array<char> *>(value);
+        uint64_t size = arr.size();
+        h = fnv1aBytes<uint64_t>(h, &size, sizeof(size));
+        if (!size)
+            return h;
+        if (field.elementPod)
+            return fnv1aBytes<uint64_t>(h, arr.data(), arr.size() * field.elementSize);
+        for (size_t i = 0; i < arr.size(); ++i)
+            h = field.elementHash(field, arr.data() + i * field.elementSize, h);
+        return h;
+    }
+
+    static void copy(const Field& field, void *dest, const void *src)
+    {
+        // arrays are copy-on-write, so elements are copied once any of them is modified
+        auto& arrDest = *static_cast<Array<char> *>(dest);
+        auto& arrSrc = *static_cast<const Array<char> *>(src);
+        arrDest = arrSrc;
+        if (!field.elementCopy || !arrSrc.size())
+            return;
+        // but objects referenced by the elements would remain shared, so they are copied one by one
+        char *data = arrDest.data();
+        for (size_t i = 0; i < arrSrc.size(); ++i)
+            field.elementCopy(field, data + i * field.elementSize, arrSrc.data() + i * field.elementSize);
+    }
+};
+
+bool variantEquals(const Variant& a, const Variant& b)
+{
+    if (a.type() != b.type())
+        return false;
+    switch (a.type())
+    {
+    case eFieldVoid:
+        return true;
+    case eFieldString:
+        return variant_cast<String>(a) == variant_cast<String>(b);
+    case eFieldDateTime:
+        return variant_cast<DateTime>(a) == variant_cast<DateTime>(b);
+    case eFieldObject:
+    {
+        Object *objA = variant_cast<Object *>(a), *objB = variant_cast<Object *>(b);
+        return objA == objB || (objA && objB && objectEquals(*objA, *objB));
+    }
+    case eFieldArray:
+    {
+        VariantArray arrA = variant_cast<VariantArray>(a), arrB = variant_cast<VariantArray>(b);
+        if (arrA.size() != arrB.size())
+            return false;
+        for (size_t i = 0; i < arrA.size(); ++i)
+            if (!variantEquals(arrA[i], arrB[i]))
+                return false;
+        return true;
+    }
+    case eFieldFloat:
+        return FloatOps<float>::equals(variant_cast<float>(a), variant_cast<float>(b));
+    case eFieldDouble:
+        return FloatOps<double>::equals(variant_cast<double>(a), variant_cast<double>(b));
+    default:
+        return 0 == std::memcmp(a.buffer(), b.buffer(), scalarSize(a.type()));
+    }
+}
+
+uint64_t variantHash(const Variant& v, uint64_t h)
+{
+    char type = static_cast<char>(v.type());
+    h = fnv1aBytes<uint64_t>(h, &type, 1);
+    switch (v.type())
+    {
+    case eFieldVoid:
+        return h;
+    case eFieldString:
+        return StringOps::hash(variant_cast<String>(v), h);
+    case eFieldDateTime:
+        return DateTimeOps::hash(variant_cast<DateTime>(v), h);
+    case eFieldObject:
+    {
+        Object *obj = variant_cast<Object *>(v);
+        return obj ? ObjectOps::hash(*obj, h) : h;
+    }
+    case eFieldArray:
+    {
+        VariantArray arr = variant_cast<VariantArray>(v);
+        for (size_t i = 0; i < arr.size(); ++i)
+            h = variantHash(arr[i], h);
+        return h;
+    }
+    case eFieldFloat:
+        return FloatOps<float>::hash(variant_cast<float>(v), h);
+    case eFieldDouble:
+        return FloatOps<double>::hash(variant_cast<double>(v), h);
+    default:
+        return fnv1aBytes<uint64_t>(h, v.buffer(), scalarSize(v.type()));
+    }
+}
+
+Variant variantClone(const Variant& v)
+{
+    switch (v.type())
+    {
+    case eFieldObject:
+    {
+        Object *obj = variant_cast<Object *>(v);
+        return obj ? Variant(objectClone(*obj)) : v;
+    }
+    case eFieldArray:
+    {
+        VariantArray arr = variant_cast<VariantArray>(v), result;
+        result.reserve(arr.size());
+        for (size_t i = 0; i < arr.size(); ++i)
+            result.push_back(variantClone(arr[i]));
+        return result;
+    }
+    default:
+        return v;
+    }
+}
+
+template<typename T, typename Ops>
+void setOps(Field& field, bool nullable)
+{
+    if (nullable)
+    {
+        field.equals = &NullableFieldOps<T, Ops>::equals;
+        field.hash = &NullableFieldOps<T, Ops>::hash;
+        field.copy = &NullableFieldOps<T, Ops>::copy;
+    }
+    else
+    {
+        field.equals = &FieldOps<T, Ops>::equals;
+        field.hash = &FieldOps<T, Ops>::hash;
+        field.copy = &FieldOps<T, Ops>::copy;
+    }
+}
+
+/** \brief Resolves operations of the non-pod value of given type, returns false if not supported */
+bool resolveOps(Field& field, EFieldType type, bool nullable)
+{
+    switch (type)
+    {
+    case eFieldBool: setOps<bool, ScalarOps<bool> >(field, nullable); break;
+    case eFieldInt: setOps<int32_t, ScalarOps<int32_t> >(field, nullable); break;
+    case eFieldUint:
+    case eFieldEnum: setOps<uint32_t, ScalarOps<uint32_t> >(field, nullable); break;
+    case eFieldInt64: setOps<int64_t, ScalarOps<int64_t> >(field, nullable); break;
+    case eFieldUint64: setOps<uint64_t, ScalarOps<uint64_t> >(field, nullable); break;
+    case eFieldFloat: setOps<float, FloatOps<float> >(field, nullable); break;
+    case eFieldDouble: setOps<double, FloatOps<double> >(field, nullable); break;
+    case eFieldString: setOps<String, StringOps>(field, nullable); break;
+    case eFieldDateTime: setOps<DateTime, DateTimeOps>(field, nullable); break;
+    case eFieldVariant: setOps<Variant, VariantOps>(field, nullable); break;
+    case eFieldObject:
+        field.equals = &FieldOps<Object, ObjectOps>::equals;
+        field.hash = &FieldOps<Object, ObjectOps>::hash;
+        field.copy = &FieldOps<Object, ObjectOps>::copy;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ObjectComparePlan::ObjectComparePlan(const MetaObject *metaObject)
+{
+    for (size_t i = 0; i < metaObject->totalFields(); ++i)
+    {
+        const MetaFieldBase *metaField = metaObject->field(i);
+        EFieldType type = metaField->type();
+        if (!metaField->nullable() && scalarSize(type) && !isFloatingPoint(type))
+        {
+            addToRuns(podRuns, metaField);
+            continue;
+        }
+        Field field { metaField, metaField->offset(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, false };
+        if (type == eFieldArray)
+        {
+            auto arrayField = reinterpret_cast<const MetaFieldArray *>(metaField);
+            Field element = field;
+            if (!resolveOps(element, arrayField->arrayElementType(), false))
+                throw std::invalid_argument(String(String("Cannot compare field ") + metaField->name() +
+                                                   ": nested arrays are not supported").c_str());
+            field.equals = &ArrayFieldOps::equals;
+            field.hash = &ArrayFieldOps::hash;
+            field.copy = &ArrayFieldOps::copy;
+            field.elementEquals = element.equals;
+            field.elementHash = element.hash;
+            field.elementSize = arrayField->arrayElementSize();
+            field.elementPod = scalarSize(arrayField->arrayElementType()) == field.elementSize &&
+                    !isFloatingPoint(arrayField->arrayElementType());
+            // variants and objects may reference other objects which should not be shared by the copies
+            if (eFieldVariant == arrayField->arrayElementType() || eFieldObject == arrayField->arrayElementType())
+                field.elementCopy = element.copy;
+        }
+        else if (!resolveOps(field, type, metaField->nullable()))
+            throw std::invalid_argument(String(String("Cannot compare field ") + metaField->name() +
+                                               ": unsupported type").c_str());
+        fields.push_back(field);
+    }
+}
+
+const ObjectComparePlan *ObjectComparePlan::get(const MetaObject *metaObject)
+{
+    std::call_once(metaObject->m_comparePlanOnce, [metaObject]()
+        { metaObject->m_comparePlan.reset(new ObjectComparePlan(metaObject)); });
+    return metaObject->m_comparePlan.get();
+}
+
+} // namespace detail
+
+bool objectEquals(const Object &a, const Object &b)
+{
+    if (&a == &b)
+        return true;
+    if (a.metaObject() != b.metaObject())
+        return false;
+    auto plan = detail::ObjectComparePlan::get(a.metaObject());
+    const char *baseA = reinterpret_cast<const char *>(&a);
+    const char *baseB = reinterpret_cast<const char *>(&b);
+    for (auto& run : plan->podRuns)
+        if (std::memcmp(baseA + run.offset, baseB + run.offset, run.size))
+            return false;
+    for (auto& field : plan->fields)
+        if (!field.equals(field, baseA + field.offset, baseB + field.offset))
+            return false;
+    return true;
+}
+
+size_t objectHash(const Object &obj)
+{
+    const MetaObject *metaObject = obj.metaObject();
+    auto plan = detail::ObjectComparePlan::get(metaObject);
+    const char *base = reinterpret_cast<const char *>(&obj);
+    uint64_t h = detail::fnv1aBytes<uint64_t>(detail::Fnv1a<uint64_t>::basis(), metaObject->name(), strlen(metaObject->name()));
+    for (auto& run : plan->podRuns)
+        h = detail::fnv1aBytes<uint64_t>(h, base + run.offset, run.size);
+    for (auto& field : plan->fields)
+        h = field.hash(field, base + field.offset, h);
+    return static_cast<size_t>(h);
+}
+
+void objectCopy(Object &dest, const Object &src)
+{
+    if (&dest == &src)
+        return;
+    if (dest.metaObject() != src.metaObject())
+        throw std::invalid_argument("objectCopy(): objects are of different classes");
+    auto plan = detail::ObjectComparePlan::get(src.metaObject());
+    char *destBase = reinterpret_cast<char *>(&dest);
+    const char *srcBase = reinterpret_cast<const char *>(&src);
+    for (auto& run : plan->podRuns)
+        std::memcpy(destBase + run.offset, srcBase + run.offset, run.size);
+    for (auto& field : plan->fields)
+        field.copy(field, destBase + field.offset, srcBase + field.offset);
+}
+
+Object *objectClone(const Object &obj)
+{
+    const MetaObject *metaObject = obj.metaObject();
+    Object *result = metaObject->createInstance(VariantArray());
+    try
+    {
+        objectCopy(*result, obj);
+    }
+    catch (...)
+    {
+        metaObject->destroyInstance(result);
+        throw;
+    }
+    return result;
+}
+
+} // namespace metacpp
@@ -0,0 +1,128 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef OBJECTOPERATIONS_H
+#define OBJECTOPERATIONS_H
+#include "config.h"
+#include "MetaObject.h"
+#include <vector>
+#include <cstdint>
+
+namespace metacpp
+{
+
+class Object;
+
+namespace detail
+{
+
+/** \brief Precomputed per-class info used for comparison, hashing and copying of objects
+ *
+ * Non-nullable integral fields are grouped into contiguous runs processed bytewise,
+ * operations for other fields are resolved to typed functions once when the plan is built.
+ */
+class ObjectComparePlan
+{
+public:
+    explicit ObjectComparePlan(const MetaObject *metaObject);
+
+    /** \brief Gets a plan of the given class, building it on first use */
+    static const ObjectComparePlan *get(const MetaObject *metaObject);
+
+    struct Field;
+
+    typedef bool (*EqualsFunc)(const Field& field, const void *a, const void *b);
+    typedef uint64_t (*HashFunc)(const Field& field, const void *value, uint64_t h);
+    typedef void (*CopyFunc)(const Field& field, void *dest, const void *src);
+
+    /** \brief Contiguous range of scalar fields */
+    struct PodRun
+    {
+        ptrdiff_t   offset;
+        size_t      size;
+    };
+
+    /** \brief Field processed with typed operations */
+    struct Field
+    {
+        const MetaFieldBase     *field;
+        ptrdiff_t               offset;
+        EqualsFunc              equals;
+        HashFunc                hash;
+        CopyFunc                copy;
+        /** \brief Element operations of the array fields */
+        EqualsFunc              elementEquals;
+        HashFunc                elementHash;
+        /** \brief Deep copy of the array elements, nullptr if copy-on-write sharing is sufficient */
+        CopyFunc                elementCopy;
+        size_t                  elementSize;
+        bool                    elementPod;
+    };
+
+    std::vector<PodRun> podRuns;
+    std::vector<Field> fields;
+};
+
+} // namespace detail
+
+/** \brief Compares all reflected fields of two objects
+ *
+ * Objects of different classes are never equal. Integral fields are compared bitwise,
+ * floating point fields by value (so -0.0 equals 0.0 and NaN is not equal to anything),
+ * nested objects and arrays are compared recursively.
+ * \throws std::invalid_argument if the class contains fields which cannot be compared (i.e. nested arrays)
+ */
+bool objectEquals(const Object& a, const Object& b);
+
+/** \brief Calculates hash of all reflected fields of the object consistent with objectEquals */
+size_t objectHash(const Object& obj);
+
+/** \brief Copies all reflected fields of src into dest of the same class
+ *
+ * Objects stored in variants (including variants in arrays) are cloned, so dest does not share them with src.
+ * \throws std::invalid_argument if classes of the objects differ
+ */
+void objectCopy(Object& dest, const Object& src);
+
+/** \brief Creates a new instance of the class of obj using MetaObject::createInstance and copies all reflected fields into it
+ *
+ * The result should be destroyed using Object::deleteThis.
+ */
+Object *objectClone(const Object& obj);
+
+/** \brief Typed version of objectClone */
+template<typename T>
+T *objectClone(const T& obj)
+{
+    return static_cast<T *>(objectClone(static_cast<const Object&>(obj)));
+}
+
+/** \brief Hash functor for reflected objects usable with STL unordered containers */
+template<typename T = Object>
+struct ObjectHash
+{
+    size_t operator()(const T& obj) const { return objectHash(obj); }
+};
+
+/** \brief Equality functor for reflected objects usable with STL unordered containers */
+template<typename T = Object>
+struct ObjectEqualTo
+{
+    bool operator()(const T& a, const T& b) const { return objectEquals(a, b); }
+};
+
+} // namespace metacpp
+
+#endif // OBJECTOPERATIONS_H
@@ -0,0 +1,325 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "ObjectSnapshot.h"
+#include "Object.h"
+#include "FieldRun.h"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace metacpp
+{
+
+FieldMask::FieldMask()
+    : m_size(0)
+{
+}
+
+FieldMask::FieldMask(size_t numFields)
+    : m_size(numFields), m_words((numFields + 63) / 64, 0)
+{
+}
+
+size_t FieldMask::size() const
+{
+    return m_size;
+}
+
+void FieldMask::set(size_t i, bool value)
+{
+    if (i >= m_size)
+        throw std::out_of_range("FieldMask::set(): index out of range");
+    if (value)
+        m_words[i / 64] |= uint64_t(1) << (i % 64);
+    else
+        m_words[i / 64] &= ~(uint64_t(1) << (i % 64));
+}
+
+bool FieldMask::test(size_t i) const
+{
+    if (i >= m_size)
+        throw std::out_of_range("FieldMask::test(): index out of range");
+    return (m_words[i / 64] >> (i % 64)) & 1;
+}
+
+void FieldMask::clear()
+{
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+size_t FieldMask::count() const
+{
+    size_t result = 0;
+    for (uint64_t word : m_words)
+    {
+        for (; word; word &= word - 1)
+            ++result;
+    }
+    return result;
+}
+
+bool FieldMask::any() const
+{
+    for (uint64_t word : m_words)
+        if (word) return true;
+    return false;
+}
+
+size_t FieldMask::hash() const
+{
+    uint64_t h = detail::fnv1aMix<uint64_t>(detail::Fnv1a<uint64_t>::basis(), m_size);
+    for (uint64_t word : m_words)
+        h = detail::fnv1aMix(h, word);
+    return static_cast<size_t>(h);
+}
+
+bool FieldMask::operator==(const FieldMask& rhs) const
+{
+    return m_size == rhs.m_size && m_words == rhs.m_words;
+}
+
+bool FieldMask::operator!=(const FieldMask& rhs) const
+{
+    return !(*this == rhs);
+}
+
+namespace detail
+{
+
+ObjectDiffPlan::ObjectDiffPlan(const MetaObject *metaObject)
+    : imageSize(0), numScalars(0), numStrings(0), numDateTimes(0),
+      numFields(metaObject->totalFields())
+{
+    const ObjectComparePlan *comparePlan = nullptr;
+    try
+    {
+        comparePlan = ObjectComparePlan::get(metaObject);
+    }
+    catch (const std::invalid_argument&)
+    {
+        // some field cannot be hashed, all hashed fields are reported as modified then
+    }
+
+    for (size_t i = 0; i < numFields; ++i)
+    {
+        const MetaFieldBase *field = metaObject->field(i);
+        switch (field->type())
+        {
+        case eFieldBool:
+        case eFieldInt:
+        case eFieldUint:
+        case eFieldInt64:
+        case eFieldUint64:
+        case eFieldFloat:
+        case eFieldDouble:
+        case eFieldEnum:
+            if (field->nullable())
+            {
+                valueFields.push_back(ValueField { i, field, ValueScalar, numScalars++ });
+            }
+            else
+            {
+                if (addToRuns(podRuns, field))
+                {
+                    podRuns.back().imageOffset = imageSize;
+                    podRuns.back().first = podFields.size();
+                }
+                podRuns.back().last = podFields.size();
+                podFields.push_back(PodField { i, field->offset(), field->size(), imageSize });
+                imageSize += field->size();
+            }
+            break;
+        case eFieldString:
+            valueFields.push_back(ValueField { i, field, ValueString, numStrings++ });
+            break;
+        case eFieldDateTime:
+            valueFields.push_back(ValueField { i, field, ValueDateTime, numDateTimes++ });
+            break;
+        default:
+        {
+            HashedField hashed { i, field->offset(), nullptr };
+            for (size_t j = 0; comparePlan && j < comparePlan->fields.size(); ++j)
+                if (comparePlan->fields[j].field == field)
+                    hashed.ops = &comparePlan->fields[j];
+            hashedFields.push_back(hashed);
+            break;
+        }
+        }
+    }
+}
+
+} // namespace detail
+
+ObjectSnapshot::ObjectSnapshot()
+    : m_metaObject(nullptr), m_plan(nullptr)
+{
+}
+
+ObjectSnapshot::ObjectSnapshot(const Object *obj)
+    : ObjectSnapshot()
+{
+    take(obj);
+}
+
+ObjectSnapshot::~ObjectSnapshot()
+{
+}
+
+void ObjectSnapshot::take(const Object *obj)
+{
+    if (!obj)
+        throw std::invalid_argument("ObjectSnapshot::take(): object cannot be null");
+    if (m_metaObject != obj->metaObject())
+    {
+        m_metaObject = obj->metaObject();
+        m_plan = m_metaObject->diffPlan();
+        m_image.resize(m_plan->imageSize);
+        m_scalars.resize(m_plan->numScalars);
+        m_set.resize(m_plan->valueFields.size());
+        m_strings.resize(m_plan->numStrings);
+        m_dateTimes.resize(m_plan->numDateTimes);
+        m_hashes.resize(m_plan->hashedFields.size());
+        m_hashed.resize(m_plan->hashedFields.size());
+    }
+    const char *base = reinterpret_cast<const char *>(obj);
+    for (auto& run : m_plan->podRuns)
+        std::memcpy(m_image.data() + run.imageOffset, base + run.offset, run.size);
+    for (size_t i = 0; i < m_plan->valueFields.size(); ++i)
+    {
+        auto& value = m_plan->valueFields[i];
+        switch (value.kind)
+        {
+        case detail::ObjectDiffPlan::ValueScalar:
+            m_scalars[value.slot] = 0;
+            m_set[i] = value.field->readInto(obj, &m_scalars[value.slot]);
+            break;
+        case detail::ObjectDiffPlan::ValueString:
+            m_set[i] = value.field->readInto(obj, &m_strings[value.slot]);
+            break;
+        case detail::ObjectDiffPlan::ValueDateTime:
+            m_set[i] = value.field->readInto(obj, &m_dateTimes[value.slot]);
+            break;
+        }
+    }
+    for (size_t i = 0; i < m_plan->hashedFields.size(); ++i)
+        m_hashed[i] = hashField(m_plan->hashedFields[i], base, m_hashes[i]);
+}
+
+void ObjectSnapshot::reset()
+{
+    m_metaObject = nullptr;
+    m_plan = nullptr;
+    m_image.clear();
+    m_scalars.clear();
+    m_set.clear();
+    m_strings.clear();
+    m_dateTimes.clear();
+    m_hashes.clear();
+    m_hashed.clear();
+}
+
+bool ObjectSnapshot::valid() const
+{
+    return m_plan != nullptr;
+}
+
+const MetaObject *ObjectSnapshot::metaObject() const
+{
+    return m_metaObject;
+}
+
+const detail::ObjectDiffPlan *ObjectSnapshot::checkedPlan(const Object *obj) const
+{
+    if (!m_plan)
+        throw std::invalid_argument("ObjectSnapshot: snapshot was not taken");
+    if (!obj || obj->metaObject() != m_metaObject)
+        throw std::invalid_argument("ObjectSnapshot: object does not match the snapshot");
+    return m_plan;
+}
+
+FieldMask ObjectSnapshot::diff(const Object *obj) const
+{
+    auto plan = checkedPlan(obj);
+    FieldMask mask(plan->numFields);
+    const char *base = reinterpret_cast<const char *>(obj);
+    for (auto& run : plan->podRuns)
+    {
+        if (!std::memcmp(m_image.data() + run.imageOffset, base + run.offset, run.size))
+            continue;
+        for (size_t i = run.first; i <= run.last; ++i)
+        {
+            auto& pod = plan->podFields[i];
+            if (std::memcmp(m_image.data() + pod.imageOffset, base + pod.offset, pod.size))
+                mask.set(pod.index);
+        }
+    }
+    uint64_t scalar;
+    String str;
+    DateTime dateTime;
+    for (size_t i = 0; i < plan->valueFields.size(); ++i)
+    {
+        auto& value = plan->valueFields[i];
+        bool set = false, equal = false;
+        switch (value.kind)
+        {
+        case detail::ObjectDiffPlan::ValueScalar:
+            scalar = 0;
+            set = value.field->readInto(obj, &scalar);
+            equal = !set || scalar == m_scalars[value.slot];
+            break;
+        case detail::ObjectDiffPlan::ValueString:
+            set = value.field->readInto(obj, &str);
+            equal = !set || str == m_strings[value.slot];
+            break;
+        case detail::ObjectDiffPlan::ValueDateTime:
+            set = value.field->readInto(obj, &dateTime);
+            equal = !set || dateTime == m_dateTimes[value.slot];
+            break;
+        }
+        if (set != m_set[i] || !equal)
+            mask.set(value.index);
+    }
+    for (size_t i = 0; i < plan->hashedFields.size(); ++i)
+    {
+        uint64_t h;
+        if (!m_hashed[i] || !hashField(plan->hashedFields[i], base, h) || h != m_hashes[i])
+            mask.set(plan->hashedFields[i].index);
+    }
+    return mask;
+}
+
+bool ObjectSnapshot::hashField(const detail::ObjectDiffPlan::HashedField &field, const char *base, uint64_t &h)
+{
+    if (!field.ops)
+        return false;
+    try
+    {
+        h = field.ops->hash(*field.ops, base + field.offset, detail::Fnv1a<uint64_t>::basis());
+        return true;
+    }
+    catch (const std::invalid_argument&)
+    {
+        // objects stored in variants may be of classes which cannot be hashed
+        return false;
+    }
+}
+
+bool ObjectSnapshot::modified(const Object *obj) const
+{
+    return diff(obj).any();
+}
+
+} // namespace metacpp
@@ -0,0 +1,179 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef OBJECTSNAPSHOT_H
+#define OBJECTSNAPSHOT_H
+#include "config.h"
+#include "MetaObject.h"
+#include "ObjectOperations.h"
+#include <vector>
+#include <cstdint>
+
+namespace metacpp
+{
+
+class Object;
+
+/** \brief Bitmap of the fields of some class, indexed the same way as MetaObject::field */
+class FieldMask
+{
+public:
+    /** \brief Constructs an empty mask */
+    FieldMask();
+    /** \brief Constructs a mask for numFields fields with all bits cleared */
+    explicit FieldMask(size_t numFields);
+
+    /** \brief Gets a number of fields covered by this mask */
+    size_t size() const;
+    /** \brief Sets or clears bit of the field at position i */
+    void set(size_t i, bool value = true);
+    /** \brief Checks bit of the field at position i */
+    bool test(size_t i) const;
+    /** \brief Clears all bits */
+    void clear();
+    /** \brief Gets a number of set bits */
+    size_t count() const;
+    /** \brief Checks whether any bit is set */
+    bool any() const;
+    /** \brief Calculates hash of the mask */
+    size_t hash() const;
+
+    bool operator==(const FieldMask& rhs) const;
+    bool operator!=(const FieldMask& rhs) const;
+private:
+    size_t m_size;
+    std::vector<uint64_t> m_words;
+};
+
+namespace detail
+{
+
+/** \brief Precomputed per-class comparison plan used by ObjectSnapshot
+ *
+ * Adjacent non-nullable scalar fields are grouped into runs compared with a single memcmp,
+ * nullable scalars, strings and datetimes are copied and compared by value,
+ * objects, arrays and variants are compared by hash.
+ */
+class ObjectDiffPlan
+{
+public:
+    explicit ObjectDiffPlan(const MetaObject *metaObject);
+
+    /** \brief Field kept in the snapshot image and compared bytewise */
+    struct PodField
+    {
+        size_t      index;
+        ptrdiff_t   offset;
+        size_t      size;
+        size_t      imageOffset;
+    };
+
+    /** \brief Contiguous range of PodFields */
+    struct PodRun
+    {
+        ptrdiff_t   offset;
+        size_t      size;
+        size_t      imageOffset;
+        size_t      first, last;
+    };
+
+    enum ValueKind
+    {
+        ValueScalar,
+        ValueString,
+        ValueDateTime
+    };
+
+    /** \brief Field copied into the typed slot of the snapshot and compared by value */
+    struct ValueField
+    {
+        size_t                  index;
+        const MetaFieldBase     *field;
+        ValueKind               kind;
+        size_t                  slot;
+    };
+
+    /** \brief Field compared by hash of it's value (objects, arrays and variants) */
+    struct HashedField
+    {
+        size_t                              index;
+        ptrdiff_t                           offset;
+        /** \brief Hash operation or nullptr if the field cannot be hashed and is always reported as modified */
+        const ObjectComparePlan::Field      *ops;
+    };
+
+    std::vector<PodField> podFields;
+    std::vector<PodRun> podRuns;
+    std::vector<ValueField> valueFields;
+    std::vector<HashedField> hashedFields;
+    size_t imageSize;
+    size_t numScalars, numStrings, numDateTimes;
+    size_t numFields;
+};
+
+} // namespace detail
+
+/** \brief Copy of the field values of an Object used for detecting modified fields
+ *
+ * Fields of object, array and variant types are not copied, only hashes of their values are kept.
+ * Fields which cannot be hashed (i.e. nested arrays) are always reported as modified.
+ * \see FieldMask
+ */
+class ObjectSnapshot
+{
+public:
+    /** \brief Constructs an empty snapshot */
+    ObjectSnapshot();
+    /** \brief Constructs a snapshot of the current state of obj */
+    explicit ObjectSnapshot(const Object *obj);
+    ~ObjectSnapshot();
+
+    ObjectSnapshot(const ObjectSnapshot&)=default;
+    ObjectSnapshot& operator=(const ObjectSnapshot&)=default;
+
+    /** \brief Replaces snapshot contents with the current state of obj */
+    void take(const Object *obj);
+    /** \brief Drops snapshot contents */
+    void reset();
+    /** \brief Checks whether snapshot was taken */
+    bool valid() const;
+    /** \brief Gets MetaObject of the object snapshot was taken from */
+    const MetaObject *metaObject() const;
+
+    /** \brief Returns mask of the fields of obj whose values differ from the snapshot
+     * \throws std::invalid_argument if obj is of another class or snapshot is not taken
+     */
+    FieldMask diff(const Object *obj) const;
+    /** \brief Checks whether any field of obj differs from the snapshot */
+    bool modified(const Object *obj) const;
+private:
+    const detail::ObjectDiffPlan *checkedPlan(const Object *obj) const;
+    /** \brief Calculates hash of the field value, returns false if it cannot be hashed */
+    static bool hashField(const detail::ObjectDiffPlan::HashedField& field, const char *base, uint64_t& h);
+
+    const MetaObject *m_metaObject;
+    const detail::ObjectDiffPlan *m_plan;
+    std::vector<char> m_image;
+    std::vector<uint64_t> m_scalars;
+    std::vector<bool> m_set;
+    Array<String> m_strings;
+    Array<DateTime> m_dateTimes;
+    std::vector<uint64_t> m_hashes;
+    std::vector<bool> m_hashed;
+};
+
+} // namespace metacpp
+
+#endif // OBJECTSNAPSHOT_H
@@ -0,0 +1,152 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef PARALLELVISIT_H
+#define PARALLELVISIT_H
+#include "config.h"
+#include "VisitorBase.h"
+#include "BatchVisitorBase.h"
+#include "WorkStealingPool.h"
+#include "Array.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace metacpp
+{
+
+class Object;
+
+namespace detail
+{
+
+inline void visitChunk(VisitorBase& visitor, Object *first, size_t count, size_t stride)
+{
+    char *base = reinterpret_cast<char *>(first);
+    for (size_t i = 0; i < count; ++i)
+        visitor.visit(reinterpret_cast<Object *>(base + i * stride));
+}
+
+inline void visitChunk(VisitorBase& visitor, Object * const *objects, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        visitor.visit(objects[i]);
+}
+
+inline void visitChunk(BatchVisitorBase& visitor, Object *first, size_t count, size_t stride)
+{
+    visitor.visit(first, count, stride);
+}
+
+inline void visitChunk(BatchVisitorBase& visitor, Object * const *objects, size_t count)
+{
+    // objects behind pointers are not contiguous, so batches consist of a single object
+    for (size_t i = 0; i < count; ++i)
+        visitor.visit(objects[i], 1, 0);
+}
+
+} // namespace detail
+
+/**
+ * \brief Runs visitors over collections of objects in parallel using WorkStealingPool
+ *
+ * TVisitor should be derived either from VisitorBase or BatchVisitorBase. One instance of the visitor
+ * is created by the factory for every worker which received some work. Once all objects are visited,
+ * the merge hook is called on the calling thread for every visitor in the order of worker indices.
+ * Optional chunk hook is called by the worker after each chunk of objects [begin, end), which may be
+ * used to collect results preserving the order of the objects.
+ */
+template<typename TVisitor>
+class ParallelVisit
+{
+public:
+    typedef std::function<std::unique_ptr<TVisitor> ()> Factory;
+    typedef std::function<void (TVisitor& visitor)> MergeHook;
+    typedef std::function<void (TVisitor& visitor, size_t begin, size_t end)> ChunkHook;
+
+    /** \brief Constructs a new ParallelVisit using given visitor factory and pool (default pool if nullptr) */
+    explicit ParallelVisit(const Factory& factory, WorkStealingPool *pool = nullptr)
+        : m_factory(factory), m_pool(pool ? pool : &WorkStealingPool::defaultPool()), m_grainSize(256)
+    {
+    }
+
+    /** \brief Sets the hook combining results of per-worker visitors */
+    ParallelVisit& merge(const MergeHook& hook) { m_merge = hook; return *this; }
+    /** \brief Sets the hook called after each chunk of objects is visited */
+    ParallelVisit& chunk(const ChunkHook& hook) { m_chunk = hook; return *this; }
+    /** \brief Sets the number of objects visited as a single unit of work */
+    ParallelVisit& grainSize(size_t size) { m_grainSize = size; return *this; }
+
+    /** \brief Visits objects pointed by the array */
+    void visit(const Array<Object *>& objects)
+    {
+        if (objects.empty())
+            return;
+        Object * const *data = objects.data();
+        run(objects.size(), [data](TVisitor& visitor, size_t begin, size_t end)
+            { detail::visitChunk(visitor, data + begin, end - begin); });
+    }
+
+    /** \brief Visits objects pointed by the array */
+    void visit(Array<Object *>& objects)
+    {
+        visit(static_cast<const Array<Object *>&>(objects));
+    }
+
+    /** \brief Visits count objects of the same type placed stride bytes apart starting from first */
+    void visit(Object *first, size_t count, size_t stride)
+    {
+        char *base = reinterpret_cast<char *>(first);
+        run(count, [base, stride](TVisitor& visitor, size_t begin, size_t end)
+            { detail::visitChunk(visitor, reinterpret_cast<Object *>(base + begin * stride), end - begin, stride); });
+    }
+
+    /** \brief Visits all objects in the typed array */
+    template<typename TObj>
+    void visit(Array<TObj>& objects)
+    {
+        if (!objects.empty())
+            visit(static_cast<Object *>(objects.data()), objects.size(), sizeof(TObj));
+    }
+private:
+    template<typename TFunc>
+    void run(size_t count, const TFunc& func)
+    {
+        std::vector<std::unique_ptr<TVisitor> > visitors(m_pool->size());
+        m_pool->run(count, m_grainSize, [&](size_t worker, size_t begin, size_t end)
+        {
+            // every worker touches only it's own slot
+            if (!visitors[worker])
+                visitors[worker] = m_factory();
+            func(*visitors[worker], begin, end);
+            if (m_chunk)
+                m_chunk(*visitors[worker], begin, end);
+        });
+        if (m_merge)
+            for (auto& visitor : visitors)
+                if (visitor)
+                    m_merge(*visitor);
+    }
+
+    Factory m_factory;
+    WorkStealingPool *m_pool;
+    size_t m_grainSize;
+    MergeHook m_merge;
+    ChunkHook m_chunk;
+};
+
+} // namespace metacpp
+
+#endif // PARALLELVISIT_H
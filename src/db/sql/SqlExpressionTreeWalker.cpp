@@ -27,7 +27,7 @@ namespace detail
 SqlExpressionTreeWalker::SqlExpressionTreeWalker(const db::detail::ExpressionNodeImplPtr &rootNode,
     bool fullQualified, SqlSyntax sqlSyntax, size_t startLiteralIndex)
     : db::detail::ASTWalkerBase(rootNode), m_fullQualified(fullQualified), m_sqlSyntax(sqlSyntax),
-    m_startLiteralIndex(startLiteralIndex)
+    m_sql(nullptr), m_startLiteralIndex(startLiteralIndex)
 {
 }
 
@@ -37,11 +37,24 @@ SqlExpressionTreeWalker::~SqlExpressionTreeWalker()
 
 String SqlExpressionTreeWalker::evaluate()
 {
-    doWalk();
-    assert(m_stack.size() == 1);
-    String result = m_stack.back();
-    m_stack.pop_back();
-    return result;
+    StringBuilder sql;
+    evaluate(sql);
+    return sql.take();
+}
+
+void SqlExpressionTreeWalker::evaluate(StringBuilder &sql)
+{
+    m_sql = &sql;
+    try
+    {
+        doWalk();
+    }
+    catch (...)
+    {
+        m_sql = nullptr;
+        throw;
+    }
+    m_sql = nullptr;
 }
 
 const VariantArray &SqlExpressionTreeWalker::literals() const
@@ -51,15 +64,12 @@ const VariantArray &SqlExpressionTreeWalker::literals() const
 
 void SqlExpressionTreeWalker::visitColumn(std::shared_ptr<db::detail::ExpressionNodeImplColumn> column)
 {
-    static String quote_char = "\"";
-    static String mysql_quote_char = "`";
-    String quote = m_sqlSyntax == SqlSyntaxMySql ? mysql_quote_char : quote_char;
-    String eval;
     if (m_fullQualified)
-        eval = quote + column->metaField()->metaObject()->name() + quote + "." + quote + column->metaField()->name() + quote;
-    else
-        eval = quote + column->metaField()->name() + quote;
-    m_stack.push_back(eval);
+    {
+        appendQuoted(column->metaField()->metaObject()->name());
+        m_sql->append('.');
+    }
+    appendQuoted(column->metaField()->name());
 }
 
 void SqlExpressionTreeWalker::visitLiteral(std::shared_ptr<db::detail::ExpressionNodeImplLiteral> literal)
@@ -68,71 +78,83 @@ void SqlExpressionTreeWalker::visitLiteral(std::shared_ptr<db::detail::Expressio
     if (m_fullQualified)
     {
         if (m_sqlSyntax == SqlSyntaxPostgreSQL)
-            m_stack.push_back("$" + String::fromValue(m_startLiteralIndex + m_bindValues.size()));
+            m_sql->append('$').append(m_startLiteralIndex + m_bindValues.size());
         else
-            m_stack.push_back("?");
+            m_sql->append('?');
     }
     else
     {
-        String eval;
+        String value = variant_cast<String>(literal->value());
         switch (literal->type())
         {
         case eFieldDateTime:
         case eFieldString:
-            eval = "\'" + variant_cast<String>(literal->value()).replace("'", "\'\'") + "\'";
+            m_sql->append('\'');
+            for (char ch : value)
+            {
+                if (ch == '\'')
+                    m_sql->append('\'');
+                m_sql->append(ch);
+            }
+            m_sql->append('\'');
             break;
         default:
-            eval = variant_cast<String>(literal->value());
+            m_sql->append(value);
             break;
         }
-        m_stack.push_back(eval);
     }
 }
 
 void SqlExpressionTreeWalker::visitNull(std::shared_ptr<db::detail::ExpressionNodeImplNull> null)
 {
     (void)null;
-    String eval = "NULL";
-    m_stack.push_back(eval);
+    m_sql->append("NULL", 4);
 }
 
 void SqlExpressionTreeWalker::visitUnaryOperator(std::shared_ptr<db::detail::ExpressionNodeImplUnaryOperator> unary)
 {
     auto inner = unary->innerNode();
-    String eval;
     switch (unary->operatorType())
     {
     case eUnaryOperatorPlus:
-        eval = evaluateSubnode(inner);
+        evaluateSubnode(inner);
         break;
     case eUnaryOperatorMinus:
-        eval = "-" + evaluateSubnode(inner, !inner->isLeaf());
+        m_sql->append('-');
+        evaluateSubnode(inner, !inner->isLeaf());
         break;
     case eUnaryOperatorNegation:
-        eval = "~" + evaluateSubnode(inner, !inner->isLeaf());
+    {
+        bool castRequired = false;
         if (m_sqlSyntax == SqlSyntaxMySql)
         {
             switch (inner->type())
             {
             case eFieldInt:
             case eFieldUint:
-                eval = "CAST(" + eval + " AS INTEGER)";
+                castRequired = true;
                 break;
             default:
                 break;
             }
         }
+        if (castRequired)
+            m_sql->append("CAST(");
+        m_sql->append('~');
+        evaluateSubnode(inner, !inner->isLeaf());
+        if (castRequired)
+            m_sql->append(" AS INTEGER)");
         break;
+    }
     default:
         throw std::invalid_argument("Unknown unary operator");
     }
-    m_stack.push_back(eval);
 }
 
 void SqlExpressionTreeWalker::visitCastOperator(std::shared_ptr<db::detail::ExpressionNodeImplCastOperator> cast)
 {
     auto inner = cast->innerNode();
-    String castType;
+    const char *castType;
     if (m_sqlSyntax == SqlSyntaxPostgreSQL)
     {
         switch (cast->type())
@@ -218,32 +240,39 @@ void SqlExpressionTreeWalker::visitCastOperator(std::shared_ptr<db::detail::Expr
         default:
             throw std::invalid_argument("Unknown cast type");
         }
-    }    m_stack.push_back("CAST(" + evaluateSubnode(inner) + " AS " + castType + ")");
+    }
+    m_sql->append("CAST(");
+    evaluateSubnode(inner);
+    m_sql->append(" AS ").append(castType).append(')');
 }
 
 void SqlExpressionTreeWalker::visitBinaryOperator(std::shared_ptr<db::detail::ExpressionNodeImplBinaryOperator> binary)
 {
     auto left = binary->leftNode();
     auto right = binary->rightNode();
-    String l = evaluateSubnode(left, !left->isLeaf());
-    String r = evaluateSubnode(right, !right->isLeaf());
-    String eval;
+    const char *op;
     switch (binary->operatorType())
     {
     case eBinaryOperatorPlus:
-        eval = l + " + " + r;
+        op = " + ";
         break;
     case eBinaryOperatorConcatenate:
         if (m_sqlSyntax == SqlSyntaxMySql)
-            eval = "CONCAT(" + l + ", " + r + ")";
-        else
-            eval = l + " || " + r;
+        {
+            m_sql->append("CONCAT(");
+            evaluateSubnode(left, !left->isLeaf());
+            m_sql->append(", ");
+            evaluateSubnode(right, !right->isLeaf());
+            m_sql->append(')');
+            return;
+        }
+        op = " || ";
         break;
     case eBinaryOperatorMinus:
-        eval = l + " - " + r;
+        op = " - ";
         break;
     case eBinaryOperatorMultiply:
-        eval = l + " * " + r;
+        op = " * ";
         break;
     case eBinaryOperatorDivide:
         if (m_sqlSyntax == SqlSyntaxMySql) {
@@ -260,104 +289,133 @@ void SqlExpressionTreeWalker::visitBinaryOperator(std::shared_ptr<db::detail::Ex
                 }
             };
             if (is_integral(left->type()) && is_integral(right->type()))
-                eval = l + " DIV " + r;
+                op = " DIV ";
             else
-                eval = l + " / " + r;
+                op = " / ";
         }
         else
-            eval = l + " / " + r;
+            op = " / ";
         break;
     case eBinaryOperatorReminder:
-        eval = l + " % " + r;
+        op = " % ";
         break;
     case eBinaryOperatorAnd:
-        eval = l + " & " + r;
+        op = " & ";
         break;
     case eBinaryOperatorOr:
-        eval = l + " | " + r;
+        op = " | ";
         break;
     case eBinaryOperatorShiftLeft:
-        eval = l + " << " + r;
+        op = " << ";
         break;
     case eBinaryOperatorShiftRight:
-        eval = l + " >> " + r;
+        op = " >> ";
         break;
     case eBinaryOperatorXor:
-        eval = "(" + l + " & ~" + r + ") | (~" + l + " & " + r + ")";
-        break;
+    {
+        // both operands are written twice, but evaluated once to keep the order of literals
+        m_sql->append('(');
+        size_t leftStart = m_sql->size();
+        evaluateSubnode(left, !left->isLeaf());
+        String l(m_sql->view(leftStart));
+        m_sql->append(" & ~");
+        size_t rightStart = m_sql->size();
+        evaluateSubnode(right, !right->isLeaf());
+        String r(m_sql->view(rightStart));
+        m_sql->append(") | (~").append(l).append(" & ").append(r).append(')');
+        return;
+    }
     default:
         throw std::invalid_argument("Unknown binary operator");
     }
-    m_stack.push_back(eval);
+    evaluateSubnode(left, !left->isLeaf());
+    m_sql->append(op);
+    evaluateSubnode(right, !right->isLeaf());
 }
 
 void SqlExpressionTreeWalker::visitFunctionCall(std::shared_ptr<db::detail::ExpressionNodeImplFunctionCall> functionCall)
 {
-    StringArray args = functionCall->argumentNodes().map<String>([this](const db::detail::ExpressionNodeImplPtr node) { return evaluateSubnode(node); });
-    String eval = functionCall->functionName() + "(" + join(args, ", ") + ")";
-    m_stack.push_back(eval);
+    m_sql->append(functionCall->functionName()).append('(');
+    const auto& args = functionCall->argumentNodes();
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        if (i) m_sql->append(", ");
+        evaluateSubnode(args[i]);
+    }
+    m_sql->append(')');
 }
 
 void SqlExpressionTreeWalker::visitWhereClauseRelational(std::shared_ptr<db::detail::ExpressionNodeImplWhereClauseRelational> whereClauseRelational)
 {
     auto left = whereClauseRelational->leftNode();
     auto right = whereClauseRelational->rightNode();
-    String l = evaluateSubnode(left, !left->isLeaf());
-    String r = evaluateSubnode(right, !right->isLeaf());
-    String eval;
+    const char *op;
+    bool unary = false;
     switch (whereClauseRelational->operatorType())
     {
     case eRelationalOperatorEqual:
-        eval = l + " = "  + r;
+        op = " = ";
         break;
     case eRelationalOperatorNotEqual:
-        eval = l + " <> " + r;
+        op = " <> ";
         break;
     case eRelationalOperatorLess:
-        eval = l + " < "  + r;
+        op = " < ";
         break;
     case eRelationalOperatorLessOrEqual:
-        eval = l + " <= " + r;
+        op = " <= ";
         break;
     case eRelationalOperatorGreater:
-        eval = l + " > "  + r;
+        op = " > ";
         break;
     case eRelationalOperatorGreaterOrEqual:
-        eval = l + " >= " + r;
+        op = " >= ";
         break;
     case eRelationalOperatorIsNull:
-        eval = l + " IS NULL";
+        op = " IS NULL";
+        unary = true;
         break;
     case eRelationalOperatorIsNotNull:
-        eval = l + " IS NOT NULL";
+        op = " IS NOT NULL";
+        unary = true;
         break;
     case eRelationalOperatorLike:
-        eval = l + " LIKE " + r;
+        op = " LIKE ";
         break;
     default:
         throw std::invalid_argument("Unknown relational operator type");
     }
-    m_stack.push_back(eval);
+    evaluateSubnode(left, !left->isLeaf());
+    if (unary)
+    {
+        // the right operand is evaluated anyway to collect its literals
+        size_t length = m_sql->size();
+        evaluateSubnode(right, !right->isLeaf());
+        m_sql->resize(length);
+        m_sql->append(op);
+        return;
+    }
+    m_sql->append(op);
+    evaluateSubnode(right, !right->isLeaf());
 }
 
 void SqlExpressionTreeWalker::visitWhereClauseLogical(std::shared_ptr<db::detail::ExpressionNodeImplWhereClauseLogical> whereClauseLogical)
 {
     auto inner = whereClauseLogical->innerNode();
-    String eval;
     switch (whereClauseLogical->operatorType())
     {
     case eLogicalOperatorNot:
-        eval = "NOT " + evaluateSubnode(inner, inner->complex());
+        m_sql->append("NOT ");
+        evaluateSubnode(inner, inner->complex());
         break;
     default:
         throw std::invalid_argument("Unknown logical operator type");
     }
-    m_stack.push_back(eval);
 }
 
 void SqlExpressionTreeWalker::visitWhereClauseConditional(std::shared_ptr<db::detail::ExpressionNodeImplWhereClauseConditional> whereClauseConditional)
 {
-    String op;
+    const char *op;
     switch (whereClauseConditional->operatorType())
     {
     case eConditionalOperatorAnd: op = " AND "; break;
@@ -367,21 +425,25 @@ void SqlExpressionTreeWalker::visitWhereClauseConditional(std::shared_ptr<db::de
     }
     auto left = whereClauseConditional->leftNode();
     auto right = whereClauseConditional->rightNode();
-    String l = evaluateSubnode(left, left->complex());
-    String r = evaluateSubnode(right, right->complex());
-    String eval = l + op + r;
-    m_stack.push_back(eval);
+    evaluateSubnode(left, left->complex());
+    m_sql->append(op);
+    evaluateSubnode(right, right->complex());
 }
 
 
-String SqlExpressionTreeWalker::evaluateSubnode(const db::detail::ExpressionNodeImplPtr &node, bool bracesRequired)
+void SqlExpressionTreeWalker::evaluateSubnode(const db::detail::ExpressionNodeImplPtr &node, bool bracesRequired)
 {
+    if (bracesRequired)
+        m_sql->append('(');
     visitNode(node);
-    String eval = m_stack.back();
-    m_stack.pop_back();
-    if (!bracesRequired)
-        return eval;
-    return "(" + eval + ")";
+    if (bracesRequired)
+        m_sql->append(')');
+}
+
+void SqlExpressionTreeWalker::appendQuoted(const char *identifier)
+{
+    char quote = m_sqlSyntax == SqlSyntaxMySql ? '`' : '"';
+    m_sql->append(quote).append(identifier).append(quote);
 }
 
 } // namespace detail
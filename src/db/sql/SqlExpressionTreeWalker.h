@@ -49,6 +49,7 @@ public:
     ~SqlExpressionTreeWalker();
 
     String evaluate();
+    void evaluate(StringBuilder& sql);
     const VariantArray& literals() const;
 
 protected:
@@ -63,11 +64,12 @@ protected:
     void visitWhereClauseLogical(std::shared_ptr<db::detail::ExpressionNodeImplWhereClauseLogical> whereClauseLogical) override;
     void visitWhereClauseConditional(std::shared_ptr<db::detail::ExpressionNodeImplWhereClauseConditional> whereClauseConditional) override;
 private:
-    String evaluateSubnode(const db::detail::ExpressionNodeImplPtr& node, bool bracesRequired = false);
+    void evaluateSubnode(const db::detail::ExpressionNodeImplPtr& node, bool bracesRequired = false);
+    void appendQuoted(const char *identifier);
 private:
     bool m_fullQualified;
     SqlSyntax m_sqlSyntax;
-    Array<String> m_stack;
+    StringBuilder *m_sql;
     VariantArray m_bindValues;
     size_t m_startLiteralIndex;
 };
@@ -15,6 +15,7 @@
 ****************************************************************************/
 #include "SqlResultSet.h"
 #include "SqlTransaction.h"
+#include "SqlStorable.h"
 
 namespace metacpp
 {
@@ -46,6 +47,7 @@ namespace detail
     bool SqlResultSetData::moveIterator()
     {
         if (m_transaction.impl()->fetchNext(m_statement.get(), m_storable)) {
+            m_storable->takeSnapshot();
             return true;
         } else {
             return false;
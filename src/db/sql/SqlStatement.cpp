@@ -25,17 +25,17 @@ namespace db
 namespace sql
 {
 
-static String quote(const char *name, SqlSyntax syntax)
+static StringBuilder& appendQuoted(StringBuilder& sql, const char *name, SqlSyntax syntax)
 {
-    static String quote_char = "\"";
-    static String mysql_quote_char = "`";
-    switch (syntax)
-    {
-    case SqlSyntaxMySql:
-        return mysql_quote_char + name + mysql_quote_char;
-    default:
-        return quote_char + name + quote_char;
-    }
+    char quote = SqlSyntaxMySql == syntax ? '`' : '"';
+    return sql.append(quote).append(name).append(quote);
+}
+
+static StringBuilder& appendPlaceholder(StringBuilder& sql, size_t index, SqlSyntax syntax)
+{
+    if (SqlSyntaxPostgreSQL == syntax)
+        return sql.append('$').append(index);
+    return sql.append('?');
 }
 
 SqlStatementBase::SqlStatementBase()
@@ -77,30 +77,30 @@ SqlStatementType SqlStatementSelect::type() const
 
 String SqlStatementSelect::buildQuery(SqlSyntax syntax)
 {
-    (void)syntax;
-    if (!m_storable->record()->metaObject()->totalFields())
+    const MetaObject *metaObject = m_storable->record()->metaObject();
+    if (!metaObject->totalFields())
         throw std::runtime_error("Invalid storable");
-    String res;
-    const char *tblName = m_storable->record()->metaObject()->name();
-    StringArray columns;
-    for (size_t i = 0; i < m_storable->record()->metaObject()->totalFields(); ++i)
-        columns.push_back(quote(tblName, syntax) + "." +
-                          quote(m_storable->record()->metaObject()->field(i)->name(), syntax));
-    res = "SELECT " + join(columns, ", ") + " FROM " + quote(tblName, syntax);
+    const char *tblName = metaObject->name();
+    StringBuilder res(256);
+    res.append("SELECT ");
+    for (size_t i = 0; i < metaObject->totalFields(); ++i)
+    {
+        if (i) res.append(", ");
+        appendQuoted(res, tblName, syntax).append('.');
+        appendQuoted(res, metaObject->field(i)->name(), syntax);
+    }
+    appendQuoted(res.append(" FROM "), tblName, syntax);
     if (!m_whereClause.empty())
     {
-        detail::SqlExpressionTreeWalker walker(m_whereClause.impl(), true, syntax);
-        String whereExpr = walker.evaluate();
-        m_literals = walker.literals();
         if (m_joins.size())
         {
             switch (m_joinType)
             {
             case JoinTypeInner:
-                res += " INNER JOIN ";
+                res.append(" INNER JOIN ");
                 break;
             case JoinTypeLeftOuter:
-                res += " LEFT OUTER JOIN ";
+                res.append(" LEFT OUTER JOIN ");
                 break;
             default:
                 throw std::runtime_error("Unknown join type");
@@ -108,30 +108,32 @@ String SqlStatementSelect::buildQuery(SqlSyntax syntax)
 
             for (size_t i = 0; i < m_joins.size(); ++i)
             {
-                res += quote(m_joins[i]->name(), syntax);
-                if (m_joins.size() - 1 != i) res += ", ";
+                appendQuoted(res, m_joins[i]->name(), syntax);
+                if (m_joins.size() - 1 != i) res.append(", ");
             }
-            res += " ON " + whereExpr;
+            res.append(" ON ");
         }
         else
         {
-            res += " WHERE " + whereExpr;
+            res.append(" WHERE ");
         }
+        detail::SqlExpressionTreeWalker walker(m_whereClause.impl(), true, syntax);
+        walker.evaluate(res);
+        m_literals = walker.literals();
     }
     if (m_order.size())
     {
-        auto orders = m_order.template map<String>(
-            [=](const std::pair<db::detail::ExpressionNodeImplPtr, bool>& order)
-                    -> String
-            {
-                return detail::SqlExpressionTreeWalker(order.first, true, syntax)
-                        .evaluate() + (order.second ? " ASC" : "DESC");
-            });
-        res += " ORDER BY " + join(orders, ", ");
+        res.append(" ORDER BY ");
+        for (size_t i = 0; i < m_order.size(); ++i)
+        {
+            if (i) res.append(", ");
+            detail::SqlExpressionTreeWalker(m_order[i].first, true, syntax).evaluate(res);
+            res.append(m_order[i].second ? " ASC" : " DESC");
+        }
     }
-    if (m_limit) res += " LIMIT " + String::fromValue(*m_limit);
-    if (m_offset) res += " OFFSET " + String::fromValue(*m_offset);
-    return res;
+    if (m_limit) res.append(" LIMIT ").append(*m_limit);
+    if (m_offset) res.append(" OFFSET ").append(*m_offset);
+    return res.take();
 }
 
 SqlStatementSelect &SqlStatementSelect::limit(size_t lim)
@@ -169,7 +171,7 @@ bool SqlStatementSelect::fetchOne(SqlTransaction &transaction)
 }
 
 SqlStatementInsert::SqlStatementInsert(SqlStorable *storable)
-    : m_storable(storable), m_numLiterals(0), m_prepared(false)
+    : m_storable(storable), m_prepared(false)
 {
 }
 
@@ -184,30 +186,30 @@ SqlStatementType SqlStatementInsert::type() const
 
 String SqlStatementInsert::buildQuery(SqlSyntax syntax)
 {
-    (void)syntax;
-    if (!m_storable->record()->metaObject()->totalFields())
+    const MetaObject *metaObject = m_storable->record()->metaObject();
+    if (!metaObject->totalFields())
         throw std::runtime_error("Invalid storable");
-    String res;
-    const char *tblName = m_storable->record()->metaObject()->name();
-    res = "INSERT INTO " + quote(tblName, syntax);
+    StringBuilder res(256), placeholders(64);
+    appendQuoted(res.append("INSERT INTO "), metaObject->name(), syntax).append('(');
     auto pkey = m_storable->primaryKey();
-    StringArray columns, placeholders;
-    for (size_t i = 0; i < m_storable->record()->metaObject()->totalFields(); ++i)
+    m_fields.clear();
+    for (size_t i = 0; i < metaObject->totalFields(); ++i)
     {
-        auto field = m_storable->record()->metaObject()->field(i);
+        auto field = metaObject->field(i);
         if (field != pkey)
         {
-            columns.push_back(quote(field->name(), syntax));
-            if (SqlSyntaxPostgreSQL == syntax)
-                placeholders.push_back("$" + String::fromValue(placeholders.size() + 1));
-            else
-                placeholders.push_back("?");
+            if (m_fields.size())
+            {
+                res.append(", ");
+                placeholders.append(", ");
+            }
+            m_fields.push_back(field);
+            appendQuoted(res, field->name(), syntax);
+            appendPlaceholder(placeholders, m_fields.size(), syntax);
         }
     }
-    res += "(" + join(columns, ", ") + ") VALUES (" + join(placeholders, ", ") + ")";
-    assert(columns.size() == placeholders.size());
-    m_numLiterals = columns.size();
-    return res;
+    res.append(") VALUES (").append(placeholders.data(), placeholders.size()).append(')');
+    return res.take();
 }
 
 int SqlStatementInsert::execPrepare(SqlTransaction &transaction)
@@ -215,7 +217,7 @@ int SqlStatementInsert::execPrepare(SqlTransaction &transaction)
     if (m_prepared)
         throw std::logic_error("Statement is already prepared");
     createImpl(transaction);
-    if (!transaction.impl()->prepare(m_impl.get(), m_numLiterals))
+    if (!transaction.impl()->prepare(m_impl.get(), m_fields.size()))
         throw std::runtime_error("Failed to prepare statement");
     m_prepared = true;
 
@@ -229,21 +231,8 @@ int SqlStatementInsert::execStep(SqlTransaction &transaction, const Object *reco
     if (m_storable->record()->metaObject() != record->metaObject())
         throw std::invalid_argument("Cannot mix storable types in insert request");
 
-    m_literals.clear();
-    m_literals.reserve(m_numLiterals);
-    auto pkey = m_storable->primaryKey();
-    for (size_t i = 0; i < record->metaObject()->totalFields(); ++i)
-    {
-        auto field = record->metaObject()->field(i);
-        if (field != pkey)
-        {
-            m_literals.push_back(field->getValue(record));
-        }
-    }
-    if (m_literals.size() != m_numLiterals)
-        throw std::logic_error("Unexpected number of columns in record");
-
-    if (m_literals.size() && !transaction.impl()->bindValues(m_impl.get(), m_literals))
+    // field values are bound directly from the record, without intermediate variants
+    if (m_fields.size() && !transaction.impl()->bindRecord(m_impl.get(), record, m_fields, VariantArray()))
         throw std::runtime_error("Failed to bind values");
     int numRows = 0;
     if (!transaction.impl()->execStatement(m_impl.get(), &numRows))
@@ -253,7 +242,7 @@ int SqlStatementInsert::execStep(SqlTransaction &transaction, const Object *reco
 }
 
 SqlStatementUpdate::SqlStatementUpdate(SqlStorable *storable)
-    : m_storable(storable)
+    : m_storable(storable), m_metaObject(nullptr), m_byPrimaryKey(false), m_prepared(false)
 {
 }
 
@@ -268,84 +257,89 @@ SqlStatementType SqlStatementUpdate::type() const
 
 String SqlStatementUpdate::buildQuery(SqlSyntax syntax)
 {
-    if (!m_storable->record()->metaObject()->totalFields())
+    const MetaObject *metaObject = m_storable->record()->metaObject();
+    if (!metaObject->totalFields())
         throw std::runtime_error("Invalid storable");
-    String res;
-    const char *tblName = m_storable->record()->metaObject()->name();
-    res = "UPDATE " + quote(tblName, syntax);
+    StringBuilder sets(256);
     auto pkey = m_storable->primaryKey();
-    StringArray sets;
+    m_fields.clear();
     if (!m_sets.size())
     {
         m_literals.clear();
-        for (size_t i = 0; i < m_storable->record()->metaObject()->totalFields(); ++i)
+        for (size_t i = 0; i < metaObject->totalFields(); ++i)
         {
-            auto field = m_storable->record()->metaObject()->field(i);
-            if (field != pkey)
+            auto field = metaObject->field(i);
+            if (field != pkey && (!m_fieldMask.size() || m_fieldMask.test(i)))
             {
-                m_literals.push_back(field->getValue(m_storable->record()));
-                if (syntax == SqlSyntaxPostgreSQL)
-                    sets.push_back(quote(field->name(), syntax) + " = $" +
-                                   String::fromValue(m_literals.size()));
-                else
-                    sets.push_back(quote(field->name(), syntax) + " = ?");
+                // values are bound directly from the record in exec()
+                if (m_fields.size()) sets.append(", ");
+                m_fields.push_back(field);
+                appendQuoted(sets, field->name(), syntax).append(" = ");
+                appendPlaceholder(sets, m_fields.size(), syntax);
             }
         }
     }
     else {
-        sets.reserve(m_sets.size());
         m_literals.reserve(m_sets.size());
-        for (auto& set : m_sets)
+        for (size_t i = 0; i < m_sets.size(); ++i)
         {
-            String expr = detail::SqlExpressionTreeWalker(set.first, false, syntax)
-                    .evaluate() + " = ";
-            detail::SqlExpressionTreeWalker walker(set.second, true, syntax, m_literals.size());
-            expr += walker.evaluate();
+            if (i) sets.append(", ");
+            detail::SqlExpressionTreeWalker(m_sets[i].first, false, syntax).evaluate(sets);
+            sets.append(" = ");
+            detail::SqlExpressionTreeWalker walker(m_sets[i].second, true, syntax, m_literals.size());
+            walker.evaluate(sets);
             m_literals.append(walker.literals());
-            sets.push_back(expr);
         }
     }
 
-    String whereExpr;
-    if (!m_whereClause.empty())
+    if (sets.empty())
+        throw std::logic_error("Nothing to update");
+
+    StringBuilder whereExpr;
+    if (m_byPrimaryKey)
+    {
+        m_fields.push_back(pkey);
+        appendQuoted(whereExpr, pkey->name(), syntax).append(" = ");
+        appendPlaceholder(whereExpr, m_fields.size(), syntax);
+    }
+    else if (!m_whereClause.empty())
     {
-        detail::SqlExpressionTreeWalker walker(m_whereClause.impl(), true, syntax, m_literals.size());
-        whereExpr = walker.evaluate();
+        detail::SqlExpressionTreeWalker walker(m_whereClause.impl(), true, syntax,
+                                               m_fields.size() + m_literals.size());
+        walker.evaluate(whereExpr);
         m_literals.append(walker.literals());
     }
 
+    StringBuilder res(sets.size() + whereExpr.size() + 64);
+    appendQuoted(res.append("UPDATE "), metaObject->name(), syntax);
+    res.append(" SET ").append(sets.data(), sets.size());
     if (m_joins.size())
     {
-        String joins;
+        if (SqlSyntaxSqlite == syntax || SqlSyntaxMySql == syntax)
+            res.append(" WHERE EXISTS (SELECT 1 FROM ");
+        else if (SqlSyntaxPostgreSQL == syntax)
+            res.append(" FROM ");
+        else
+            throw std::runtime_error("Unimplemented syntax");
+
         for (size_t i = 0; i < m_joins.size(); ++i)
         {
-            joins += quote(m_joins[i]->name(), syntax);
+            appendQuoted(res, m_joins[i]->name(), syntax);
             if (i != m_joins.size() - 1)
-                joins += ", ";
+                res.append(", ");
         }
 
-        if (SqlSyntaxSqlite == syntax || SqlSyntaxMySql == syntax)
-        {
-            res += " SET " + join(sets, ", ") +
-                   " WHERE EXISTS (SELECT 1 FROM " + joins;
-
-            if (!m_whereClause.empty()) res += " WHERE " + whereExpr + ")";
-        }
-        else if (SqlSyntaxPostgreSQL == syntax)
+        if (!m_whereClause.empty())
         {
-            res += " SET " + join(sets, ", ") +
-                   " FROM " + joins;
-            if (!m_whereClause.empty()) res += " WHERE " + whereExpr;
+            res.append(" WHERE ").append(whereExpr.data(), whereExpr.size());
+            if (SqlSyntaxPostgreSQL != syntax) res.append(')');
         }
-        else
-            throw std::runtime_error("Unimplemented syntax");
     }
-    else
+    else if (!whereExpr.empty())
     {
-        res += " SET " + join(sets, ", ");
-        if (!whereExpr.isNullOrEmpty()) res += " WHERE " + whereExpr;
+        res.append(" WHERE ").append(whereExpr.data(), whereExpr.size());
     }
-    return res;
+    return res.take();
 }
 
 SqlStatementUpdate &SqlStatementUpdate::where(const ExpressionNodeWhereClause &whereClause)
@@ -354,12 +348,58 @@ SqlStatementUpdate &SqlStatementUpdate::where(const ExpressionNodeWhereClause &w
     return *this;
 }
 
+SqlStatementUpdate &SqlStatementUpdate::fields(const FieldMask &mask)
+{
+    if (mask.size() != m_storable->record()->metaObject()->totalFields())
+        throw std::invalid_argument("Field mask does not match the storable");
+    m_fieldMask = mask;
+    return *this;
+}
+
 int SqlStatementUpdate::exec(SqlTransaction &transaction)
 {
     createImpl(transaction);
-    if (!transaction.impl()->prepare(m_impl.get(), m_literals.size()))
+    if (!transaction.impl()->prepare(m_impl.get(), m_fields.size() + m_literals.size()))
         throw std::runtime_error("Failed to prepare statement");
-    if (m_literals.size() && !transaction.impl()->bindValues(m_impl.get(), m_literals))
+    if (m_fields.size())
+    {
+        if (!transaction.impl()->bindRecord(m_impl.get(), m_storable->record(), m_fields, m_literals))
+            throw std::runtime_error("Failed to bind values");
+    }
+    else if (m_literals.size() && !transaction.impl()->bindValues(m_impl.get(), m_literals))
+        throw std::runtime_error("Failed to bind values");
+    int numRows = 0;
+    if (!transaction.impl()->execStatement(m_impl.get(), &numRows))
+        throw std::runtime_error("Failed to execute statement");
+    return numRows;
+}
+
+int SqlStatementUpdate::execPrepare(SqlTransaction &transaction)
+{
+    if (m_prepared)
+        throw std::logic_error("Statement is already prepared");
+    if (m_sets.size() || !m_whereClause.empty() || m_joins.size())
+        throw std::logic_error("Statement updating by primary key cannot have set or where clauses");
+    if (!m_storable->primaryKey())
+        throw std::runtime_error(std::string("Table ") + m_storable->record()->metaObject()->name() +
+                                 " has no primary key");
+    m_byPrimaryKey = true;
+    m_metaObject = m_storable->record()->metaObject();
+    createImpl(transaction);
+    if (!transaction.impl()->prepare(m_impl.get(), m_fields.size()))
+        throw std::runtime_error("Failed to prepare statement");
+    m_prepared = true;
+    return 0;
+}
+
+int SqlStatementUpdate::execStep(SqlTransaction &transaction, const Object *record)
+{
+    if (!m_prepared)
+        throw std::logic_error("Statement must be prepared first");
+    if (m_metaObject != record->metaObject())
+        throw std::invalid_argument("Cannot mix storable types in update request");
+
+    if (!transaction.impl()->bindRecord(m_impl.get(), record, m_fields, VariantArray()))
         throw std::runtime_error("Failed to bind values");
     int numRows = 0;
     if (!transaction.impl()->execStatement(m_impl.get(), &numRows))
@@ -367,6 +407,13 @@ int SqlStatementUpdate::exec(SqlTransaction &transaction)
     return numRows;
 }
 
+void SqlStatementUpdate::rebind(SqlStorable *storable)
+{
+    if (m_metaObject != storable->record()->metaObject())
+        throw std::invalid_argument("Cannot mix storable types in update request");
+    m_storable = storable;
+}
+
 SqlStatementDelete::SqlStatementDelete(SqlStorable *storable)
     : m_storable(storable)
 {
@@ -383,47 +430,47 @@ SqlStatementType SqlStatementDelete::type() const
 
 String SqlStatementDelete::buildQuery(SqlSyntax syntax)
 {
-    String res;
     const char *tblName = m_storable->record()->metaObject()->name();
-
-    String whereExpr;
-    if (!m_whereClause.empty())
-    {
-        detail::SqlExpressionTreeWalker walker(m_whereClause.impl(), true, syntax);
-        whereExpr = walker.evaluate();
-        m_literals.append(walker.literals());
-    }
+    StringBuilder res(256);
 
     if (m_joins.size())
     {
-        StringArray joins = m_joins.template map<String>(
-                    [=](const MetaObject * mo) { return quote(mo->name(), syntax); });
+        const char *separator = ", ";
         if (SqlSyntaxSqlite == syntax)
         {
-            res = "DELETE FROM " + quote(tblName, syntax) +
-                    " WHERE EXISTS (SELECT 1 FROM " + join(joins, ", ");
-            if (!whereExpr.isNullOrEmpty()) res += " WHERE " + whereExpr;
-            res += ")";
+            appendQuoted(res.append("DELETE FROM "), tblName, syntax).append(" WHERE EXISTS (SELECT 1 FROM ");
         }
         else if (SqlSyntaxPostgreSQL == syntax)
         {
-            res = "DELETE FROM " + quote(tblName, syntax) + " USING " + join(joins, ", ");
-            if (!whereExpr.isNullOrEmpty()) res += " WHERE " + whereExpr;
+            appendQuoted(res.append("DELETE FROM "), tblName, syntax).append(" USING ");
         }
         else // MySql
         {
-            res = "DELETE " + quote(tblName, syntax) + " FROM " + quote(tblName, syntax) +
-                    " JOIN " + join(joins, " JOIN ");
-            if (!whereExpr.isNullOrEmpty()) res += " WHERE " + whereExpr;
+            appendQuoted(res.append("DELETE "), tblName, syntax).append(" FROM ");
+            appendQuoted(res, tblName, syntax).append(" JOIN ");
+            separator = " JOIN ";
+        }
+        for (size_t i = 0; i < m_joins.size(); ++i)
+        {
+            if (i) res.append(separator);
+            appendQuoted(res, m_joins[i]->name(), syntax);
         }
     }
     else
     {
-        res = "DELETE FROM " + quote(tblName, syntax);
-        if (!whereExpr.isNullOrEmpty()) res += " WHERE " + whereExpr;
+        appendQuoted(res.append("DELETE FROM "), tblName, syntax);
     }
-    return res;
 
+    if (!m_whereClause.empty())
+    {
+        res.append(" WHERE ");
+        detail::SqlExpressionTreeWalker walker(m_whereClause.impl(), true, syntax);
+        walker.evaluate(res);
+        m_literals.append(walker.literals());
+    }
+    if (m_joins.size() && SqlSyntaxSqlite == syntax)
+        res.append(')');
+    return res.take();
 }
 
 SqlStatementDelete &SqlStatementDelete::where(const ExpressionNodeWhereClause &whereClause)
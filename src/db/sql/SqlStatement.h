@@ -21,6 +21,7 @@
 #include "ExpressionAssignment.h"
 #include "ExpressionNode.h"
 #include "SqlExpressionTreeWalker.h"
+#include "ObjectSnapshot.h"
 
 namespace metacpp
 {
@@ -202,7 +203,7 @@ public:
     int execStep(SqlTransaction& transaction, const Object *record);
 private:
     SqlStorable *m_storable;
-    size_t m_numLiterals;
+    Array<const MetaFieldBase *> m_fields;
     bool m_prepared;
 };
 
@@ -254,13 +255,34 @@ public:
 
     /** \brief Specifies a where clause */
     SqlStatementUpdate& where(const ExpressionNodeWhereClause& whereClause);
+    /** \brief Restricts the implicit set clause (used when no set() is specified) to the fields marked in mask */
+    SqlStatementUpdate& fields(const FieldMask& mask);
     /** \brief Executes statement using given transaction and returns number of rows updated */
     int exec(SqlTransaction& transaction);
+    /** \brief Prepares statement updating a record matched by it's primary key for multiple executions
+     *
+     * Neither set() nor where() clauses are allowed for such statements.
+     */
+    int execPrepare(SqlTransaction& transaction);
+    /** \brief Executes previously prepared statement on given record
+     *  and returns number of rows updated (on success should be equal to 1) */
+    int execStep(SqlTransaction& transaction, const Object *record);
+    /** \brief Binds prepared statement to another storable of the same class
+     *
+     * Statements cached in SqlTransaction outlive storables they were created with,
+     * so they are rebound before each use.
+     */
+    void rebind(SqlStorable *storable);
 private:
     Array<const MetaObject *> m_joins;
     ExpressionNodeWhereClause m_whereClause;
     Array<std::pair<db::detail::ExpressionNodeImplPtr, db::detail::ExpressionNodeImplPtr> > m_sets;
+    Array<const MetaFieldBase *> m_fields;
+    FieldMask m_fieldMask;
     SqlStorable *m_storable;
+    const MetaObject *m_metaObject;
+    bool m_byPrimaryKey;
+    bool m_prepared;
 };
 
 /** \brief Class representing Delete queries */
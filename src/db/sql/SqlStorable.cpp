@@ -25,6 +25,7 @@ namespace sql
 {
 
 SqlStorable::SqlStorable()
+    : m_trackChanges(false)
 {
 }
 
@@ -52,13 +53,38 @@ bool SqlStorable::insertOne(SqlTransaction& transaction)
     SqlStatementInsert statement(this);
     statement.execPrepare(transaction);
     int nRows = statement.execStep(transaction, record());
+    takeSnapshot();
     return nRows < 0 || nRows == 1;
 }
 
 bool SqlStorable::updateOne(SqlTransaction &transaction)
 {
-    SqlStatementUpdate statement(this);
-    int nRows = statement.where(whereId()).exec(transaction);
+    if (!m_trackChanges || !m_snapshot.valid())
+    {
+        SqlStatementUpdate statement(this);
+        int nRows = statement.where(whereId()).exec(transaction);
+        takeSnapshot();
+        return nRows < 0 || nRows == 1;
+    }
+
+    FieldMask mask = m_snapshot.diff(record());
+    // primary key is used to match the row and never appears in the set clause
+    mask.set(primaryKeyIndex(), false);
+    if (!mask.any())
+        return true;
+
+    // one prepared statement per set of modified columns
+    std::shared_ptr<SqlStatementUpdate>& cached = transaction.cachedUpdateStatement(record()->metaObject(), mask);
+    if (!cached)
+    {
+        auto statement = std::make_shared<SqlStatementUpdate>(this);
+        statement->fields(mask).execPrepare(transaction);
+        cached = statement;
+    }
+    // cached statement may have been created by another storable which is already gone
+    cached->rebind(this);
+    int nRows = cached->execStep(transaction, record());
+    takeSnapshot();
     return nRows < 0 || nRows == 1;
 }
 
@@ -69,23 +95,83 @@ bool SqlStorable::removeOne(SqlTransaction &transaction)
     return nRows < 0 || nRows == 1;
 }
 
+void SqlStorable::setTrackChanges(bool enable)
+{
+    m_trackChanges = enable;
+    if (enable)
+        m_snapshot.take(record());
+    else
+        m_snapshot.reset();
+}
+
+bool SqlStorable::trackChanges() const
+{
+    return m_trackChanges;
+}
+
+void SqlStorable::takeSnapshot()
+{
+    if (m_trackChanges)
+        m_snapshot.take(record());
+}
+
+FieldMask SqlStorable::modifiedFields()
+{
+    if (!m_trackChanges)
+        throw std::logic_error("SqlStorable::modifiedFields(): tracking of the changes is disabled");
+    return m_snapshot.diff(record());
+}
+
 void SqlStorable::createSchema(SqlTransaction &transaction, const MetaObject *metaObject,
                                const Array<SqlConstraintBasePtr> &constraints)
 {
     SqlSyntax syntax = transaction.connector()->sqlSyntax();
+    StringArray statements = schemaStatements(syntax, metaObject, constraints);
+    for (size_t i = 0; i < statements.size(); ++i)
+    {
+        if (!i && syntax == SqlSyntaxMySql)
+        {
+            try
+            {
+                SqlStatementCustom(statements[i]).exec(transaction);
+            }
+            catch (const std::exception&) {
+                // skip creation of indices if schema is already exist
+                return;
+            }
+        }
+        else
+            SqlStatementCustom(statements[i]).exec(transaction);
+    }
+}
+
+StringArray SqlStorable::schemaStatements(SqlSyntax syntax, const MetaObject *metaObject,
+                                          const Array<SqlConstraintBasePtr> &constraints)
+{
     switch (syntax)
     {
     case SqlSyntaxSqlite:
-        return createSchemaSqlite(transaction, metaObject, constraints);
+        return schemaSqlite(metaObject, constraints);
     case SqlSyntaxPostgreSQL:
-        return createSchemaPostgreSQL(transaction, metaObject, constraints);
+        return schemaPostgreSQL(metaObject, constraints);
     case SqlSyntaxMySql:
-        return createSchemaMySql(transaction, metaObject, constraints);
+        return schemaMySql(metaObject, constraints);
     default:
         throw std::runtime_error("SqlStorable::createSchema(): syntax not implemented");
     }
 }
 
+size_t SqlStorable::primaryKeyIndex()
+{
+    auto pkey = primaryKey();
+    const MetaObject *metaObject = record()->metaObject();
+    for (size_t i = 0; pkey && i < metaObject->totalFields(); ++i)
+        if (metaObject->field(i) == pkey)
+            return i;
+    throw std::runtime_error(std::string("Table ") + metaObject->name() +
+                             " has no primary key");
+}
+
 ExpressionNodeWhereClause SqlStorable::whereId()
 {
     auto pkey = primaryKey();
@@ -97,9 +183,20 @@ ExpressionNodeWhereClause SqlStorable::whereId()
         std::make_shared<db::detail::ExpressionNodeImplLiteral>(pkey->getValue(record()))));
 }
 
-void SqlStorable::createSchemaSqlite(SqlTransaction &transaction, const MetaObject *metaObject, const Array<SqlConstraintBasePtr> &constraints)
+/** Appends the default value of the field to the column definition */
+template<typename TField>
+static void appendDefault(StringBuilder& column, const MetaFieldBase *field, SqlSyntax syntax)
 {
-    String tblName = metaObject->name();
+    if (field->mandatoriness() != eDefaultable)
+        return;
+    column.append(" DEFAULT ");
+    detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
+        (reinterpret_cast<const TField *>(field)->defaultValue()), false, syntax).evaluate(column);
+}
+
+StringArray SqlStorable::schemaSqlite(const MetaObject *metaObject, const Array<SqlConstraintBasePtr> &constraints)
+{
+    const char *tblName = metaObject->name();
     // validate constraints
     for (SqlConstraintBasePtr constraint : constraints)
     {
@@ -107,8 +204,8 @@ void SqlStorable::createSchemaSqlite(SqlTransaction &transaction, const MetaObje
             throw std::runtime_error("Constraint does not belong to this table");
     }
 
-    String queryStr = "CREATE TABLE IF NOT EXISTS \"" + tblName + "\"(";
-    StringArray columns;
+    StringBuilder queryStr(256);
+    queryStr.append("CREATE TABLE IF NOT EXISTS \"").append(tblName).append("\"(");
     auto findConstraint = [constraints](SqlConstraintType type, const MetaFieldBase *field)
     {
         for (SqlConstraintBasePtr constraint : constraints)
@@ -119,150 +216,113 @@ void SqlStorable::createSchemaSqlite(SqlTransaction &transaction, const MetaObje
         return SqlConstraintBasePtr();
     };
 
+    // constraints of the column, each one is prefixed with a space
+    StringBuilder columnConstraints(64);
     for (size_t i = 0; i < metaObject->totalFields(); ++i)
     {
         const MetaFieldBase *field = metaObject->field(i);
-        String name = field->name();
-        String typeName;
-        StringArray constraints;
+        const char *typeName;
+        columnConstraints.clear();
         if (!field->nullable())
-            constraints.push_back("NOT NULL");
+            columnConstraints.append(" NOT NULL");
         switch (field->type())
         {
         case eFieldBool:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldBool *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldBool>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldInt:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldInt *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldInt>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldEnum:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldEnum *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldEnum>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldUint:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldUint *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldUint>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldInt64:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldInt64 *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldInt64>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldUint64:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldUint64 *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldUint64>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldFloat:
             typeName = "REAL";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldFloat *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldFloat>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldDouble:
             typeName = "REAL";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldDouble *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldDouble>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldString:
             typeName = "TEXT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldString *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldString>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         case eFieldDateTime:
             typeName = "DATETIME";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldDateTime *>(field)->defaultValue()), false, SqlSyntaxSqlite).evaluate());
-            }
+            appendDefault<MetaFieldDateTime>(columnConstraints, field, SqlSyntaxSqlite);
             break;
         default:
             throw std::runtime_error(std::string("Cannot handle field ") + field->name() + " as an sql column");
         }
 
+        if (i) queryStr.append(", ");
+        queryStr.append('"').append(field->name()).append("\" ").append(typeName);
+
         auto primaryKey = findConstraint(SqlConstraintTypePrimaryKey, field);
         if (primaryKey)
         {
-            constraints.push_back("PRIMARY KEY AUTOINCREMENT");
+            columnConstraints.append(" PRIMARY KEY AUTOINCREMENT");
         }
 
         auto foreignKey = std::dynamic_pointer_cast<SqlConstraintForeignKey>(
                     findConstraint(SqlConstraintTypeForeignKey, field));
         if (foreignKey)
         {
-            constraints.push_back(String("REFERENCES \"") + foreignKey->referenceMetaObject()->name() +
-                                  "\"(\"" + foreignKey->referenceMetaField()->name() + "\")");
+            columnConstraints.append(" REFERENCES \"").append(foreignKey->referenceMetaObject()->name())
+                    .append("\"(\"").append(foreignKey->referenceMetaField()->name()).append("\")");
         }
 
         auto check = findConstraint(SqlConstraintTypeCheck, field);
         if (check)
         {
-            constraints.push_back("CHECK (" +
-                                  std::dynamic_pointer_cast<SqlConstraintCheck>(check)->checkExpression()
-                                  + ")");
+            columnConstraints.append(" CHECK (")
+                    .append(std::dynamic_pointer_cast<SqlConstraintCheck>(check)->checkExpression())
+                    .append(')');
         }
 
-        String column = "\"" + name + "\" " + typeName + (constraints.size() ? " " : "") + join(constraints, " ");
-        columns.push_back(column);
+        queryStr.append(columnConstraints.data(), columnConstraints.size());
     }
-    queryStr += join(columns, ", ") + ")";
+    queryStr.append(')');
 
     // main statement CREATE TABLE
-    SqlStatementCustom statement(queryStr);
-    statement.exec(transaction);
+    StringArray statements;
+    statements.push_back(queryStr.take());
 
     for (auto constraint : constraints)
     {
         if (constraint->type() == SqlConstraintTypeIndex)
         {
             std::shared_ptr<SqlConstraintIndex> constrIdx = std::dynamic_pointer_cast<SqlConstraintIndex>(constraint);
-            String queryStr = constrIdx->unique() ?
-                        "CREATE UNIQUE INDEX IF NOT EXISTS" : "CREATE INDEX IF NOT EXISTS";
-            queryStr += " \"idx_" + tblName + "_" + constrIdx->metaField()->name() +
-                    "\" ON \"" + tblName + "\"(\"" + constrIdx->metaField()->name() + "\")";
-            SqlStatementCustom statement(queryStr);
-            statement.exec(transaction);
+            const char *columnName = constrIdx->metaField()->name();
+            StringBuilder queryStr(128);
+            queryStr.append(constrIdx->unique() ? "CREATE UNIQUE INDEX IF NOT EXISTS" : "CREATE INDEX IF NOT EXISTS")
+                    .append(" \"idx_").append(tblName).append('_').append(columnName)
+                    .append("\" ON \"").append(tblName).append("\"(\"").append(columnName).append("\")");
+            statements.push_back(queryStr.take());
         }
     }
+    return statements;
 }
 
-void SqlStorable::createSchemaPostgreSQL(SqlTransaction &transaction, const MetaObject *metaObject,
-                                         const Array<SqlConstraintBasePtr> &constraints)
+StringArray SqlStorable::schemaPostgreSQL(const MetaObject *metaObject, const Array<SqlConstraintBasePtr> &constraints)
 {
-    String tblName = metaObject->name();
+    const char *tblName = metaObject->name();
     // validate constraints
     for (SqlConstraintBasePtr constraint : constraints)
     {
@@ -270,8 +330,8 @@ void SqlStorable::createSchemaPostgreSQL(SqlTransaction &transaction, const Meta
             throw std::runtime_error("Constraint does not belong to this table");
     }
 
-    String queryStr = "CREATE TABLE IF NOT EXISTS \"" + tblName + "\"(";
-    StringArray columns;
+    StringBuilder queryStr(256);
+    queryStr.append("CREATE TABLE IF NOT EXISTS \"").append(tblName).append("\"(");
     auto findConstraint = [constraints](SqlConstraintType type, const MetaFieldBase *field)
     {
         for (SqlConstraintBasePtr constraint : constraints)
@@ -282,95 +342,56 @@ void SqlStorable::createSchemaPostgreSQL(SqlTransaction &transaction, const Meta
         return SqlConstraintBasePtr();
     };
 
+    // constraints of the column, each one is prefixed with a space
+    StringBuilder columnConstraints(64);
     for (size_t i = 0; i < metaObject->totalFields(); ++i)
     {
         const MetaFieldBase *field = metaObject->field(i);
-        String name = field->name();
-        String typeName;
-        StringArray constraints;
+        const char *typeName;
+        columnConstraints.clear();
         if (!field->nullable())
-            constraints.push_back("NOT NULL");
+            columnConstraints.append(" NOT NULL");
         switch (field->type())
         {
         case eFieldBool:
             typeName = "SMALLINT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldBool *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldBool>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldInt:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldInt *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldInt>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldEnum:
             typeName = "INTEGER";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldEnum *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldEnum>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldUint:
             typeName = "BIGINT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldUint *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldUint>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldInt64:
             typeName = "BIGINT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldInt64 *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldInt64>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldUint64:
             typeName = "BIGINT";    // NUMERIC?
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldUint64 *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldUint64>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldFloat:
             typeName = "REAL";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldFloat *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldFloat>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldDouble:
             typeName = "DOUBLE PRECISION";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldDouble *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldDouble>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldString:
             typeName = "TEXT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldString *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldString>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         case eFieldDateTime:
             typeName = "TIMESTAMP";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                    (reinterpret_cast<const MetaFieldDateTime *>(field)->defaultValue()), false, SqlSyntaxPostgreSQL).evaluate());
-            }
+            appendDefault<MetaFieldDateTime>(columnConstraints, field, SqlSyntaxPostgreSQL);
             break;
         default:
             throw std::runtime_error(std::string("Cannot handle field ") + field->name() + " as an sql column");
@@ -379,65 +400,72 @@ void SqlStorable::createSchemaPostgreSQL(SqlTransaction &transaction, const Meta
         auto primaryKey = findConstraint(SqlConstraintTypePrimaryKey, field);
         if (primaryKey)
         {
-            if (typeName == "INTEGER")
+            if (!strcmp(typeName, "INTEGER"))
                 typeName = "SERIAL";
-            else if (typeName == "BIGINT")
+            else if (!strcmp(typeName, "BIGINT"))
                 typeName = "BIGSERIAL";
             else
                 throw std::runtime_error("Primary keys are only allowed on integral types");
         }
 
+        if (i) queryStr.append(", ");
+        queryStr.append('"').append(field->name()).append("\" ").append(typeName);
+
         auto foreignKey = std::dynamic_pointer_cast<SqlConstraintForeignKey>(
                     findConstraint(SqlConstraintTypeForeignKey, field));
         if (foreignKey)
         {
-            constraints.push_back(String("REFERENCES \"") + foreignKey->referenceMetaObject()->name() +
-                                  "\"(\"" + foreignKey->referenceMetaField()->name() + "\")");
+            columnConstraints.append(" REFERENCES \"").append(foreignKey->referenceMetaObject()->name())
+                    .append("\"(\"").append(foreignKey->referenceMetaField()->name()).append("\")");
         }
 
         auto check = findConstraint(SqlConstraintTypeCheck, field);
         if (check)
         {
-            constraints.push_back("CHECK (" +
-                                  std::dynamic_pointer_cast<SqlConstraintCheck>(check)->checkExpression()
-                                  + ")");
+            columnConstraints.append(" CHECK (")
+                    .append(std::dynamic_pointer_cast<SqlConstraintCheck>(check)->checkExpression())
+                    .append(')');
         }
 
-        String column = "\"" + name + "\" " + typeName + (constraints.size() ? " " : "") + join(constraints, " ");
-        columns.push_back(column);
+        queryStr.append(columnConstraints.data(), columnConstraints.size());
     }
-    queryStr += join(columns, ", ") + ")";
+    queryStr.append(')');
 
     // main statement CREATE TABLE
-    SqlStatementCustom statement(queryStr);
-    statement.exec(transaction);
+    StringArray statements;
+    statements.push_back(queryStr.take());
 
     for (auto constraint : constraints)
     {
         if (constraint->type() == SqlConstraintTypeIndex)
         {
             std::shared_ptr<SqlConstraintIndex> constrIdx = std::dynamic_pointer_cast<SqlConstraintIndex>(constraint);
-            String columnName = constrIdx->metaField()->name();
-            String indexName = "idx_" + tblName + "_" + columnName;
-            String queryStr =
-                    "DO $$ DECLARE index_exists boolean;"
-                    "BEGIN "
-                    "index_exists := FALSE;"
-                    "SELECT TRUE INTO index_exists FROM pg_indexes WHERE indexname = lower(\'" + indexName + "\') LIMIT 1;"
-                    "IF NOT FOUND THEN" +
-                    (constrIdx->unique() ? " CREATE UNIQUE INDEX " : " CREATE INDEX ") + indexName +
-                    " ON \"" + tblName + "\"(\"" + columnName + "\");"
-                    "END IF;"
-                    "END$$ LANGUAGE plpgsql";
-            SqlStatementCustom statement(queryStr);
-            statement.exec(transaction);
+            const char *columnName = constrIdx->metaField()->name();
+            StringBuilder indexName(64);
+            indexName.append("idx_").append(tblName).append('_').append(columnName);
+            StringBuilder queryStr(384);
+            queryStr.append("DO $$ DECLARE index_exists boolean;"
+                            "BEGIN "
+                            "index_exists := FALSE;"
+                            "SELECT TRUE INTO index_exists FROM pg_indexes WHERE indexname = lower(\'")
+                    .append(indexName.data(), indexName.size())
+                    .append("\') LIMIT 1;"
+                            "IF NOT FOUND THEN")
+                    .append(constrIdx->unique() ? " CREATE UNIQUE INDEX " : " CREATE INDEX ")
+                    .append(indexName.data(), indexName.size())
+                    .append(" ON \"").append(tblName).append("\"(\"").append(columnName)
+                    .append("\");"
+                            "END IF;"
+                            "END$$ LANGUAGE plpgsql");
+            statements.push_back(queryStr.take());
         }
     }
+    return statements;
 }
 
-void SqlStorable::createSchemaMySql(SqlTransaction &transaction, const MetaObject *metaObject, const Array<SqlConstraintBasePtr> &constraints)
+StringArray SqlStorable::schemaMySql(const MetaObject *metaObject, const Array<SqlConstraintBasePtr> &constraints)
 {
-    String tblName = metaObject->name();
+    const char *tblName = metaObject->name();
     // validate constraints
     for (SqlConstraintBasePtr constraint : constraints)
     {
@@ -445,8 +473,8 @@ void SqlStorable::createSchemaMySql(SqlTransaction &transaction, const MetaObjec
             throw std::runtime_error("Constraint does not belong to this table");
     }
 
-    String queryStr = "CREATE TABLE `" + tblName + "`(";
-    StringArray columns;
+    StringBuilder queryStr(256);
+    queryStr.append("CREATE TABLE `").append(tblName).append("`(");
     auto findConstraint = [constraints](SqlConstraintType type, const MetaFieldBase *field)
     {
         for (SqlConstraintBasePtr constraint : constraints)
@@ -457,100 +485,68 @@ void SqlStorable::createSchemaMySql(SqlTransaction &transaction, const MetaObjec
         return SqlConstraintBasePtr();
     };
 
+    // constraints of the column, each one is prefixed with a space
+    StringBuilder columnConstraints(64);
     for (size_t i = 0; i < metaObject->totalFields(); ++i)
     {
         const MetaFieldBase *field = metaObject->field(i);
-        String name = field->name();
-        String typeName;
-        StringArray constraints;
+        const char *typeName;
+        columnConstraints.clear();
         if (!field->nullable())
-            constraints.push_back("NOT NULL");
+            columnConstraints.append(" NOT NULL");
         switch (field->type())
         {
         case eFieldBool:
             typeName = "TINYINT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldBool *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldBool>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldInt:
             typeName = "INT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldInt *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldInt>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldEnum:
             typeName = "INT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldEnum *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldEnum>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldUint:
             typeName = "INT UNSIGNED";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldUint *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldUint>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldInt64:
             typeName = "BIGINT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldInt64 *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldInt64>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldUint64:
             typeName = "BIGINT UNSIGNED";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldUint64 *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldUint64>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldFloat:
             typeName = "FLOAT";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldFloat *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldFloat>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldDouble:
             typeName = "DOUBLE";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldDouble *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldDouble>(columnConstraints, field, SqlSyntaxMySql);
             break;
         case eFieldString:
             typeName = "TEXT";
             break;
         case eFieldDateTime:
             typeName = "DATETIME";
-            if (field->mandatoriness() == eDefaultable)
-            {
-                constraints.push_back("DEFAULT " + detail::SqlExpressionTreeWalker(std::make_shared<db::detail::ExpressionNodeImplLiteral>
-                                                                                   (reinterpret_cast<const MetaFieldDateTime *>(field)->defaultValue()), false, SqlSyntaxMySql).evaluate());
-            }
+            appendDefault<MetaFieldDateTime>(columnConstraints, field, SqlSyntaxMySql);
             break;
         default:
             throw std::runtime_error(std::string("Cannot handle field ") + field->name() + " as an sql column");
         }
 
+        if (i) queryStr.append(", ");
+        queryStr.append('`').append(field->name()).append("` ").append(typeName);
+
         auto primaryKey = findConstraint(SqlConstraintTypePrimaryKey, field);
         if (primaryKey)
         {
             if (field->isIntegral())
-                typeName += " PRIMARY KEY AUTO_INCREMENT";
+                queryStr.append(" PRIMARY KEY AUTO_INCREMENT");
             else
                 throw std::runtime_error("Primary keys are only allowed on integral types");
         }
@@ -559,51 +555,40 @@ void SqlStorable::createSchemaMySql(SqlTransaction &transaction, const MetaObjec
                     findConstraint(SqlConstraintTypeForeignKey, field));
         if (foreignKey)
         {
-            constraints.push_back(String("REFERENCES `") + foreignKey->referenceMetaObject()->name() +
-                                  "`(`" + foreignKey->referenceMetaField()->name() + "`)");
+            columnConstraints.append(" REFERENCES `").append(foreignKey->referenceMetaObject()->name())
+                    .append("`(`").append(foreignKey->referenceMetaField()->name()).append("`)");
         }
 
         auto check = findConstraint(SqlConstraintTypeCheck, field);
         if (check)
         {
-            constraints.push_back("CHECK (" +
-                                  std::dynamic_pointer_cast<SqlConstraintCheck>(check)->checkExpression()
-                                  + ")");
+            columnConstraints.append(" CHECK (")
+                    .append(std::dynamic_pointer_cast<SqlConstraintCheck>(check)->checkExpression())
+                    .append(')');
         }
 
-        String column = "`" + name + "` " + typeName + (constraints.size() ? " " : "") + join(constraints, " ");
-        columns.push_back(column);
+        queryStr.append(columnConstraints.data(), columnConstraints.size());
     }
-    queryStr += join(columns, ", ") + ")";
+    queryStr.append(')');
 
-    try
-    {
-        // main statement CREATE TABLE
-        SqlStatementCustom statement(queryStr);
-        statement.exec(transaction);
-    }
-    catch (const std::exception&) {
-        // skip creation of indices if schema is already exist
-        return;
-    }
+    // main statement CREATE TABLE
+    StringArray statements;
+    statements.push_back(queryStr.take());
 
     for (auto constraint : constraints)
     {
         if (constraint->type() == SqlConstraintTypeIndex)
         {
-            if (std::dynamic_pointer_cast<SqlConstraintIndex>(constraint)->unique())
-                SqlStatementCustom(String("ALTER TABLE `") + metaObject->name() +
-                                   "` ADD UNIQUE (`" + constraint->metaField()->name() + "`)")
-                        .exec(transaction);
-            else
-                SqlStatementCustom(String("ALTER TABLE `") + metaObject->name() +
-                                   "` ADD INDEX (`" + constraint->metaField()->name() + "`)")
-                        .exec(transaction);
+            StringBuilder queryStr(128);
+            queryStr.append("ALTER TABLE `").append(tblName)
+                    .append(std::dynamic_pointer_cast<SqlConstraintIndex>(constraint)->unique() ? "` ADD UNIQUE (`" : "` ADD INDEX (`")
+                    .append(constraint->metaField()->name()).append("`)");
+            statements.push_back(queryStr.take());
         }
     }
+    return statements;
 }
 
-
 } // namespace sql
 } // namespace db
 } // namespace metacpp
@@ -19,6 +19,8 @@
 #include <cstdint>
 #include <memory>
 #include "Object.h"
+#include "ObjectSnapshot.h"
+#include "ObjectArena.h"
 #include "SqlStatement.h"
 #include "SqlColumnConstraint.h"
 
@@ -55,17 +57,35 @@ namespace sql
         bool updateOne(SqlTransaction& transaction);
         /** Delete the record by primary key using specified transaction */
         bool removeOne(SqlTransaction& transaction);
+
+        /** \brief Enables or disables tracking of the changes made to the record (disabled by default)
+         *
+         * When enabled, updateOne writes only the columns modified since the record was last
+         * fetched, inserted or updated, and does not execute any statement if nothing has changed.
+         */
+        void setTrackChanges(bool enable);
+        /** \brief Checks whether tracking of the changes is enabled */
+        bool trackChanges() const;
+        /** \brief Marks the current state of the record as persisted if tracking of the changes is enabled */
+        void takeSnapshot();
+        /** \brief Returns mask of the fields modified since the last snapshot
+         * \throws std::logic_error if tracking of the changes is disabled
+         */
+        FieldMask modifiedFields();
     protected:
         static void createSchema(SqlTransaction& transaction, const MetaObject *metaObject,
                                  const Array<SqlConstraintBasePtr>& constraints);
+        static StringArray schemaStatements(SqlSyntax syntax, const MetaObject *metaObject,
+                                            const Array<SqlConstraintBasePtr>& constraints);
     private:
         ExpressionNodeWhereClause whereId();
-        static void createSchemaSqlite(SqlTransaction& transaction, const MetaObject *metaObject,
-                                       const Array<SqlConstraintBasePtr>& constraints);
-        static void createSchemaPostgreSQL(SqlTransaction &transaction, const MetaObject *metaObject,
-                                    const Array<SqlConstraintBasePtr> &constraints);
-        static void createSchemaMySql(SqlTransaction& transaction, const MetaObject *metaObject,
-                                      const Array<SqlConstraintBasePtr>& constraints);
+        size_t primaryKeyIndex();
+        static StringArray schemaSqlite(const MetaObject *metaObject, const Array<SqlConstraintBasePtr>& constraints);
+        static StringArray schemaPostgreSQL(const MetaObject *metaObject, const Array<SqlConstraintBasePtr>& constraints);
+        static StringArray schemaMySql(const MetaObject *metaObject, const Array<SqlConstraintBasePtr>& constraints);
+    private:
+        ObjectSnapshot m_snapshot;
+        bool m_trackChanges;
     };
 
     /** \brief Common wrapper template class for Object.
@@ -108,6 +128,12 @@ namespace sql
             SqlStorable::createSchema(transaction, TObj::staticMetaObject(), ms_constraints);
         }
 
+        /** \brief Builds sql statements creating the table and its indices, which are executed by createSchema */
+        static StringArray schemaStatements(SqlSyntax syntax)
+        {
+            return SqlStorable::schemaStatements(syntax, TObj::staticMetaObject(), ms_constraints);
+        }
+
         static Array<TObj> fetchAll(SqlTransaction& transaction) {
             Array<TObj> result;
             Storable<TObj> storable;
@@ -138,6 +164,42 @@ namespace sql
             return result;
         }
 
+        /** \brief Fetches all records into objects owned by the given arena
+         *
+         * Records are allocated from the slab pool of TObj instead of being copied into
+         * a contiguous array, and are destroyed together with the arena.
+         */
+        static Array<TObj *> fetchAll(SqlTransaction& transaction, ObjectArena& arena) {
+            Array<TObj *> result;
+            Storable<TObj> storable;
+            auto set = storable.select().exec(transaction);
+            size_t size = set.size();
+            if (size != std::numeric_limits<size_t>::max())
+                result.reserve(size);
+            for (auto row : set) {
+                (void)row;
+                result.push_back(arena.create<TObj>(static_cast<const TObj&>(storable)));
+            }
+            return result;
+        }
+
+        /** \brief Fetches records matching whereClause into objects owned by the given arena */
+        static Array<TObj *> fetchAll(SqlTransaction& transaction, ObjectArena& arena,
+                             const ExpressionNodeWhereClause& whereClause)
+        {
+            Array<TObj *> result;
+            Storable<TObj> storable;
+            auto set = storable.select().where(whereClause).exec(transaction);
+            size_t size = set.size();
+            if (size != std::numeric_limits<size_t>::max())
+                result.reserve(size);
+            for (auto row : set) {
+                (void)row;
+                result.push_back(arena.create<TObj>(static_cast<const TObj&>(storable)));
+            }
+            return result;
+        }
+
         static void insertAll(SqlTransaction& transaction,
                               const Array<TObj> objects)
         {
@@ -16,6 +16,7 @@
 #include "SqlTransaction.h"
 #include "SqlConnectorBase.h"
 #include "SqlTransactionImpl.h"
+#include "SqlStatement.h"
 
 namespace metacpp
 {
@@ -59,6 +60,8 @@ SqlTransaction::~SqlTransaction()
             break;
         }
     }
+    // cached statements must be closed before the transaction
+    m_updateStatements.clear();
     if (m_impl)
         m_connector->closeTransaction(m_impl);
 }
@@ -73,6 +76,11 @@ connectors::SqlTransactionImpl *SqlTransaction::impl() const
     return m_impl;
 }
 
+std::shared_ptr<SqlStatementUpdate>& SqlTransaction::cachedUpdateStatement(const MetaObject *metaObject, const FieldMask &fields)
+{
+    return m_updateStatements[UpdateStatementKey { metaObject, fields }];
+}
+
 bool SqlTransaction::started() const
 {
     return m_transactionStarted;
@@ -17,6 +17,9 @@
 #define SQLTRANSACTION_H
 #include "config.h"
 #include "SqlConnectorBase.h"
+#include "ObjectSnapshot.h"
+#include <unordered_map>
+#include <memory>
 
 namespace metacpp
 {
@@ -31,6 +34,8 @@ namespace connectors
     class SqlTransactionImpl;
 }
 
+class SqlStatementUpdate;
+
 /** \brief Defines consistency policy of SqlTransaction */
 enum SqlTransactionAutoCloseMode
 {
@@ -88,11 +93,38 @@ public:
     /** \brief Drp[s all statements in current transaction block and finishes it.
      * The database is rollbacked to it's previous consistent state */
     void rollback();
+    /** \brief Gets a slot for the prepared update statement of given class and set of columns
+     *
+     * Statements are kept until the transaction is destroyed, so that a statement is prepared
+     * only once for each distinct set of modified columns.
+     * \see SqlStorable::updateOne
+     */
+    std::shared_ptr<SqlStatementUpdate>& cachedUpdateStatement(const MetaObject *metaObject, const FieldMask& fields);
 private:
+    struct UpdateStatementKey
+    {
+        const MetaObject *metaObject;
+        FieldMask fields;
+
+        bool operator==(const UpdateStatementKey& rhs) const
+        {
+            return metaObject == rhs.metaObject && fields == rhs.fields;
+        }
+    };
+
+    struct UpdateStatementKeyHash
+    {
+        size_t operator()(const UpdateStatementKey& key) const
+        {
+            return std::hash<const MetaObject *>()(key.metaObject) ^ key.fields.hash();
+        }
+    };
+
     connectors::SqlConnectorBase *m_connector;
     connectors::SqlTransactionImpl *m_impl;
     SqlTransactionAutoCloseMode m_autoCloseMode;
     bool m_transactionStarted;
+    std::unordered_map<UpdateStatementKey, std::shared_ptr<SqlStatementUpdate>, UpdateStatementKeyHash> m_updateStatements;
 };
 
 
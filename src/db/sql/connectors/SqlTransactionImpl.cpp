@@ -34,6 +34,17 @@ SqlTransactionImpl::~SqlTransactionImpl()
 
 }
 
+bool SqlTransactionImpl::bindRecord(SqlStatementImpl *statement, const Object *record,
+                                    const Array<const MetaFieldBase *> &fields, const VariantArray &values)
+{
+    VariantArray allValues;
+    allValues.reserve(fields.size() + values.size());
+    for (const MetaFieldBase *field : fields)
+        allValues.push_back(field->getValue(record));
+    allValues.append(values);
+    return bindValues(statement, allValues);
+}
+
 } // namespace connectors
 } // namespace sql
 } // namespace db
@@ -59,6 +59,14 @@ public:
     /** \brief Bind in sql statement literal values */
     virtual bool bindValues(SqlStatementImpl *statement, const VariantArray& values) = 0;
 
+    /** \brief Bind in sql statement values of the record fields followed by literal values
+     *
+     * Default implementation converts field values to metacpp::Variant and calls bindValues.
+     * Connectors should override it to bind field values directly (see MetaFieldBase::visitValue).
+     */
+    virtual bool bindRecord(SqlStatementImpl *statement, const Object *record,
+                            const Array<const MetaFieldBase *>& fields, const VariantArray& values);
+
     /** \brief Execute statement
      * \param numRowsAffected pointer to retrieve number of rows affected with update or delete statement
     */
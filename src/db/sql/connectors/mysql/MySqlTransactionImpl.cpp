@@ -267,10 +267,11 @@ bool MySqlTransactionImpl::fetchNext(SqlStatementImpl *statement, SqlStorable *s
     for (unsigned int i = 0; i < nFields; ++i)
     {
         MYSQL_FIELD *mysqlField = mysql_fetch_field_direct(res, i);
-        auto field = storable->record()->metaObject()->fieldByName(String(mysqlField->name, mysqlField->name_length), false);
+        auto field = storable->record()->metaObject()->fieldByName(StringView(mysqlField->name, mysqlField->name_length), false);
         if (!field)
         {
-            std::cerr << "Cannot bind sql result to an object field " << field->name() << std::endl;
+            std::cerr << "Cannot bind sql result to an object field "
+                      << std::string(mysqlField->name, mysqlField->name_length) << std::endl;
             continue;
         }
 
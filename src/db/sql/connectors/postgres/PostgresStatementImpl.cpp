@@ -23,7 +23,8 @@ namespace connectors {
 namespace postgres {
 
 PostgresStatementImpl::PostgresStatementImpl(SqlStatementType type, const String &queryText)
-    : SqlStatementImpl(type, queryText), m_result(nullptr), m_execResult(nullptr), m_currentRow(-1)
+    : SqlStatementImpl(type, queryText), m_result(nullptr), m_execResult(nullptr), m_currentRow(-1),
+      m_columnsMetaObject(nullptr)
 {
 
 }
@@ -45,6 +46,7 @@ void PostgresStatementImpl::setResult(PGresult *result, const String &idString)
 void PostgresStatementImpl::setExecResult(PGresult *result)
 {
     m_execResult = result;
+    m_columnsMetaObject = nullptr;
 }
 
 PGresult *PostgresStatementImpl::getResult() const
@@ -72,14 +74,27 @@ void PostgresStatementImpl::setCurrentRow(int row)
     m_currentRow = row;
 }
 
-void PostgresStatementImpl::bindValues(const VariantArray &values)
+void PostgresStatementImpl::bindParams(StringArray &&params)
 {
-    m_boundValues = values;
+    m_boundParams = std::move(params);
 }
 
-const VariantArray &PostgresStatementImpl::boundValues() const
+const StringArray &PostgresStatementImpl::boundParams() const
 {
-    return m_boundValues;
+    return m_boundParams;
+}
+
+const Array<const MetaFieldBase *> &PostgresStatementImpl::columnFields(const MetaObject *metaObject)
+{
+    if (m_columnsMetaObject != metaObject)
+    {
+        const int nFields = PQnfields(m_execResult);
+        m_columnFields.resize(nFields);
+        for (int i = 0; i < nFields; ++i)
+            m_columnFields[i] = metaObject->fieldByName(PQfname(m_execResult, i), false);
+        m_columnsMetaObject = metaObject;
+    }
+    return m_columnFields;
 }
 
 } // namespace postgres
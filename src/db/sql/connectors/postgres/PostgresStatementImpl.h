@@ -38,13 +38,19 @@ public:
     const String& getIdString() const;
     int currentRow() const;
     void setCurrentRow(int row);
-    void bindValues(const VariantArray& values);
-    const VariantArray& boundValues() const;
+    /** Sets text values of the parameters, null strings are passed as sql NULL */
+    void bindParams(StringArray&& params);
+    const StringArray& boundParams() const;
+    /** Gets fields of the given class matching the columns of the result, null for unknown columns.
+     * Names are resolved once per result instead of once per row. */
+    const Array<const MetaFieldBase *>& columnFields(const MetaObject *metaObject);
 private:
-    VariantArray m_boundValues;
+    StringArray m_boundParams;
     PGresult *m_result, *m_execResult;
     String m_idString;
     int m_currentRow;
+    const MetaObject *m_columnsMetaObject;
+    Array<const MetaFieldBase *> m_columnFields;
 };
 
 } // namespace postgres
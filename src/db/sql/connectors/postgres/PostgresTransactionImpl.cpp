@@ -83,12 +83,89 @@ bool PostgresTransactionImpl::prepare(SqlStatementImpl *statement, size_t numPar
     return true;
 }
 
+namespace
+{
+
+/** Gets a text representation of the date and time parameter */
+String dateTimeParam(const DateTime& value)
+{
+    // quoted the same way PQescapeLiteral does for the ISO-8601 text
+    char buf[DateTimeBufferSize];
+    StringBuilder param(DateTimeBufferSize + 2);
+    return param.append('\'').append(buf, formatDateTime(buf, value)).append('\'').take();
+}
+
+/** Gets a text representation of the parameter, null string for NULL */
+String variantParam(const Variant& value)
+{
+    if (!value.valid())
+        return String();
+    if (value.isDateTime())
+        return dateTimeParam(variant_cast<DateTime>(value));
+    return variant_cast<String>(value);
+}
+
+/** Formats field values directly into text parameters avoiding Variant conversion */
+class FieldFormatter : public FieldValueVisitor
+{
+public:
+    explicit FieldFormatter(StringArray& params)
+        : m_params(params)
+    {
+    }
+
+    void visitNull() override { m_params.push_back(String()); }
+    void visit(bool value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(int32_t value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(uint32_t value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(int64_t value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(uint64_t value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(float value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(double value) override { m_params.push_back(String::fromValue(value)); }
+    void visit(const String& value) override { m_params.push_back(value); }
+    void visit(const DateTime& value) override
+    {
+        if (!value.valid())
+            return visitNull();
+        m_params.push_back(dateTimeParam(value));
+    }
+    void visit(const Variant& value) override { m_params.push_back(variantParam(value)); }
+private:
+    StringArray& m_params;
+};
+
+} // anonymous namespace
+
 bool PostgresTransactionImpl::bindValues(SqlStatementImpl *statement, const VariantArray &values)
 {
     if (!statement->prepared())
-        throw std::runtime_error("PostgresTransactionImpl::execStatement(): should be prepared first");
-    PostgresStatementImpl *postgresStatement = reinterpret_cast<PostgresStatementImpl *>(statement);
-    postgresStatement->bindValues(values);
+        throw std::runtime_error("PostgresTransactionImpl::bindValues(): should be prepared first");
+    StringArray params;
+    params.reserve(values.size());
+    for (const Variant& value : values)
+        params.push_back(variantParam(value));
+    reinterpret_cast<PostgresStatementImpl *>(statement)->bindParams(std::move(params));
+    return true;
+}
+
+bool PostgresTransactionImpl::bindRecord(SqlStatementImpl *statement, const Object *record,
+                                         const Array<const MetaFieldBase *> &fields, const VariantArray &values)
+{
+    if (!statement->prepared())
+        throw std::runtime_error("PostgresTransactionImpl::bindRecord(): should be prepared first");
+    StringArray params;
+    params.reserve(fields.size() + values.size());
+    FieldFormatter formatter(params);
+    for (const MetaFieldBase *field : fields)
+    {
+        if (eFieldVariant == field->type())
+            params.push_back(variantParam(field->getValue(record)));
+        else
+            field->visitValue(record, formatter);
+    }
+    for (const Variant& value : values)
+        params.push_back(variantParam(value));
+    reinterpret_cast<PostgresStatementImpl *>(statement)->bindParams(std::move(params));
     return true;
 }
 
@@ -97,36 +174,15 @@ bool PostgresTransactionImpl::execStatement(SqlStatementImpl *statement, int *nu
     if (!statement->prepared())
         throw std::runtime_error("PostgresTransactionImpl::execStatement(): should be prepared first");
     PostgresStatementImpl *postgresStatement = reinterpret_cast<PostgresStatementImpl *>(statement);
-    VariantArray values = postgresStatement->boundValues();
+    const StringArray& params = postgresStatement->boundParams();
     PGresult *result;
-    if (values.size())
+    if (params.size())
     {
-        const char **paramValues = (const char **)alloca(sizeof(char *) * values.size());
-        StringArray transient;
-        for (size_t i = 0; i < values.size(); ++i)
-        {
-            if (!values[i].valid())
-            {
-                paramValues[i] = nullptr;
-                transient.push_back(String());
-            }
-            else
-            {
-                String val = variant_cast<String>(values[i]);
-                if (values[i].isDateTime())
-                    paramValues[i] = PQescapeLiteral(m_dbConn, val.data(), val.size());
-                else
-                    paramValues[i] = val.data();
-                transient.push_back(val);
-            }
-        }
-        result = PQexecPrepared(m_dbConn, postgresStatement->getIdString().c_str(), static_cast<int>(values.size()),
+        const char **paramValues = (const char **)alloca(sizeof(char *) * params.size());
+        for (size_t i = 0; i < params.size(); ++i)
+            paramValues[i] = params[i].isNull() ? nullptr : params[i].c_str();
+        result = PQexecPrepared(m_dbConn, postgresStatement->getIdString().c_str(), static_cast<int>(params.size()),
             paramValues, nullptr, nullptr, 0 /* text format */);
-        for (size_t i = 0; i < values.size(); ++i)
-        {
-            if (values[i].isDateTime())
-                PQfreemem(const_cast<char *>(paramValues[i]));
-        }
     }
     else {
         result = PQexecPrepared(m_dbConn, postgresStatement->getIdString().c_str(), 0, nullptr, nullptr, nullptr, 0 /* text format */);
@@ -142,6 +198,15 @@ bool PostgresTransactionImpl::execStatement(SqlStatementImpl *statement, int *nu
     return true;
 }
 
+/** Parses numeric column value without constructing an intermediate string */
+template<typename T>
+T parseValue(const char *pVal)
+{
+    T val;
+    metacpp::detail::parseNumberString(pVal, strlen(pVal), val);
+    return val;
+}
+
 template<typename T>
 void assignField(const MetaFieldBase *field, bool isNull, const T& val, Object *obj)
 {
@@ -175,14 +240,13 @@ bool PostgresTransactionImpl::fetchNext(SqlStatementImpl *statement, SqlStorable
         postgresStatement->setDone();
         return false;
     }
-    const int nFields = PQnfields(postgresStatement->getExecResult());
-    for (int i = 0; i < nFields; ++i)
+    const Array<const MetaFieldBase *>& fields = postgresStatement->columnFields(storable->record()->metaObject());
+    for (int i = 0; i < static_cast<int>(fields.size()); ++i)
     {
-        const char *fName = PQfname(postgresStatement->getExecResult(), i);
-        auto field = storable->record()->metaObject()->fieldByName(fName, false);
+        auto field = fields[i];
         if (!field)
         {
-            std::cerr << "Cannot bind sql result to an object field " << fName << std::endl;
+            std::cerr << "Cannot bind sql result to an object field " << PQfname(postgresStatement->getExecResult(), i) << std::endl;
             continue;
         }
         bool isNull = PQgetisnull(postgresStatement->getExecResult(), currentRow, i);
@@ -194,23 +258,23 @@ bool PostgresTransactionImpl::fetchNext(SqlStatementImpl *statement, SqlStorable
             assignField<bool>(field, isNull, isNull ? bool() : *pVal == 't', storable->record());
             break;
         case eFieldInt:
-            assignField<int32_t>(field, isNull, isNull ? int32_t() : String(pVal).toValue<int32_t>(), storable->record());
+            assignField<int32_t>(field, isNull, isNull ? int32_t() : parseValue<int32_t>(pVal), storable->record());
             break;
         case eFieldEnum:
         case eFieldUint:
-            assignField<uint32_t>(field, isNull, isNull ? uint32_t() : String(pVal).toValue<uint32_t>(), storable->record());
+            assignField<uint32_t>(field, isNull, isNull ? uint32_t() : parseValue<uint32_t>(pVal), storable->record());
             break;
         case eFieldInt64:
-            assignField<int64_t>(field, isNull, isNull ? int64_t() : String(pVal).toValue<int64_t>(), storable->record());
+            assignField<int64_t>(field, isNull, isNull ? int64_t() : parseValue<int64_t>(pVal), storable->record());
             break;
         case eFieldUint64:
-            assignField<uint64_t>(field, isNull, isNull ? uint64_t() : String(pVal).toValue<uint64_t>(), storable->record());
+            assignField<uint64_t>(field, isNull, isNull ? uint64_t() : parseValue<uint64_t>(pVal), storable->record());
             break;
         case eFieldFloat:
-            assignField<float>(field, isNull, isNull ? float () : String(pVal).toValue<float>(), storable->record());
+            assignField<float>(field, isNull, isNull ? float () : parseValue<float>(pVal), storable->record());
             break;
         case eFieldDouble:
-            assignField<double>(field, isNull, isNull ? double() : String(pVal).toValue<double>(), storable->record());
+            assignField<double>(field, isNull, isNull ? double() : parseValue<double>(pVal), storable->record());
             break;
         case eFieldString:
             assignField<String>(field, isNull, isNull ? String() : String(pVal, PQgetlength(postgresStatement->getExecResult(), currentRow, i)), storable->record());
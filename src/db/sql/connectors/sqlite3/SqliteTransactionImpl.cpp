@@ -108,6 +108,23 @@ bool SqliteTransactionImpl::prepare(SqlStatementImpl *statement, size_t numParam
     return true;
 }
 
+int SqliteTransactionImpl::bindValue(sqlite3_stmt *stmt, int index, const Variant &v)
+{
+    if (!v.valid())
+        return sqlite3_bind_null(stmt, index);
+    else if (v.isIntegral())
+        return sqlite3_bind_int64(stmt, index, variant_cast<int64_t>(v));
+    else if (v.isFloatingPoint())
+        return sqlite3_bind_double(stmt, index, variant_cast<double>(v));
+    else if (v.isString() || v.isDateTime())
+    {
+        String s = variant_cast<String>(v);
+        return sqlite3_bind_text(stmt, index, s.data(), static_cast<int>(s.length()), SQLITE_TRANSIENT);
+    }
+    else
+        throw std::invalid_argument("Unsupported - not a scalar variant value");
+}
+
 bool SqliteTransactionImpl::bindValues(SqlStatementImpl *statement, const VariantArray &values)
 {
     if (!statement->prepared())
@@ -115,25 +132,98 @@ bool SqliteTransactionImpl::bindValues(SqlStatementImpl *statement, const Varian
     sqlite3_stmt *stmt = reinterpret_cast<SqliteStatementImpl *>(statement)->handle();
     for (size_t i = 0; i < values.size(); ++i)
     {
-        int error = SQLITE_OK;
-        Variant v = values[i];
-        if (!v.valid())
-            error = sqlite3_bind_null(stmt, static_cast<int>(i + 1));
-        else if (v.isIntegral())
-            error = sqlite3_bind_int64(stmt, static_cast<int>(i + 1), variant_cast<int64_t>(v));
-        else if (v.isFloatingPoint())
-            error = sqlite3_bind_double(stmt, static_cast<int>(i + 1), variant_cast<double>(v));
-        else if (v.isString() || v.isDateTime())
+        int error = bindValue(stmt, static_cast<int>(i + 1), values[i]);
+        if (SQLITE_OK != error)
+        {
+            std::cerr << "sqlite3_bind_*(): " << sqlite3_errmsg(m_dbHandle) << std::endl;
+            std::cerr << values[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace
+{
+
+/** Binds field values directly into sqlite statement avoiding Variant conversion */
+class FieldBinder : public FieldValueVisitor
+{
+public:
+    FieldBinder(sqlite3_stmt *stmt, int index)
+        : m_stmt(stmt), m_index(index), m_error(SQLITE_OK)
+    {
+    }
+
+    int error() const { return m_error; }
+
+    void visitNull() override { m_error = sqlite3_bind_null(m_stmt, m_index); }
+    void visit(bool value) override { m_error = sqlite3_bind_int64(m_stmt, m_index, value ? 1 : 0); }
+    void visit(int32_t value) override { m_error = sqlite3_bind_int64(m_stmt, m_index, value); }
+    void visit(uint32_t value) override { m_error = sqlite3_bind_int64(m_stmt, m_index, value); }
+    void visit(int64_t value) override { m_error = sqlite3_bind_int64(m_stmt, m_index, value); }
+    void visit(uint64_t value) override { m_error = sqlite3_bind_int64(m_stmt, m_index, static_cast<int64_t>(value)); }
+    void visit(float value) override { m_error = sqlite3_bind_double(m_stmt, m_index, value); }
+    void visit(double value) override { m_error = sqlite3_bind_double(m_stmt, m_index, value); }
+    void visit(const String& value) override
+    {
+        m_error = sqlite3_bind_text(m_stmt, m_index, value.data(), static_cast<int>(value.length()), SQLITE_TRANSIENT);
+    }
+    void visit(const DateTime& value) override
+    {
+        if (!value.valid())
+            return visitNull();
+        char buf[DateTimeBufferSize];
+        size_t length = formatDateTime(buf, value);
+        m_error = sqlite3_bind_text(m_stmt, m_index, buf, static_cast<int>(length), SQLITE_TRANSIENT);
+    }
+    void visit(const Variant&) override
+    {
+        throw std::logic_error("Variant fields should be bound with bindValue");
+    }
+private:
+    sqlite3_stmt *m_stmt;
+    int m_index;
+    int m_error;
+};
+
+} // anonymous namespace
+
+bool SqliteTransactionImpl::bindRecord(SqlStatementImpl *statement, const Object *record,
+                                       const Array<const MetaFieldBase *> &fields, const VariantArray &values)
+{
+    if (!statement->prepared())
+        throw std::runtime_error("SqliteTransactionImpl::bindRecord(): statement should be prepared first");
+    sqlite3_stmt *stmt = reinterpret_cast<SqliteStatementImpl *>(statement)->handle();
+    int index = 1;
+    for (const MetaFieldBase *field : fields)
+    {
+        int error;
+        if (eFieldVariant == field->type())
         {
-            String s = variant_cast<String>(v);
-            error = sqlite3_bind_text(stmt, static_cast<int>(i + 1), s.data(), static_cast<int>(s.length()), SQLITE_TRANSIENT);
+            error = bindValue(stmt, index, field->getValue(record));
         }
         else
-            throw std::invalid_argument("Unsupported - not a scalar variant value");
+        {
+            FieldBinder binder(stmt, index);
+            field->visitValue(record, binder);
+            error = binder.error();
+        }
+        if (SQLITE_OK != error)
+        {
+            std::cerr << "sqlite3_bind_*(): " << sqlite3_errmsg(m_dbHandle) << std::endl;
+            std::cerr << field->name() << std::endl;
+            return false;
+        }
+        ++index;
+    }
+    for (size_t i = 0; i < values.size(); ++i, ++index)
+    {
+        int error = bindValue(stmt, index, values[i]);
         if (SQLITE_OK != error)
         {
             std::cerr << "sqlite3_bind_*(): " << sqlite3_errmsg(m_dbHandle) << std::endl;
-            std::cerr << v << std::endl;
+            std::cerr << values[i] << std::endl;
             return false;
         }
     }
@@ -197,7 +287,7 @@ bool SqliteTransactionImpl::fetchNext(SqlStatementImpl *statement, SqlStorable *
         int columnCount = sqlite3_data_count(stmt);
         for (int i = 0; i < columnCount; ++i)
         {
-            String name = sqlite3_column_name(stmt, i);
+            const char *name = sqlite3_column_name(stmt, i);
             auto field = storable->record()->metaObject()->fieldByName(name, false);
             if (!field)
             {
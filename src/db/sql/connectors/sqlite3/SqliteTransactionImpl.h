@@ -45,6 +45,8 @@ public:
     SqlStatementImpl *createStatement(SqlStatementType type, const String& queryText) override;
     bool prepare(SqlStatementImpl *statement, size_t numParams) override;
     bool bindValues(SqlStatementImpl *statement, const VariantArray &values) override;
+    bool bindRecord(SqlStatementImpl *statement, const Object *record,
+                    const Array<const MetaFieldBase *>& fields, const VariantArray& values) override;
     bool execStatement(SqlStatementImpl *statement, int *numRowsAffected = nullptr) override;
     bool fetchNext(SqlStatementImpl *statement, SqlStorable *storable) override;
     size_t size(SqlStatementImpl *statement) override;
@@ -53,6 +55,8 @@ public:
 
     sqlite3 *dbHandle() const { return m_dbHandle; }
 private:
+    int bindValue(sqlite3_stmt *stmt, int index, const Variant& v);
+
     sqlite3 *m_dbHandle;
     Array<SqliteStatementImpl *> m_statements;
     std::mutex m_statementsMutex;
@@ -190,7 +190,7 @@ JS::Value toValue(JSContext *context, Variant v)
         {
             auto thread = JSScriptThread::getRunningInstance(context);
 
-            auto ci = thread->findRegisteredClass(nativeObject->metaObject()->name());
+            auto ci = thread->findRegisteredClass(nativeObject->metaObject());
             if (!ci) {
                 throw std::invalid_argument("Class is not registered");
             }
@@ -546,14 +546,14 @@ JSScriptThread *JSScriptThread::getRunningInstance(JSContext *cx)
 
 const detail::ClassInfo *JSScriptThread::findRegisteredClass(const String &name)
 {
-    auto it = std::find_if(m_registeredClasses.begin(), m_registeredClasses.end(),
-        [&](const detail::ClassInfo *ci)
-        {
-            return ci->class_.name == name;
-        });
-    if (it == m_registeredClasses.end())
-        return nullptr;
-    return *it;
+    auto it = m_classNameIndex.find(name);
+    return it == m_classNameIndex.end() ? nullptr : it->second;
+}
+
+const detail::ClassInfo *JSScriptThread::findRegisteredClass(const MetaObject *metaObject)
+{
+    auto it = m_classIndex.find(metaObject);
+    return it == m_classIndex.end() ? nullptr : it->second;
 }
 
 void JSScriptThread::onError(const char *message, JSErrorReport *report)
@@ -594,6 +594,8 @@ void JSScriptThread::registerNativeClasses(JSContext *cx, JS::HandleObject globa
         detail::ClassInfo& classInfo = *m_registeredClasses.back();
         memset(&classInfo.class_, 0, sizeof(JSClass));
         classInfo.metaObject = mo;
+        m_classIndex[mo] = &classInfo;
+        m_classNameIndex[mo->name()] = &classInfo;
         classInfo.class_.name = mo->name();
         classInfo.class_.flags = JSCLASS_HAS_PRIVATE;
 #if MOZJS_MAJOR_VERSION < 38
@@ -649,6 +651,8 @@ void JSScriptThread::unregisterNativeClasses()
         delete ci;
     }
     m_registeredClasses.clear();
+    m_classIndex.clear();
+    m_classNameIndex.clear();
 }
 
 void JSScriptThread::nativeObjectFinalize(JSFreeOp *, JSObject *obj)
@@ -695,6 +699,9 @@ JSBool JSScriptThread::nativeObjectConstruct(JSContext *cx, unsigned argc, jsval
         if (!obj)
             return false;
 
+        // Script constructed objects are not arena allocated on purpose: each one is finalized
+        // by the GC on its own and may be handed over to a Variant, both of which release it
+        // through destroyInstance, while an arena frees its objects only all at once
         Object *pNativeObject = ci->metaObject->createInstance(argWrapper.nativeArgs());
         if (pNativeObject == NULL) {
             JS_ReportOutOfMemory(cx);
@@ -830,8 +837,15 @@ JSBool JSScriptThread::nativeObjectDynamicGetter(JSContext* cx, JS::HandleObject
 #endif
         String propName = variant_cast<String>(detail::fromValue(cx, idValue));
         auto wrapper = (detail::NativeObjectWrapper *)JS_GetPrivate(obj);
+        const MetaObject *metaObject = wrapper->nativeObject->metaObject();
+        // reflected fields are the most common case, read them with a single hashed lookup
+        if (auto field = metaObject->fieldByName(propName))
+        {
+            vp.set(detail::toValue(cx, field->getValue(wrapper->nativeObject)));
+            return true;
+        }
         // method properties
-        if (wrapper->nativeObject->metaObject()->methodByName(propName))
+        if (metaObject->methodByName(propName))
             return JS_PropertyStub(cx, obj, id, vp);
         vp.set(detail::toValue(cx, wrapper->nativeObject->getProperty(propName)));
         return true;
@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <thread>
 #include <condition_variable>
+#include <unordered_map>
 
 namespace metacpp {
 namespace scripting {
@@ -49,6 +50,7 @@ public:
 
     static JSScriptThread *getRunningInstance(JSContext *cx);
     const detail::ClassInfo *findRegisteredClass(const String& name);
+    const detail::ClassInfo *findRegisteredClass(const MetaObject *metaObject);
 private:
     void onError(const char *message, JSErrorReport *report);
     static void dispatchError(JSContext *ctx, const char *message, JSErrorReport *report);
@@ -101,6 +103,8 @@ private:
     std::exception_ptr m_exception;
 
     Array<detail::ClassInfo *> m_registeredClasses;
+    std::unordered_map<const MetaObject *, detail::ClassInfo *> m_classIndex;
+    std::unordered_map<String, detail::ClassInfo *> m_classNameIndex;
 };
 
 } // namespace js
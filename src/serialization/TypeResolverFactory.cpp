@@ -8,16 +8,20 @@ namespace serialization
 TypeResolverFactory::TypeResolverFactory(Array<const MetaObject *> knownTypes)
     : m_knownTypes(knownTypes)
 {
+    // resolved against the known types only, classes sharing the name elsewhere must not shadow them
+    std::vector<const char *> names;
+    names.reserve(m_knownTypes.size());
+    for (const MetaObject *knownType : m_knownTypes)
+        names.push_back(knownType->name());
+    m_nameIndex.build(names, true);
 }
 
-Object *TypeResolverFactory::createInstance(String typeUri)
+Object *TypeResolverFactory::createInstance(const StringView& typeUri)
 {
-    for (const MetaObject *knownType : m_knownTypes) {
-        if (knownType->name() == typeUri) {
-            return knownType->createInstance();
-        }
-    }
-    throw std::invalid_argument(String("Could not resolve type " + typeUri).c_str());
+    size_t pos = m_nameIndex.find(typeUri.data(), typeUri.length());
+    if (pos != metacpp::detail::NameIndex::npos)
+        return m_knownTypes[pos]->createInstance();
+    throw std::invalid_argument(String("Could not resolve type " + typeUri.toString()).c_str());
 }
 
 } // namespace serialization
@@ -10,14 +10,15 @@ namespace metacpp
 namespace serialization
 {
 
-class TypeResolverFactory : FactoryBase<Object *, String>
+class TypeResolverFactory : FactoryBase<Object *, const StringView&>
 {
 public:
     explicit TypeResolverFactory(Array<const metacpp::MetaObject *> knownTypes);
 
-    Object *createInstance(String typeUri) override;
+    Object *createInstance(const StringView& typeUri) override;
 private:
     Array<const metacpp::MetaObject *> m_knownTypes;
+    metacpp::detail::NameIndex m_nameIndex;
 };
 
 } // namespace serialization
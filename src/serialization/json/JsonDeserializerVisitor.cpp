@@ -82,10 +82,9 @@ static metacpp::Variant ToVariant(const Json::Value& val, TypeResolverFactory *t
         Json::Value typeValue = val[szTypeName];
         if (!typeValue.isString())
             throw std::invalid_argument("Unknown type of Object encapsulated into Variant");
-        auto typeName = typeValue.asString();
         if (!typeResolver)
-            throw std::invalid_argument("Unknown type " + typeName);
-        Object *subObj = typeResolver->createInstance(typeValue.asString());
+            throw std::invalid_argument("Unknown type " + typeValue.asString());
+        Object *subObj = typeResolver->createInstance(typeValue.asCString());
         JsonDeserializerVisitor visitor(val, typeResolver);
         visitor.visit(subObj);
         return subObj;
@@ -152,7 +152,10 @@ void JsonSerializerVisitor::appendSubValue(Json::Value& val, EFieldType type, co
     case eFieldDateTime: {
         auto pDateTime = reinterpret_cast<const metacpp::DateTime *>(pValue);
         if (pDateTime->valid())
-            val = pDateTime->toString().c_str();
+        {
+            char buf[DateTimeBufferSize];
+            val = Json::Value(buf, buf + formatDateTime(buf, *pDateTime));
+        }
         break;
     }
     case eFieldVariant: {
@@ -18,11 +18,14 @@
 #include "config.h"
 #include <algorithm>
 #include <string.h>
+#include <stdlib.h>
 #include "SharedDataBase.h"
 #include "SharedDataPointer.h"
 #include <type_traits>
 #include <cassert>
 #include <functional>
+#include <new>
+#include <utility>
 
 namespace metacpp
 {
@@ -32,186 +35,211 @@ namespace detail
     template<typename T, typename Enable = void>
     struct TypeTraits;
 
-    /** \brief Array traits specialization for POD types */
+    /** \brief Array traits specialization for POD types
+     *
+     * Elements are relocated with memcpy/realloc and left uninitialized when the array grows.
+     */
     template<typename T>
     struct TypeTraits<T, typename std::enable_if<std::is_pod<T>::value>::type>
     {
-        static T *Allocate(size_t size, const T *initialData = nullptr)
+        static const bool Trivial = true;
+
+        static void Construct(void *data, size_t count)
         {
-            T *data = (T *)malloc(size * sizeof(T));
-            if (initialData)
-                memcpy(data, initialData, size * sizeof(T));
-            return data;
+            (void)data; (void)count;
         }
 
-        static void Deallocate(T *data)
+        static void Copy(void *dest, const void *source, size_t count)
         {
-            free(data);
+            if (count) memcpy(dest, source, count * sizeof(T));
         }
 
-        static T *Reallocate(T *data, size_t newSize, size_t oldSize)
+        static void Relocate(void *dest, void *source, size_t count)
         {
-            (void)oldSize;
-            return (T *)realloc(data, newSize * sizeof(T));
+            if (count) memcpy(dest, source, count * sizeof(T));
+        }
+
+        static void Destroy(void *data, size_t count)
+        {
+            (void)data; (void)count;
         }
     };
 
-    /** \brief Array traits specialization for non-movable types */
+    /** \brief Array traits specialization for non-POD types
+     *
+     * Elements are constructed in place in the raw storage and relocated by moving them
+     * if their move constructor does not throw and by copying otherwise.
+     */
     template<typename T>
-    struct TypeTraits<T, typename std::enable_if<!std::is_pod<T>::value && !std::is_constructible<T, T&&>::value>::type>
+    struct TypeTraits<T, typename std::enable_if<!std::is_pod<T>::value>::type>
     {
-        static T *Allocate(size_t size, const T *initialData = nullptr)
-        {
-            T *data = new T[size];
-            if (initialData) std::copy_n(initialData, size, data);
-            return data;
-        }
+        static const bool Trivial = false;
 
-        static void Deallocate(T *data)
+        static void Construct(void *data, size_t count)
         {
-            delete[] data;
+            T *p = static_cast<T *>(data);
+            size_t i = 0;
+            try
+            {
+                for (; i < count; ++i) new (p + i) T();
+            }
+            catch (...)
+            {
+                Destroy(p, i);
+                throw;
+            }
         }
 
-        static T *Reallocate(T *data, size_t newSize, size_t oldSize)
+        static void Copy(void *dest, const void *source, size_t count)
         {
-            T *newData = newSize ? new T[newSize] : nullptr;
-            if (data)
+            T *p = static_cast<T *>(dest);
+            const T *src = static_cast<const T *>(source);
+            size_t i = 0;
+            try
             {
-                std::copy_n(data, std::min(newSize, oldSize), newData);
-                delete[] data;
+                for (; i < count; ++i) new (p + i) T(src[i]);
+            }
+            catch (...)
+            {
+                Destroy(p, i);
+                throw;
             }
-            return newData;
         }
-    };
 
-    /** \brief Array traits specialization for movable types */
-    template<typename T>
-    struct TypeTraits<T, typename std::enable_if<!std::is_pod<T>::value && std::is_constructible<T, T&&>::value>::type>
-    {
-        static T *Allocate(size_t size, const T *initialData = nullptr)
+        static void Relocate(void *dest, void *source, size_t count)
         {
-            T *data = new T[size];
-            if (initialData)
-                std::move(initialData, initialData + size, data);
-            return data;
+            T *p = static_cast<T *>(dest), *src = static_cast<T *>(source);
+            size_t i = 0;
+            try
+            {
+                for (; i < count; ++i) new (p + i) T(std::move_if_noexcept(src[i]));
+            }
+            catch (...)
+            {
+                // source is left intact when elements are copied
+                Destroy(p, i);
+                throw;
+            }
+            Destroy(src, count);
         }
 
-        static void Deallocate(T *data)
+        static void Destroy(void *data, size_t count)
         {
-            delete[] data;
+            T *p = static_cast<T *>(data);
+            for (size_t i = 0; i < count; ++i) p[i].~T();
         }
+    };
 
-        static T *Reallocate(T *data, size_t newSize, size_t oldSize)
-        {
-            T *newData = new T[newSize];
-            if (data)
-            {
-                std::move(data, data + std::min(newSize, oldSize), newData);
-                delete[] data;
-            }
-            return newData;
-        }
+    /** \brief Growth factor of the array buffers in percents, may be specialized for the particular element type */
+    template<typename T>
+    struct ArrayGrowthFactor
+    {
+        static const unsigned Percent = 150;
     };
 
-    typedef void *(*AllocateCB_t)(size_t size, const void *initialData);
-    typedef void (*DeallocateCB_t)(void *data);
-    typedef void *(*ReallocateCB_t)(void *data, size_t newSize, size_t oldSize);
+    typedef void (*ConstructCB_t)(void *data, size_t count);
+    typedef void (*CopyCB_t)(void *dest, const void *source, size_t count);
+    typedef void (*RelocateCB_t)(void *dest, void *source, size_t count);
+    typedef void (*DestroyCB_t)(void *data, size_t count);
 
+    /** \brief Type-erased element operations, so that arrays may be resized and copied without knowing their type */
     typedef struct
     {
-        AllocateCB_t allocCb;
-        DeallocateCB_t deallocCb;
-        ReallocateCB_t reallocCb;
+        size_t elementSize;
+        bool trivial;
+        unsigned growthPercent;
+        ConstructCB_t constructCb;
+        CopyCB_t copyCb;
+        RelocateCB_t relocateCb;
+        DestroyCB_t destroyCb;
     } ArrayDataTraits;
 
+    template<typename T>
+    struct ArrayDataTraitsOf
+    {
+        static const ArrayDataTraits value;
+    };
+
+    template<typename T>
+    const ArrayDataTraits ArrayDataTraitsOf<T>::value = {
+        sizeof(T), TypeTraits<T>::Trivial, ArrayGrowthFactor<T>::Percent,
+        &TypeTraits<T>::Construct, &TypeTraits<T>::Copy, &TypeTraits<T>::Relocate, &TypeTraits<T>::Destroy
+    };
+
+    /** \brief Storage of the array elements
+     *
+     * Only the first m_dwSize elements of the buffer are constructed. Operations which do not
+     * depend on the element type go through the traits and remain valid when the array is accessed
+     * through a pointer to an array of different type, like reflection does with Array<char>.
+     */
     template<typename T>
     class ArrayData : public SharedDataBase
     {
     public:
         ArrayData() :
-            m_data(nullptr), m_dwSize(0), m_dwAllocatedSize(0)
+            m_data(nullptr), m_dwSize(0), m_dwAllocatedSize(0), m_traits(&ArrayDataTraitsOf<T>::value)
         {
-            ArrayDataTraits traits;
-            traits.allocCb = (AllocateCB_t)&TypeTraits<T>::Allocate;
-            traits.deallocCb = (DeallocateCB_t)&TypeTraits<T>::Deallocate;
-            traits.reallocCb = (ReallocateCB_t)&TypeTraits<T>::Reallocate;
-            _initTraits(traits);
         }
 
         ArrayData(const ArrayDataTraits& traits) :
-            m_data(nullptr), m_dwSize(0), m_dwAllocatedSize(0)
+            m_data(nullptr), m_dwSize(0), m_dwAllocatedSize(0), m_traits(&traits)
         {
-            _initTraits(traits);
         }
 
-        ArrayData(const T *data, size_t size)
+        ArrayData(const T *data, size_t size) :
+            m_data(nullptr), m_dwSize(0), m_dwAllocatedSize(0), m_traits(&ArrayDataTraitsOf<T>::value)
         {
-            ArrayDataTraits traits;
-            traits.allocCb = (AllocateCB_t)&TypeTraits<T>::Allocate;
-            traits.deallocCb = (DeallocateCB_t)&TypeTraits<T>::Deallocate;
-            traits.reallocCb = (ReallocateCB_t)&TypeTraits<T>::Reallocate;
-            _initTraits(traits);
-
             if (size)
             {
-                m_data = (T *)m_traits.allocCb(size, data);
-                if (!m_data)
-                    throw std::bad_alloc();
-
-                m_dwSize = m_dwAllocatedSize = size;
-            }
-            else
-            {
-                m_data = nullptr;
-                m_dwSize = m_dwAllocatedSize = 0;
+                _reallocate(size);
+                if (data)
+                    m_traits->copyCb(m_data, data, size);
+                else
+                    m_traits->constructCb(m_data, size);
+                m_dwSize = size;
             }
-
         }
 
         ArrayData(const ArrayData&)/* =delete */;
 
         ~ArrayData()
         {
-            if (m_data) m_traits.deallocCb(m_data);
+            _free();
         }
 
-        void _initTraits(const ArrayDataTraits& traits)
+        void _reserve(size_t size)
         {
-            m_traits = traits;
+            if (m_dwAllocatedSize < size)
+                _reallocate(size);
         }
 
-        void _reserve(size_t size)
+        /** \brief Ensures capacity for the given number of elements growing the buffer geometrically */
+        void _grow(size_t size)
         {
-            if (m_dwSize < size && m_dwAllocatedSize < size)
+            if (m_dwAllocatedSize < size)
             {
-                m_data = (T *)m_traits.reallocCb(m_data, size, m_dwSize);
-                if (!m_data)
-                    throw std::bad_alloc();
-                m_dwAllocatedSize = size;
+                size_t newSize = m_dwAllocatedSize * m_traits->growthPercent / 100;
+                if (newSize < size) newSize = size;
+                _reallocate(newSize);
             }
         }
 
         void _resize(size_t size)
         {
-            if (m_dwAllocatedSize < size)
+            if (size > m_dwSize)
             {
-                size_t newSize = m_dwAllocatedSize + m_dwAllocatedSize * 3 / 2;
-                if (newSize < size) newSize = size;
-
-                _reserve(newSize);
+                _grow(size);
+                m_traits->constructCb(_at(m_dwSize), size - m_dwSize);
             }
+            else
+                m_traits->destroyCb(_at(size), m_dwSize - size);
             m_dwSize = size;
         }
 
         void _squeeze()
         {
             if (m_dwAllocatedSize != m_dwSize)
-            {
-                m_data = (T *)m_traits.reallocCb(m_data, m_dwSize, m_dwAllocatedSize);
-                if (m_dwSize && !m_data)
-                    throw std::bad_alloc();
-                m_dwAllocatedSize = m_dwSize;
-            }
+                _reallocate(m_dwSize);
         }
 
         size_t _size() const
@@ -226,100 +254,350 @@ namespace detail
 
         void _free()
         {
-            if (m_data) m_traits.deallocCb(m_data);
+            if (m_data)
+            {
+                m_traits->destroyCb(m_data, m_dwSize);
+                free(static_cast<void *>(m_data));
+                m_data = nullptr;
+            }
             m_dwAllocatedSize = m_dwSize = 0;
         }
 
         T *_data() { return m_data; }
         const T *_data() const { return m_data; }
 
-        void _push_back(const T& v)
+        template<typename... TArgs>
+        T& _emplace_back(TArgs&&... args)
         {
-            _resize(m_dwSize + 1);
-            *(m_data + m_dwSize - 1) = v;
+            if (m_dwSize == m_dwAllocatedSize)
+            {
+                // arguments may refer to the elements moved away by the reallocation
+                T value(std::forward<TArgs>(args)...);
+                _grow(m_dwSize + 1);
+                new (m_data + m_dwSize) T(std::move(value));
+            }
+            else
+                new (m_data + m_dwSize) T(std::forward<TArgs>(args)...);
+            return m_data[m_dwSize++];
         }
 
-        template<typename... TArgs>
-        void _emplace_back(TArgs... args)
+        void _push_back(const T& v)
         {
-            _resize(m_dwSize + 1);
-            new (m_data + m_dwSize - 1) T(args...);
+            _emplace_back(v);
         }
 
         void _push_back(T&& v)
         {
-            _resize(m_dwSize + 1);
-            *(m_data + m_dwSize - 1) = std::move(v);
+            _emplace_back(std::move(v));
         }
 
         void _push_front(const T& v)
         {
-            _resize(m_dwSize + 1);
-            std::copy(m_data, m_data + m_dwSize - 1, m_data + 1);
-            *m_data = v;
+            _emplace(0, v);
         }
 
         void _push_front(T&& v)
         {
-            _resize(m_dwSize + 1);
-            std::copy(m_data, m_data + m_dwSize - 1, m_data + 1);
-            *m_data = std::move(v);
+            _emplace(0, std::move(v));
         }
 
         void _pop_back()
         {
             assert(m_dwSize);
-            _resize(m_dwSize - 1);
+            m_data[--m_dwSize].~T();
         }
 
         void _pop_front()
         {
             assert(m_dwSize);
-            std::copy(m_data + 1, m_data + m_dwSize, m_data);
-            _resize(m_dwSize -1);
+            _erase(0, 1);
         }
 
         void _insert(const T& v, size_t i)
         {
-            assert(i <= m_dwSize);
-            _resize(m_dwSize + 1);
-            std::copy(m_data + i, m_data + m_dwSize - 1, m_data + i + 1);
-            *(m_data + i) = v;
+            _emplace(i, v);
         }
 
         template<typename... TArgs>
-        void _emplace(size_t i, TArgs... args)
+        void _emplace(size_t i, TArgs&&... args)
         {
             assert(i <= m_dwSize);
-            _resize(m_dwSize + 1);
-            std::copy(m_data + i, m_data + m_dwSize - 1, m_data + i + 1);
-            new (m_data + i)T(args...);
+            if (i == m_dwSize)
+            {
+                _emplace_back(std::forward<TArgs>(args)...);
+                return;
+            }
+            T value(std::forward<TArgs>(args)...);
+            _grow(m_dwSize + 1);
+            // shift the tail by one moving the last element into the uninitialized storage
+            new (m_data + m_dwSize) T(std::move(m_data[m_dwSize - 1]));
+            ++m_dwSize;
+            std::move_backward(m_data + i, m_data + m_dwSize - 2, m_data + m_dwSize - 1);
+            m_data[i] = std::move(value);
         }
 
         void _erase(size_t from, size_t to)
         {
             assert(from <= m_dwSize && to <= m_dwSize && from < to);
-            std::copy(m_data + to, m_data + m_dwSize, m_data + from);
-            _resize(m_dwSize - (to - from));
+            std::move(m_data + to, m_data + m_dwSize, m_data + from);
+            size_t size = m_dwSize - (to - from);
+            TypeTraits<T>::Destroy(m_data + size, to - from);
+            m_dwSize = size;
         }
 
         SharedDataBase *clone() const override
         {
-            ArrayData *copy = new ArrayData();
-            copy->m_data = (T *)m_traits.allocCb(m_dwSize, m_data);
-            if (!copy->m_data)
-                throw std::bad_alloc();
-            copy->m_dwAllocatedSize = copy->m_dwSize = m_dwSize;
-            copy->m_traits = m_traits;
+            ArrayData *copy = new ArrayData(*m_traits);
+            if (m_dwSize)
+            {
+                copy->_reallocate(m_dwSize);
+                m_traits->copyCb(copy->m_data, m_data, m_dwSize);
+                copy->m_dwSize = m_dwSize;
+            }
             return copy;
         }
     protected:
+        /** \brief Gets the pointer to the i-th element using the element size of the traits */
+        void *_at(size_t i) const
+        {
+            return reinterpret_cast<char *>(m_data) + i * m_traits->elementSize;
+        }
+
+        /** \brief Moves elements into the buffer of the given capacity, which should fit all of them */
+        void _reallocate(size_t capacity)
+        {
+            assert(capacity >= m_dwSize);
+            T *newData = nullptr;
+            if (m_traits->trivial && m_data)
+            {
+                if (!capacity)
+                    free(static_cast<void *>(m_data));
+                else if (!(newData = (T *)realloc(static_cast<void *>(m_data), capacity * m_traits->elementSize)))
+                    throw std::bad_alloc();
+            }
+            else
+            {
+                if (capacity && !(newData = (T *)malloc(capacity * m_traits->elementSize)))
+                    throw std::bad_alloc();
+                if (m_data)
+                {
+                    try
+                    {
+                        m_traits->relocateCb(newData, m_data, m_dwSize);
+                    }
+                    catch (...)
+                    {
+                        free(newData);
+                        throw;
+                    }
+                    free(static_cast<void *>(m_data));
+                }
+            }
+            m_data = newData;
+            m_dwAllocatedSize = capacity;
+        }
+
         T *m_data;
         size_t m_dwSize, m_dwAllocatedSize;
-        ArrayDataTraits m_traits;
+        const ArrayDataTraits *m_traits;
     };
 } // namespace detail
 
+/** \brief A non-owning range of contiguous array elements
+ *
+ * Element access through a span goes straight to the buffer without reference counting
+ * checks, so loops over it compile to plain pointer arithmetic and may be vectorized.
+ * The span is invalidated by any operation changing size or capacity of the array it
+ * was taken from. An Array must not be copied while its mutable span is in use,
+ * otherwise the writes will be visible through the copy as well.
+ */
+template<typename T>
+class ArraySpan
+{
+public:
+    /** \brief Random access STL iterator for this span */
+    typedef T *iterator;
+    /** \brief Reference to the element of span */
+    typedef T& reference;
+
+    /** \brief Constructs an empty span */
+    ArraySpan() : m_begin(nullptr), m_end(nullptr) { }
+    /** \brief Constructs a span covering elements in the range [begin, end) */
+    ArraySpan(T *begin, T *end) : m_begin(begin), m_end(end) { }
+
+    /** \brief Gets the pointer to the first element */
+    T *data() const { return m_begin; }
+    /** \brief Gets number of elements in the span */
+    size_t size() const { return m_end - m_begin; }
+    /** \brief Checks whether span is empty */
+    bool empty() const { return m_begin == m_end; }
+    /** \brief Gets an STL iterator pointing to the begin of this span */
+    iterator begin() const { return m_begin; }
+    /** \brief Gets an STL iterator pointing to the end of this span */
+    iterator end() const { return m_end; }
+    /** \brief Gets reference to the element at specified index */
+    reference operator[](size_t i) const { assert(i < size()); return m_begin[i]; }
+private:
+    T *m_begin, *m_end;
+};
+
+template<typename T>
+class Array;
+
+/** \brief A dynamic array exclusively owning its buffer.
+ *
+ * Unlike Array it is never implicitly shared, so mutable access does not perform copy-on-write
+ * checks. Elements are moved between UniqueArray and Array by transferring the buffer, without copying.
+ */
+template<typename T>
+class UniqueArray
+{
+public:
+    /** \brief Random access STL iterator for this array */
+    typedef T *iterator;
+    /** \brief Const random access STL iterator for this array */
+    typedef const T *const_iterator;
+    /** \brief Reference to the element of array */
+    typedef T& reference;
+    /** \brief Const reference to the element of array */
+    typedef const T& const_reference;
+
+    /** \brief Constructs a new empty array. No memory is allocated until the first element is added. */
+    UniqueArray() : m_d(nullptr)
+    {
+    }
+
+    /** \brief Constructs a new array and initializes it's data from raw buffer */
+    UniqueArray(const T *data, size_t size)
+        : m_d(new detail::ArrayData<T>(data, size))
+    {
+    }
+
+    /** \brief Constructs a new array and initializes it with braced initializer list */
+    UniqueArray(const std::initializer_list<T>& init) : m_d(nullptr)
+    {
+        reserve(init.size());
+        for (auto& item : init)
+            push_back(item);
+    }
+
+    /** \brief Constructs a deep copy of the other array */
+    UniqueArray(const UniqueArray& o)
+        : m_d(o.m_d ? static_cast<detail::ArrayData<T> *>(o.m_d->clone()) : nullptr)
+    {
+    }
+
+    /** \brief Takes the buffer of the other array leaving it empty */
+    UniqueArray(UniqueArray&& o) noexcept : m_d(o.m_d)
+    {
+        o.m_d = nullptr;
+    }
+
+    /** \brief Takes the buffer of the shared array. Elements are copied only if the buffer is referenced by other arrays. */
+    UniqueArray(Array<T>&& o);
+
+    ~UniqueArray()
+    {
+        destroy(m_d);
+    }
+
+    /** \brief Replaces contents of this array with a copy (or the buffer) of the other */
+    UniqueArray& operator=(UniqueArray o)
+    {
+        std::swap(m_d, o.m_d);
+        return *this;
+    }
+
+    /** \brief Gets the pointer to the raw buffer */
+    T *data() { return m_d ? m_d->_data() : nullptr; }
+    /** \brief Gets the pointer to the readonly raw buffer */
+    const T *data() const { return m_d ? m_d->_data() : nullptr; }
+    /** \brief Gets number of elements in the array */
+    size_t size() const { return m_d ? m_d->_size() : 0; }
+    /** \brief Checks whether array is empty */
+    bool empty() const { return 0 == size(); }
+    /** \brief Gets maximum number of arguments that may be fitted into this array without need of expanding buffers */
+    size_t capacity() const { return m_d ? m_d->_capacity() : 0; }
+    /** \brief Ensures that array may fit given number of arguments */
+    void reserve(size_t size) { d()->_reserve(size); }
+    /** \brief Resizes array to the given number of arguments. \see Array::resize */
+    void resize(size_t size) { d()->_resize(size); }
+    /** \brief Sqeezes allocated buffers to the minimum size to fit array data */
+    void squeeze() { if (m_d) m_d->_squeeze(); }
+    /** \brief Removes one element at the specified position */
+    void erase(size_t i) { d()->_erase(i, i + 1); }
+    /** \brief Removes element in the inclusive range between specified positions */
+    void erase(size_t from, size_t to) { d()->_erase(from, to); }
+    /** \brief Removes one element pointed by specified iterator */
+    void erase(const_iterator it) { erase(it - begin()); }
+
+    /** \brief Gets reference to the element at specified index */
+    reference operator[](size_t i) { assert(i < size()); return m_d->_data()[i]; }
+    /** \brief Gets const reference to the element at specified index */
+    const_reference operator[](size_t i) const { assert(i < size()); return m_d->_data()[i]; }
+
+    /** \brief Gets reference to the first element in the array. Array should not be empty. */
+    reference front() { assert(size()); return *begin(); }
+    /** \brief Gets const reference to the first element in the array. Array should not be empty. */
+    const_reference front() const { assert(size()); return *begin(); }
+    /** \brief Gets reference to the last element in the array. Array should not be empty. */
+    reference back() { assert(size()); return *(end() - 1); }
+    /** \brief Gets const reference to the last element in the array. Array should not be empty. */
+    const_reference back() const { assert(size()); return *(end() - 1); }
+
+    /** \brief Gets an STL iterator pointing to the begin of this array */
+    iterator begin() { return data(); }
+    /** \brief Gets an STL iterator pointing to the end of this array */
+    iterator end() { return data() + size(); }
+    /** \brief Gets an const STL iterator pointing to the begin of this array */
+    const_iterator begin() const { return data(); }
+    /** \brief Gets an const STL iterator pointing to the end of this array */
+    const_iterator end() const { return data() + size(); }
+    /** \brief Gets a span over all elements of this array */
+    ArraySpan<T> span() { return ArraySpan<T>(begin(), end()); }
+
+    /** \brief Puts given element into the end of this array. Operation has complexity O(1). */
+    void push_back(const T& v) { d()->_push_back(v); }
+    /** \brief Moves given element into the end of this array. Operation has complexity O(1). */
+    void push_back(T&& v) { d()->_push_back(std::move(v)); }
+    /** \brief Puts given element into the begin of this array. Operation has complexity O(N), where N is a current array size. */
+    void push_front(const T& v) { d()->_push_front(v); }
+    /** \brief Removes element from the end of this array. Operation has complexity O(1) */
+    void pop_back() { d()->_pop_back(); }
+    /** \brief Removes element from the begin of this array. Operation has complexity O(N), where N is a current array size. */
+    void pop_front() { d()->_pop_front(); }
+
+    /** \brief Constructs element in-place at the end of this array forwarding arguments to its constructor */
+    template<typename... TArgs>
+    void emplace_back(TArgs&&... args) { d()->_emplace_back(std::forward<TArgs>(args)...); }
+
+    /** \brief Puts set of elements from an array into the end of this array */
+    void append(const T *many, size_t n) {
+        d()->_grow(size() + n);
+        for (size_t i = 0; i < n; ++i) m_d->_push_back(many[i]);
+    }
+
+    /** \brief Empties this array releasing the buffer */
+    void clear() { destroy(m_d); m_d = nullptr; }
+
+private:
+    friend class Array<T>;
+
+    detail::ArrayData<T> *d()
+    {
+        if (!m_d) m_d = new detail::ArrayData<T>();
+        return m_d;
+    }
+
+    static void destroy(detail::ArrayData<T> *d)
+    {
+        if (d && !d->deref())
+            delete d;
+    }
+
+    detail::ArrayData<T> *m_d;
+};
+
 /** \brief A template class that provides dynamic collection of simple datatypes.
  * Utilizes copy-on-write techinque.
  */
@@ -349,6 +627,19 @@ public:
     {
     }
 
+    /** \brief Constructs a new array taking the buffer of the other one, which becomes empty */
+    Array(Array&& o) noexcept : Base(std::move(o))
+    {
+        o.m_d = sharedEmpty();
+    }
+
+    /** \brief Constructs a new array taking the buffer of the unique array, elements are not copied */
+    Array(UniqueArray<T>&& o)
+        : Base(o.m_d ? o.m_d : new detail::ArrayData<T>())
+    {
+        o.m_d = nullptr;
+    }
+
     /** \brief Constructs a new array and initializes it's data from raw buffer */
     Array(const T *data, size_t size)
         : Base(new detail::ArrayData<T>(data, size))
@@ -367,6 +658,19 @@ public:
     {
     }
 
+    /** \brief Makes this array share the data buffer with the other one */
+    Array& operator=(const Array& o) = default;
+    /** \brief Takes the buffer of the other array, which becomes empty */
+    Array& operator=(Array&& o) noexcept
+    {
+        if (this != &o)
+        {
+            Base::operator=(std::move(o));
+            o.m_d = sharedEmpty();
+        }
+        return *this;
+    }
+
     /** \brief Gets the pointer to the raw buffer */
     T *data() { this->detachOrInitialize(); return this->m_d->_data(); }
     /** \brief Gets the pointer to the readonly raw buffer */
@@ -382,7 +686,8 @@ public:
     /** \brief Resizes array to the given number of arguments.
      *
      * If current size of the array exceeds given number, the array is truncted to the specified value,
-     * if array size is smaller than given size, the array is expanded with default constructed elements
+     * if array size is smaller than given size, the array is expanded with default constructed elements.
+     * New elements of POD types are left uninitialized.
      */
     void resize(size_t size) { this->detachOrInitialize(); this->m_d->_resize(size); }
     /** \brief Sqeezes allocated buffers to the minimum size to fit array data */
@@ -413,12 +718,26 @@ public:
     /** \brief Gets an STL iterator pointing to the end of this array */
     iterator end() { this->detachOrInitialize(); return this->m_d->_data() + this->m_d->_size(); }
     /** \brief Gets an const STL iterator pointing to the begin of this array */
-    const_iterator begin() const { return this->m_d->_data(); }
+    const_iterator begin() const { return data(); }
     /** \brief Gets an const STL iterator pointing to the end of this array */
-    const_iterator end() const { return this->m_d->_data() + this->m_d->_size(); }
+    const_iterator end() const { return data() + size(); }
+
+    /** \brief Detaches the array once and returns a span over its elements.
+     *
+     * Unlike non-const operator[] and iterators, element access through the span skips
+     * the copy-on-write check, use it for tight loops modifying array elements.
+     */
+    ArraySpan<T> mutableSpan()
+    {
+        this->detachOrInitialize();
+        T *first = this->m_d->_data();
+        return ArraySpan<T>(first, first + this->m_d->_size());
+    }
 
     /** \brief Puts given element into the end of this array. Operation has complexity O(1). */
     void push_back(const T& v) { this->detachOrInitialize(); this->m_d->_push_back(v); }
+    /** \brief Moves given element into the end of this array. Operation has complexity O(1). */
+    void push_back(T&& v) { this->detachOrInitialize(); this->m_d->_push_back(std::move(v)); }
     /** \brief Puts given element into the begin of this array. Operation has complexity O(N), where N is a current array size. */
     void push_front(const T& v) { this->detachOrInitialize(); this->m_d->_push_front(v); }
     /** \brief Removes element from the end of this array. Operation has complexity O(1) */
@@ -426,14 +745,14 @@ public:
     /** \brief Removes element from the begin of this array. Operation has complexity O(N), where N is a current array size. */
     void pop_front() { this->detachOrInitialize(); this->m_d->_pop_front(); }
 
-    /** \brief Constructs element in-place at the end of this array */
+    /** \brief Constructs element in-place at the end of this array forwarding arguments to its constructor */
     template<typename... TArgs>
-    void emplace_back(TArgs... args) { this->detachOrInitialize(); this->m_d->_emplace_back(args...); }
+    void emplace_back(TArgs&&... args) { this->detachOrInitialize(); this->m_d->_emplace_back(std::forward<TArgs>(args)...); }
 
     /** \brief Puts set of elements from an array into the end of this array */
     void append(const T *many, size_t n) {
         this->detachOrInitialize();
-        reserve(size() + n);
+        this->m_d->_grow(size() + n);
         for (size_t i = 0; i < n; ++i) this->m_d->_push_back(many[i]);
     }
 
@@ -453,8 +772,40 @@ public:
             res.emplace_back(functor((*this)[i]));
         return res;
     }
+
+private:
+    friend class UniqueArray<T>;
+
+    /** Gets the buffer referenced by moved-from arrays.
+     *
+     * Reflection resizes array fields through Array<char>, so they must keep the buffer
+     * with traits of the actual element type rather than being left without one.
+     * The buffer is never freed and is detached on the first modification.
+     */
+    static detail::ArrayData<T> *sharedEmpty()
+    {
+        static detail::ArrayData<T> *empty = new detail::ArrayData<T>();
+        empty->ref();
+        return empty;
+    }
 };
 
+template<typename T>
+UniqueArray<T>::UniqueArray(Array<T>&& o) : m_d(nullptr)
+{
+    if (o.m_d && o.m_d->count() == 1)
+    {
+        m_d = o.m_d;
+        o.m_d = nullptr;
+    }
+    else if (o.m_d)
+    {
+        m_d = static_cast<detail::ArrayData<T> *>(o.m_d->clone());
+        o.Base::clear();
+    }
+    o.m_d = Array<T>::sharedEmpty();
+}
+
 /** \brief Array of bytes
  * \relates metacpp::Array
  */
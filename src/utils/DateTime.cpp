@@ -14,11 +14,12 @@
 * limitations under the License.                                            *
 ****************************************************************************/
 #include "DateTime.h"
-#include <mutex>
+#include "TimeZone.h"
 #include <stdio.h>
-#include <locale>
+#include <string.h>
 #include <ctime>
-#include <iomanip>
+#include <limits>
+#include "NumberFormat.h"
 #ifdef _MSC_VER
 #include "compat/strptime.h"
 #endif
@@ -29,471 +30,623 @@ namespace metacpp {
 #define sprintf(buf, fmt, ...) sprintf_s(buf, fmt, __VA_ARGS__)
 #endif
 
-namespace detail
-{
-    DateTimeData::DateTimeData(time_t stdTime)
-    {
-        // standard time lib isn't thread safe
-        static std::mutex g_stdTimeMutex;
-        std::lock_guard<std::mutex> _guard(g_stdTimeMutex);
+using namespace detail;
 
-#ifdef _MSC_VER
-        if (0 != localtime_s(&m_tm, &stdTime))
-            throw std::invalid_argument("stdTime");
-#else
-        m_tm = *localtime(&stdTime);
-#endif
-    }
+namespace
+{
+    const int64_t MicrosecondsPerSecond = 1000000;
+    const int64_t MicrosecondsPerMinute = 60 * MicrosecondsPerSecond;
+    const int64_t MicrosecondsPerHour = 60 * MicrosecondsPerMinute;
+    const int64_t MicrosecondsPerDay = 24 * MicrosecondsPerHour;
+    const int64_t InvalidValue = std::numeric_limits<int64_t>::min();
+    // keeps any representable date far from the int64_t overflow
+    const int MaxYear = 200000;
+    // bounds of the values within the range of years above
+    const int64_t MinValue = daysFromCivil(-MaxYear, 1, 1) * MicrosecondsPerDay;
+    const int64_t MaxValue = daysFromCivil(MaxYear + 1, 1, 1) * MicrosecondsPerDay - 1;
 
-    DateTimeData::DateTimeData(const tm &tm)
-        : m_tm(tm)
+    inline struct tm emptyTm()
     {
-
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        return tm;
     }
 
-    DateTimeData::~DateTimeData()
+    /** Broken-down representation of the DateTime value */
+    struct CivilTime
     {
+        int year;
+        unsigned month; // 1-based
+        unsigned day;
+        int hours, minutes, seconds, microseconds;
 
-    }
+        explicit CivilTime(int64_t value)
+        {
+            int64_t days = floorDiv(value, MicrosecondsPerDay);
+            int64_t timeOfDay = value - days * MicrosecondsPerDay;
+            civilFromDays(days, year, month, day);
+            hours = static_cast<int>(timeOfDay / MicrosecondsPerHour);
+            minutes = static_cast<int>(timeOfDay / MicrosecondsPerMinute % 60);
+            seconds = static_cast<int>(timeOfDay / MicrosecondsPerSecond % 60);
+            microseconds = static_cast<int>(timeOfDay % MicrosecondsPerSecond);
+        }
 
-    bool DateTimeData::operator ==(const DateTimeData& rhs) const
-    {
-        return  m_tm.tm_year == rhs.m_tm.tm_year &&
-                m_tm.tm_mon == rhs.m_tm.tm_mon &&
-                m_tm.tm_mday == rhs.m_tm.tm_mday &&
-                m_tm.tm_hour == rhs.m_tm.tm_hour &&
-                m_tm.tm_min == rhs.m_tm.tm_min &&
-                m_tm.tm_sec == rhs.m_tm.tm_sec;
-    }
+        CivilTime(const struct tm& tm)
+            : year(tm.tm_year + 1900), month(static_cast<unsigned>(tm.tm_mon + 1)), day(static_cast<unsigned>(tm.tm_mday)),
+              hours(tm.tm_hour), minutes(tm.tm_min), seconds(tm.tm_sec), microseconds(0)
+        {
+        }
 
-    bool DateTimeData::operator !=(const DateTimeData& rhs) const
-    {
-        return !(*this == rhs);
-    }
+        CivilTime()
+            : year(1970), month(1), day(1), hours(0), minutes(0), seconds(0), microseconds(0)
+        {
+        }
 
-    int DateTimeData::year() const
-    {
-        return m_tm.tm_year + 1900;
-    }
+        CivilTime(int y, EMonth mo, int d, int h, int m, int s, int us = 0)
+            : year(y), month(static_cast<unsigned>(mo) + 1), day(static_cast<unsigned>(d)),
+              hours(h), minutes(m), seconds(s), microseconds(us)
+        {
+        }
 
-    EMonth DateTimeData::month() const
-    {
-        switch (m_tm.tm_mon)
+        /** Clamps day to the length of the month, used after year or month arithmetic */
+        void clampDay()
         {
-        case 0:  return January;
-        case 1:  return February;
-        case 2:  return March;
-        case 3:  return April;
-        case 4:  return May;
-        case 5:  return June;
-        case 6:  return July;
-        case 7:  return August;
-        case 8:  return September;
-        case 9:  return October;
-        case 10: return Novermber;
-        case 11: return December;
-        default: throw std::invalid_argument("Invalid tm_mon");
+            unsigned last = daysInMonth(year, month);
+            if (day > last) day = last;
         }
 
-        return static_cast<EMonth>(m_tm.tm_mon);
-    }
+        /** Checks parts for consistency, returns description of the first error found or nullptr */
+        const char *validate() const
+        {
+            if (year < -MaxYear || year > MaxYear)
+                return "Incorrect year";
+            if (month < 1 || month > 12)
+                return "Incorrect month";
+            if (day < 1 || day > daysInMonth(year, month))
+                return "Incorrect day of month";
+            if (hours < 0 || hours > 23)
+                return "Incorrect hours";
+            if (minutes < 0 || minutes > 59)
+                return "Incorrect minutes";
+            if (seconds < 0 || seconds > 60) // leap second
+                return "Incorrect seconds";
+            if (microseconds < 0 || microseconds >= MicrosecondsPerSecond)
+                return "Incorrect microseconds";
+            return nullptr;
+        }
 
-    int DateTimeData::day() const
-    {
-        return m_tm.tm_mday;
-    }
+        /** Composes parts into the DateTime value without validation */
+        int64_t compose() const
+        {
+            return daysFromCivil(year, month, day) * MicrosecondsPerDay + hours * MicrosecondsPerHour +
+                    minutes * MicrosecondsPerMinute + seconds * MicrosecondsPerSecond + microseconds;
+        }
 
-#ifndef _MSC_VER
-    EDayOfWeek DateTimeData::dayOfWeek() const
-    {
-        switch (m_tm.tm_wday)
+        /** Validates parts and composes them into the DateTime value */
+        int64_t value() const
         {
-        case 0:  return Sunday;
-        case 1:  return Monday;
-        case 2:  return Tuesday;
-        case 3:  return Wednesday;
-        case 4:  return Thursday;
-        case 5:  return Friday;
-        case 6:  return Sataday;
-        default: throw std::invalid_argument("Invalid tm_wday");
+            if (const char *error = validate())
+                throw std::invalid_argument(error);
+            return compose();
         }
-    }
-#endif
 
-    int DateTimeData::hours() const
+        struct tm toTm() const
+        {
+            struct tm tm = emptyTm();
+            tm.tm_year = year - 1900;
+            tm.tm_mon = static_cast<int>(month) - 1;
+            tm.tm_mday = static_cast<int>(day);
+            tm.tm_hour = hours;
+            tm.tm_min = minutes;
+            tm.tm_sec = seconds;
+            int64_t days = daysFromCivil(year, month, day);
+            tm.tm_wday = static_cast<int>(days - floorDiv(days + 4, 7) * 7 + 4);
+            tm.tm_yday = static_cast<int>(days - daysFromCivil(year, 1, 1));
+            tm.tm_isdst = -1;
+            return tm;
+        }
+    };
+
+    inline bool isDigit(char ch)
     {
-        return m_tm.tm_hour;
+        return static_cast<unsigned>(ch - '0') < 10;
     }
 
-    int DateTimeData::minutes() const
+    /** Reads a two-digit field, lenient mode also accepts a single digit */
+    inline bool readField(const char *&p, const char *last, bool lenient, int& value)
     {
-        return m_tm.tm_min;
+        if (p == last || !isDigit(*p))
+            return false;
+        value = *p++ - '0';
+        if (p != last && isDigit(*p))
+            value = value * 10 + (*p++ - '0');
+        else if (!lenient)
+            return false;
+        return true;
     }
 
-    int DateTimeData::seconds() const
+    inline bool expect(const char *&p, const char *last, char ch)
     {
-        return m_tm.tm_sec;
+        if (p == last || *p != ch)
+            return false;
+        ++p;
+        return true;
     }
 
-    time_t DateTimeData::toStdTime() const
+    inline char *writeTwoDigits(char *p, int value)
     {
-        return mktime(const_cast<struct tm *>(&m_tm));
+        p[0] = static_cast<char>('0' + value / 10);
+        p[1] = static_cast<char>('0' + value % 10);
+        return p + 2;
     }
 
-    tm DateTimeData::toTm() const
+    inline char *writeDigits(char *p, unsigned value, unsigned count)
     {
-        return m_tm;
+        for (unsigned i = count; i > 0; --i, value /= 10)
+            p[i - 1] = static_cast<char>('0' + value % 10);
+        return p + count;
     }
 
-    String DateTimeData::toString() const
+} // namespace
+
+size_t formatDateTime(char *buffer, const DateTime& value, char separator, int utcOffset)
+{
+    CivilTime ct(value.toMicrosecondsSinceEpoch());
+    char *p = buffer;
+    unsigned year = static_cast<unsigned>(ct.year);
+    if (ct.year < 0)
     {
-        char buf[50];
-        //strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &m_tm);
-        sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d", year(), static_cast<int>(month()) + 1, day(), hours(), minutes(), seconds());
-        return buf;
+        *p++ = '-';
+        year = static_cast<unsigned>(-ct.year);
     }
-
-    String DateTimeData::toString(const char *format) const
+    if (year < 10000)
+        p = writeDigits(p, year, 4);
+    else
+        p += formatNumber(p, static_cast<uint32_t>(year));
+    *p++ = '-';
+    p = writeTwoDigits(p, static_cast<int>(ct.month));
+    *p++ = '-';
+    p = writeTwoDigits(p, static_cast<int>(ct.day));
+    *p++ = separator;
+    p = writeTwoDigits(p, ct.hours);
+    *p++ = ':';
+    p = writeTwoDigits(p, ct.minutes);
+    *p++ = ':';
+    p = writeTwoDigits(p, ct.seconds);
+    if (ct.microseconds)
     {
-        for (size_t bufSize = 50; ; bufSize += (size_t)(0.3 * bufSize))
-        {
-            char *buf = reinterpret_cast<char *>(alloca(bufSize));
-            size_t size = strftime(buf, bufSize, format, &m_tm);
-            if (size) return String(buf, size);
-        }
+        *p++ = '.';
+        if (ct.microseconds % 1000)
+            p = writeDigits(p, static_cast<unsigned>(ct.microseconds), 6);
+        else
+            p = writeDigits(p, static_cast<unsigned>(ct.microseconds / 1000), 3);
     }
-
-    void DateTimeData::fromString(const char *isoString)
+    if (utcOffset == 0)
+        *p++ = 'Z';
+    else if (utcOffset != NoUtcOffset)
     {
-        return fromString(isoString, "%Y-%m-%d %H:%M:%S");
+        *p++ = utcOffset < 0 ? '-' : '+';
+        unsigned offset = static_cast<unsigned>(utcOffset < 0 ? -utcOffset : utcOffset);
+        p = writeTwoDigits(p, static_cast<int>(offset / 60 % 100));
+        *p++ = ':';
+        p = writeTwoDigits(p, static_cast<int>(offset % 60));
     }
-
-    void DateTimeData::fromString(const char *str, const char *format)
+    return p - buffer;
+}
+
+const char *parseDateTime(const char *first, const char *last, DateTime& value, int& utcOffset, EDateTimeParseMode mode)
+{
+    const bool lenient = mode == eDateTimeLenient;
+    const char *p = first;
+    CivilTime ct;
+
+    bool negative = false;
+    if (lenient && p != last && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    // four digit year, lenient mode allows expanded representation up to six digits
+    const char *yearStart = p;
+    int year = 0;
+    for (; p != last && isDigit(*p) && p - yearStart < (lenient ? 6 : 4); ++p)
+        year = year * 10 + (*p - '0');
+    if (p - yearStart < 4)
+        return nullptr;
+    ct.year = negative ? -year : year;
+
+    int month, day;
+    if (!expect(p, last, '-') || !readField(p, last, lenient, month) ||
+            !expect(p, last, '-') || !readField(p, last, lenient, day))
+        return nullptr;
+    ct.month = static_cast<unsigned>(month);
+    ct.day = static_cast<unsigned>(day);
+
+    if (p == last || !(*p == 'T' || *p == ' ' || (lenient && *p == 't')))
+        return nullptr;
+    ++p;
+    if (!readField(p, last, lenient, ct.hours) || !expect(p, last, ':') ||
+            !readField(p, last, lenient, ct.minutes) || !expect(p, last, ':') ||
+            !readField(p, last, lenient, ct.seconds))
+        return nullptr;
+
+    if (p != last && (*p == '.' || (lenient && *p == ',')))
     {
-        const char *res = strptime(str, format, &m_tm);
-        if (NULL == res || *res)
-            throw std::invalid_argument(String(String(str) + " is not a datetime in specified format").c_str());
+        ++p;
+        if (p == last || !isDigit(*p))
+            return nullptr;
+        // digits beyond microseconds are truncated
+        int digits = 0;
+        for (; p != last && isDigit(*p); ++p, ++digits)
+            if (digits < 6)
+                ct.microseconds = ct.microseconds * 10 + (*p - '0');
+        for (; digits < 6; ++digits)
+            ct.microseconds *= 10;
     }
 
-    SharedDataBase *DateTimeData::clone() const
+    utcOffset = NoUtcOffset;
+    if (p != last && (*p == 'Z' || (lenient && *p == 'z')))
     {
-        return new DateTimeData(m_tm);
+        utcOffset = 0;
+        ++p;
+    }
+    else if (p != last && (*p == '+' || *p == '-'))
+    {
+        bool negativeOffset = *p++ == '-';
+        int offsetHours, offsetMinutes = 0;
+        if (!readField(p, last, false, offsetHours))
+            return nullptr;
+        if (lenient)
+        {
+            // +hh, +hhmm and +hh:mm
+            const char *mark = p;
+            expect(p, last, ':');
+            if (!readField(p, last, false, offsetMinutes))
+            {
+                p = mark;
+                offsetMinutes = 0;
+            }
+        }
+        else if (!expect(p, last, ':') || !readField(p, last, false, offsetMinutes))
+            return nullptr;
+        if (offsetHours > 23 || offsetMinutes > 59)
+            return nullptr;
+        utcOffset = (offsetHours * 60 + offsetMinutes) * (negativeOffset ? -1 : 1);
     }
 
+    if (ct.validate())
+        return nullptr;
+    value = DateTime::fromMicrosecondsSinceEpoch(ct.compose());
+    return p;
+}
 
-} // namespace detail
+DateTime::DateTime(time_t stdTime)
+    : m_value(TimeZone::local().toLocal(fromStdTimeUtc(stdTime)).m_value)
+{
+}
 
-DateTime::DateTime(detail::DateTimeData *d)
-    : SharedDataPointer(d)
+DateTime::DateTime(int y, EMonth mo, int d, int h, int m, int s)
+    : m_value(CivilTime(y, mo, d, h, m, s).value())
 {
 }
 
-DateTime::DateTime(time_t stdTime)
-    : SharedDataPointer(new detail::DateTimeData(stdTime))
+DateTime::DateTime()
+    : m_value(InvalidValue)
 {
+}
 
+bool DateTime::valid() const
+{
+    return m_value != InvalidValue;
 }
 
-DateTime::DateTime(int y, EMonth mo, int d, int h, int m, int s)
+bool DateTime::operator==(const DateTime& rhs) const
 {
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d", y, static_cast<int>(mo) + 1, d, h, m, s);
-    *this = fromString(buf);
+    return m_value == rhs.m_value;
 }
 
-DateTime::DateTime()
+bool DateTime::operator!=(const DateTime& rhs) const
 {
+    return m_value != rhs.m_value;
 }
 
-DateTime::~DateTime()
+bool DateTime::operator<(const DateTime& rhs) const
 {
+    return m_value < rhs.m_value;
 }
 
-bool DateTime::valid() const
+bool DateTime::operator<=(const DateTime& rhs) const
 {
-    return m_d != nullptr;
+    return m_value <= rhs.m_value;
 }
 
-bool DateTime::operator==(const DateTime& rhs) const
+bool DateTime::operator>(const DateTime& rhs) const
 {
-    if (!valid() || !rhs.valid())
-        return valid() == rhs.valid();
-    return *m_d == *rhs.m_d;
+    return m_value > rhs.m_value;
 }
 
-bool DateTime::operator!=(const DateTime& rhs) const
+bool DateTime::operator>=(const DateTime& rhs) const
 {
-    return !(*this == rhs);
+    return m_value >= rhs.m_value;
 }
 
 int DateTime::year() const
 {
-    return getData()->year();
+    int y;
+    unsigned m, d;
+    civilFromDays(floorDiv(value(), MicrosecondsPerDay), y, m, d);
+    return y;
 }
 
 EMonth DateTime::month() const
 {
-    return getData()->month();
+    int y;
+    unsigned m, d;
+    civilFromDays(floorDiv(value(), MicrosecondsPerDay), y, m, d);
+    return static_cast<EMonth>(m - 1);
 }
 
 int DateTime::day() const
 {
-    return getData()->day();
+    int y;
+    unsigned m, d;
+    civilFromDays(floorDiv(value(), MicrosecondsPerDay), y, m, d);
+    return static_cast<int>(d);
 }
 
-#ifndef _MSC_VER
 EDayOfWeek DateTime::dayOfWeek() const
 {
-    return getData()->dayOfWeek();
+    // 1970-01-01 was Thursday
+    int64_t days = floorDiv(value(), MicrosecondsPerDay) + Thursday;
+    return static_cast<EDayOfWeek>(days - floorDiv(days, 7) * 7);
 }
-#endif
 
 int DateTime::hours() const
 {
-    return getData()->hours();
+    int64_t v = value();
+    return static_cast<int>((v - floorDiv(v, MicrosecondsPerDay) * MicrosecondsPerDay) / MicrosecondsPerHour);
 }
 
 int DateTime::minutes() const
 {
-    return getData()->minutes();
+    int64_t v = value();
+    return static_cast<int>((v - floorDiv(v, MicrosecondsPerHour) * MicrosecondsPerHour) / MicrosecondsPerMinute);
 }
 
 int DateTime::seconds() const
 {
-    return getData()->seconds();
+    int64_t v = value();
+    return static_cast<int>((v - floorDiv(v, MicrosecondsPerMinute) * MicrosecondsPerMinute) / MicrosecondsPerSecond);
 }
 
-DateTime &DateTime::addYears(int years)
+int DateTime::microseconds() const
 {
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            getData()->year() + years,
-            static_cast<int>(getData()->month()) + 1,
-            getData()->day(),
-            getData()->hours(),
-            getData()->minutes(),
-            getData()->seconds());
+    int64_t v = value();
+    return static_cast<int>(v - floorDiv(v, MicrosecondsPerSecond) * MicrosecondsPerSecond);
+}
 
-    return *this = fromString(buf);
+DateTime &DateTime::addYears(int years)
+{
+    return addMonths(years * 12);
 }
 
 DateTime &DateTime::addMonths(int months)
 {
-    char buf[50];
-    int m = static_cast<int>(getData()->month()) + months;
-    int y = getData()->year();
-    if (m < 0)
-    {
-        y -= m / 12 + 1;
-        m = 12 + (m % 12);
-    }
-    else
-    {
-        y += m / 12;
-        m %= 12;
-    }
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            y,
-            m + 1,
-            getData()->day(),
-            getData()->hours(),
-            getData()->minutes(),
-            getData()->seconds());
-
-    return *this = fromString(buf);
+    CivilTime ct(value());
+    int64_t total = static_cast<int64_t>(ct.year) * 12 + ct.month - 1 + months;
+    int64_t y = floorDiv(total, 12);
+    if (y < -MaxYear || y > MaxYear)
+        throw std::invalid_argument("Incorrect year");
+    ct.year = static_cast<int>(y);
+    ct.month = static_cast<unsigned>(total - y * 12) + 1;
+    ct.clampDay();
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::addDays(int days)
 {
-    return addSeconds(days * 24 * 60 * 60);
+    // the product overflows for the largest numbers of days
+    if (days > std::numeric_limits<int64_t>::max() / MicrosecondsPerDay ||
+            days < -std::numeric_limits<int64_t>::max() / MicrosecondsPerDay)
+        throw std::invalid_argument("Incorrect year");
+    return addMicroseconds(days * MicrosecondsPerDay);
 }
 
 DateTime &DateTime::addHours(int hours)
 {
-    return addSeconds(hours * 60 * 60);
+    return addMicroseconds(hours * MicrosecondsPerHour);
 }
 
 DateTime &DateTime::addMinutes(int minutes)
 {
-    return addSeconds(minutes * 60);
+    return addMicroseconds(minutes * MicrosecondsPerMinute);
 }
 
 DateTime &DateTime::addSeconds(int seconds)
 {
-    time_t time = getData()->toStdTime();
-    time += seconds;
-    if (!this->m_d->deref())
-        delete this->m_d;
-    this->m_d = new detail::DateTimeData(time);
+    return addMicroseconds(seconds * MicrosecondsPerSecond);
+}
+
+DateTime &DateTime::addMicroseconds(int64_t microseconds)
+{
+    int64_t v = value();
+    // the sum is checked before being computed, the minimal int64_t is reserved for invalid value
+    if (microseconds > 0 ? v > std::numeric_limits<int64_t>::max() - microseconds :
+                           v < std::numeric_limits<int64_t>::min() + 1 - microseconds)
+        throw std::invalid_argument("Incorrect year");
+    v += microseconds;
+    if (v < MinValue || v > MaxValue)
+        throw std::invalid_argument("Incorrect year");
+    m_value = v;
     return *this;
 }
 
 DateTime &DateTime::setYear(int year)
 {
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            year,
-            static_cast<int>(getData()->month()) + 1,
-            getData()->day(),
-            getData()->hours(),
-            getData()->minutes(),
-            getData()->seconds());
-
-    return *this = fromString(buf);
+    CivilTime ct(value());
+    ct.year = year;
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setMonth(EMonth month)
 {
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            getData()->year(),
-            static_cast<int>(month) + 1,
-            getData()->day(),
-            getData()->hours(),
-            getData()->minutes(),
-            getData()->seconds());
-
-    return *this = fromString(buf);
+    CivilTime ct(value());
+    ct.month = static_cast<unsigned>(month) + 1;
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setDay(int day)
 {
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            getData()->year(),
-            static_cast<int>(getData()->month()) + 1,
-            day,
-            getData()->hours(),
-            getData()->minutes(),
-            getData()->seconds());
-
-    return *this = fromString(buf);
+    CivilTime ct(value());
+    ct.day = static_cast<unsigned>(day);
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setYMD(int year, EMonth month, int day)
 {
-    if (day < 1 || day > 31)
-        throw std::invalid_argument("Incorrect day of month");
-    int h = 0, m = 0, s = 0;
-    if (m_d)
-    {
-        h = m_d->hours();
-        m = m_d->minutes();
-        s = m_d->seconds();
-    }
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d", year, static_cast<int>(month) + 1, day, h, m, s);
-    return *this = fromString(buf);
+    CivilTime ct(valid() ? m_value : 0);
+    ct.year = year;
+    ct.month = static_cast<unsigned>(month) + 1;
+    ct.day = static_cast<unsigned>(day);
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setHours(int hours)
 {
-    if (hours < 0 || hours > 23)
-        throw std::invalid_argument("Incorrect hours");
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            getData()->year(),
-            static_cast<int>(getData()->month()) + 1,
-            getData()->day(),
-            hours,
-            getData()->minutes(),
-            getData()->seconds());
-
-    return *this = fromString(buf);
+    CivilTime ct(value());
+    ct.hours = hours;
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setMinutes(int minutes)
 {
-    if (minutes < 0 || minutes > 59)
-        throw std::invalid_argument("Incorrect minutes");
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            getData()->year(),
-            static_cast<int>(getData()->month()) + 1,
-            getData()->day(),
-            getData()->hours(),
-            minutes,
-            getData()->seconds());
-
-    return *this = fromString(buf);
+    CivilTime ct(value());
+    ct.minutes = minutes;
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setSeconds(int seconds)
 {
-    if (seconds < 0 || seconds > 60) // leap second
-        throw std::invalid_argument("Incorrect minutes");
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            getData()->year(),
-            static_cast<int>(getData()->month()) + 1,
-            getData()->day(),
-            getData()->hours(),
-            getData()->minutes(),
-            seconds);
+    CivilTime ct(value());
+    ct.seconds = seconds;
+    m_value = ct.value();
+    return *this;
+}
 
-    return *this = fromString(buf);
+DateTime &DateTime::setMicroseconds(int microseconds)
+{
+    CivilTime ct(value());
+    ct.microseconds = microseconds;
+    m_value = ct.value();
+    return *this;
 }
 
 DateTime &DateTime::setHMS(int hour, int minute, int second)
 {
-    if (hour < 0 || hour > 23)
-        throw std::invalid_argument("Incorrect hours");
-    if (minute < 0 || minute > 59)
-        throw std::invalid_argument("Incorrect minutes");
-    if (second < 0 || second > 60) // leap second
-        throw std::invalid_argument("Incorrect minutes");
-    int y = getData()->year(), m = static_cast<int>(getData()->month()) + 1, d = getData()->day();
-    char buf[50];
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d", y, m, d, hour, minute, second);
-    return *this = fromString(buf);
-
+    CivilTime ct(value());
+    ct.hours = hour;
+    ct.minutes = minute;
+    ct.seconds = second;
+    ct.microseconds = 0;
+    m_value = ct.value();
+    return *this;
 }
 
-detail::DateTimeData *DateTime::getData() const
+int64_t DateTime::value() const
 {
-    if (!m_d)
+    if (!valid())
         throw std::runtime_error("DateTime is invalid");
-    return m_d;
+    return m_value;
 }
 
 time_t DateTime::toStdTime() const
 {
-    return getData()->toStdTime();
+    return TimeZone::local().toUtc(*this).toStdTimeUtc();
+}
+
+time_t DateTime::toStdTimeUtc() const
+{
+    return static_cast<time_t>(floorDiv(value(), MicrosecondsPerSecond));
+}
+
+int64_t DateTime::toMicrosecondsSinceEpoch() const
+{
+    return value();
 }
 
 String DateTime::toString() const
 {
-    return getData()->toString();
+    char buf[DateTimeBufferSize];
+    return String(buf, formatDateTime(buf, *this));
 }
 
 String DateTime::toString(const char *format) const
 {
-    return getData()->toString(format);
+    struct tm tm = CivilTime(value()).toTm();
+    for (size_t bufSize = 50; ; bufSize += (size_t)(0.3 * bufSize))
+    {
+        char *buf = reinterpret_cast<char *>(alloca(bufSize));
+        size_t size = strftime(buf, bufSize, format, &tm);
+        if (size) return String(buf, size);
+    }
 }
 
 DateTime DateTime::fromString(const char *isoString)
 {
-    DateTime res(new detail::DateTimeData());
-    res.m_d->fromString(isoString);
+    const char *last = isoString + strlen(isoString);
+    DateTime res;
+    int utcOffset;
+    const char *end = parseDateTime(isoString, last, res, utcOffset, eDateTimeLenient);
+    if (end != last)
+        throw std::invalid_argument(String(String(isoString) + " is not a datetime in ISO format").c_str());
+    if (utcOffset != NoUtcOffset)
+        res.addMinutes(-utcOffset);
     return res;
 }
 
 DateTime DateTime::fromString(const char *string, const char *format)
 {
-    DateTime res(new detail::DateTimeData());
-    res.m_d->fromString(string, format);
+    struct tm tm = emptyTm();
+    tm.tm_mday = 1;
+    const char *res = strptime(string, format, &tm);
+    if (NULL == res || *res)
+        throw std::invalid_argument(String(String(string) + " is not a datetime in specified format").c_str());
+    return fromMicrosecondsSinceEpoch(CivilTime(tm).value());
+}
+
+DateTime DateTime::fromMicrosecondsSinceEpoch(int64_t microseconds)
+{
+    DateTime res;
+    res.m_value = microseconds;
     return res;
 }
 
+DateTime DateTime::fromStdTimeUtc(time_t stdTime)
+{
+    // keep the same range of years as the calendar constructors do
+    const int64_t maxSeconds = (MaxYear - 1970) * int64_t(365) * 24 * 60 * 60;
+    if (stdTime < -maxSeconds || stdTime > maxSeconds)
+        throw std::invalid_argument("stdTime");
+    return fromMicrosecondsSinceEpoch(stdTime * MicrosecondsPerSecond);
+}
+
 DateTime DateTime::now()
 {
     return DateTime(time(NULL));
 }
 
+DateTime DateTime::nowUtc()
+{
+    return fromStdTimeUtc(time(NULL));
+}
+
 std::ostream &operator<<(std::ostream &stream, const DateTime &dt)
 {
     return stream << dt.toString();
 }
 
 } // namespace metacpp
-
@@ -17,8 +17,9 @@
 #define METACPP_DATETIME_H
 #include "config.h"
 #include <time.h>
+#include <cstdint>
+#include <climits>
 #include "StringBase.h"
-#include "SharedDataPointer.h"
 
 namespace metacpp {
 
@@ -54,48 +55,71 @@ enum EDayOfWeek
 namespace detail
 {
 
-    class DateTimeData : public SharedDataBase
+    /** \brief Integer division rounding towards negative infinity */
+    inline int64_t floorDiv(int64_t a, int64_t b)
     {
-    public:
-        explicit DateTimeData(time_t stdTime = 0);
-        explicit DateTimeData(const struct tm& tm);
-        ~DateTimeData();
-
-        bool operator==(const DateTimeData& rhs) const;
-        bool operator!=(const DateTimeData& rhs) const;
-
-        int year() const;
-        EMonth month() const;
-        int day() const;
-#ifndef _MSC_VER
-        EDayOfWeek dayOfWeek() const;
-#endif
-        int hours() const;
-        int minutes() const;
-        int seconds() const;
-
-        time_t toStdTime() const;
-        struct tm toTm() const;
-        String toString() const;
-        String toString(const char *format) const;
-
-        SharedDataBase *clone() const override;
-
-        void fromString(const char *isoString);
-        void fromString(const char *str, const char *format);
-    private:
-        struct tm m_tm;
-    };
+        return a / b - (a % b < 0);
+    }
+
+    /*
+     * Conversions between days since 1970-01-01 and proleptic Gregorian dates, see
+     * H. Hinnant "chrono-Compatible Low-Level Date Algorithms". Years are shifted to begin
+     * in March, so the leap day becomes the last one in the year and no lookup tables are needed.
+     */
+
+    /** \brief Gets number of days since 1970-01-01, month is 1-based */
+    inline int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+    {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+        const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+    }
+
+    /** \brief Gets date from number of days since 1970-01-01, month is 1-based */
+    inline void civilFromDays(int64_t days, int& year, unsigned& month, unsigned& day)
+    {
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+        const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned mp = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        year = static_cast<int>(era * 400 + yearOfEra + (month <= 2));
+    }
+
+    /** \brief Checks whether the year is leap in Gregorian calendar */
+    inline bool isLeapYear(int year)
+    {
+        return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    }
+
+    /** \brief Gets number of days in the month, month is 1-based */
+    inline unsigned daysInMonth(int year, unsigned month)
+    {
+        static const unsigned char days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+    }
 
 } // namespace detail
 
-/** \brief A class representing date and time in Gregorian calendar and providing methods of manipulation */
-class DateTime final : protected SharedDataPointer<detail::DateTimeData>
+/** \brief A class representing date and time in Gregorian calendar and providing methods of manipulation
+ *
+ * The value is stored inline as a number of microseconds elapsed since 1970-01-01 00:00:00 of the
+ * same calendar (i.e. without regard to time zones), all the calendar arithmetic is done in integers.
+ * Leap seconds are not represented, the 60th second rolls over into the next minute.
+ */
+class DateTime final
 {
-    explicit DateTime(detail::DateTimeData *d);
 public:
     /** \brief Constructs new instance of DateTime from given Unix time
-     * (number of seconds since 1970-01-01)
+     * (number of seconds since 1970-01-01 UTC) converted to the local time zone
+     *
+     * \see TimeZone::local, fromStdTimeUtc
     */
     explicit DateTime(time_t stdTime);
 
@@ -103,7 +127,6 @@ public:
 
     /** \brief Constructs invalid instance of DateTime */
     DateTime();
-    ~DateTime();
 
     /** \brief Checks whether this is a valid DateTime */
     bool valid() const;
@@ -112,6 +135,14 @@ public:
     bool operator==(const DateTime& rhs) const;
     /** \brief Checks DateTimes for inequality */
     bool operator!=(const DateTime& rhs) const;
+    /** \brief Checks whether this DateTime precedes the other one. Invalid DateTime precedes any valid. */
+    bool operator<(const DateTime& rhs) const;
+    /** \brief Checks whether this DateTime precedes or equals to the other one */
+    bool operator<=(const DateTime& rhs) const;
+    /** \brief Checks whether this DateTime follows the other one */
+    bool operator>(const DateTime& rhs) const;
+    /** \brief Checks whether this DateTime follows or equals to the other one */
+    bool operator>=(const DateTime& rhs) const;
 
     /** \brief Gets a year part */
     int year() const;
@@ -119,20 +150,26 @@ public:
     EMonth month() const;
     /** \brief Gets a day of the month part */
     int day() const;
-#ifndef _MSC_VER
     /** \brief Gets a day of the week part */
     EDayOfWeek dayOfWeek() const;
-#endif
     /** \brief Gets an hour part (from 0 to 23) */
     int hours() const;
     /** \brief Gets a minute part (from 0 to 59) */
     int minutes() const;
     /** \brief Gets a second part (from 0 to 59) */
     int seconds() const;
+    /** \brief Gets a microsecond part (from 0 to 999999) */
+    int microseconds() const;
 
-    /** \brief Adds given number of years to the value stored in this instance of DateTime and returns a reference to it */
+    /** \brief Adds given number of years to the value stored in this instance of DateTime and returns a reference to it
+     *
+     * The day of month is clamped to the length of the resulting month.
+     */
     DateTime& addYears(int years);
-    /** \brief Adds given number of months to the value stored in this instance of DateTime and returns a reference to it */
+    /** \brief Adds given number of months to the value stored in this instance of DateTime and returns a reference to it
+     *
+     * The day of month is clamped to the length of the resulting month.
+     */
     DateTime& addMonths(int months);
     /** \brief Adds given number of days to the value stored in this instance of DateTime and returns a reference to it */
     DateTime& addDays(int days);
@@ -142,7 +179,9 @@ public:
     DateTime& addMinutes(int minutes);
     /** \brief Adds given number of seconds to the value stored in this instance of DateTime and returns a reference to it */
     DateTime& addSeconds(int seconds);
-    
+    /** \brief Adds given number of microseconds to the value stored in this instance of DateTime and returns a reference to it */
+    DateTime& addMicroseconds(int64_t microseconds);
+
     /** \brief Sets year part */
     DateTime& setYear(int year);
     /** \brief Sets month part */
@@ -157,12 +196,22 @@ public:
     DateTime& setMinutes(int minutes);
     /** \brief Sets a second part (from 0 to 59) */
     DateTime& setSeconds(int seconds);
+    /** \brief Sets a microsecond part (from 0 to 999999) */
+    DateTime& setMicroseconds(int microseconds);
     /** \brief Sets time in a form of hour, minute, second */
     DateTime& setHMS(int hour, int minute, int second);
 
-    /** \brief Converts stored date and time value to the Unix time */
+    /** \brief Converts stored date and time value in the local time zone to the Unix time */
     time_t toStdTime() const;
-    /** \brief Converts stored date and time to string into ISO format */
+    /** \brief Converts stored date and time value in UTC to the Unix time */
+    time_t toStdTimeUtc() const;
+    /** \brief Gets number of microseconds elapsed since 1970-01-01 00:00:00 to the stored date and time */
+    int64_t toMicrosecondsSinceEpoch() const;
+    /** \brief Converts stored date and time to string into ISO format
+     *
+     * The string has form of "YYYY-MM-DD hh:mm:ss", fractional part of seconds is appended if not zero.
+     * \see formatDateTime
+     */
     String toString() const;
     /** \brief Converts stored date and time to string in specified format
      *
@@ -170,19 +219,68 @@ public:
     */
     String toString(const char *format) const;
 
-    /** \brief Returns a new instance of DateTime from the given string in ISO format */
+    /** \brief Returns a new instance of DateTime from the given string in ISO format
+     *
+     * The string is parsed in eDateTimeLenient mode. Date and time with UTC offset specified are converted to UTC.
+     * \see parseDateTime
+     */
     static DateTime fromString(const char *isoString);
     /** \brief Returns a new instance of DateTime from the given string in specified format
      *
      * \arg format As specified in strftime(3)
     */
     static DateTime fromString(const char *string, const char *format);
+    /** \brief Returns a new instance of DateTime from number of microseconds elapsed since 1970-01-01 00:00:00 */
+    static DateTime fromMicrosecondsSinceEpoch(int64_t microseconds);
+    /** \brief Returns a new instance of DateTime from the Unix time without time zone conversion, i.e. in UTC */
+    static DateTime fromStdTimeUtc(time_t stdTime);
     /** \brief Returns a new instance of DateTime from local date and type set in the system */
     static DateTime now();
+    /** \brief Returns a new instance of DateTime with current date and time in UTC */
+    static DateTime nowUtc();
 private:
-    detail::DateTimeData *getData() const;
+    int64_t value() const;
+
+    int64_t m_value;
 };
 
+/** \brief Strictness of the ISO-8601 date and time parser */
+enum EDateTimeParseMode
+{
+    /** \brief Accepts RFC 3339 form "YYYY-MM-DDThh:mm:ss[.f][Z|+hh:mm]" only, a space may be used instead of 'T' */
+    eDateTimeStrict,
+    /** \brief Additionally accepts one digit month, day and time parts, signed and expanded years,
+     * lowercase 't' and 'z', comma as a decimal separator and UTC offsets in form of +hh and +hhmm
+     */
+    eDateTimeLenient
+};
+
+/** \brief Size of the buffer sufficient for any string written by formatDateTime */
+static const size_t DateTimeBufferSize = 40;
+
+/** \brief Value of UTC offset meaning that the offset is not specified */
+static const int NoUtcOffset = INT_MIN;
+
+/** \brief Writes date and time in ISO-8601 format into the buffer and returns number of characters written
+ *
+ * Fractional part of seconds is written with millisecond or microsecond precision if not zero.
+ * The buffer should be at least DateTimeBufferSize characters long, the result is not null-terminated.
+ * \arg separator Character separating date and time, ' ' or 'T'
+ * \arg utcOffset Offset from UTC in minutes to append, zero offset is written as 'Z'
+ */
+size_t formatDateTime(char *buffer, const DateTime& value, char separator = ' ', int utcOffset = NoUtcOffset);
+
+/** \brief Parses ISO-8601 date and time at the beginning of the range [first, last)
+ *
+ * Digits of the fractional part beyond microseconds are truncated. The value receives date and time as written,
+ * the UTC offset is not applied to it.
+ * \arg utcOffset Receives offset from UTC in minutes or NoUtcOffset if the offset is not specified
+ * \returns pointer to the first character after the date and time or nullptr if the range does not
+ * start with a valid date and time
+ */
+const char *parseDateTime(const char *first, const char *last, DateTime& value, int& utcOffset,
+                          EDateTimeParseMode mode = eDateTimeStrict);
+
 /** \brief Serializes DateTime into stream using ISO format
  * \relates metacpp::DateTime
 */
@@ -18,6 +18,7 @@
 #include "config.h"
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 /** \brief Basic type wrapper for representing optionally set values */
 template<typename T>
@@ -27,6 +28,10 @@ public:
     template<typename... Args>
     Nullable(Args&&... args) : m_isSet(sizeof...(args) != 0), m_value(args...) {}
     Nullable(const Nullable& other) { *this = other; }
+    // exact matches for the non-const and rvalue references, otherwise the variadic constructor would be taken
+    Nullable(Nullable& other) : Nullable(static_cast<const Nullable&>(other)) {}
+    Nullable(Nullable&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : m_isSet(other.m_isSet), m_value(std::move(other.m_value)) {}
     Nullable(const T& value) : m_isSet(true), m_value(value) {}
 
     typename std::enable_if<std::is_copy_assignable<T>::value, Nullable>::type& operator=(const Nullable& other)
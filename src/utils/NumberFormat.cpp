@@ -0,0 +1,685 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "NumberFormat.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace metacpp
+{
+
+static const char digitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+static size_t formatUnsigned(char *buffer, uint64_t value)
+{
+    char digits[20];
+    char *p = digits + sizeof(digits);
+    while (value >= 100)
+    {
+        unsigned i = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--p = digitPairs[i + 1];
+        *--p = digitPairs[i];
+    }
+    if (value >= 10)
+    {
+        unsigned i = static_cast<unsigned>(value) * 2;
+        *--p = digitPairs[i + 1];
+        *--p = digitPairs[i];
+    }
+    else
+        *--p = static_cast<char>('0' + value);
+    size_t length = digits + sizeof(digits) - p;
+    memcpy(buffer, p, length);
+    return length;
+}
+
+static size_t formatSigned(char *buffer, int64_t value)
+{
+    if (value < 0)
+    {
+        *buffer = '-';
+        return formatUnsigned(buffer + 1, 0 - static_cast<uint64_t>(value)) + 1;
+    }
+    return formatUnsigned(buffer, static_cast<uint64_t>(value));
+}
+
+size_t formatNumber(char *buffer, int32_t value)
+{
+    return formatSigned(buffer, value);
+}
+
+size_t formatNumber(char *buffer, uint32_t value)
+{
+    return formatUnsigned(buffer, value);
+}
+
+size_t formatNumber(char *buffer, int64_t value)
+{
+    return formatSigned(buffer, value);
+}
+
+size_t formatNumber(char *buffer, uint64_t value)
+{
+    return formatUnsigned(buffer, value);
+}
+
+static const char *skipSpaces(const char *p, const char *last)
+{
+    while (p != last && (*p == ' ' || (*p >= '\t' && *p <= '\r')))
+        ++p;
+    return p;
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static const char *parseMagnitude(const char *p, const char *last, uint64_t limit, uint64_t& result)
+{
+    const char *start = p;
+    uint64_t r = 0;
+    for (; p != last && isDigit(*p); ++p)
+    {
+        unsigned digit = static_cast<unsigned>(*p - '0');
+        if (r > (limit - digit) / 10)
+            return nullptr;
+        r = r * 10 + digit;
+    }
+    if (p == start)
+        return nullptr;
+    result = r;
+    return p;
+}
+
+template<typename T>
+static const char *parseSigned(const char *first, const char *last, T& value)
+{
+    const char *p = skipSpaces(first, last);
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+    uint64_t magnitude;
+    p = parseMagnitude(p, last, limit, magnitude);
+    if (!p)
+        return nullptr;
+    if (negative && magnitude)
+        value = static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
+    else
+        value = static_cast<T>(magnitude);
+    return p;
+}
+
+template<typename T>
+static const char *parseUnsigned(const char *first, const char *last, T& value)
+{
+    const char *p = skipSpaces(first, last);
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    uint64_t magnitude;
+    p = parseMagnitude(p, last, std::numeric_limits<T>::max(), magnitude);
+    // only zero may be negative
+    if (!p || (negative && magnitude))
+        return nullptr;
+    value = static_cast<T>(magnitude);
+    return p;
+}
+
+const char *parseNumber(const char *first, const char *last, int32_t& value)
+{
+    return parseSigned(first, last, value);
+}
+
+const char *parseNumber(const char *first, const char *last, uint32_t& value)
+{
+    return parseUnsigned(first, last, value);
+}
+
+const char *parseNumber(const char *first, const char *last, int64_t& value)
+{
+    return parseSigned(first, last, value);
+}
+
+const char *parseNumber(const char *first, const char *last, uint64_t& value)
+{
+    return parseUnsigned(first, last, value);
+}
+
+namespace
+{
+    template<typename T>
+    struct FloatTraits;
+
+    template<>
+    struct FloatTraits<double>
+    {
+        // integers up to 2^53 and powers of ten up to 10^22 are exact doubles
+        static const uint64_t maxExactMantissa = 1ULL << 53;
+        static const int maxExactPower = 22;
+        static const int maxPrecision = 17;
+        static const uint64_t maxIntegral = 1000000000000000ULL;
+        static double strto(const char *str) { return strtod(str, nullptr); }
+    };
+
+    template<>
+    struct FloatTraits<float>
+    {
+        static const uint64_t maxExactMantissa = 1ULL << 24;
+        static const int maxExactPower = 10;
+        static const int maxPrecision = 9;
+        static const uint64_t maxIntegral = 1000000ULL;
+        static float strto(const char *str) { return strtof(str, nullptr); }
+    };
+
+    const double exactPowersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    bool matchesWord(const char *p, const char *last, const char *word)
+    {
+        for (; *word; ++p, ++word)
+            if (p == last || (*p | 0x20) != *word)
+                return false;
+        return true;
+    }
+
+    char localeDecimalPoint()
+    {
+        const char *point = localeconv()->decimal_point;
+        return point && *point ? *point : '.';
+    }
+} // anonymous namespace
+
+template<typename T>
+static const char *parseFloat(const char *first, const char *last, T& value)
+{
+    typedef FloatTraits<T> Traits;
+
+    const char *p = skipSpaces(first, last);
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    if (matchesWord(p, last, "inf"))
+    {
+        p += 3;
+        if (matchesWord(p, last, "inity"))
+            p += 5;
+        value = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+        return p;
+    }
+    if (matchesWord(p, last, "nan"))
+    {
+        value = negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+        return p + 3;
+    }
+
+    const char *start = p;
+    uint64_t mantissa = 0;
+    int numDigits = 0, exponent = 0;
+    bool hasDigits = false, truncated = false;
+    for (; p != last && isDigit(*p); ++p)
+    {
+        hasDigits = true;
+        unsigned digit = static_cast<unsigned>(*p - '0');
+        if (numDigits < 19)
+        {
+            mantissa = mantissa * 10 + digit;
+            if (mantissa) ++numDigits;
+        }
+        else
+        {
+            ++exponent;
+            truncated = truncated || digit;
+        }
+    }
+    if (p != last && *p == '.')
+    {
+        const char *fraction = ++p;
+        for (; p != last && isDigit(*p); ++p)
+        {
+            unsigned digit = static_cast<unsigned>(*p - '0');
+            if (numDigits < 19)
+            {
+                mantissa = mantissa * 10 + digit;
+                if (mantissa) ++numDigits;
+                --exponent;
+            }
+            else
+                truncated = truncated || digit;
+        }
+        hasDigits = hasDigits || p != fraction;
+    }
+    // a single point is not a number
+    if (!hasDigits)
+        return nullptr;
+
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool negativeExp = false;
+        if (q != last && (*q == '-' || *q == '+'))
+            negativeExp = *q++ == '-';
+        if (q != last && isDigit(*q))
+        {
+            int exp = 0;
+            for (; q != last && isDigit(*q); ++q)
+                if (exp < 100000) exp = exp * 10 + (*q - '0');
+            exponent += negativeExp ? -exp : exp;
+            p = q;
+        }
+    }
+
+    T result;
+    if (!mantissa)
+        result = T(0);
+    else if (!truncated && mantissa <= Traits::maxExactMantissa &&
+             exponent >= -Traits::maxExactPower && exponent <= Traits::maxExactPower)
+    {
+        // both operands are exact, so the single rounding gives a correct result
+        result = static_cast<T>(mantissa);
+        if (exponent < 0)
+            result /= static_cast<T>(exactPowersOfTen[-exponent]);
+        else
+            result *= static_cast<T>(exactPowersOfTen[exponent]);
+    }
+    else
+    {
+        // slow path: correctly rounded libc conversion with decimal point of the current locale
+        const size_t length = p - start;
+        char local[64];
+        std::string heap;
+        char *buffer = local;
+        if (length >= sizeof(local))
+        {
+            heap.resize(length + 1);
+            buffer = &heap[0];
+        }
+        memcpy(buffer, start, length);
+        buffer[length] = 0;
+        char *point = static_cast<char *>(memchr(buffer, '.', length));
+        if (point)
+            *point = localeDecimalPoint();
+        result = Traits::strto(buffer);
+        if (std::isinf(result))
+            return nullptr;
+    }
+    value = negative ? -result : result;
+    return p;
+}
+
+const char *parseNumber(const char *first, const char *last, float& value)
+{
+    return parseFloat(first, last, value);
+}
+
+const char *parseNumber(const char *first, const char *last, double& value)
+{
+    return parseFloat(first, last, value);
+}
+
+namespace
+{
+    /** Floating point number represented as f * 2^e with a 64-bit significand (Grisu2 by F. Loitsch) */
+    struct DiyFp
+    {
+        uint64_t f;
+        int e;
+
+        DiyFp(uint64_t f = 0, int e = 0) : f(f), e(e) { }
+
+        DiyFp operator-(const DiyFp& rhs) const
+        {
+            return DiyFp(f - rhs.f, e);
+        }
+
+        DiyFp operator*(const DiyFp& rhs) const
+        {
+            const uint64_t M32 = 0xFFFFFFFFu;
+            const uint64_t a = f >> 32, b = f & M32, c = rhs.f >> 32, d = rhs.f & M32;
+            const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+            uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+            tmp += 1u << 31; // round
+            return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+        }
+
+        DiyFp normalize() const
+        {
+            DiyFp res = *this;
+            while (!(res.f & (1ULL << 63)))
+            {
+                res.f <<= 1;
+                res.e--;
+            }
+            return res;
+        }
+    };
+
+    // normalized 10^k for k = -348, -340, ..., 340
+    const DiyFp cachedPowers[] = {
+    { 0xFA8FD5A0081C0288ULL, -1220 }, { 0xBAAEE17FA23EBF76ULL, -1193 }, { 0x8B16FB203055AC76ULL, -1166 }, { 0xCF42894A5DCE35EAULL, -1140 },
+    { 0x9A6BB0AA55653B2DULL, -1113 }, { 0xE61ACF033D1A45DFULL, -1087 }, { 0xAB70FE17C79AC6CAULL, -1060 }, { 0xFF77B1FCBEBCDC4FULL, -1034 },
+    { 0xBE5691EF416BD60CULL, -1007 }, { 0x8DD01FAD907FFC3CULL, -980 }, { 0xD3515C2831559A83ULL, -954 }, { 0x9D71AC8FADA6C9B5ULL, -927 },
+    { 0xEA9C227723EE8BCBULL, -901 }, { 0xAECC49914078536DULL, -874 }, { 0x823C12795DB6CE57ULL, -847 }, { 0xC21094364DFB5637ULL, -821 },
+    { 0x9096EA6F3848984FULL, -794 }, { 0xD77485CB25823AC7ULL, -768 }, { 0xA086CFCD97BF97F4ULL, -741 }, { 0xEF340A98172AACE5ULL, -715 },
+    { 0xB23867FB2A35B28EULL, -688 }, { 0x84C8D4DFD2C63F3BULL, -661 }, { 0xC5DD44271AD3CDBAULL, -635 }, { 0x936B9FCEBB25C996ULL, -608 },
+    { 0xDBAC6C247D62A584ULL, -582 }, { 0xA3AB66580D5FDAF6ULL, -555 }, { 0xF3E2F893DEC3F126ULL, -529 }, { 0xB5B5ADA8AAFF80B8ULL, -502 },
+    { 0x87625F056C7C4A8BULL, -475 }, { 0xC9BCFF6034C13053ULL, -449 }, { 0x964E858C91BA2655ULL, -422 }, { 0xDFF9772470297EBDULL, -396 },
+    { 0xA6DFBD9FB8E5B88FULL, -369 }, { 0xF8A95FCF88747D94ULL, -343 }, { 0xB94470938FA89BCFULL, -316 }, { 0x8A08F0F8BF0F156BULL, -289 },
+    { 0xCDB02555653131B6ULL, -263 }, { 0x993FE2C6D07B7FACULL, -236 }, { 0xE45C10C42A2B3B06ULL, -210 }, { 0xAA242499697392D3ULL, -183 },
+    { 0xFD87B5F28300CA0EULL, -157 }, { 0xBCE5086492111AEBULL, -130 }, { 0x8CBCCC096F5088CCULL, -103 }, { 0xD1B71758E219652CULL, -77 },
+    { 0x9C40000000000000ULL, -50 }, { 0xE8D4A51000000000ULL, -24 }, { 0xAD78EBC5AC620000ULL, 3 }, { 0x813F3978F8940984ULL, 30 },
+    { 0xC097CE7BC90715B3ULL, 56 }, { 0x8F7E32CE7BEA5C70ULL, 83 }, { 0xD5D238A4ABE98068ULL, 109 }, { 0x9F4F2726179A2245ULL, 136 },
+    { 0xED63A231D4C4FB27ULL, 162 }, { 0xB0DE65388CC8ADA8ULL, 189 }, { 0x83C7088E1AAB65DBULL, 216 }, { 0xC45D1DF942711D9AULL, 242 },
+    { 0x924D692CA61BE758ULL, 269 }, { 0xDA01EE641A708DEAULL, 295 }, { 0xA26DA3999AEF774AULL, 322 }, { 0xF209787BB47D6B85ULL, 348 },
+    { 0xB454E4A179DD1877ULL, 375 }, { 0x865B86925B9BC5C2ULL, 402 }, { 0xC83553C5C8965D3DULL, 428 }, { 0x952AB45CFA97A0B3ULL, 455 },
+    { 0xDE469FBD99A05FE3ULL, 481 }, { 0xA59BC234DB398C25ULL, 508 }, { 0xF6C69A72A3989F5CULL, 534 }, { 0xB7DCBF5354E9BECEULL, 561 },
+    { 0x88FCF317F22241E2ULL, 588 }, { 0xCC20CE9BD35C78A5ULL, 614 }, { 0x98165AF37B2153DFULL, 641 }, { 0xE2A0B5DC971F303AULL, 667 },
+    { 0xA8D9D1535CE3B396ULL, 694 }, { 0xFB9B7CD9A4A7443CULL, 720 }, { 0xBB764C4CA7A44410ULL, 747 }, { 0x8BAB8EEFB6409C1AULL, 774 },
+    { 0xD01FEF10A657842CULL, 800 }, { 0x9B10A4E5E9913129ULL, 827 }, { 0xE7109BFBA19C0C9DULL, 853 }, { 0xAC2820D9623BF429ULL, 880 },
+    { 0x80444B5E7AA7CF85ULL, 907 }, { 0xBF21E44003ACDD2DULL, 933 }, { 0x8E679C2F5E44FF8FULL, 960 }, { 0xD433179D9C8CB841ULL, 986 },
+    { 0x9E19DB92B4E31BA9ULL, 1013 }, { 0xEB96BF6EBADF77D9ULL, 1039 }, { 0xAF87023B9BF0EE6BULL, 1066 }
+    };
+
+    const uint64_t powersOfTen[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+    };
+
+    /** Returns cached power c = 10^k such that w * c has binary exponent in [-60, -32] */
+    DiyFp getCachedPower(int e, int& k)
+    {
+        const double dk = (-61 - e) * 0.30102999566398114 + 347; // 1 / log2(10)
+        int ik = static_cast<int>(dk);
+        if (dk - ik > 0.0)
+            ++ik;
+        const unsigned index = static_cast<unsigned>((ik >> 3) + 1);
+        k = -(-348 + static_cast<int>(index << 3));
+        return cachedPowers[index];
+    }
+
+    int countDecimalDigits(uint32_t n)
+    {
+        int count = 1;
+        while (n >= 10 && count < 10)
+        {
+            n /= 10;
+            ++count;
+        }
+        return count;
+    }
+
+    void grisuRound(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t wpw)
+    {
+        while (rest < wpw && delta - rest >= tenKappa &&
+               (rest + tenKappa < wpw || wpw - rest > rest + tenKappa - wpw))
+        {
+            buffer[length - 1]--;
+            rest += tenKappa;
+        }
+    }
+
+    /** Generates the shortest digits of W lying between Mp - delta and Mp */
+    int digitGen(const DiyFp& W, const DiyFp& Mp, uint64_t delta, char *buffer, int& k)
+    {
+        const DiyFp one(1ULL << -Mp.e, Mp.e);
+        const DiyFp wpw = Mp - W;
+        uint32_t p1 = static_cast<uint32_t>(Mp.f >> -one.e);
+        uint64_t p2 = Mp.f & (one.f - 1);
+        int kappa = countDecimalDigits(p1);
+        int length = 0;
+        while (kappa > 0)
+        {
+            const uint32_t divisor = static_cast<uint32_t>(powersOfTen[kappa - 1]);
+            const uint32_t d = p1 / divisor;
+            p1 %= divisor;
+            if (d || length)
+                buffer[length++] = static_cast<char>('0' + d);
+            kappa--;
+            const uint64_t rest = (static_cast<uint64_t>(p1) << -one.e) + p2;
+            if (rest <= delta)
+            {
+                k += kappa;
+                grisuRound(buffer, length, delta, rest, powersOfTen[kappa] << -one.e, wpw.f);
+                return length;
+            }
+        }
+        for (;;)
+        {
+            p2 *= 10;
+            delta *= 10;
+            const char d = static_cast<char>(p2 >> -one.e);
+            if (d || length)
+                buffer[length++] = static_cast<char>('0' + d);
+            p2 &= one.f - 1;
+            kappa--;
+            if (p2 < delta)
+            {
+                k += kappa;
+                const int index = -kappa;
+                grisuRound(buffer, length, delta, p2, one.f, wpw.f * (index < 20 ? powersOfTen[index] : 0));
+                return length;
+            }
+        }
+    }
+
+    /** Writes the shortest digits of a finite positive value, the value equals digits * 10^k */
+    template<typename T>
+    int grisu2(T value, char *buffer, int& k)
+    {
+        typedef typename std::conditional<sizeof(T) == sizeof(uint64_t), uint64_t, uint32_t>::type Bits;
+        const int significandBits = std::numeric_limits<T>::digits - 1;
+        const int exponentBias = std::numeric_limits<T>::max_exponent - 1 + significandBits;
+        const uint64_t hiddenBit = 1ULL << significandBits;
+
+        Bits bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const int biasedExponent = static_cast<int>(bits >> significandBits);
+        const uint64_t significand = bits & (hiddenBit - 1);
+        DiyFp v = biasedExponent ? DiyFp(significand + hiddenBit, biasedExponent - exponentBias)
+                                 : DiyFp(significand, 1 - exponentBias);
+
+        // boundaries m- and m+ halfway to the neighbouring values
+        DiyFp plus((v.f << 1) + 1, v.e - 1);
+        while (!(plus.f & (hiddenBit << 1)))
+        {
+            plus.f <<= 1;
+            plus.e--;
+        }
+        plus.f <<= 64 - significandBits - 2;
+        plus.e -= 64 - significandBits - 2;
+        DiyFp minus = v.f == hiddenBit ? DiyFp((v.f << 2) - 1, v.e - 2) : DiyFp((v.f << 1) - 1, v.e - 1);
+        minus.f <<= minus.e - plus.e;
+        minus.e = plus.e;
+
+        const DiyFp cmk = getCachedPower(plus.e, k);
+        const DiyFp W = v.normalize() * cmk;
+        DiyFp Wp = plus * cmk;
+        DiyFp Wm = minus * cmk;
+        Wm.f++;
+        Wp.f--;
+        return digitGen(W, Wp, Wp.f - Wm.f, buffer, k);
+    }
+
+    size_t writeExponent(char *buffer, int exponent)
+    {
+        char *p = buffer;
+        *p++ = 'e';
+        if (exponent < 0)
+        {
+            *p++ = '-';
+            exponent = -exponent;
+        }
+        else
+            *p++ = '+';
+        // at least two digits like printf does
+        if (exponent < 10)
+            *p++ = '0';
+        return p - buffer + formatUnsigned(p, static_cast<uint64_t>(exponent));
+    }
+} // anonymous namespace
+
+template<typename T>
+static size_t formatFloat(char *buffer, T value)
+{
+    typedef FloatTraits<T> Traits;
+
+    if (std::isnan(value))
+    {
+        const char *str = std::signbit(value) ? "-nan" : "nan";
+        size_t length = strlen(str);
+        memcpy(buffer, str, length);
+        return length;
+    }
+    if (std::isinf(value))
+    {
+        const char *str = value < 0 ? "-inf" : "inf";
+        size_t length = strlen(str);
+        memcpy(buffer, str, length);
+        return length;
+    }
+    char *p = buffer;
+    if (std::signbit(value))
+    {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == T(0))
+    {
+        *p++ = '0';
+        return p - buffer;
+    }
+    // integral values are written as is
+    if (value < static_cast<T>(Traits::maxIntegral) && value == std::trunc(value))
+        return p - buffer + formatUnsigned(p, static_cast<uint64_t>(value));
+
+    char digits[20];
+    int k;
+    const int length = grisu2(value, digits, k);
+    // decimal exponent of the first digit, notation is chosen the same way as %g does
+    const int exponent = length + k - 1;
+    if (exponent < -4 || exponent >= Traits::maxPrecision)
+    {
+        *p++ = digits[0];
+        if (length > 1)
+        {
+            *p++ = '.';
+            memcpy(p, digits + 1, length - 1);
+            p += length - 1;
+        }
+        p += writeExponent(p, exponent);
+    }
+    else if (exponent < 0)
+    {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = exponent + 1; i < 0; ++i)
+            *p++ = '0';
+        memcpy(p, digits, length);
+        p += length;
+    }
+    else if (exponent + 1 >= length)
+    {
+        memcpy(p, digits, length);
+        p += length;
+        for (int i = length; i <= exponent; ++i)
+            *p++ = '0';
+    }
+    else
+    {
+        memcpy(p, digits, exponent + 1);
+        p += exponent + 1;
+        *p++ = '.';
+        memcpy(p, digits + exponent + 1, length - exponent - 1);
+        p += length - exponent - 1;
+    }
+    return p - buffer;
+}
+
+size_t formatNumber(char *buffer, float value)
+{
+    return formatFloat(buffer, value);
+}
+
+size_t formatNumber(char *buffer, double value)
+{
+    return formatFloat(buffer, value);
+}
+
+namespace detail
+{
+
+template<typename TChar, typename TNumber>
+void parseNumberString(const TChar *str, size_t length, TNumber& value)
+{
+    char local[64];
+    std::string heap;
+    const char *first;
+    if (std::is_same<TChar, char>::value)
+        first = reinterpret_cast<const char *>(str);
+    else
+    {
+        // numbers are pure ascii, anything else just stops the parser
+        char *buffer = local;
+        if (length > sizeof(local))
+        {
+            heap.resize(length);
+            buffer = &heap[0];
+        }
+        for (size_t i = 0; i < length; ++i)
+            buffer[i] = static_cast<uint32_t>(str[i]) < 0x80 ? static_cast<char>(str[i]) : '\x7f';
+        first = buffer;
+    }
+    if (!length || !parseNumber(first, first + length, value))
+        throw std::invalid_argument("String is not convertible to a number of the requested type");
+}
+
+template void parseNumberString(const char *, size_t, int32_t&);
+template void parseNumberString(const char *, size_t, uint32_t&);
+template void parseNumberString(const char *, size_t, int64_t&);
+template void parseNumberString(const char *, size_t, uint64_t&);
+template void parseNumberString(const char *, size_t, float&);
+template void parseNumberString(const char *, size_t, double&);
+template void parseNumberString(const char16_t *, size_t, int32_t&);
+template void parseNumberString(const char16_t *, size_t, uint32_t&);
+template void parseNumberString(const char16_t *, size_t, int64_t&);
+template void parseNumberString(const char16_t *, size_t, uint64_t&);
+template void parseNumberString(const char16_t *, size_t, float&);
+template void parseNumberString(const char16_t *, size_t, double&);
+
+} // namespace detail
+
+} // namespace metacpp
@@ -0,0 +1,101 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef NUMBERFORMAT_H
+#define NUMBERFORMAT_H
+#include "config.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace metacpp
+{
+
+/** \brief Size of the buffer sufficient for any number written by formatNumber */
+static const size_t NumberBufferSize = 32;
+
+/** \brief Writes decimal representation of the value into the buffer and returns number of characters written
+ *
+ * The buffer should be at least NumberBufferSize characters long, the result is not null-terminated.
+ */
+size_t formatNumber(char *buffer, int32_t value);
+size_t formatNumber(char *buffer, uint32_t value);
+size_t formatNumber(char *buffer, int64_t value);
+size_t formatNumber(char *buffer, uint64_t value);
+/** \brief Writes the shortest representation of the value which parses back to the same float
+ *
+ * Digits are generated with Grisu2, which yields the shortest output for the vast majority
+ * of values and a round-trip one for the rest.
+ */
+size_t formatNumber(char *buffer, float value);
+/** \brief Writes the shortest representation of the value which parses back to the same double */
+size_t formatNumber(char *buffer, double value);
+
+/** \brief Parses a number at the beginning of the range [first, last)
+ *
+ * Leading whitespace and an optional sign are skipped, parsing stops at the first character
+ * not belonging to the number. Floating point parser also accepts "inf", "infinity" and "nan"
+ * regardless of case. Locale settings are ignored, the decimal point is always '.'.
+ * \returns pointer to the first character after the number or nullptr if the range does not
+ * start with a number or the number does not fit into the value
+ */
+const char *parseNumber(const char *first, const char *last, int32_t& value);
+const char *parseNumber(const char *first, const char *last, uint32_t& value);
+const char *parseNumber(const char *first, const char *last, int64_t& value);
+const char *parseNumber(const char *first, const char *last, uint64_t& value);
+const char *parseNumber(const char *first, const char *last, float& value);
+const char *parseNumber(const char *first, const char *last, double& value);
+
+namespace detail
+{
+    /** \brief Maps an arithmetic type onto the type handled by formatNumber/parseNumber
+     *
+     * Character types, bool and long double are not handled (type is void)
+     */
+    template<typename T, typename = void>
+    struct NumberFormatType
+    {
+        typedef void type;
+    };
+
+    template<typename T>
+    struct NumberFormatType<T, typename std::enable_if<std::is_integral<T>::value &&
+            !std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+            !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+            !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value &&
+            !std::is_same<T, char32_t>::value>::type>
+    {
+        typedef typename std::conditional<std::is_signed<T>::value,
+            typename std::conditional<(sizeof(T) <= sizeof(int32_t)), int32_t, int64_t>::type,
+            typename std::conditional<(sizeof(T) <= sizeof(uint32_t)), uint32_t, uint64_t>::type>::type type;
+    };
+
+    template<> struct NumberFormatType<float> { typedef float type; };
+    template<> struct NumberFormatType<double> { typedef double type; };
+
+    /** \brief Parses the whole string as a number throwing std::invalid_argument on failure */
+    template<typename TChar, typename TNumber>
+    void parseNumberString(const TChar *str, size_t length, TNumber& value);
+
+    template<typename T>
+    struct IsFormattableNumber : std::integral_constant<bool,
+            !std::is_void<typename NumberFormatType<T>::type>::value>
+    {
+    };
+} // namespace detail
+
+} // namespace metacpp
+
+#endif // NUMBERFORMAT_H
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <type_traits>
 #include <memory>
+#include <stdexcept>
 
 namespace metacpp
 {
@@ -43,16 +43,20 @@ namespace metacpp
             if (m_d) m_d->ref();
         }
 
-        SharedDataPointer(SharedDataPointer&& other)
+        SharedDataPointer(SharedDataPointer&& other) noexcept
+            : m_d(other.m_d)
         {
-            *this = std::move(other);
+            other.m_d = nullptr;
         }
 
-        SharedDataPointer& operator=(SharedDataPointer&& rhs)
+        SharedDataPointer& operator=(SharedDataPointer&& rhs) noexcept
         {
-            clear();
-            m_d = rhs.m_d;
-            rhs.clear();
+            if (this != &rhs)
+            {
+                clear();
+                m_d = rhs.m_d;
+                rhs.m_d = nullptr;
+            }
             return *this;
         }
 
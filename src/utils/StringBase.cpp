@@ -15,28 +15,20 @@
 ****************************************************************************/
 #include "StringBase.h"
 #include "Variant.h"
+#include "Unicode.h"
+#include "DateTime.h"
 #include <climits>
 #include <locale>
 #include <iomanip>
 #include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 #ifdef _WIN32
-#include <windows.h>
-
 // compatibility workaround
 #define snprintf _snprintf
-
-// breaks numeric limits
-#ifdef max
-#undef max
-#endif
-#ifdef min
-#undef min
-#endif
-#else
-
-#include <iconv.h>
-
 #endif // _WIN32
 
 namespace metacpp
@@ -116,10 +108,9 @@ namespace detail
     template<>
     int StringHelper<char16_t>::strcasecmp(const char16_t *a, const char16_t *b)
     {
-        std::locale loc;
         while (true)
         {
-            int ca = std::tolower(*a, loc), cb = std::tolower(*b, loc);
+            int ca = asciiToLower(*a), cb = asciiToLower(*b);
             if (ca != cb) return ca - cb;
             if (!ca) return 0;
             ++a; ++b;
@@ -142,11 +133,10 @@ namespace detail
     template<>
     int StringHelper<char16_t>::strncasecmp(const char16_t *a, const char16_t *b, size_t size)
     {
-        std::locale loc;
         while (true)
         {
             if (!size--) break;
-            int ca = std::tolower(*a, loc), cb = std::tolower(*b, loc);
+            int ca = asciiToLower(*a), cb = asciiToLower(*b);
             if (ca != cb) return ca - cb;
             if (!ca) return 0;
             ++a; ++b;
@@ -180,22 +170,9 @@ namespace detail
     template<>
     const char16_t *StringHelper<char16_t>::strstr(const char16_t *haystack, const char16_t *needle)
     {
-        while (*haystack)
-        {
-            bool match = true;
-            for (const char16_t *p = needle, *p1 = haystack; *p && *p1; ++p, ++p1)
-            {
-                if (*p != *p1)
-                {
-                    match = false;
-                    break;
-                }
-            }
-            if (match)
-                return haystack;
-            ++haystack;
-        }
-        return nullptr;
+        const char16_t *last = haystack + strlen(haystack);
+        const char16_t *res = findSubstring(haystack, last, needle, strlen(needle));
+        return res != last || !*needle ? res : nullptr;
     }
 
 } // namespace detail
@@ -224,100 +201,25 @@ namespace detail
 
     template<>
     WString string_cast<WString>(const char *aString, size_t length) {
-#ifdef _WIN32
-        if (length != (size_t)-1)
-            length += 1;
-        int resultLength = MultiByteToWideChar(CP_ACP, 0, aString, (int)length, NULL, 0) - 1;
-        WString result(nullptr, resultLength);
-        MultiByteToWideChar(CP_ACP, 0, aString, (int)length, LPWSTR(result.begin()), resultLength + 1);
-        return result;
-#else
+        if ((size_t)-1 == length)
+            length = detail::StringHelper<char>::strlen(aString);
         WString result;
-        iconv_t cd = iconv_open("UTF-16LE", "UTF-8");
-        if ((iconv_t)-1 == cd)
-        {
-            throw std::bad_cast();
-        }
-
-        size_t inputSize = (size_t)-1 != length ? length : detail::StringHelper<char>::strlen(aString);
-
-        size_t bufLength = inputSize;
-        size_t converted = -1;
-        do {
-            result.reserve(bufLength);
-
-            size_t inputBytesLeft = inputSize;
-            size_t outputBytesLeft = bufLength * sizeof(char16_t);
-            char *inbuf = const_cast<char *>(aString);
-            char *outbuf = (char *)result.data();
-            converted = iconv(cd, &inbuf, &inputBytesLeft, &outbuf, &outputBytesLeft);
-            if ((size_t)-1 == converted && E2BIG == errno)
-            {
-                bufLength += (size_t)(0.3 * bufLength + 1); // increase buffer
-                continue;
-            }
-
-            // truncate string
-            result.resize(bufLength - outputBytesLeft / sizeof(char16_t));
-            break;
-        } while (true);
-
-        if (-1 == iconv_close(cd)) {
-            perror("iconv_close(): ");
-        }
+        result.resize(detail::utf16MaxLength(length));
+        result.resize(detail::utf8ToUtf16(aString, length, result.begin()));
         return result;
-#endif
     }
 
     template<>
     String string_cast<String>(const char16_t *wString, size_t length) {
-#ifdef _WIN32
-        if (length != (size_t)-1)
-            length += 1;
-        int resultLength = WideCharToMultiByte(CP_ACP, 0, (LPCWSTR)wString, (int)length, NULL, 0, NULL, NULL) - 1;
-        String result(nullptr, resultLength);
-        WideCharToMultiByte(CP_ACP, 0, (LPCWSTR)wString, (int)length, const_cast<char *>(result.data()), resultLength + 1, NULL, NULL);
-        return result;
-#else
-
+        if ((size_t)-1 == length)
+            length = detail::StringHelper<char16_t>::strlen(wString);
         String result;
-        iconv_t cd = iconv_open("UTF-8", "UTF-16LE");
-        if ((iconv_t)-1 == cd)
-        {
-            throw std::bad_cast();
-        }
-
-        size_t inputSize = (size_t)-1 != length ? length : detail::StringHelper<char16_t>::strlen(wString);
-
-        size_t bufLength = inputSize;
-        size_t converted = -1;
-        do {
-            result.reserve(bufLength);
-
-            size_t inputBytesLeft = inputSize * sizeof(char16_t);
-            size_t outputBytesLeft = bufLength;
-            char *inbuf = (char *)wString;
-            char *outbuf = const_cast<char *>(result.data());
-            converted = iconv(cd, &inbuf, &inputBytesLeft, &outbuf, &outputBytesLeft);
-            if ((size_t)-1 == converted && E2BIG == errno)
-            {
-                bufLength += (size_t)(0.3 * bufLength + 1); // increase buffer
-                continue;
-            }
-
-            // truncate string
-            result.resize(bufLength - outputBytesLeft);
-            break;
-        } while (true);
-
-        if (-1 == iconv_close(cd)) {
-            perror("iconv_close(): ");
-        }
+        result.resize(detail::utf8Length(wString, length));
+        detail::utf16ToUtf8(wString, length, result.begin());
         return result;
-#endif
     }
 
-template<>
+    template<>
     String string_cast<String>(const String& strA) {
         return strA;
     }
@@ -364,131 +266,500 @@ template<>
         return str;
     }
 
-    template<>
-    StringBase<char> StringBase<char>::format(const char *fmt, const VariantArray& args)
+namespace detail
+{
+    FormatArg FormatArg::fromVariant(const Variant& v)
     {
-        const char *p = fmt;
-        char buffer[256];
-        size_t i = 0;
-        String result;
-        while (*p) {
-            if (*p == '%') {
-                String subformat;
-                subformat.reserve(10);
-                subformat.append(*p);
-                if (*(p + 1) == '%')
+        switch (v.type())
+        {
+        case eFieldBool:
+            return FormatArg(variant_cast<bool>(v));
+        case eFieldInt:
+            return FormatArg(variant_cast<int32_t>(v));
+        case eFieldUint:
+            return FormatArg(variant_cast<uint32_t>(v));
+        case eFieldInt64:
+            return FormatArg(variant_cast<int64_t>(v));
+        case eFieldUint64:
+            return FormatArg(variant_cast<uint64_t>(v));
+        case eFieldFloat:
+            return FormatArg(variant_cast<float>(v));
+        case eFieldDouble:
+            return FormatArg(variant_cast<double>(v));
+        case eFieldString:
+            return FormatArg(*static_cast<const String *>(v.buffer()));
+        case eFieldDateTime:
+            return FormatArg(*static_cast<const DateTime *>(v.buffer()));
+        default:
+            // invalid variants, objects and arrays throw the same exceptions as variant_cast does
+            return FormatArg(v);
+        }
+    }
+} // namespace detail
+
+namespace
+{
+    enum EFormatFlags : unsigned char
+    {
+        eFormatLeft = 1,
+        eFormatPlus = 2,
+        eFormatSpace = 4,
+        eFormatAlternate = 8,
+        eFormatZero = 16
+    };
+
+    /** Maximum width and precision of the conversion specification */
+    const int MaxFieldWidth = 65535;
+
+    /** Gets two's complement bits of the integer value of the argument */
+    uint64_t integerArgument(const detail::FormatArg& arg)
+    {
+        switch (arg.kind())
+        {
+        case detail::FormatArg::eKindBool:
+        case detail::FormatArg::eKindUnsigned:
+            return arg.unsignedValue();
+        case detail::FormatArg::eKindSigned:
+            return static_cast<uint64_t>(arg.signedValue());
+        case detail::FormatArg::eKindFloat:
+        case detail::FormatArg::eKindDouble:
+            // out of range values (including nan) are undefined for the cast
+            return arg.doubleValue() > -9.2233720368547758e18 && arg.doubleValue() < 9.2233720368547758e18 ?
+                        static_cast<uint64_t>(static_cast<int64_t>(arg.doubleValue())) : 0;
+        case detail::FormatArg::eKindVariant:
+            return variant_cast<uint64_t>(arg.variant());
+        default:
+            throw std::invalid_argument("Argument is not convertible to an integer");
+        }
+    }
+
+    double floatingPointArgument(const detail::FormatArg& arg)
+    {
+        switch (arg.kind())
+        {
+        case detail::FormatArg::eKindBool:
+        case detail::FormatArg::eKindUnsigned:
+            return static_cast<double>(arg.unsignedValue());
+        case detail::FormatArg::eKindSigned:
+            return static_cast<double>(arg.signedValue());
+        case detail::FormatArg::eKindFloat:
+        case detail::FormatArg::eKindDouble:
+            return arg.doubleValue();
+        case detail::FormatArg::eKindVariant:
+            return variant_cast<double>(arg.variant());
+        default:
+            throw std::invalid_argument("Argument is not convertible to a floating point number");
+        }
+    }
+
+    const void *pointerArgument(const detail::FormatArg& arg)
+    {
+        switch (arg.kind())
+        {
+        case detail::FormatArg::eKindPointer:
+            return arg.pointer();
+        case detail::FormatArg::eKindVariant:
+            return arg.variant().buffer();
+        default:
+            throw std::invalid_argument("Argument is not a pointer");
+        }
+    }
+
+    /** Writes text padded to the field width */
+    void writePadded(StringBuilder& writer, const char *str, size_t length, unsigned char flags, int width)
+    {
+        size_t padding = static_cast<size_t>(width) > length ? width - length : 0;
+        if (padding && !(flags & eFormatLeft))
+            writer.append(padding, ' ');
+        writer.append(str, length);
+        if (padding && (flags & eFormatLeft))
+            writer.append(padding, ' ');
+    }
+
+    /** Writes the number padded to the field width with spaces or with zeros between the sign and digits */
+    void writeNumber(StringBuilder& writer, const char *prefix, size_t nPrefix, size_t zeros,
+                     const char *digits, size_t nDigits, unsigned char flags, int width, bool zeroPadding)
+    {
+        size_t length = nPrefix + zeros + nDigits;
+        size_t padding = static_cast<size_t>(width) > length ? width - length : 0;
+        if (padding && !(flags & eFormatLeft))
+        {
+            if ((flags & eFormatZero) && zeroPadding)
+                zeros += padding;
+            else
+                writer.append(padding, ' ');
+            padding = 0;
+        }
+        writer.append(prefix, nPrefix);
+        if (zeros) writer.append(zeros, '0');
+        writer.append(digits, nDigits);
+        if (padding) writer.append(padding, ' ');
+    }
+
+    /** Writes an integer conversion (d, i, u, o, x or X) following printf rules for flags, width and precision */
+    void writeInteger(StringBuilder& writer, uint64_t magnitude, bool negative, char conversion,
+                      unsigned char flags, int width, int precision)
+    {
+        char digits[NumberBufferSize];
+        size_t nDigits = 0;
+        bool nonzero = magnitude != 0;
+        if (nonzero || precision)
+        {
+            if ('o' == conversion || 'x' == conversion || 'X' == conversion)
+            {
+                const char *alphabet = 'X' == conversion ? "0123456789ABCDEF" : "0123456789abcdef";
+                unsigned shift = 'o' == conversion ? 3 : 4, mask = 'o' == conversion ? 7 : 15;
+                char *p = digits + sizeof(digits);
+                do *--p = alphabet[magnitude & mask]; while (magnitude >>= shift);
+                nDigits = digits + sizeof(digits) - p;
+                memmove(digits, p, nDigits);
+            }
+            else
+                nDigits = formatNumber(digits, magnitude);
+        }
+
+        char prefix[2];
+        size_t nPrefix = 0;
+        if ('d' == conversion || 'i' == conversion)
+        {
+            if (negative) prefix[nPrefix++] = '-';
+            else if (flags & eFormatPlus) prefix[nPrefix++] = '+';
+            else if (flags & eFormatSpace) prefix[nPrefix++] = ' ';
+        }
+        else if ((flags & eFormatAlternate) && nonzero && ('x' == conversion || 'X' == conversion))
+        {
+            prefix[nPrefix++] = '0';
+            prefix[nPrefix++] = conversion;
+        }
+
+        size_t zeros = precision > 0 && static_cast<size_t>(precision) > nDigits ? precision - nDigits : 0;
+        if ((flags & eFormatAlternate) && 'o' == conversion && !zeros && (!nDigits || digits[0] != '0'))
+            zeros = 1;
+        writeNumber(writer, prefix, nPrefix, zeros, digits, nDigits, flags, width, precision < 0);
+    }
+
+    /** Writes %f conversion exactly as printf does, returns false if the value should be passed to snprintf */
+    bool writeFixed(StringBuilder& writer, double value, unsigned char flags, int width, int precision)
+    {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+        if (precision < 0)
+            precision = 6;
+        if (precision > 9)
+            return false;
+        double scaled = std::fabs(value) * powers[precision];
+        // also rejects infinities and nan, fractional part of larger values is not exact
+        if (!(scaled < 4.5e15))
+            return false;
+        // the product is rounded, so if it is too close to the tie of two neighbours the exact
+        // decimal value may round another way
+        double integral = std::floor(scaled), fraction = scaled - integral;
+        if (std::fabs(fraction - 0.5) <= scaled * std::numeric_limits<double>::epsilon())
+            return false;
+        uint64_t rounded = static_cast<uint64_t>(integral) + (fraction > 0.5);
+        uint64_t divisor = static_cast<uint64_t>(powers[precision]);
+
+        char digits[NumberBufferSize * 2];
+        size_t nDigits = formatNumber(digits, rounded / divisor);
+        if (precision || (flags & eFormatAlternate))
+            digits[nDigits++] = '.';
+        for (uint64_t rest = rounded % divisor, i = precision; i--; rest /= 10)
+            digits[nDigits + i] = static_cast<char>('0' + rest % 10);
+        nDigits += precision;
+
+        char sign = std::signbit(value) ? '-' : flags & eFormatPlus ? '+' : flags & eFormatSpace ? ' ' : 0;
+        writeNumber(writer, &sign, sign ? 1 : 0, 0, digits, nDigits, flags, width, true);
+        return true;
+    }
+
+    /** Writes the value with snprintf growing the buffer if the initial guess is too short */
+    template<typename TValue>
+    void writePrintf(StringBuilder& writer, const char *spec, TValue value)
+    {
+        size_t size = 64;
+        for (;;)
+        {
+            int nChars = snprintf(writer.appendBuffer(size), size, spec, value);
+            if (nChars < 0)
+                throw std::invalid_argument("Generic format error");
+            if (static_cast<size_t>(nChars) < size)
+            {
+                writer.commit(nChars);
+                return;
+            }
+            size = nChars + 1;
+        }
+    }
+
+    /** Parses the width or precision of the conversion specification */
+    int parseFieldWidth(const char *&p)
+    {
+        int result = 0;
+        for (; *p >= '0' && *p <= '9'; ++p)
+        {
+            result = result * 10 + (*p - '0');
+            if (result > MaxFieldWidth)
+                throw std::invalid_argument("Field width in format string is too large");
+        }
+        return result;
+    }
+} // namespace
+
+    StringFormatter::StringFormatter(const char *fmt)
+        : m_argumentCount(0)
+    {
+        const char *p = fmt, *literal = fmt;
+        Segment segment;
+        for (;;)
+        {
+            if (*p && *p != '%')
+            {
+                ++p;
+                continue;
+            }
+            if (p != literal)
+            {
+                // adjacent pieces of text (split by %%) are merged
+                if (m_segments.size() && !m_segments.back().conversion)
+                    m_segments.back().literalLength += static_cast<uint32_t>(p - literal);
+                else
                 {
-                    result.append('%');
-                    p += 2;
-                    continue;
+                    memset(&segment, 0, sizeof(segment));
+                    segment.literalOffset = static_cast<uint32_t>(m_literals.size());
+                    segment.literalLength = static_cast<uint32_t>(p - literal);
+                    m_segments.push_back(segment);
                 }
-                for (;;)
+                m_literals.append(literal, p - literal);
+            }
+            if (!*p)
+                break;
+            if ('%' == p[1])
+            {
+                literal = ++p;
+                ++p;
+                continue;
+            }
+
+            memset(&segment, 0, sizeof(segment));
+            segment.precision = -1;
+            for (bool flag = true; flag; )
+            {
+                switch (*++p)
                 {
-                    EFieldType argType = eFieldVoid;
-                    ++p;
-                    switch (*p)
-                    {
-                    case 0:
-                        throw std::invalid_argument("Unexpected end of format string");
-                    default:
-                        throw std::invalid_argument("Invalid character in format string");
-                    // flags
-                    case '-':
-                    case '+':
-                    case ' ':
-                    case '#':
-                    case '0':
-                    case '1':
-                    case '2':
-                    case '3':
-                    case '4':
-                    case '5':
-                    case '6':
-                    case '7':
-                    case '8':
-                    case '9':
-                    case '.':
-                        break;
-
-                    case '*':
-                        throw std::invalid_argument("* width specified is not supported");
-
-                    // specifiers
-                    case 's':
-                        argType = eFieldString;
-                        break;
-                    case 'c':
-                        argType = eFieldInt;
-                        break;
-                    case 'd':
-                    case 'i':
-                    case 'u':
-                    case 'o':
-                    case 'x':
-                    case 'X':
-                        argType = subformat.contains("ll") ? eFieldUint64 : eFieldUint;
-                        break;
-                    case 'f':
-                    case 'F':
-                    case 'e':
-                    case 'E':
-                    case 'g':
-                    case 'G':
-                    case 'a':
-                    case 'A':
-                        argType = eFieldDouble;
-                        break;
-                    case 'p':
-                        argType = eFieldObject;
-                        break;
-                    }
-                    subformat.append(*p);
-
-                    if (argType == eFieldVoid)
-                        continue;
-                    if (i >= args.size())
-                        throw std::invalid_argument("Not enough arguments for the given format");
-                    Variant arg = args[i++];
-                    int nChars = -1;
-
-                    switch (argType)
-                    {
-                    default:
-                        throw std::invalid_argument("Unhandled argument type");
-                    case eFieldString:
-                        result.append(variant_cast<String>(arg));
-                        nChars = 0;
-                        break;
-                    case eFieldInt:
-                        nChars = snprintf(buffer, sizeof(buffer), subformat.c_str(),
-                                                       variant_cast<int32_t>(arg));
-                        break;
-                    case eFieldUint:
-                        nChars = snprintf(buffer, sizeof(buffer), subformat.c_str(),
-                                                       variant_cast<uint32_t>(arg));
-                        break;
-                    case eFieldDouble:
-                        nChars = snprintf(buffer, sizeof(buffer), subformat.c_str(),
-                                                       variant_cast<double>(arg));
-                        break;
-                    case eFieldObject:
-                        nChars = snprintf(buffer, sizeof(buffer), subformat.c_str(),
-                                                       arg.buffer());
-                        break;
-                    }
-                    if (nChars < 0)
-                        throw std::invalid_argument("Generic format error");
-                    if (nChars)
-                        result.append(buffer, nChars);
+                case '-': segment.flags |= eFormatLeft; break;
+                case '+': segment.flags |= eFormatPlus; break;
+                case ' ': segment.flags |= eFormatSpace; break;
+                case '#': segment.flags |= eFormatAlternate; break;
+                case '0': segment.flags |= eFormatZero; break;
+                default: flag = false; break;
+                }
+            }
+            if ('*' == *p)
+                throw std::invalid_argument("* width specified is not supported");
+            segment.width = parseFieldWidth(p);
+            if ('.' == *p)
+            {
+                if ('*' == *++p)
+                    throw std::invalid_argument("* width specified is not supported");
+                segment.precision = parseFieldWidth(p);
+            }
+            if ('l' == *p)
+            {
+                segment.wide = true;
+                if ('l' == *++p) ++p;
+            }
+
+            switch (*p)
+            {
+            case 0:
+                throw std::invalid_argument("Unexpected end of format string");
+            default:
+                throw std::invalid_argument("Invalid character in format string");
+            case 's': case 'c':
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            case 'p':
+                break;
+            }
+            segment.conversion = *p++;
+
+            char *spec = segment.spec;
+            *spec++ = '%';
+            if (segment.flags & eFormatLeft) *spec++ = '-';
+            if (segment.flags & eFormatPlus) *spec++ = '+';
+            if (segment.flags & eFormatSpace) *spec++ = ' ';
+            if (segment.flags & eFormatAlternate) *spec++ = '#';
+            if (segment.flags & eFormatZero) *spec++ = '0';
+            if (segment.width)
+                spec += formatNumber(spec, static_cast<int32_t>(segment.width));
+            if (segment.precision >= 0)
+            {
+                *spec++ = '.';
+                spec += formatNumber(spec, static_cast<int32_t>(segment.precision));
+            }
+            *spec++ = segment.conversion;
+            *spec = 0;
 
+            m_segments.push_back(segment);
+            ++m_argumentCount;
+            literal = p;
+        }
+    }
+
+    String StringFormatter::operator()(const VariantArray& args) const
+    {
+        static const size_t StackArgs = 16;
+        detail::FormatArg stackArgs[StackArgs];
+        Array<detail::FormatArg> heapArgs;
+        detail::FormatArg *formatArgs = stackArgs;
+        if (args.size() > StackArgs)
+        {
+            heapArgs.resize(args.size());
+            formatArgs = heapArgs.data();
+        }
+        for (size_t i = 0; i < args.size(); ++i)
+            formatArgs[i] = detail::FormatArg::fromVariant(args[i]);
+        StringBuilder result(m_literals.size() + m_argumentCount * 16);
+        appendArgs(result, formatArgs, args.size());
+        return result.take();
+    }
+
+    String StringFormatter::apply(std::initializer_list<detail::FormatArg> args) const
+    {
+        StringBuilder result(m_literals.size() + m_argumentCount * 16);
+        appendArgs(result, args.begin(), args.size());
+        return result.take();
+    }
+
+    void StringFormatter::appendTo(String& dest, std::initializer_list<detail::FormatArg> args) const
+    {
+        size_t length = dest.size();
+        StringBuilder builder(std::move(dest));
+        try
+        {
+            appendArgs(builder, args.begin(), args.size());
+        }
+        catch (...)
+        {
+            // leaves the string as it was before the call
+            builder.resize(length);
+            dest = builder.take();
+            throw;
+        }
+        dest = builder.take();
+    }
+
+    void StringFormatter::appendTo(StringBuilder& dest, std::initializer_list<detail::FormatArg> args) const
+    {
+        appendArgs(dest, args.begin(), args.size());
+    }
+
+    void StringFormatter::appendArgs(StringBuilder& writer, const detail::FormatArg *args, size_t count) const
+    {
+        if (count < m_argumentCount)
+            throw std::invalid_argument("Not enough arguments for the given format");
+        writer.reserve(writer.size() + m_literals.size() + m_argumentCount * 16);
+        const char *literals = m_literals.data();
+        const detail::FormatArg *arg = args;
+        char buffer[DateTimeBufferSize > NumberBufferSize ? DateTimeBufferSize : NumberBufferSize];
+        for (const Segment& segment : m_segments)
+        {
+            switch (segment.conversion)
+            {
+            case 0:
+                writer.append(literals + segment.literalOffset, segment.literalLength);
+                continue;
+            case 's':
+            {
+                const char *str = buffer;
+                size_t length;
+                switch (arg->kind())
+                {
+                case detail::FormatArg::eKindString:
+                    str = arg->stringData();
+                    length = arg->stringLength();
+                    break;
+                case detail::FormatArg::eKindBool:
+                    buffer[0] = arg->boolValue() ? '1' : '0';
+                    length = 1;
+                    break;
+                case detail::FormatArg::eKindSigned:
+                    length = formatNumber(buffer, arg->signedValue());
+                    break;
+                case detail::FormatArg::eKindUnsigned:
+                    length = formatNumber(buffer, arg->unsignedValue());
                     break;
+                case detail::FormatArg::eKindFloat:
+                    length = formatNumber(buffer, static_cast<float>(arg->doubleValue()));
+                    break;
+                case detail::FormatArg::eKindDouble:
+                    length = formatNumber(buffer, arg->doubleValue());
+                    break;
+                case detail::FormatArg::eKindDateTime:
+                    length = formatDateTime(buffer, arg->dateTime());
+                    break;
+                case detail::FormatArg::eKindVariant:
+                {
+                    String value = variant_cast<String>(arg->variant());
+                    writePadded(writer, value.data(), segment.precision >= 0 ?
+                                    std::min(value.size(), static_cast<size_t>(segment.precision)) : value.size(),
+                                segment.flags, segment.width);
+                    ++arg;
+                    continue;
+                }
+                default:
+                    throw std::invalid_argument("Argument is not convertible to String");
                 }
-            } else {
-                result.append(*p);
+                if (segment.precision >= 0 && length > static_cast<size_t>(segment.precision))
+                    length = segment.precision;
+                writePadded(writer, str, length, segment.flags, segment.width);
+                break;
             }
-            p++;
+            case 'c':
+                buffer[0] = static_cast<char>(integerArgument(*arg));
+                writePadded(writer, buffer, 1, segment.flags, segment.width);
+                break;
+            case 'd':
+            case 'i':
+            {
+                uint64_t bits = integerArgument(*arg);
+                int64_t value = segment.wide ? static_cast<int64_t>(bits) : static_cast<int32_t>(static_cast<uint32_t>(bits));
+                writeInteger(writer, value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value),
+                             value < 0, segment.conversion, segment.flags, segment.width, segment.precision);
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            {
+                uint64_t bits = integerArgument(*arg);
+                writeInteger(writer, segment.wide ? bits : static_cast<uint32_t>(bits), false,
+                             segment.conversion, segment.flags, segment.width, segment.precision);
+                break;
+            }
+            case 'p':
+                writePrintf(writer, segment.spec, pointerArgument(*arg));
+                break;
+            case 'f':
+            case 'F':
+            {
+                double value = floatingPointArgument(*arg);
+                if (!writeFixed(writer, value, segment.flags, segment.width, segment.precision))
+                    writePrintf(writer, segment.spec, value);
+                break;
+            }
+            default:
+                writePrintf(writer, segment.spec, floatingPointArgument(*arg));
+                break;
+            }
+            ++arg;
         }
-        return result;
+    }
+
+    template<>
+    StringBase<char> StringBase<char>::format(const char *fmt, const VariantArray& args)
+    {
+        return StringFormatter(fmt)(args);
     }
 
     template<>
@@ -497,6 +768,18 @@ template<>
         return string_cast<WString>(String::format(string_cast<String>(format).c_str(), args));
     }
 
+    template<>
+    StringBase<char> StringBase<char>::formatArgs(const char *fmt, std::initializer_list<detail::FormatArg> args)
+    {
+        return StringFormatter(fmt).apply(args);
+    }
+
+    template<>
+    StringBase<char16_t> StringBase<char16_t>::formatArgs(const char16_t *fmt, std::initializer_list<detail::FormatArg> args)
+    {
+        return string_cast<WString>(StringFormatter(string_cast<String>(fmt).c_str()).apply(args));
+    }
+
     template<>
     StringBase<char> StringBase<char>::urldecode() const
     {
@@ -518,21 +801,32 @@ template<>
             -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
             -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1
         };
+        if (isNullOrEmpty())
+            return StringBase<char>();
+        // decoded string is never longer than the source one
         StringBase<char> result;
-        result.reserve(size());
-        for (const char *p = data(); *p; ++p) {
-            if ((*p == '%') && p[1] && p[2]) {
-                const char c1 = xlat[(unsigned)p[1]], c2 = xlat[(unsigned)p[2]];
+        result.resize(size());
+        char *out = result.begin();
+        const char *p = data(), *end = p + size();
+        while (p != end) {
+            // copy runs of plain characters at once
+            size_t plain = detail::urlPlainSpan(p, end - p);
+            memcpy(out, p, plain);
+            out += plain;
+            p += plain;
+            if (p == end)
+                break;
+            if ((*p == '%') && end - p > 2) {
+                const char c1 = xlat[(unsigned char)p[1]], c2 = xlat[(unsigned char)p[2]];
                 if (c1 < 0 || c2 < 0)
                     throw std::invalid_argument("Invalid percent encoded character sequence");
-                result.append((c1 << 4) | c2);
-                p += 2;
+                *out++ = (c1 << 4) | c2;
+                p += 3;
             }
-            else if (*p == '+')
-                result.append(' ');
             else
-                result.append(*p);
+                *out++ = *p++ == '+' ? ' ' : '%';
         }
+        result.resize(out - result.data());
         return result;
     }
 
@@ -545,19 +839,33 @@ template<>
     template<>
     StringBase<char> StringBase<char>::urlencode() const
     {
-        OutputStringStream ss;
-        ss << std::hex << std::uppercase << std::setfill('0');
-
-        for (const char *p = data(); *p; ++p) {
-            if (*p == ' ')
-                ss << '+';
-            else if (isalnum(*p) || *p == '-' || *p == '_' || *p == '.' || *p == '~')
-                ss << *p;
+        static const char hexDigits[] = "0123456789ABCDEF";
+        if (isNullOrEmpty())
+            return StringBase<char>();
+        // every character takes at most three after encoding
+        StringBase<char> result;
+        result.resize(size() * 3);
+        char *out = result.begin();
+        const char *p = data(), *end = p + size();
+        while (p != end) {
+            // copy runs of unreserved characters at once
+            size_t unreserved = detail::urlUnreservedSpan(p, end - p);
+            memcpy(out, p, unreserved);
+            out += unreserved;
+            p += unreserved;
+            if (p == end)
+                break;
+            const unsigned char ch = *p++;
+            if (ch == ' ')
+                *out++ = '+';
             else {
-                ss << '%' << std::setw(2) << (int)*p;
+                *out++ = '%';
+                *out++ = hexDigits[ch >> 4];
+                *out++ = hexDigits[ch & 0xF];
             }
         }
-        return ss.str();
+        result.resize(out - result.data());
+        return result;
     }
 
     template<>
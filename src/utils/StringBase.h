@@ -18,9 +18,14 @@
 #include "config.h"
 #include <string>
 #include <stdio.h>
+#include <string.h>
 #include <wchar.h>
 #include <sstream>
 #include "Array.h"
+#include "NumberFormat.h"
+#include "StringView.h"
+#include <limits>
+#include <stdexcept>
 
 #ifdef _MSC_VER
 #define U16(str) reinterpret_cast<const char16_t *>(L##str)
@@ -35,6 +40,13 @@ template<typename T>
 class StringBase;
 
 class Variant;
+class DateTime;
+class StringFormatter;
+
+namespace detail
+{
+    class FormatArg;
+} // namespace detail
 
 /** \brief String in native system encoding (ANSI on Windows platforms and UTF-8 on linux)
  * \relates metacpp::StringBase
@@ -85,20 +97,6 @@ T string_cast(const std::basic_string<char16_t>& strW);
 namespace detail
 {
 
-    /** \brief Unified helper for manipulating C-strings */
-    template<typename T>
-    struct StringHelper
-    {
-        static size_t strlen(const T *str);
-        static int strcmp(const T *a, const T *b);
-        static int strcasecmp(const T *a, const T *b);
-        static int strncmp(const T *a, const T *b, size_t size);
-        static int strncasecmp(const T *a, const T *b, size_t size);
-        static T *strcpy(T *dest, const T *source) ;
-        static T *strncpy(T *dest, const T *source, size_t n);
-        static const T *strstr(const T *haystack, const T *needle);
-    };
-
     template<typename T>
     class StringData : public ArrayData<T>
     {
@@ -107,13 +105,13 @@ namespace detail
         static const size_t npos;
 
         StringData()
-            : m_dwLength(0)
+            : m_dwLength(0), m_hash(0)
         {
         }
 
         explicit StringData(const T *data, size_t length = npos)
             : ArrayData<T>(data, length == npos ? (data ? Helper::strlen(data) + 1 : 0) : length + 1),
-            m_dwLength(this->m_dwSize ? this->m_dwSize - 1 : 0)
+            m_dwLength(this->m_dwSize ? this->m_dwSize - 1 : 0), m_hash(0)
         {
             if (this->m_data) this->m_data[m_dwLength] = T(0);
         }
@@ -122,12 +120,8 @@ namespace detail
 
         SharedDataBase *clone() const override
         {
-            StringData *copy = new StringData();
-            copy->m_data = new T[m_dwLength + 1];
-            std::copy(this->m_data, this->m_data + m_dwLength + 1, copy->m_data);
-            copy->m_dwLength = m_dwLength;
-            copy->m_dwAllocatedSize = copy->m_dwSize = m_dwLength + 1;
-
+            StringData *copy = new StringData(this->m_data, m_dwLength);
+            copy->m_hash.store(_cachedHash(), std::memory_order_relaxed);
             return copy;
         }
 
@@ -136,6 +130,7 @@ namespace detail
             ArrayData<T>::_resize(size);
             m_dwLength = this->m_dwSize ? this->m_dwSize - 1 : 0;
             this->m_data[m_dwLength] = T(0);
+            _invalidateHash();
         }
 
         size_t _length() const { return m_dwLength;  }
@@ -149,9 +144,30 @@ namespace detail
             std::copy(data, data + length, this->m_data + m_dwLength);
             m_dwLength += length;
             this->m_data[m_dwLength] = T(0);    // null terminator
+            _invalidateHash();
+        }
+
+        /** \brief Gets hash of the string, calculating it on the first call */
+        size_t _hash() const
+        {
+            size_t h = m_hash.load(std::memory_order_relaxed);
+            if (!h)
+            {
+                // zero marks hash as not calculated yet
+                h = Helper::hash(this->m_data, m_dwLength) | 1;
+                m_hash.store(h, std::memory_order_relaxed);
+            }
+            return h;
         }
+
+        /** \brief Gets hash of the string if it was already calculated or zero otherwise */
+        size_t _cachedHash() const { return m_hash.load(std::memory_order_relaxed); }
+
+        /** \brief Resets cached hash, should be called on every modification of the string */
+        void _invalidateHash() { m_hash.store(0, std::memory_order_relaxed); }
     private:
         size_t m_dwLength;
+        mutable std::atomic<size_t> m_hash;
     };
 } // namespace detail
 
@@ -353,10 +369,9 @@ typedef StringStreamBase<char16_t> WStringStream;
  * Implementation uses copy-on-write optimization methods.
  */
 template<typename T>
-class StringBase : protected SharedDataPointer<detail::StringData<T> >
+class StringBase
 {
     typedef detail::StringData<T> Data;
-    typedef  SharedDataPointer<detail::StringData<T> > Base;
 public:
     /** \brief Random access iterator for accessing an individual character in the string (or supplementary and surrogate character) */
     typedef T *iterator;
@@ -368,73 +383,156 @@ public:
     typedef const T& const_reference;
     /** \brief Invalid/end-of-string character index */
     static const size_t npos;
+    /** \brief Maximum length of the string stored inline without a heap allocation */
+    static const size_t InlineCapacity = (3 * sizeof(void *) - 1) / sizeof(T) - 1;
 
     /** \brief Constructs new null string */
-    StringBase() { }
+    StringBase() { setTag(NullTag); }
     /** \brief Constructs new instance of StringBase using null-terminated C-string */
-    StringBase(const T *str) : Base(new Data(str)) { }
-    /** \brief Constructs new instance of StringBase from the given buffer */
-    StringBase(const T *str, size_t length) : Base(new Data(str, length)) { }
+    StringBase(const T *str) { setTag(NullTag); if (str) assign(str, detail::StringHelper<T>::strlen(str)); }
+    /** \brief Constructs new instance of StringBase from the given buffer, npos length means null-terminated C-string */
+    StringBase(const T *str, size_t length)
+    {
+        setTag(NullTag);
+        if (length != npos)
+            assign(str, length);
+        else if (str)
+            assign(str, detail::StringHelper<T>::strlen(str));
+    }
     /** \brief Constructs new instance of StringBase from the given range of characters */
     StringBase(const_iterator begin, const_iterator end) : StringBase(begin, std::distance(begin, end)) { }
     /** \brief Constructs new instance of StringBase from another instance */
-    StringBase(const StringBase& other) : Base(other) { }
+    StringBase(const StringBase& other) { copyFrom(other); }
+    /** \brief Constructs new instance of StringBase taking value of another instance, which becomes null */
+    StringBase(StringBase&& other) noexcept { moveFrom(other); }
     /** \brief Constructs new instance of StringBase from standard library string */
-    StringBase(const std::basic_string<T>& stdstr) : Base(new Data(stdstr.c_str(), stdstr.size())) { }
-    ~StringBase() { }
+    StringBase(const std::basic_string<T>& stdstr) { assign(stdstr.c_str(), stdstr.size()); }
+    /** \brief Constructs new instance of StringBase holding a copy of characters referenced by the view */
+    explicit StringBase(const StringViewBase<T>& view) : StringBase(view.data(), view.length()) { if (view.isNull()) release(); }
+    ~StringBase() { release(); }
 
     /** \brief Gets a pointer to the raw C-string buffer used to store this string */
-    const T *data() const { return this->m_d ? this->m_d->_data() : ms_empty.data(); }
+    const T *data() const { return isHeap() ? m_d->_data() : isInline() ? m_inline : ms_empty.data(); }
     /** \brief Gets a pointer to the raw C-string buffer used to store this string */
-    const T *c_str() const { return this->m_d ? this->m_d->_data() : ms_empty.data(); }
+    const T *c_str() const { return data(); }
+
+    /** \brief Gets a view of the whole string without copying */
+    operator StringViewBase<T>() const { return isNull() ? StringViewBase<T>() : StringViewBase<T>(data(), length()); }
+    /** \brief Gets a view of the part of this string without copying */
+    StringViewBase<T> view(size_t start = 0, size_t length = npos) const { return StringViewBase<T>(*this).substr(start, length); }
 
     /** \brief Checks whether this string is undefined */
-    bool isNull() const { return !this->m_d || !this->m_d->_data(); }
+    bool isNull() const { return tag() == NullTag; }
     /** \brief Checks whether this string is either undefined or empty */
-    bool isNullOrEmpty() const { return isNull() || !*this->m_d->_data(); }
+    bool isNullOrEmpty() const { return !length(); }
+
+    /** \brief Sets value of another string to this instance */
+    StringBase& operator=(const StringBase& rhs)
+    {
+        if (this != &rhs)
+        {
+            release();
+            copyFrom(rhs);
+        }
+        return *this;
+    }
+
+    /** \brief Moves value of another string to this instance, another string becomes null */
+    StringBase& operator=(StringBase&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            release();
+            moveFrom(rhs);
+        }
+        return *this;
+    }
 
     /** \brief Sets new string value to this instance from given C-string */
     StringBase& operator=(const T *rhs)
     {
-        this->clear();
-        this->m_d = new Data(rhs);
-        return *this;
+        // rhs may point into this string
+        StringBase tmp(rhs);
+        return *this = std::move(tmp);
     }
 
     /** \brief Checks two strings for equality */
     bool equals(const StringBase& rhs, bool caseSensetive = true) const
     {
-        bool hasA = !isNullOrEmpty(), hasB = !rhs.isNullOrEmpty();
-        if (hasA && hasB) return 0 == (caseSensetive ? this->m_d->_cmp(rhs.data()) : this->m_d->_icmp(rhs.data()));
-        return hasA == hasB;
+        size_t len = length();
+        if (len != rhs.length()) return false;
+        if (!len) return true;
+        if (caseSensetive)
+        {
+            // strings which hashes were already calculated are likely to differ in them
+            if (isHeap() && rhs.isHeap() && m_d->_cachedHash() && rhs.m_d->_cachedHash() &&
+                    m_d->_cachedHash() != rhs.m_d->_cachedHash())
+                return false;
+            return std::equal(data(), data() + len, rhs.data());
+        }
+        return 0 == detail::compareIgnoreCase(data(), rhs.data(), len);
     }
 
     /** \brief Checks two strings for equality */
-    bool equals(const T *rhs, bool caseSensetive = true)
+    bool equals(const T *rhs, bool caseSensetive = true) const
     {
         bool hasA = !isNullOrEmpty(), hasB = rhs && *rhs;
-        if (hasA && hasB) return 0 == (caseSensetive ? this->m_d->_cmp(rhs) : this->m_d->_icmp(rhs));
+        if (hasA && hasB) return 0 == (caseSensetive ? detail::StringHelper<T>::strcmp(data(), rhs) :
+                                                       detail::StringHelper<T>::strcasecmp(data(), rhs));
         return hasA == hasB;
     }
 
+    /** \brief Gets hash of this string
+     *
+     * Hash of a long string is calculated once and shared between all copies until modification.
+     * Null and empty strings have the same hash.
+     */
+    size_t hash() const
+    {
+        if (isHeap()) return m_d->_hash();
+        return detail::StringHelper<T>::hash(data(), length()) | 1;
+    }
+
     /** \brief Gets length of this string in characters (excluding terminating null character) */
-    size_t length() const { return this->m_d ? this->m_d->_length() : 0; }
+    size_t length() const { return isHeap() ? m_d->_length() : isInline() ? tag() : 0; }
 
     /** \brief Gets a const reference to the character at given position */
-    const_reference operator[](size_t i) const { assert(i < length()); return this->m_d->_data()[i];  }
+    const_reference operator[](size_t i) const { assert(i < length()); return data()[i];  }
     /** \brief Gets a reference to the character at given position */
-    reference operator[](size_t i) { assert(i < length()); this->detachOrInitialize(); return this->m_d->_data()[i];  }
+    reference operator[](size_t i) { assert(i < length()); return mutableData()[i];  }
 
     /** \brief Gets length of this string in characters (excluding terminating null character) */
     size_t size() const { return length(); }
     /** \brief Gets current length of the buffer used to store value of this string */
-    size_t capacity() const { return this->m_d ? this->m_d->_capacity() - 1 : 0; }
+    size_t capacity() const { return isHeap() ? m_d->_capacity() - 1 : isInline() ? InlineCapacity : 0; }
     /** \brief Ensures buffer is capable to store string value of the given length */
-    void reserve(size_t length) { this->detachOrInitialize(); this->m_d->_reserve(length + 1); }
+    void reserve(size_t length)
+    {
+        if (isNull())
+            assign(nullptr, 0);
+        if (length > capacity())
+            moveToHeap(length);
+        else
+            mutableData();
+    }
     /** \brief Squeezes buffer to it's minimum possible length capable to store current string value */
-    void squeeze() { this->detachOrInitialize(); this->m_d->_squeeze(); }
+    void squeeze() { if (isHeap()) { mutableData(); m_d->_squeeze(); } }
     /** \brief Sets string length to the given value terminating it with null character */
-    void resize(size_t size) { this->detachOrInitialize(); this->m_d->_resize(size + 1); }
+    void resize(size_t size)
+    {
+        if (isNull())
+            assign(nullptr, 0);
+        if (isInline() && size <= InlineCapacity)
+        {
+            setTag(static_cast<unsigned char>(size));
+            m_inline[size] = T(0);
+            return;
+        }
+        if (!isHeap())
+            moveToHeap(size);
+        mutableData();
+        m_d->_resize(size + 1);
+    }
 
     /** \brief Gets a reference to the first character in the string. String should not be null or empty. */
     reference front() { assert(size()); return *begin(); }
@@ -446,21 +544,42 @@ public:
     const_reference back() const { assert(size()); return *(end() - 1); }
 
     /** \brief Gets an iterator pointing to the first character in the string. */
-    iterator begin() { this->detachOrInitialize(); return isNull() ? ms_empty.begin() : this->m_d->_data(); }
+    iterator begin() { return isNull() ? const_cast<T *>(ms_empty.data()) : mutableData(); }
     /** \brief Gets an iterator pointing to the null terminating character in the string. */
-    iterator end() { this->detachOrInitialize(); return isNull() ? ms_empty.end() : (this->m_d->_data() + this->m_d->_length()); }
+    iterator end() { return begin() + length(); }
     /** \brief Gets a const iterator pointing to the first character in the string. */
-    const_iterator begin() const { return isNull() ? ms_empty.begin() : this->m_d->_data(); }
+    const_iterator begin() const { return data(); }
     /** \brief Gets a const iterator pointing to the null terminating character in the string. */
-    const_iterator end() const { return isNull() ? ms_empty.end() : (this->m_d->_data() + this->m_d->_length()); }
+    const_iterator end() const { return data() + length(); }
 
     /** \brief Appends given character buffer to this string */
     void append(const T *str, size_t length = npos)
     {
         if (str && *str)
         {
-            this->detachOrInitialize();
-            this->m_d->_append(str, length);
+            if (length == npos) length = detail::StringHelper<T>::strlen(str);
+            size_t oldLength = this->length();
+            if (!isHeap() && oldLength + length <= InlineCapacity)
+            {
+                std::copy(str, str + length, m_inline + oldLength);
+                setTag(static_cast<unsigned char>(oldLength + length));
+                m_inline[tag()] = T(0);
+                return;
+            }
+            if (!isHeap())
+            {
+                // str may point into the inline buffer which is overwritten by the heap pointer
+                Data *d = new Data();
+                d->_reserve(oldLength + length + 1);
+                d->_append(data(), oldLength);
+                d->_append(str, length);
+                release();
+                m_d = d;
+                setTag(HeapTag);
+                return;
+            }
+            mutableData();
+            m_d->_append(str, length);
         }
     }
 
@@ -489,8 +608,9 @@ public:
     {
         if (length == npos) length = detail::StringHelper<T>::strlen(str);
         if (pos >= size()) return npos;
-        auto it = std::search(begin() + pos, end(), str, str + length);
-        return it == end() ? npos : std::distance(begin(), it);
+        const T *first = data(), *last = first + size();
+        const T *it = detail::findSubstring(first + pos, last, str, length);
+        return it == last ? npos : it - first;
     }
 
     /** \brief Gets a position of the next occurence of given substring in this string starting from the specified position.
@@ -529,8 +649,9 @@ public:
     size_t lastIndexOf(const T *str, size_t length = npos) const
     {
         if (length == npos) length = detail::StringHelper<T>::strlen(str);
-        auto it = std::find_end(begin(), end(), str, str + length);
-        return it == end() ? npos : std::distance(begin(), it);
+        const T *first = data(), *last = first + size();
+        const T *it = detail::findLastSubstring(first, last, str, length);
+        return it == last ? npos : it - first;
     }
 
     /** \brief Gets a position of the last occurence of given character buffer in this string.
@@ -583,13 +704,30 @@ public:
 
     /** \brief Transforms given value to the string */
     template<typename T1>
-    static StringBase fromValue(const T1& value)
+    static typename std::enable_if<!detail::IsFormattableNumber<T1>::value, StringBase>::type
+        fromValue(const T1& value)
     {
         OutputStringStreamBase<T> ss;
         ss << value;
         return ss.str();
     }
 
+    /** \brief Transforms given number to the string without using streams
+     *
+     * Floating point numbers are written in the shortest form parsed back to the same value
+     */
+    template<typename T1>
+    static typename std::enable_if<detail::IsFormattableNumber<T1>::value, StringBase>::type
+        fromValue(const T1& value)
+    {
+        char buffer[NumberBufferSize];
+        size_t length = formatNumber(buffer, static_cast<typename detail::NumberFormatType<T1>::type>(value));
+        StringBase result;
+        result.resize(length);
+        std::copy(buffer, buffer + length, result.begin());
+        return result;
+    }
+
     static StringBase fromValue(const StringBase& value)
     {
         return value;
@@ -597,7 +735,7 @@ public:
 
     /** \brief Trys to transform this string to value of the given type */
     template<typename T1>
-    T1 toValue() const
+    typename std::enable_if<!detail::IsFormattableNumber<T1>::value, T1>::type toValue() const
     {
         T1 res;
         InputStringStreamBase<T> ss(*this);
@@ -606,6 +744,23 @@ public:
         return res;
     }
 
+    /** \brief Parses the number at the beginning of this string without using streams
+     *
+     * Leading whitespace is skipped and parsing stops at the first character which is not
+     * a part of the number. Throws std::invalid_argument if the string does not start with
+     * a number or the number does not fit into T1.
+     */
+    template<typename T1>
+    typename std::enable_if<detail::IsFormattableNumber<T1>::value, T1>::type toValue() const
+    {
+        typename detail::NumberFormatType<T1>::type result;
+        detail::parseNumberString(data(), size(), result);
+        if (std::is_integral<T1>::value &&
+                (result < std::numeric_limits<T1>::lowest() || result > std::numeric_limits<T1>::max()))
+            throw std::invalid_argument("String is not convertible to a number of the requested type");
+        return static_cast<T1>(result);
+    }
+
     /** \brief Returns array of substring in this instance delimited by given seperator */
     Array<StringBase<T> > split(T separator, bool keepEmptyElements = false) const
     {
@@ -614,7 +769,7 @@ public:
         auto b = begin(), e = end();
         while (true)
         {
-            auto ps = std::find(b, e, separator);
+            auto ps = detail::findChar(b, e, separator);
             StringBase<T> elem(b, std::distance(b, ps));
             if (keepEmptyElements || !elem.isNullOrEmpty()) result.push_back(elem);
             if (ps == e) break;
@@ -650,19 +805,130 @@ public:
         return *this;
     }
 
+    /** \brief Format string compiled once to be applied to many argument lists, \see StringFormatter */
+    typedef StringFormatter Formatter;
+
+    /** \brief Formats arguments stored in the array according to the printf-like format string
+     *
+     * Supported conversions are s, c, d, i, u, o, x, X, f, F, e, E, g, G, a, A and p with optional
+     * flags, width, precision and l/ll length modifier (integers are 32-bit without the modifier).
+     * Throws std::invalid_argument if the format is malformed or does not match the arguments.
+     */
     static StringBase format(const T *fmt, const Array<Variant>& args);
+    /** \brief Formats given arguments according to the printf-like format string without boxing them into variants */
     template<typename... TArgs>
-    static StringBase format(const T *fmt, TArgs... args) { return format(fmt, { args... }); }
+    static StringBase format(const T *fmt, const TArgs&... args);
     StringBase urlencode() const;
     StringBase urldecode() const;
 private:
+    static StringBase formatArgs(const T *fmt, std::initializer_list<detail::FormatArg> args);
+
+    enum : unsigned char
+    {
+        HeapTag = 0xFE,
+        NullTag = 0xFF
+    };
+
+    bool isInline() const { return tag() <= InlineCapacity; }
+    bool isHeap() const { return tag() == HeapTag; }
+
+    /** Sets value of this null string, short values are stored inline */
+    void assign(const T *str, size_t length)
+    {
+        if (length <= InlineCapacity)
+        {
+            if (str) std::copy(str, str + length, m_inline);
+            m_inline[length] = T(0);
+            setTag(static_cast<unsigned char>(length));
+        }
+        else
+        {
+            m_d = new Data(str, length);
+            setTag(HeapTag);
+        }
+    }
+
+    void copyFrom(const StringBase& other)
+    {
+        memcpy(m_raw, other.m_raw, sizeof(m_raw));
+        if (isHeap())
+            m_d->ref();
+    }
+
+    void moveFrom(StringBase& other)
+    {
+        memcpy(m_raw, other.m_raw, sizeof(m_raw));
+        other.setTag(NullTag);
+    }
+
+    void release()
+    {
+        if (isHeap() && !m_d->deref())
+            delete m_d;
+        setTag(NullTag);
+    }
+
+    /** Moves the value to a heap buffer of at least given capacity */
+    void moveToHeap(size_t capacity)
+    {
+        if (isHeap())
+        {
+            mutableData();
+            m_d->_reserve(capacity + 1);
+            return;
+        }
+        Data *d = new Data();
+        d->_reserve(capacity + 1);
+        d->_append(data(), length());
+        release();
+        m_d = d;
+        setTag(HeapTag);
+    }
+
+    /** Gets writable buffer detaching the shared one */
+    T *mutableData()
+    {
+        if (isHeap())
+        {
+            if (m_d->count() != 1)
+            {
+                Data *d = static_cast<Data *>(m_d->clone());
+                if (!m_d->deref()) delete m_d;
+                m_d = d;
+            }
+            m_d->_invalidateHash();
+            return m_d->_data();
+        }
+        return m_inline;
+    }
+
+    // the last byte holds length of the inline string, HeapTag or NullTag (Variant relies on this layout)
+    unsigned char tag() const { return m_raw[sizeof(m_raw) - 1]; }
+    void setTag(unsigned char tag) { m_raw[sizeof(m_raw) - 1] = tag; }
+
+    union
+    {
+        Data *m_d;
+        T m_inline[InlineCapacity + 1];
+        unsigned char m_raw[3 * sizeof(void *)];
+    };
+
     static StringBase<T> ms_null;
     static StringBase<T> ms_empty;
 };
 
+template<typename T>
+const size_t StringBase<T>::InlineCapacity;
+
 template<typename T>
 StringBase<T> StringBase<T>::ms_null;
 
+template<typename T>
+StringBase<T> StringViewBase<T>::toString() const
+{
+    return StringBase<T>(*this);
+}
+
 template<typename T>
 inline bool operator==(const StringBase<T>& lhs, const StringBase<T>& rhs) { return lhs.equals(rhs); }
 
@@ -681,6 +947,18 @@ inline bool operator==(const T *lhs, const StringBase<T>& rhs) { return rhs.equa
 template<typename T>
 inline bool operator!=(const T *lhs, const StringBase<T>& rhs) { return !rhs.equals(lhs); }
 
+template<typename T>
+inline bool operator==(const StringBase<T>& lhs, const StringViewBase<T>& rhs) { return StringViewBase<T>(lhs).equals(rhs); }
+
+template<typename T>
+inline bool operator!=(const StringBase<T>& lhs, const StringViewBase<T>& rhs) { return !StringViewBase<T>(lhs).equals(rhs); }
+
+template<typename T>
+inline bool operator==(const StringViewBase<T>& lhs, const StringBase<T>& rhs) { return lhs.equals(rhs); }
+
+template<typename T>
+inline bool operator!=(const StringViewBase<T>& lhs, const StringBase<T>& rhs) { return !lhs.equals(rhs); }
+
 /** \brief Combines strings in this array into one string delimiting them with given string */
 template<typename T>
 StringBase<T> join(const Array<StringBase<T> >& arr, const T *delim = "", size_t delimSize = (size_t)-1)
@@ -709,21 +987,355 @@ StringBase<T> join(const Array<StringBase<T> >& arr, const StringBase<T>& delim)
 typedef Array<String> StringArray;
 typedef Array<WString> WStringArray;
 
+// Array relocates elements with std::move_if_noexcept, a throwing move would fall back to copying
+static_assert(std::is_nothrow_move_constructible<String>::value, "String must be nothrow move constructible");
+static_assert(std::is_nothrow_move_constructible<WString>::value, "WString must be nothrow move constructible");
+static_assert(std::is_nothrow_move_constructible<StringArray>::value, "Array must be nothrow move constructible");
+
+/** \brief Appendable buffer for assembling a string piece by piece
+ *
+ * Unlike a chain of concatenations, which allocates a new string on every step, the builder
+ * writes into one buffer growing geometrically. The buffer may be reused for the next string
+ * after clear() or handed off to the resulting string by take() without copying.
+ */
+template<typename T>
+class StringBuilderBase
+{
+public:
+    /** \brief Constructs an empty builder without allocating a buffer */
+    StringBuilderBase() : m_data(nullptr), m_length(0), m_capacity(0) { }
+    /** \brief Constructs an empty builder with a buffer for the string of the given length */
+    explicit StringBuilderBase(size_t capacity) : StringBuilderBase() { reserve(capacity); }
+    /** \brief Constructs a builder appending to the value of the string and reusing its buffer */
+    explicit StringBuilderBase(StringBase<T>&& str)
+        : m_buffer(std::move(str)), m_data(nullptr), m_length(m_buffer.size()), m_capacity(0)
+    {
+        if (!m_buffer.isNull())
+            grow(m_buffer.capacity());
+    }
+    StringBuilderBase(const StringBuilderBase&)=delete;
+    StringBuilderBase(StringBuilderBase&& other)
+        : m_buffer(std::move(other.m_buffer)), m_data(nullptr), m_length(other.m_length), m_capacity(other.m_capacity)
+    {
+        // inline buffer of the string has moved together with it
+        if (m_capacity) m_data = m_buffer.begin();
+        other.m_data = nullptr;
+        other.m_length = other.m_capacity = 0;
+    }
+    StringBuilderBase& operator=(const StringBuilderBase&)=delete;
+    StringBuilderBase& operator=(StringBuilderBase&& rhs)
+    {
+        if (this != &rhs)
+        {
+            m_buffer = std::move(rhs.m_buffer);
+            m_length = rhs.m_length;
+            m_capacity = rhs.m_capacity;
+            m_data = m_capacity ? m_buffer.begin() : nullptr;
+            rhs.m_data = nullptr;
+            rhs.m_length = rhs.m_capacity = 0;
+        }
+        return *this;
+    }
+
+    /** \brief Gets the number of characters appended so far */
+    size_t length() const { return m_length; }
+    /** \brief Gets the number of characters appended so far */
+    size_t size() const { return m_length; }
+    /** \brief Checks whether nothing was appended yet */
+    bool empty() const { return !m_length; }
+    /** \brief Gets the number of characters the builder can hold without reallocating the buffer */
+    size_t capacity() const { return m_capacity; }
+    /** \brief Gets a pointer to the characters appended so far, the buffer is not null-terminated */
+    const T *data() const { return m_data; }
+    /** \brief Gets a view of the characters appended so far */
+    StringViewBase<T> view(size_t start = 0, size_t length = StringViewBase<T>::npos) const
+    {
+        return StringViewBase<T>(m_length ? m_data : m_buffer.data(), m_length).substr(start, length);
+    }
+
+    /** \brief Ensures the buffer is capable to store the string of the given length */
+    void reserve(size_t capacity) { if (capacity > m_capacity) grow(capacity); }
+    /** \brief Removes all appended characters keeping the buffer for reuse */
+    void clear() { m_length = 0; }
+    /** \brief Sets the length of the string, new characters are left uninitialized */
+    void resize(size_t length)
+    {
+        reserve(length);
+        m_length = length;
+    }
+
+    /** \brief Gets the built string handing off the buffer to it, the builder becomes empty */
+    StringBase<T> take()
+    {
+        // nothing has been appended yet, the result is still an empty string rather than a null one
+        if (m_buffer.isNull())
+            return StringBase<T>(m_buffer.data(), m_length);
+        m_buffer.resize(m_length);
+        StringBase<T> result(std::move(m_buffer));
+        m_data = nullptr;
+        m_length = m_capacity = 0;
+        return result;
+    }
+    /** \brief Gets a copy of the built string */
+    StringBase<T> toString() const { return StringBase<T>(m_length ? m_data : m_buffer.data(), m_length); }
+
+    /** \brief Appends given character buffer */
+    StringBuilderBase& append(const T *str, size_t length)
+    {
+        if (length)
+        {
+            std::copy(str, str + length, appendBuffer(length));
+            m_length += length;
+        }
+        return *this;
+    }
+    /** \brief Appends given null-terminated string */
+    StringBuilderBase& append(const T *str) { return str ? append(str, detail::StringHelper<T>::strlen(str)) : *this; }
+    /** \brief Appends given string */
+    StringBuilderBase& append(const StringBase<T>& str) { return append(str.data(), str.length()); }
+    /** \brief Appends characters referenced by the view */
+    StringBuilderBase& append(const StringViewBase<T>& str) { return append(str.data(), str.length()); }
+    /** \brief Appends one character */
+    StringBuilderBase& append(T ch)
+    {
+        *appendBuffer(1) = ch;
+        ++m_length;
+        return *this;
+    }
+    /** \brief Appends the character repeated given number of times */
+    StringBuilderBase& append(size_t count, T ch)
+    {
+        std::fill_n(appendBuffer(count), count, ch);
+        m_length += count;
+        return *this;
+    }
+    /** \brief Appends boolean value in the same form as StringBase::fromValue does */
+    StringBuilderBase& append(bool value) { return append(T(value ? '1' : '0')); }
+    /** \brief Appends decimal representation of the number, floating point numbers are written in the shortest form */
+    template<typename TNumber>
+    typename std::enable_if<detail::IsFormattableNumber<TNumber>::value, StringBuilderBase&>::type
+        append(TNumber value)
+    {
+        char buffer[NumberBufferSize];
+        return appendAscii(buffer, formatNumber(buffer, static_cast<typename detail::NumberFormatType<TNumber>::type>(value)));
+    }
+
+    /** \brief Gets a pointer to the space for at least given number of characters after the end of the string
+     *
+     * Characters written there become a part of the string after commit() call.
+     */
+    T *appendBuffer(size_t length)
+    {
+        if (m_capacity - m_length < length)
+            grow(m_length + length);
+        return m_data + m_length;
+    }
+    /** \brief Appends given number of characters written into the space obtained by appendBuffer() */
+    void commit(size_t length) { assert(m_length + length <= m_capacity); m_length += length; }
+
+private:
+    StringBuilderBase& appendAscii(const char *str, size_t length)
+    {
+        std::copy(str, str + length, appendBuffer(length));
+        m_length += length;
+        return *this;
+    }
+
+    void grow(size_t capacity)
+    {
+        // the string grows its heap buffer geometrically, so all of the allocated space is used
+        m_buffer.resize(capacity);
+        m_capacity = m_buffer.capacity();
+        m_buffer.resize(m_capacity);
+        m_data = m_buffer.begin();
+    }
+
+    StringBase<T> m_buffer;     // sized to the whole capacity, only m_length characters are valid
+    T *m_data;
+    size_t m_length;
+    size_t m_capacity;
+};
+
+/** \brief Builder of strings in native system encoding
+ * \relates metacpp::StringBuilderBase
+ */
+typedef StringBuilderBase<char> StringBuilder;
+/** \brief Builder of UTF-16 strings
+ * \relates metacpp::StringBuilderBase
+ */
+typedef StringBuilderBase<char16_t> WStringBuilder;
+
+namespace detail
+{
+    /** \brief Reference to an argument of the formatting function keeping its original type
+     *
+     * Values are not converted into variants, strings and date/times are referenced, not copied,
+     * so an instance should not outlive the argument it was created from.
+     */
+    class FormatArg
+    {
+    public:
+        enum EKind
+        {
+            eKindNone,
+            eKindBool,
+            eKindSigned,
+            eKindUnsigned,
+            eKindFloat,
+            eKindDouble,
+            eKindString,
+            eKindDateTime,
+            eKindPointer,
+            eKindVariant
+        };
+
+        FormatArg() : m_kind(eKindNone) { m_unsigned = 0; }
+        FormatArg(bool value) : m_kind(eKindBool) { m_unsigned = value; }
+
+        template<typename TInt>
+        FormatArg(TInt value, typename std::enable_if<(std::is_integral<TInt>::value || std::is_enum<TInt>::value) &&
+                  !std::is_same<TInt, bool>::value>::type * = nullptr)
+            : m_kind(std::is_signed<TInt>::value || std::is_enum<TInt>::value ? eKindSigned : eKindUnsigned)
+        {
+            if (eKindSigned == m_kind)
+                m_signed = static_cast<int64_t>(value);
+            else
+                m_unsigned = static_cast<uint64_t>(value);
+        }
+
+        FormatArg(float value) : m_kind(eKindFloat) { m_double = value; }
+        FormatArg(double value) : m_kind(eKindDouble) { m_double = value; }
+        FormatArg(const char *str) : m_kind(eKindString) { setString(str, str ? ::strlen(str) : 0); }
+        FormatArg(const String& str) : m_kind(eKindString) { setString(str.data(), str.length()); }
+        FormatArg(const StringView& str) : m_kind(eKindString) { setString(str.data(), str.length()); }
+        FormatArg(const DateTime& dt) : m_kind(eKindDateTime) { m_pointer = &dt; }
+        FormatArg(const void *ptr) : m_kind(eKindPointer) { m_pointer = ptr; }
+
+        /** Only variants themselves are accepted, converting other types into a temporary variant would leave a dangling reference */
+        template<typename TVariant>
+        FormatArg(const TVariant& v, typename std::enable_if<std::is_same<TVariant, Variant>::value>::type * = nullptr)
+            : m_kind(eKindVariant)
+        {
+            m_pointer = &v;
+        }
+
+        /** \brief Creates an argument referencing the value stored in the variant */
+        static FormatArg fromVariant(const Variant& v);
+
+        EKind kind() const { return m_kind; }
+        bool boolValue() const { return m_unsigned != 0; }
+        int64_t signedValue() const { return m_signed; }
+        uint64_t unsignedValue() const { return m_unsigned; }
+        double doubleValue() const { return m_double; }
+        const char *stringData() const { return m_string.data; }
+        size_t stringLength() const { return m_string.length; }
+        const DateTime& dateTime() const { return *static_cast<const DateTime *>(m_pointer); }
+        const void *pointer() const { return m_pointer; }
+        const Variant& variant() const { return *static_cast<const Variant *>(m_pointer); }
+    private:
+        void setString(const char *data, size_t length)
+        {
+            m_string.data = data;
+            m_string.length = length;
+        }
+
+        struct StringRef
+        {
+            const char *data;
+            size_t length;
+        };
+
+        EKind m_kind;
+        union
+        {
+            int64_t m_signed;
+            uint64_t m_unsigned;
+            double m_double;
+            const void *m_pointer;
+            StringRef m_string;
+        };
+    };
+} // namespace detail
+
+/** \brief Format string of String::format compiled once to be applied to many argument lists
+ *
+ * The format is split into the literal text and conversion specifications by the constructor,
+ * so formatting only emits arguments into a growing buffer. Integers, characters and strings are
+ * written directly, floating point numbers and pointers are passed to snprintf with the prebuilt
+ * specification.
+ * \relates metacpp::StringBase
+ */
+class StringFormatter
+{
+public:
+    /** \brief Compiles the format string throwing std::invalid_argument if it is malformed */
+    explicit StringFormatter(const char *fmt);
+
+    /** \brief Gets the number of arguments consumed by the format */
+    size_t argumentCount() const { return m_argumentCount; }
+
+    /** \brief Formats given arguments into a new string */
+    template<typename... TArgs>
+    String operator()(const TArgs&... args) const { return apply({ detail::FormatArg(args)... }); }
+    /** \brief Formats the arguments stored in the array into a new string */
+    String operator()(const Array<Variant>& args) const;
+
+    /** \brief Appends formatted arguments to the given string reusing its buffer */
+    template<typename... TArgs>
+    void appendTo(String& dest, const TArgs&... args) const { appendTo(dest, { detail::FormatArg(args)... }); }
+    /** \brief Appends formatted arguments to the given builder */
+    template<typename... TArgs>
+    void appendTo(StringBuilder& dest, const TArgs&... args) const { appendTo(dest, { detail::FormatArg(args)... }); }
+
+    /** \brief Formats the list of arguments into a new string */
+    String apply(std::initializer_list<detail::FormatArg> args) const;
+    /** \brief Appends the list of formatted arguments to the given string */
+    void appendTo(String& dest, std::initializer_list<detail::FormatArg> args) const;
+    /** \brief Appends the list of formatted arguments to the given builder */
+    void appendTo(StringBuilder& dest, std::initializer_list<detail::FormatArg> args) const;
+private:
+    void appendArgs(StringBuilder& dest, const detail::FormatArg *args, size_t count) const;
+
+    /** Range of the literal text or conversion specification */
+    struct Segment
+    {
+        uint32_t literalOffset;     // range in m_literals if conversion is zero
+        uint32_t literalLength;
+        char conversion;
+        unsigned char flags;
+        bool wide;                  // l or ll length modifier
+        int width;
+        int precision;              // negative if not specified
+        char spec[24];              // null-terminated specification for snprintf without length modifier
+    };
+
+    String m_literals;
+    Array<Segment> m_segments;
+    size_t m_argumentCount;
+};
+
+template<typename T>
+template<typename... TArgs>
+StringBase<T> StringBase<T>::format(const T *fmt, const TArgs&... args)
+{
+    return formatArgs(fmt, { detail::FormatArg(args)... });
+}
+
 template<typename T1, typename T2>
-class StringBuilder;
+class StringConcatenation;
 
 namespace detail
 {
     template<typename T>
-    class StringBuilderHelper;
+    class StringConcatenationHelper;
 
     template<typename T>
-    class StringBuilderHelper<T *>
+    class StringConcatenationHelper<T *>
     {
     public:
         typedef T CharT;
 
-        StringBuilderHelper(const T *str) : m_str(str), m_length(StringHelper<T>::strlen(m_str))
+        StringConcatenationHelper(const T *str) : m_str(str), m_length(StringHelper<T>::strlen(m_str))
         {
         }
 
@@ -735,12 +1347,12 @@ namespace detail
     };
 
     template<typename T, size_t N>
-    class StringBuilderHelper<T[N]>
+    class StringConcatenationHelper<T[N]>
     {
     public:
         typedef T CharT;
 
-        StringBuilderHelper(const T (&str)[N]) : m_str(str)
+        StringConcatenationHelper(const T (&str)[N]) : m_str(str)
         {
         }
 
@@ -751,12 +1363,12 @@ namespace detail
     };
 
     template<typename T>
-    class StringBuilderHelper<StringBase<T> >
+    class StringConcatenationHelper<StringBase<T> >
     {
     public:
         typedef T CharT;
 
-        StringBuilderHelper(const StringBase<T>& str)
+        StringConcatenationHelper(const StringBase<T>& str)
             : m_str(str)
         {
         }
@@ -768,12 +1380,12 @@ namespace detail
     };
 
     template<typename T>
-    class StringBuilderHelper<std::basic_string<T> >
+    class StringConcatenationHelper<std::basic_string<T> >
     {
     public:
         typedef T CharT;
 
-        StringBuilderHelper(const std::basic_string<T>& str)
+        StringConcatenationHelper(const std::basic_string<T>& str)
             : m_str(str)
         {
         }
@@ -785,12 +1397,12 @@ namespace detail
     };
 
     template<typename T1, typename T2>
-    class StringBuilderHelper<StringBuilder<T1, T2> >
+    class StringConcatenationHelper<StringConcatenation<T1, T2> >
     {
     public:
-        typedef typename StringBuilder<T1, T2>::CharT CharT;
+        typedef typename StringConcatenation<T1, T2>::CharT CharT;
 
-        StringBuilderHelper(const StringBuilder<T1, T2>& sb)
+        StringConcatenationHelper(const StringConcatenation<T1, T2>& sb)
             : m_sb(sb)
         {
         }
@@ -798,7 +1410,7 @@ namespace detail
         size_t length() const { return m_sb.length(); }
         void appendTo(StringBase<CharT>& acc) const { m_sb.appendTo(acc); }
     private:
-        const StringBuilder<T1, T2>& m_sb;
+        const StringConcatenation<T1, T2>& m_sb;
     };
 } // namespace detail
 
@@ -806,12 +1418,12 @@ namespace detail
  * \relates metacpp::StringBase
  */
 template<typename T1, typename T2>
-class StringBuilder
+class StringConcatenation
 {
 public:
-    typedef typename detail::StringBuilderHelper<T1>::CharT CharT;
+    typedef typename detail::StringConcatenationHelper<T1>::CharT CharT;
 
-    StringBuilder(const detail::StringBuilderHelper<T1>& a, const detail::StringBuilderHelper<T2>& b)
+    StringConcatenation(const detail::StringConcatenationHelper<T1>& a, const detail::StringConcatenationHelper<T2>& b)
         : m_a(a), m_b(b)
     {
     }
@@ -833,87 +1445,87 @@ public:
     }
 
 private:
-    detail::StringBuilderHelper<T1> m_a;
-    detail::StringBuilderHelper<T2> m_b;
+    detail::StringConcatenationHelper<T1> m_a;
+    detail::StringConcatenationHelper<T2> m_b;
 };
 
 /** \brief Concatenates two strings
  * \relates metacpp::StringBase
  */
 template<typename T>
-StringBuilder<StringBase<T>, StringBase<T> > operator +(const StringBase<T>& a, const StringBase<T>& b)
+StringConcatenation<StringBase<T>, StringBase<T> > operator +(const StringBase<T>& a, const StringBase<T>& b)
 {
-    return StringBuilder<StringBase<T>, StringBase<T> >(a, b);
+    return StringConcatenation<StringBase<T>, StringBase<T> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T>
-StringBuilder<StringBase<T>, StringBase<T> > operator +(const StringBase<T>& a, const std::basic_string<T>& b)
+StringConcatenation<StringBase<T>, StringBase<T> > operator +(const StringBase<T>& a, const std::basic_string<T>& b)
 {
-    return StringBuilder<StringBase<T>, std::basic_string<T> >(a, b);
+    return StringConcatenation<StringBase<T>, std::basic_string<T> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T>
-StringBuilder<StringBase<T>, StringBase<T> > operator +(const std::basic_string<T>& a, const StringBase<T>& b)
+StringConcatenation<StringBase<T>, StringBase<T> > operator +(const std::basic_string<T>& a, const StringBase<T>& b)
 {
-    return StringBuilder<std::basic_string<T>, StringBase<T> >(a, b);
+    return StringConcatenation<std::basic_string<T>, StringBase<T> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T>
-StringBuilder<StringBase<T>, T *> operator +(const StringBase<T>& a, const T *b)
+StringConcatenation<StringBase<T>, T *> operator +(const StringBase<T>& a, const T *b)
 {
-    return StringBuilder<StringBase<T>, T *>(a, b);
+    return StringConcatenation<StringBase<T>, T *>(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T>
-StringBuilder<T *, StringBase<T>> operator +(const T *a, const StringBase<T>& b)
+StringConcatenation<T *, StringBase<T>> operator +(const T *a, const StringBase<T>& b)
 {
-    return StringBuilder<T *, StringBase<T> >(a, b);
+    return StringConcatenation<T *, StringBase<T> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T, typename T1, typename T2>
-StringBuilder<StringBase<T>, StringBuilder<T1, T2> > operator +(const StringBase<T>& a, const StringBuilder<T1, T2>& b)
+StringConcatenation<StringBase<T>, StringConcatenation<T1, T2> > operator +(const StringBase<T>& a, const StringConcatenation<T1, T2>& b)
 {
-    return StringBuilder<StringBase<T>, StringBuilder<T1, T2> >(a, b);
+    return StringConcatenation<StringBase<T>, StringConcatenation<T1, T2> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T, typename T1, typename T2>
-StringBuilder<StringBuilder<T1, T2>, StringBase<T>> operator +(const StringBuilder<T1, T2>& a, const StringBase<T>& b)
+StringConcatenation<StringConcatenation<T1, T2>, StringBase<T>> operator +(const StringConcatenation<T1, T2>& a, const StringBase<T>& b)
 {
-    return StringBuilder<StringBuilder<T1, T2>, StringBase<T> >(a, b);
+    return StringConcatenation<StringConcatenation<T1, T2>, StringBase<T> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T, typename T1, typename T2>
-StringBuilder<StringBase<T>, StringBuilder<T1, T2> > operator +(const std::basic_string<T>& a, const StringBuilder<T1, T2>& b)
+StringConcatenation<StringBase<T>, StringConcatenation<T1, T2> > operator +(const std::basic_string<T>& a, const StringConcatenation<T1, T2>& b)
 {
-    return StringBuilder<std::basic_string<T>, StringBuilder<T1, T2> >(a, b);
+    return StringConcatenation<std::basic_string<T>, StringConcatenation<T1, T2> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T, typename T1, typename T2>
-StringBuilder<StringBuilder<T1, T2>, StringBase<T>> operator +(const StringBuilder<T1, T2>& a, const std::basic_string<T>& b)
+StringConcatenation<StringConcatenation<T1, T2>, StringBase<T>> operator +(const StringConcatenation<T1, T2>& a, const std::basic_string<T>& b)
 {
-    return StringBuilder<StringBuilder<T1, T2>, std::basic_string<T> >(a, b);
+    return StringConcatenation<StringConcatenation<T1, T2>, std::basic_string<T> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T, typename T1, typename T2>
-StringBuilder<T *, StringBuilder<T1, T2> > operator +(const T *a, const StringBuilder<T1, T2>& b)
+StringConcatenation<T *, StringConcatenation<T1, T2> > operator +(const T *a, const StringConcatenation<T1, T2>& b)
 {
-    return StringBuilder<T *, StringBuilder<T1, T2> >(a, b);
+    return StringConcatenation<T *, StringConcatenation<T1, T2> >(a, b);
 }
 
 /** \relates metacpp::StringBase */
 template<typename T, typename T1, typename T2>
-StringBuilder<StringBuilder<T1, T2>, T *> operator +(const StringBuilder<T1, T2>& a, const T *b)
+StringConcatenation<StringConcatenation<T1, T2>, T *> operator +(const StringConcatenation<T1, T2>& a, const T *b)
 {
-    return StringBuilder<StringBuilder<T1, T2>, T *>(a, b);
+    return StringConcatenation<StringConcatenation<T1, T2>, T *>(a, b);
 }
 
 /** \relates metacpp::StringBase */
@@ -957,4 +1569,19 @@ std::basic_ostream<char16_t>& operator<<(std::basic_ostream<char16_t>& stream, c
 }
 
 } // namespace metacpp
+
+namespace std
+{
+
+/** \brief Hash functor for using strings as keys of STL unordered containers
+ * \relates metacpp::StringBase
+ */
+template<typename T>
+struct hash<metacpp::StringBase<T> >
+{
+    size_t operator()(const metacpp::StringBase<T>& str) const { return str.hash(); }
+};
+
+} // namespace std
+
 #endif // STRING_H
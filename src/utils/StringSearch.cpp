@@ -0,0 +1,627 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "StringSearch.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define METACPP_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(METACPP_SIMD_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// AVX2 kernels are compiled per function and only entered after a runtime CPU check
+#define METACPP_SIMD_AVX2
+#include <immintrin.h>
+#define METACPP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define METACPP_FORCE_INLINE __forceinline
+#elif defined(__GNUC__)
+#define METACPP_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define METACPP_FORCE_INLINE inline
+#endif
+
+namespace metacpp
+{
+namespace detail
+{
+
+namespace
+{
+
+inline unsigned lowestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline unsigned highestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return index;
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+}
+
+template<typename T>
+inline bool equalChars(const T *a, const T *b, size_t length)
+{
+    return 0 == memcmp(a, b, length * sizeof(T));
+}
+
+inline bool isUrlUnreserved(char ch)
+{
+    uint32_t c = static_cast<unsigned char>(ch);
+    return c - '0' < 10 || (c | 0x20) - 'a' < 26 || ch == '-' || ch == '_' || ch == '.' || ch == '~';
+}
+
+/** Portable fallbacks, also used for the tails shorter than one vector */
+namespace scalar
+{
+    template<typename T>
+    const T *findChar(const T *first, const T *last, T ch)
+    {
+        for (; first != last; ++first)
+            if (*first == ch) return first;
+        return last;
+    }
+
+    template<typename T>
+    const T *findLastChar(const T *first, const T *last, T ch)
+    {
+        for (const T *p = last; p != first;)
+            if (*--p == ch) return p;
+        return last;
+    }
+
+    template<typename T>
+    const T *findSubstring(const T *first, const T *last, const T *needle, size_t length)
+    {
+        if (static_cast<size_t>(last - first) < length) return last;
+        const T *lastStart = last - length;
+        for (const T *p = first; p <= lastStart; ++p)
+            if (*p == *needle && equalChars(p + 1, needle + 1, length - 1))
+                return p;
+        return last;
+    }
+
+    template<typename T>
+    const T *findLastSubstring(const T *first, const T *last, const T *needle, size_t length)
+    {
+        if (static_cast<size_t>(last - first) < length) return last;
+        for (const T *p = last - length + 1; p != first;)
+        {
+            --p;
+            if (*p == *needle && equalChars(p + 1, needle + 1, length - 1))
+                return p;
+        }
+        return last;
+    }
+
+    template<typename T>
+    int compareIgnoreCase(const T *a, const T *b, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            uint32_t ca = asciiToLower(a[i]), cb = asciiToLower(b[i]);
+            if (ca != cb) return static_cast<int>(ca) - static_cast<int>(cb);
+        }
+        return 0;
+    }
+
+    size_t urlUnreservedSpan(const char *str, size_t length)
+    {
+        size_t i = 0;
+        while (i < length && isUrlUnreserved(str[i])) ++i;
+        return i;
+    }
+
+    size_t urlPlainSpan(const char *str, size_t length)
+    {
+        size_t i = 0;
+        while (i < length && str[i] != '%' && str[i] != '+') ++i;
+        return i;
+    }
+} // namespace scalar
+
+/*
+ * Vector kernels are written once against a small set of primitives, each of which
+ * checks Elements characters at once and returns a bitmask with one bit per character.
+ * The primitives of a wider instruction set carry their own target attribute and get
+ * inlined into the kernels instantiated within the functions having the same target.
+ */
+
+template<typename V, typename T>
+METACPP_FORCE_INLINE const T *findCharKernel(const T *first, const T *last, T ch)
+{
+    for (; static_cast<size_t>(last - first) >= V::Elements; first += V::Elements)
+        if (uint32_t mask = V::equal(first, ch))
+            return first + lowestBit(mask);
+    return scalar::findChar(first, last, ch);
+}
+
+template<typename V, typename T>
+METACPP_FORCE_INLINE const T *findLastCharKernel(const T *first, const T *last, T ch)
+{
+    const T *p = last;
+    for (; static_cast<size_t>(p - first) >= V::Elements; )
+    {
+        p -= V::Elements;
+        if (uint32_t mask = V::equal(p, ch))
+            return p + highestBit(mask);
+    }
+    const T *res = scalar::findLastChar(first, p, ch);
+    return res == p ? last : res;
+}
+
+template<typename V, typename T>
+METACPP_FORCE_INLINE const T *findSubstringKernel(const T *first, const T *last, const T *needle, size_t length)
+{
+    // compare the first and the last characters of the needle at all positions of the block,
+    // only the positions where both match are verified completely
+    if (static_cast<size_t>(last - first) < length) return last;
+    const T *lastStart = last - length;
+    const T firstCh = needle[0], lastCh = needle[length - 1];
+    const T *p = first;
+    for (; p <= lastStart && static_cast<size_t>(lastStart - p) >= V::Elements - 1; p += V::Elements)
+    {
+        uint32_t mask = V::equal(p, firstCh) & V::equal(p + length - 1, lastCh);
+        while (mask)
+        {
+            unsigned bit = lowestBit(mask);
+            if (equalChars(p + bit + 1, needle + 1, length - 2))
+                return p + bit;
+            mask &= mask - 1;
+        }
+    }
+    return scalar::findSubstring(p, last, needle, length);
+}
+
+template<typename V, typename T>
+METACPP_FORCE_INLINE const T *findLastSubstringKernel(const T *first, const T *last, const T *needle, size_t length)
+{
+    if (static_cast<size_t>(last - first) < length) return last;
+    const T firstCh = needle[0], lastCh = needle[length - 1];
+    // candidates left to check are [first, end)
+    const T *end = last - length + 1;
+    while (static_cast<size_t>(end - first) >= V::Elements)
+    {
+        const T *p = end - V::Elements;
+        uint32_t mask = V::equal(p, firstCh) & V::equal(p + length - 1, lastCh);
+        while (mask)
+        {
+            unsigned bit = highestBit(mask);
+            if (equalChars(p + bit + 1, needle + 1, length - 2))
+                return p + bit;
+            mask &= ~(1u << bit);
+        }
+        end = p;
+    }
+    // the remaining candidates together with the needle fit into [first, end + length - 1)
+    const T *res = scalar::findLastSubstring(first, end + length - 1, needle, length);
+    return res == end + length - 1 ? last : res;
+}
+
+template<typename V, typename T>
+METACPP_FORCE_INLINE int compareIgnoreCaseKernel(const T *a, const T *b, size_t length)
+{
+    size_t i = 0;
+    for (; length - i >= V::Elements; i += V::Elements)
+        if (uint32_t mask = V::mismatchIgnoreCase(a + i, b + i))
+        {
+            size_t j = i + lowestBit(mask);
+            return static_cast<int>(asciiToLower(a[j])) - static_cast<int>(asciiToLower(b[j]));
+        }
+    return scalar::compareIgnoreCase(a + i, b + i, length - i);
+}
+
+template<typename V>
+METACPP_FORCE_INLINE size_t urlUnreservedSpanKernel(const char *str, size_t length)
+{
+    // most runs between escaped characters are short, check them before loading a vector
+    size_t i = 0;
+    for (; i < length && i < 8; ++i)
+        if (!isUrlUnreserved(str[i])) return i;
+    for (; length - i >= V::Elements; i += V::Elements)
+        if (uint32_t mask = V::urlReserved(str + i))
+            return i + lowestBit(mask);
+    return i + scalar::urlUnreservedSpan(str + i, length - i);
+}
+
+template<typename V>
+METACPP_FORCE_INLINE size_t urlPlainSpanKernel(const char *str, size_t length)
+{
+    size_t i = 0;
+    for (; i < length && i < 8; ++i)
+        if (str[i] == '%' || str[i] == '+') return i;
+    for (; length - i >= V::Elements; i += V::Elements)
+        if (uint32_t mask = V::equal(str + i, '%') | V::equal(str + i, '+'))
+            return i + lowestBit(mask);
+    return i + scalar::urlPlainSpan(str + i, length - i);
+}
+
+#ifdef METACPP_SIMD_SSE2
+struct Sse2
+{
+    static const size_t Elements = 16;
+
+    static __m128i load(const void *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+    static __m128i inRange8(__m128i v, char lo, char hi)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+    }
+
+    static __m128i toLower8(__m128i v)
+    {
+        return _mm_or_si128(v, _mm_and_si128(inRange8(v, 'A', 'Z'), _mm_set1_epi8(0x20)));
+    }
+
+    static __m128i toLower16(__m128i v)
+    {
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16('A' - 1)),
+                                      _mm_cmpgt_epi16(_mm_set1_epi16('Z' + 1), v));
+        return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+    }
+
+    static uint32_t equal(const char *p, char ch)
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(load(p), _mm_set1_epi8(ch)));
+    }
+
+    static uint32_t equal(const char16_t *p, char16_t ch)
+    {
+        __m128i c = _mm_set1_epi16(static_cast<short>(ch));
+        return _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(load(p), c), _mm_cmpeq_epi16(load(p + 8), c)));
+    }
+
+    static uint32_t mismatchIgnoreCase(const char *a, const char *b)
+    {
+        return ~_mm_movemask_epi8(_mm_cmpeq_epi8(toLower8(load(a)), toLower8(load(b)))) & 0xFFFF;
+    }
+
+    static uint32_t mismatchIgnoreCase(const char16_t *a, const char16_t *b)
+    {
+        __m128i lo = _mm_cmpeq_epi16(toLower16(load(a)), toLower16(load(b)));
+        __m128i hi = _mm_cmpeq_epi16(toLower16(load(a + 8)), toLower16(load(b + 8)));
+        return ~_mm_movemask_epi8(_mm_packs_epi16(lo, hi)) & 0xFFFF;
+    }
+
+    static uint32_t urlReserved(const char *p)
+    {
+        __m128i v = load(p);
+        __m128i unreserved = _mm_or_si128(inRange8(v, '0', '9'), inRange8(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'));
+        unreserved = _mm_or_si128(unreserved, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')), _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))));
+        unreserved = _mm_or_si128(unreserved, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')), _mm_cmpeq_epi8(v, _mm_set1_epi8('~'))));
+        return ~_mm_movemask_epi8(unreserved) & 0xFFFF;
+    }
+};
+#endif // METACPP_SIMD_SSE2
+
+#ifdef METACPP_SIMD_AVX2
+struct Avx2
+{
+    static const size_t Elements = 32;
+
+    METACPP_TARGET_AVX2 static __m256i load(const void *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+    METACPP_TARGET_AVX2 static __m256i inRange8(__m256i v, char lo, char hi)
+    {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+    }
+
+    METACPP_TARGET_AVX2 static __m256i toLower8(__m256i v)
+    {
+        return _mm256_or_si256(v, _mm256_and_si256(inRange8(v, 'A', 'Z'), _mm256_set1_epi8(0x20)));
+    }
+
+    METACPP_TARGET_AVX2 static __m256i toLower16(__m256i v)
+    {
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi16(v, _mm256_set1_epi16('A' - 1)),
+                                         _mm256_cmpgt_epi16(_mm256_set1_epi16('Z' + 1), v));
+        return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi16(0x20)));
+    }
+
+    // packs 16-bit lanes of two vectors into bytes preserving the order of characters
+    METACPP_TARGET_AVX2 static uint32_t movemask16(__m256i lo, __m256i hi)
+    {
+        return _mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8));
+    }
+
+    METACPP_TARGET_AVX2 static uint32_t equal(const char *p, char ch)
+    {
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi8(load(p), _mm256_set1_epi8(ch)));
+    }
+
+    METACPP_TARGET_AVX2 static uint32_t equal(const char16_t *p, char16_t ch)
+    {
+        __m256i c = _mm256_set1_epi16(static_cast<short>(ch));
+        return movemask16(_mm256_cmpeq_epi16(load(p), c), _mm256_cmpeq_epi16(load(p + 16), c));
+    }
+
+    METACPP_TARGET_AVX2 static uint32_t mismatchIgnoreCase(const char *a, const char *b)
+    {
+        return ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(toLower8(load(a)), toLower8(load(b))));
+    }
+
+    METACPP_TARGET_AVX2 static uint32_t mismatchIgnoreCase(const char16_t *a, const char16_t *b)
+    {
+        return ~movemask16(_mm256_cmpeq_epi16(toLower16(load(a)), toLower16(load(b))),
+                           _mm256_cmpeq_epi16(toLower16(load(a + 16)), toLower16(load(b + 16))));
+    }
+};
+
+// entry points instantiating the kernels within AVX2 enabled functions
+template<typename T>
+METACPP_TARGET_AVX2 const T *findCharAvx2(const T *first, const T *last, T ch)
+{
+    return findCharKernel<Avx2>(first, last, ch);
+}
+
+template<typename T>
+METACPP_TARGET_AVX2 const T *findLastCharAvx2(const T *first, const T *last, T ch)
+{
+    return findLastCharKernel<Avx2>(first, last, ch);
+}
+
+template<typename T>
+METACPP_TARGET_AVX2 const T *findSubstringAvx2(const T *first, const T *last, const T *needle, size_t length)
+{
+    return findSubstringKernel<Avx2>(first, last, needle, length);
+}
+
+template<typename T>
+METACPP_TARGET_AVX2 const T *findLastSubstringAvx2(const T *first, const T *last, const T *needle, size_t length)
+{
+    return findLastSubstringKernel<Avx2>(first, last, needle, length);
+}
+
+template<typename T>
+METACPP_TARGET_AVX2 int compareIgnoreCaseAvx2(const T *a, const T *b, size_t length)
+{
+    return compareIgnoreCaseKernel<Avx2>(a, b, length);
+}
+
+#endif // METACPP_SIMD_AVX2
+
+ESimdLevel supportedSimdLevel()
+{
+#if defined(METACPP_SIMD_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return eSimdAvx2;
+#endif
+#if defined(METACPP_SIMD_SSE2)
+    return eSimdSse2;
+#else
+    return eSimdScalar;
+#endif
+}
+
+std::atomic<int> g_simdLevel(-1);
+
+inline ESimdLevel currentSimdLevel()
+{
+    int level = g_simdLevel.load(std::memory_order_relaxed);
+    if (level < 0)
+    {
+        level = supportedSimdLevel();
+        g_simdLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<ESimdLevel>(level);
+}
+
+template<typename T>
+const T *findCharImpl(const T *first, const T *last, T ch)
+{
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_AVX2
+    case eSimdAvx2:
+        return findCharAvx2(first, last, ch);
+#endif
+#ifdef METACPP_SIMD_SSE2
+    case eSimdSse2:
+        return findCharKernel<Sse2>(first, last, ch);
+#endif
+    default:
+        return scalar::findChar(first, last, ch);
+    }
+}
+
+template<typename T>
+const T *findLastCharImpl(const T *first, const T *last, T ch)
+{
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_AVX2
+    case eSimdAvx2:
+        return findLastCharAvx2(first, last, ch);
+#endif
+#ifdef METACPP_SIMD_SSE2
+    case eSimdSse2:
+        return findLastCharKernel<Sse2>(first, last, ch);
+#endif
+    default:
+        return scalar::findLastChar(first, last, ch);
+    }
+}
+
+template<typename T>
+const T *findSubstringImpl(const T *first, const T *last, const T *needle, size_t length)
+{
+    if (!length) return first;
+    if (length == 1) return findCharImpl(first, last, *needle);
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_AVX2
+    case eSimdAvx2:
+        return findSubstringAvx2(first, last, needle, length);
+#endif
+#ifdef METACPP_SIMD_SSE2
+    case eSimdSse2:
+        return findSubstringKernel<Sse2>(first, last, needle, length);
+#endif
+    default:
+        return scalar::findSubstring(first, last, needle, length);
+    }
+}
+
+template<typename T>
+const T *findLastSubstringImpl(const T *first, const T *last, const T *needle, size_t length)
+{
+    if (!length) return last;
+    if (length == 1) return findLastCharImpl(first, last, *needle);
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_AVX2
+    case eSimdAvx2:
+        return findLastSubstringAvx2(first, last, needle, length);
+#endif
+#ifdef METACPP_SIMD_SSE2
+    case eSimdSse2:
+        return findLastSubstringKernel<Sse2>(first, last, needle, length);
+#endif
+    default:
+        return scalar::findLastSubstring(first, last, needle, length);
+    }
+}
+
+template<typename T>
+int compareIgnoreCaseImpl(const T *a, const T *b, size_t length)
+{
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_AVX2
+    case eSimdAvx2:
+        return compareIgnoreCaseAvx2(a, b, length);
+#endif
+#ifdef METACPP_SIMD_SSE2
+    case eSimdSse2:
+        return compareIgnoreCaseKernel<Sse2>(a, b, length);
+#endif
+    default:
+        return scalar::compareIgnoreCase(a, b, length);
+    }
+}
+
+} // namespace
+
+ESimdLevel simdLevel()
+{
+    return currentSimdLevel();
+}
+
+void setSimdLevel(ESimdLevel level)
+{
+    ESimdLevel supported = supportedSimdLevel();
+    g_simdLevel.store(level < supported ? level : supported, std::memory_order_relaxed);
+}
+
+const char *findChar(const char *first, const char *last, char ch)
+{
+    return findCharImpl(first, last, ch);
+}
+
+const char16_t *findChar(const char16_t *first, const char16_t *last, char16_t ch)
+{
+    return findCharImpl(first, last, ch);
+}
+
+const char *findLastChar(const char *first, const char *last, char ch)
+{
+    return findLastCharImpl(first, last, ch);
+}
+
+const char16_t *findLastChar(const char16_t *first, const char16_t *last, char16_t ch)
+{
+    return findLastCharImpl(first, last, ch);
+}
+
+const char *findSubstring(const char *first, const char *last, const char *needle, size_t length)
+{
+    return findSubstringImpl(first, last, needle, length);
+}
+
+const char16_t *findSubstring(const char16_t *first, const char16_t *last, const char16_t *needle, size_t length)
+{
+    return findSubstringImpl(first, last, needle, length);
+}
+
+const char *findLastSubstring(const char *first, const char *last, const char *needle, size_t length)
+{
+    return findLastSubstringImpl(first, last, needle, length);
+}
+
+const char16_t *findLastSubstring(const char16_t *first, const char16_t *last, const char16_t *needle, size_t length)
+{
+    return findLastSubstringImpl(first, last, needle, length);
+}
+
+int compareIgnoreCase(const char *a, const char *b, size_t length)
+{
+    return compareIgnoreCaseImpl(a, b, length);
+}
+
+int compareIgnoreCase(const char16_t *a, const char16_t *b, size_t length)
+{
+    return compareIgnoreCaseImpl(a, b, length);
+}
+
+size_t urlUnreservedSpan(const char *str, size_t length)
+{
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_SSE2
+    // the runs are rarely long enough for the wider vectors to pay off
+    case eSimdAvx2:
+    case eSimdSse2:
+        return urlUnreservedSpanKernel<Sse2>(str, length);
+#endif
+    default:
+        return scalar::urlUnreservedSpan(str, length);
+    }
+}
+
+size_t urlPlainSpan(const char *str, size_t length)
+{
+    switch (currentSimdLevel())
+    {
+#ifdef METACPP_SIMD_SSE2
+    // the runs are rarely long enough for the wider vectors to pay off
+    case eSimdAvx2:
+    case eSimdSse2:
+        return urlPlainSpanKernel<Sse2>(str, length);
+#endif
+    default:
+        return scalar::urlPlainSpan(str, length);
+    }
+}
+
+} // namespace detail
+} // namespace metacpp
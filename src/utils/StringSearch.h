@@ -0,0 +1,108 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef STRINGSEARCH_H
+#define STRINGSEARCH_H
+#include "config.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace metacpp
+{
+namespace detail
+{
+
+/** \brief Instruction set used by the string scanning kernels */
+enum ESimdLevel
+{
+    eSimdScalar,    /**< Portable scalar loops */
+    eSimdSse2,      /**< 128-bit SSE2 kernels */
+    eSimdAvx2       /**< 256-bit AVX2 kernels */
+};
+
+/** \brief Gets the instruction set the kernels are currently dispatched to
+ *
+ * Detected on first use from the capabilities of the running CPU.
+ */
+ESimdLevel simdLevel();
+
+/** \brief Restricts the kernels to the given instruction set, clamped to what the CPU supports
+ *
+ * Intended for tests and benchmarks comparing the kernels with each other.
+ */
+void setSimdLevel(ESimdLevel level);
+
+/** \brief Finds the first occurence of ch in [first, last), returns last if there is none */
+const char *findChar(const char *first, const char *last, char ch);
+/** \brief Finds the first occurence of ch in [first, last), returns last if there is none */
+const char16_t *findChar(const char16_t *first, const char16_t *last, char16_t ch);
+
+/** \brief Finds the last occurence of ch in [first, last), returns last if there is none */
+const char *findLastChar(const char *first, const char *last, char ch);
+/** \brief Finds the last occurence of ch in [first, last), returns last if there is none */
+const char16_t *findLastChar(const char16_t *first, const char16_t *last, char16_t ch);
+
+/** \brief Finds the first occurence of the needle in [first, last), returns last if there is none
+ *
+ * An empty needle is found at first.
+ */
+const char *findSubstring(const char *first, const char *last, const char *needle, size_t length);
+/** \brief Finds the first occurence of the needle in [first, last), returns last if there is none
+ *
+ * An empty needle is found at first.
+ */
+const char16_t *findSubstring(const char16_t *first, const char16_t *last, const char16_t *needle, size_t length);
+
+/** \brief Finds the last occurence of the needle in [first, last), returns last if there is none
+ *
+ * An empty needle is never found.
+ */
+const char *findLastSubstring(const char *first, const char *last, const char *needle, size_t length);
+/** \brief Finds the last occurence of the needle in [first, last), returns last if there is none
+ *
+ * An empty needle is never found.
+ */
+const char16_t *findLastSubstring(const char16_t *first, const char16_t *last, const char16_t *needle, size_t length);
+
+/** \brief Compares two buffers of the same length ignoring the case of ASCII letters
+ *
+ * \returns difference of the first mismatching lowercased characters or zero
+ */
+int compareIgnoreCase(const char *a, const char *b, size_t length);
+/** \brief Compares two buffers of the same length ignoring the case of ASCII letters
+ *
+ * \returns difference of the first mismatching lowercased characters or zero
+ */
+int compareIgnoreCase(const char16_t *a, const char16_t *b, size_t length);
+
+/** \brief Gets the length of the leading run of characters which do not need percent encoding */
+size_t urlUnreservedSpan(const char *str, size_t length);
+
+/** \brief Gets the length of the leading run of characters other than '%' and '+' */
+size_t urlPlainSpan(const char *str, size_t length);
+
+/** \brief Converts an ASCII uppercase letter to lowercase, leaving any other character untouched */
+template<typename T>
+inline uint32_t asciiToLower(T ch)
+{
+    uint32_t c = static_cast<typename std::make_unsigned<T>::type>(ch);
+    return c - 'A' < 26 ? c | 0x20 : c;
+}
+
+} // namespace detail
+} // namespace metacpp
+
+#endif // STRINGSEARCH_H
@@ -0,0 +1,270 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef STRINGVIEW_H
+#define STRINGVIEW_H
+#include "config.h"
+#include <string>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "Array.h"
+#include "NumberFormat.h"
+#include "StringSearch.h"
+#include "Utils.h"
+
+namespace metacpp
+{
+
+template<typename T>
+class StringBase;
+
+namespace detail
+{
+
+    /** \brief Unified helper for manipulating C-strings */
+    template<typename T>
+    struct StringHelper
+    {
+        static size_t strlen(const T *str);
+        static int strcmp(const T *a, const T *b);
+        static int strcasecmp(const T *a, const T *b);
+        static int strncmp(const T *a, const T *b, size_t size);
+        static int strncasecmp(const T *a, const T *b, size_t size);
+        static T *strcpy(T *dest, const T *source) ;
+        static T *strncpy(T *dest, const T *source, size_t n);
+        static const T *strstr(const T *haystack, const T *needle);
+
+        /** \brief Calculates FNV-1a hash of the given character buffer */
+        static size_t hash(const T *str, size_t length)
+        {
+            uint64_t h = Fnv1a<uint64_t>::basis();
+            for (size_t i = 0; i < length; ++i)
+                h = fnv1aMix<uint64_t>(h, static_cast<typename std::make_unsigned<T>::type>(str[i]));
+            return static_cast<size_t>(h);
+        }
+    };
+
+} // namespace detail
+
+/** \brief Non-owning reference to a range of characters (not necessarily null-terminated)
+ *
+ * A view never allocates and is valid as long as the referenced buffer is alive.
+ * StringBase is implicitly convertible to a view, while a view should be converted
+ * to StringBase explicitly using toString().
+ */
+template<typename T>
+class StringViewBase
+{
+public:
+    /** \brief Random access iterator for accessing an individual character in the view */
+    typedef const T *iterator;
+    /** \brief Random access iterator for accessing an individual character in the view */
+    typedef const T *const_iterator;
+    /** \brief Invalid/end-of-string character index */
+    static const size_t npos = static_cast<size_t>(-1);
+
+    /** \brief Constructs a null view */
+    StringViewBase() : m_data(nullptr), m_length(0) { }
+    /** \brief Constructs a view referencing a null-terminated C-string */
+    StringViewBase(const T *str) : m_data(str), m_length(str ? detail::StringHelper<T>::strlen(str) : 0) { }
+    /** \brief Constructs a view referencing the given buffer */
+    StringViewBase(const T *str, size_t length) : m_data(str), m_length(length) { }
+    /** \brief Constructs a view referencing the given range of characters */
+    StringViewBase(const_iterator begin, const_iterator end) : m_data(begin), m_length(end - begin) { }
+    /** \brief Constructs a view referencing contents of the standard library string */
+    StringViewBase(const std::basic_string<T>& str) : m_data(str.data()), m_length(str.size()) { }
+
+    /** \brief Gets a pointer to the first referenced character */
+    const T *data() const { return m_data; }
+    /** \brief Gets number of referenced characters */
+    size_t length() const { return m_length; }
+    /** \brief Gets number of referenced characters */
+    size_t size() const { return m_length; }
+    /** \brief Checks whether this view references no buffer */
+    bool isNull() const { return !m_data; }
+    /** \brief Checks whether this view is either null or empty */
+    bool isNullOrEmpty() const { return !m_length; }
+
+    /** \brief Gets a character at given position */
+    const T& operator[](size_t i) const { assert(i < m_length); return m_data[i]; }
+    /** \brief Gets the first character. View should not be empty. */
+    const T& front() const { assert(m_length); return m_data[0]; }
+    /** \brief Gets the last character. View should not be empty. */
+    const T& back() const { assert(m_length); return m_data[m_length - 1]; }
+
+    /** \brief Gets an iterator pointing to the first character */
+    const_iterator begin() const { return m_data; }
+    /** \brief Gets an iterator pointing past the last character */
+    const_iterator end() const { return m_data + m_length; }
+
+    /** \brief Gets a position of the next occurence of the character starting from the specified position or npos */
+    size_t find(T ch, size_t pos = 0) const
+    {
+        if (pos >= m_length) return npos;
+        auto it = detail::findChar(begin() + pos, end(), ch);
+        return it == end() ? npos : it - begin();
+    }
+
+    /** \brief Gets a position of the next occurence of the substring starting from the specified position or npos */
+    size_t find(const StringViewBase& str, size_t pos = 0) const
+    {
+        if (pos > m_length) return npos;
+        auto it = detail::findSubstring(begin() + pos, end(), str.m_data, str.m_length);
+        return it == end() && str.m_length ? npos : it - begin();
+    }
+
+    /** \brief Gets a position of the last occurence of the character or npos */
+    size_t rfind(T ch) const
+    {
+        auto it = detail::findLastChar(begin(), end(), ch);
+        return it == end() ? npos : it - begin();
+    }
+
+    /** \brief Gets a position of the last occurence of the substring or npos */
+    size_t rfind(const StringViewBase& str) const
+    {
+        auto it = detail::findLastSubstring(begin(), end(), str.m_data, str.m_length);
+        return it == end() ? npos : it - begin();
+    }
+
+    /** \brief Checks whether this view contains given substring */
+    bool contains(const StringViewBase& str) const { return find(str) != npos; }
+
+    /** \brief Checks whether this view starts with given string */
+    bool startsWith(const StringViewBase& str) const
+    {
+        return str.m_length <= m_length && std::equal(str.begin(), str.end(), begin());
+    }
+
+    /** \brief Checks whether this view ends with given string */
+    bool endsWith(const StringViewBase& str) const
+    {
+        return str.m_length <= m_length && std::equal(str.begin(), str.end(), end() - str.m_length);
+    }
+
+    /** \brief Gets a view of the part of this view */
+    StringViewBase substr(size_t start, size_t length = npos) const
+    {
+        if (start >= m_length) return StringViewBase(m_data ? end() : nullptr, size_t(0));
+        return StringViewBase(m_data + start, std::min(length, m_length - start));
+    }
+
+    /** \brief Returns array of views of parts of this view delimited by given separator */
+    Array<StringViewBase> split(T separator, bool keepEmptyElements = false) const
+    {
+        Array<StringViewBase> result;
+        auto b = begin(), e = end();
+        while (true)
+        {
+            auto ps = detail::findChar(b, e, separator);
+            if (keepEmptyElements || ps != b) result.push_back(StringViewBase(b, ps));
+            if (ps == e) break;
+            b = ps + 1;
+        }
+        return result;
+    }
+
+    /** \brief Checks two views for equality, null and empty views are equal */
+    bool equals(const StringViewBase& rhs, bool caseSensetive = true) const
+    {
+        if (m_length != rhs.m_length) return false;
+        if (!m_length) return true;
+        return caseSensetive ? std::equal(begin(), end(), rhs.begin()) :
+                               0 == detail::compareIgnoreCase(m_data, rhs.m_data, m_length);
+    }
+
+    /** \brief Gets hash of the referenced characters equal to the hash of the same StringBase */
+    size_t hash() const { return detail::StringHelper<T>::hash(m_data, m_length) | 1; }
+
+    /** \brief Creates a string holding a copy of the referenced characters */
+    StringBase<T> toString() const;
+
+    /** \brief Parses the number at the beginning of this view
+     *
+     * Throws std::invalid_argument if the view does not start with a number or the number does not fit into T1.
+     */
+    template<typename T1>
+    T1 toValue() const
+    {
+        static_assert(detail::IsFormattableNumber<T1>::value, "Only numbers may be parsed from StringView");
+        typename detail::NumberFormatType<T1>::type result;
+        detail::parseNumberString(m_data, m_length, result);
+        if (std::is_integral<T1>::value &&
+                (result < std::numeric_limits<T1>::lowest() || result > std::numeric_limits<T1>::max()))
+            throw std::invalid_argument("String is not convertible to a number of the requested type");
+        return static_cast<T1>(result);
+    }
+private:
+    const T *m_data;
+    size_t m_length;
+};
+
+template<typename T>
+const size_t StringViewBase<T>::npos;
+
+/** \brief View of a string in native system encoding
+ * \relates metacpp::StringViewBase
+ */
+typedef StringViewBase<char> StringView;
+
+/** \brief View of a string in UTF16-LE encoding
+ * \relates metacpp::StringViewBase
+ */
+typedef StringViewBase<char16_t> WStringView;
+
+/** \relates metacpp::StringViewBase */
+template<typename T>
+inline bool operator==(const StringViewBase<T>& lhs, const StringViewBase<T>& rhs) { return lhs.equals(rhs); }
+
+/** \relates metacpp::StringViewBase */
+template<typename T>
+inline bool operator!=(const StringViewBase<T>& lhs, const StringViewBase<T>& rhs) { return !lhs.equals(rhs); }
+
+/** \relates metacpp::StringViewBase */
+template<typename T>
+inline bool operator==(const StringViewBase<T>& lhs, const T *rhs) { return lhs.equals(rhs); }
+
+/** \relates metacpp::StringViewBase */
+template<typename T>
+inline bool operator!=(const StringViewBase<T>& lhs, const T *rhs) { return !lhs.equals(rhs); }
+
+/** \relates metacpp::StringViewBase */
+template<typename T>
+bool operator<(const StringViewBase<T>& a, const StringViewBase<T>& b)
+{
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+} // namespace metacpp
+
+namespace std
+{
+
+/** \brief Hash functor for using string views as keys of STL unordered containers
+ * \relates metacpp::StringViewBase
+ */
+template<typename T>
+struct hash<metacpp::StringViewBase<T> >
+{
+    size_t operator()(const metacpp::StringViewBase<T>& str) const { return str.hash(); }
+};
+
+} // namespace std
+
+#endif // STRINGVIEW_H
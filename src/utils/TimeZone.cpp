@@ -0,0 +1,458 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "TimeZone.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace metacpp {
+
+namespace detail
+{
+
+namespace
+{
+    const int SecondsPerDay = 24 * 60 * 60;
+
+    bool isAlpha(char ch)
+    {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+    }
+
+    bool isDigit(char ch)
+    {
+        return ch >= '0' && ch <= '9';
+    }
+
+    bool parseNumber(const char *&p, int min, int max, int& value)
+    {
+        if (!isDigit(*p))
+            return false;
+        value = 0;
+        for (; isDigit(*p); ++p)
+        {
+            value = value * 10 + (*p - '0');
+            if (value > max)
+                return false;
+        }
+        return value >= min;
+    }
+
+    /** Parses zone abbreviation, either alphabetic or quoted in angle brackets */
+    bool parseAbbreviation(const char *&p)
+    {
+        const char *start = p;
+        if (*p == '<')
+        {
+            while (*p && *p != '>') ++p;
+            if (!*p) return false;
+            return ++p - start >= 5;
+        }
+        while (isAlpha(*p)) ++p;
+        return p - start >= 3;
+    }
+
+    /** Parses [+|-]hh[:mm[:ss]], hours may be up to 167 as allowed for transition times */
+    bool parseTime(const char *&p, int& seconds)
+    {
+        int sign = 1;
+        if (*p == '+' || *p == '-')
+            sign = *p++ == '-' ? -1 : 1;
+        int h, m = 0, s = 0;
+        if (!parseNumber(p, 0, 167, h))
+            return false;
+        if (*p == ':' && (!parseNumber(++p, 0, 59, m) || (*p == ':' && !parseNumber(++p, 0, 59, s))))
+            return false;
+        seconds = sign * (h * 3600 + m * 60 + s);
+        return true;
+    }
+
+    bool parseTransition(const char *&p, TimeZoneRule::Transition& transition)
+    {
+        transition.time = 2 * 3600;
+        transition.month = transition.week = 0;
+        if (*p == 'M')
+        {
+            transition.kind = 'M';
+            if (!parseNumber(++p, 1, 12, transition.month) || *p != '.' ||
+                    !parseNumber(++p, 1, 5, transition.week) || *p != '.' ||
+                    !parseNumber(++p, 0, 6, transition.day))
+                return false;
+        }
+        else if (*p == 'J')
+        {
+            transition.kind = 'J';
+            if (!parseNumber(++p, 1, 365, transition.day))
+                return false;
+        }
+        else
+        {
+            transition.kind = 'D';
+            if (!parseNumber(p, 0, 365, transition.day))
+                return false;
+        }
+        return *p != '/' || parseTime(++p, transition.time);
+    }
+
+    /** Sequential big-endian reader of the TZif data */
+    class TzifReader
+    {
+    public:
+        TzifReader(const uint8_t *data, size_t size)
+            : m_p(data), m_end(data + size)
+        {
+        }
+
+        bool has(size_t n) const { return static_cast<size_t>(m_end - m_p) >= n; }
+        void skip(size_t n) { m_p += n; }
+        const uint8_t *data() const { return m_p; }
+        size_t remaining() const { return m_end - m_p; }
+
+        uint8_t u8() { return *m_p++; }
+
+        uint32_t u32()
+        {
+            uint32_t v = (uint32_t)m_p[0] << 24 | (uint32_t)m_p[1] << 16 | (uint32_t)m_p[2] << 8 | m_p[3];
+            m_p += 4;
+            return v;
+        }
+
+        int64_t i64()
+        {
+            uint64_t hi = u32();
+            return static_cast<int64_t>(hi << 32 | u32());
+        }
+    private:
+        const uint8_t *m_p, *m_end;
+    };
+
+    struct TzifHeader
+    {
+        char version;
+        uint32_t isUtCount, isStdCount, leapCount, timeCount, typeCount, charCount;
+
+        bool read(TzifReader& reader)
+        {
+            if (!reader.has(44) || memcmp(reader.data(), "TZif", 4))
+                return false;
+            reader.skip(4);
+            version = static_cast<char>(reader.u8());
+            reader.skip(15);
+            isUtCount = reader.u32();
+            isStdCount = reader.u32();
+            leapCount = reader.u32();
+            timeCount = reader.u32();
+            typeCount = reader.u32();
+            charCount = reader.u32();
+            return typeCount > 0;
+        }
+
+        size_t dataSize(size_t timeSize) const
+        {
+            return timeCount * (timeSize + 1) + typeCount * 6 + charCount +
+                    leapCount * (timeSize + 4) + isStdCount + isUtCount;
+        }
+    };
+
+    bool parseTzif(const uint8_t *data, size_t size, TimeZoneData& zone)
+    {
+        TzifReader reader(data, size);
+        TzifHeader header;
+        if (!header.read(reader))
+            return false;
+        size_t timeSize = 4;
+        if (header.version >= '2')
+        {
+            // skip the legacy 32-bit block
+            if (!reader.has(header.dataSize(4)))
+                return false;
+            reader.skip(header.dataSize(4));
+            if (!header.read(reader))
+                return false;
+            timeSize = 8;
+        }
+        if (!reader.has(header.dataSize(timeSize)))
+            return false;
+
+        zone.transitions.resize(header.timeCount);
+        for (uint32_t i = 0; i < header.timeCount; ++i)
+            zone.transitions[i] = timeSize == 8 ? reader.i64() : static_cast<int32_t>(reader.u32());
+        const uint8_t *indices = reader.data();
+        reader.skip(header.timeCount);
+        Array<int32_t> typeOffsets;
+        typeOffsets.resize(header.typeCount);
+        for (uint32_t i = 0; i < header.typeCount; ++i)
+        {
+            typeOffsets[i] = static_cast<int32_t>(reader.u32());
+            reader.skip(2); // isdst and abbreviation index
+        }
+        zone.offsets.resize(header.timeCount);
+        for (uint32_t i = 0; i < header.timeCount; ++i)
+        {
+            if (indices[i] >= header.typeCount)
+                return false;
+            zone.offsets[i] = typeOffsets[indices[i]];
+        }
+        // local time before the first transition is described by the first type
+        zone.initialOffset = typeOffsets[0];
+        reader.skip(header.charCount + header.leapCount * (timeSize + 4) + header.isStdCount + header.isUtCount);
+
+        zone.hasRule = false;
+        if (timeSize == 8 && reader.has(2) && reader.u8() == '\n')
+        {
+            const char *footer = reinterpret_cast<const char *>(reader.data());
+            const char *footerEnd = static_cast<const char *>(memchr(footer, '\n', reader.remaining()));
+            if (footerEnd && footerEnd != footer)
+            {
+                String rule(footer, footerEnd - footer);
+                zone.hasRule = zone.rule.parse(rule.c_str());
+            }
+        }
+        return true;
+    }
+
+    TimeZone loadLocalTimeZone()
+    {
+#ifdef _WIN32
+        // no tz database, use current standard offset of the system
+        _tzset();
+        long seconds = 0;
+        _get_timezone(&seconds);
+        char rule[32];
+        char sign = seconds < 0 ? '-' : '+';
+        seconds = labs(seconds);
+        snprintf(rule, sizeof(rule), "<LOCAL>%c%ld:%02ld:%02ld", sign, seconds / 3600, seconds / 60 % 60, seconds % 60);
+        return TimeZone::fromName(rule);
+#else
+        const char *tz = getenv("TZ");
+        try
+        {
+            if (tz)
+                return *tz ? TimeZone::fromName(*tz == ':' ? tz + 1 : tz) : TimeZone();
+            return TimeZone::fromFile("/etc/localtime", "localtime");
+        }
+        catch (const std::invalid_argument&)
+        {
+            return TimeZone();
+        }
+#endif
+    }
+
+} // namespace
+
+int64_t TimeZoneRule::Transition::localTime(int year) const
+{
+    int64_t days;
+    switch (kind)
+    {
+    case 'J':
+        // February 29 is never counted
+        days = daysFromCivil(year, 1, 1) + day - 1 + (isLeapYear(year) && day >= 60);
+        break;
+    case 'D':
+        days = daysFromCivil(year, 1, 1) + day;
+        break;
+    default:
+    {
+        int64_t first = daysFromCivil(year, static_cast<unsigned>(month), 1);
+        int64_t weekDay = first + 4 - floorDiv(first + 4, 7) * 7;
+        days = first + (day - weekDay + 7) % 7 + (week - 1) * 7;
+        int64_t last = first + daysInMonth(year, static_cast<unsigned>(month)) - 1;
+        while (days > last)
+            days -= 7;
+        break;
+    }
+    }
+    return days * SecondsPerDay + time;
+}
+
+int TimeZoneRule::offsetAt(int64_t utcSeconds) const
+{
+    if (!hasDst)
+        return stdOffset;
+    int year;
+    unsigned month, day;
+    civilFromDays(floorDiv(utcSeconds + stdOffset, SecondsPerDay), year, month, day);
+    // start time is specified in standard time and end time in daylight saving time
+    int64_t dstStart = start.localTime(year) - stdOffset;
+    int64_t dstEnd = end.localTime(year) - dstOffset;
+    bool dst = dstStart < dstEnd ?
+                utcSeconds >= dstStart && utcSeconds < dstEnd :
+                utcSeconds < dstEnd || utcSeconds >= dstStart;
+    return dst ? dstOffset : stdOffset;
+}
+
+bool TimeZoneRule::parse(const char *str)
+{
+    const char *p = str;
+    int offset;
+    // POSIX offsets are positive west of Greenwich
+    if (!parseAbbreviation(p) || !parseTime(p, offset))
+        return false;
+    stdOffset = -offset;
+    hasDst = *p != '\0';
+    if (!hasDst)
+        return true;
+    if (!parseAbbreviation(p))
+        return false;
+    dstOffset = stdOffset + 3600;
+    if (*p && *p != ',')
+    {
+        if (!parseTime(p, offset))
+            return false;
+        dstOffset = -offset;
+    }
+    if (!*p)
+    {
+        // rules are implementation defined when omitted, use the US ones like glibc does
+        p = ",M3.2.0,M11.1.0";
+    }
+    return *p == ',' && parseTransition(++p, start) && *p == ',' && parseTransition(++p, end) && !*p;
+}
+
+TimeZoneData::TimeZoneData()
+    : name("UTC"), initialOffset(0), hasRule(false)
+{
+    rule.stdOffset = rule.dstOffset = 0;
+    rule.hasDst = false;
+}
+
+SharedDataBase *TimeZoneData::clone() const
+{
+    TimeZoneData *copy = new TimeZoneData();
+    copy->name = name;
+    copy->transitions = transitions;
+    copy->offsets = offsets;
+    copy->initialOffset = initialOffset;
+    copy->rule = rule;
+    copy->hasRule = hasRule;
+    return copy;
+}
+
+} // namespace detail
+
+TimeZone::TimeZone(detail::TimeZoneData *d)
+    : SharedDataPointer(d)
+{
+}
+
+TimeZone::TimeZone()
+    : SharedDataPointer(new detail::TimeZoneData())
+{
+}
+
+const String &TimeZone::name() const
+{
+    return m_d->name;
+}
+
+int TimeZone::offsetFromUtc(int64_t utcSeconds) const
+{
+    const detail::TimeZoneData *d = m_d;
+    size_t count = d->transitions.size();
+    if (!count || utcSeconds < d->transitions[0])
+        return !count && d->hasRule ? d->rule.offsetAt(utcSeconds) : d->initialOffset;
+    if (utcSeconds >= d->transitions[count - 1] && d->hasRule)
+        return d->rule.offsetAt(utcSeconds);
+    const int64_t *first = d->transitions.data();
+    size_t i = std::upper_bound(first, first + count, utcSeconds) - first;
+    return d->offsets[i - 1];
+}
+
+int TimeZone::offsetFromLocal(int64_t localSeconds) const
+{
+    // offsets around the local time, the one in effect before a transition is tried first
+    int before = offsetFromUtc(localSeconds - 24 * 60 * 60);
+    int after = offsetFromUtc(localSeconds + 24 * 60 * 60);
+    if (offsetFromUtc(localSeconds - before) == before)
+        return before;
+    if (offsetFromUtc(localSeconds - after) == after)
+        return after;
+    return before;
+}
+
+DateTime TimeZone::toLocal(const DateTime& utc) const
+{
+    int64_t us = utc.toMicrosecondsSinceEpoch();
+    return DateTime::fromMicrosecondsSinceEpoch(us + offsetFromUtc(detail::floorDiv(us, 1000000)) * int64_t(1000000));
+}
+
+DateTime TimeZone::toUtc(const DateTime& local) const
+{
+    int64_t us = local.toMicrosecondsSinceEpoch();
+    return DateTime::fromMicrosecondsSinceEpoch(us - offsetFromLocal(detail::floorDiv(us, 1000000)) * int64_t(1000000));
+}
+
+const TimeZone &TimeZone::utc()
+{
+    static const TimeZone zone;
+    return zone;
+}
+
+const TimeZone &TimeZone::local()
+{
+    static const TimeZone zone = detail::loadLocalTimeZone();
+    return zone;
+}
+
+TimeZone TimeZone::fromName(const char *name)
+{
+    if (!name || !*name)
+        throw std::invalid_argument("Empty time zone name");
+    if (name[0] == '/')
+        return fromFile(name, name);
+    if (!strstr(name, ".."))
+    {
+        const char *dir = getenv("TZDIR");
+        String path = String(dir && *dir ? dir : "/usr/share/zoneinfo") + "/" + name;
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file)
+        {
+            fclose(file);
+            return fromFile(path.c_str(), name);
+        }
+    }
+    detail::TimeZoneData *d = new detail::TimeZoneData();
+    TimeZone zone(d);
+    if (!d->rule.parse(name))
+        throw std::invalid_argument(String(String("Unknown time zone ") + name).c_str());
+    d->name = name;
+    d->hasRule = true;
+    d->initialOffset = d->rule.stdOffset;
+    return zone;
+}
+
+TimeZone TimeZone::fromFile(const char *path, const char *name)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        throw std::invalid_argument(String(String("Cannot open time zone file ") + path).c_str());
+    ByteArray content;
+    uint8_t buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), file)) > 0; )
+        content.append(buf, n);
+    fclose(file);
+
+    detail::TimeZoneData *d = new detail::TimeZoneData();
+    TimeZone zone(d);
+    if (!detail::parseTzif(content.data(), content.size(), *d))
+        throw std::invalid_argument(String(String("Malformed time zone file ") + path).c_str());
+    d->name = name;
+    return zone;
+}
+
+} // namespace metacpp
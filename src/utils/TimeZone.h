@@ -0,0 +1,130 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef METACPP_TIMEZONE_H
+#define METACPP_TIMEZONE_H
+#include "config.h"
+#include "DateTime.h"
+#include "Array.h"
+
+namespace metacpp {
+
+namespace detail
+{
+    /** \brief Daylight saving time rule in form of POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3" */
+    struct TimeZoneRule
+    {
+        /** \brief Date and local time of the transition */
+        struct Transition
+        {
+            /** \brief 'J' for one-based day of year without leap days, 'D' for zero-based day of year, 'M' for month rule */
+            char kind;
+            /** \brief Day of year or day of week for month rule (0 is Sunday) */
+            int day;
+            /** \brief Month (1-based) and week of month (5 is the last week) for month rule */
+            int month, week;
+            /** \brief Local time of the transition in seconds */
+            int time;
+
+            /** \brief Gets number of local seconds since 1970-01-01 of the transition in the given year */
+            int64_t localTime(int year) const;
+        };
+
+        /** \brief Standard and daylight saving time offsets in seconds east of UTC */
+        int stdOffset, dstOffset;
+        bool hasDst;
+        Transition start, end;
+
+        /** \brief Gets offset from UTC in seconds at the given number of seconds since the epoch */
+        int offsetAt(int64_t utcSeconds) const;
+        /** \brief Parses rule from the POSIX TZ string, returns false if the string is malformed */
+        bool parse(const char *str);
+    };
+
+    class TimeZoneData : public SharedDataBase
+    {
+    public:
+        TimeZoneData();
+
+        SharedDataBase *clone() const override;
+
+        String name;
+        /** \brief Moments of offset changes in seconds since the epoch, ascending */
+        Array<int64_t> transitions;
+        /** \brief Offsets in seconds east of UTC taking effect at the corresponding transitions */
+        Array<int32_t> offsets;
+        /** \brief Offset in effect before the first transition */
+        int32_t initialOffset;
+        /** \brief Rule in effect after the last transition */
+        TimeZoneRule rule;
+        bool hasRule;
+    };
+} // namespace detail
+
+/** \brief A class representing time zone compiled from the tz database
+ *
+ * Offsets are looked up in the transition table loaded once from the TZif file, times beyond
+ * the table are covered by the POSIX rule from the file footer. Instances are immutable,
+ * conversions take no locks and do not call into the C library.
+ */
+class TimeZone final : protected SharedDataPointer<detail::TimeZoneData>
+{
+    explicit TimeZone(detail::TimeZoneData *d);
+public:
+    /** \brief Constructs UTC time zone */
+    TimeZone();
+
+    /** \brief Gets name of this time zone */
+    const String& name() const;
+
+    /** \brief Gets offset from UTC in seconds at the given moment (in seconds since 1970-01-01 UTC) */
+    int offsetFromUtc(int64_t utcSeconds) const;
+    /** \brief Gets offset from UTC in seconds at the given local time (in seconds since 1970-01-01 of local calendar)
+     *
+     * Ambiguous local times repeating at the end of daylight saving time resolve to the earlier moment,
+     * nonexistent local times skipped at its start are treated as the time before the transition.
+     */
+    int offsetFromLocal(int64_t localSeconds) const;
+
+    /** \brief Converts date and time in UTC to the local time of this zone */
+    DateTime toLocal(const DateTime& utc) const;
+    /** \brief Converts local date and time of this zone to UTC */
+    DateTime toUtc(const DateTime& local) const;
+
+    /** \brief Gets UTC time zone */
+    static const TimeZone& utc();
+    /** \brief Gets local time zone of the system
+     *
+     * The zone is loaded on the first use from the TZ environment variable or /etc/localtime,
+     * UTC is used if neither is available.
+     */
+    static const TimeZone& local();
+    /** \brief Loads time zone with the given name
+     *
+     * \arg name Either a name in the tz database (e.g. "Europe/Berlin") looked up in TZDIR or
+     * /usr/share/zoneinfo, an absolute path of the TZif file or a POSIX TZ string (e.g. "EST5EDT,M3.2.0,M11.1.0")
+     * \throws std::invalid_argument if time zone is not found or malformed
+     */
+    static TimeZone fromName(const char *name);
+    /** \brief Loads time zone from the file in TZif format
+     *
+     * \throws std::invalid_argument if the file does not exist or malformed
+     */
+    static TimeZone fromFile(const char *path, const char *name);
+};
+
+} // namespace metacpp
+
+#endif // METACPP_TIMEZONE_H
@@ -0,0 +1,229 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "Unicode.h"
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define METACPP_UNICODE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace metacpp
+{
+namespace detail
+{
+
+namespace
+{
+
+const char16_t ReplacementCharacter = 0xFFFD;
+
+inline bool isHighSurrogate(uint32_t ch) { return ch - 0xD800 < 0x400; }
+inline bool isLowSurrogate(uint32_t ch) { return ch - 0xDC00 < 0x400; }
+
+/** Copies the leading run of ASCII characters widening them, returns length of the run */
+size_t widenAscii(const char *str, size_t length, char16_t *dest)
+{
+    size_t i = 0;
+#ifdef METACPP_UNICODE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; length - i >= 16; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+        if (_mm_movemask_epi8(v))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+#endif
+    for (; i < length && !(str[i] & 0x80); ++i)
+        dest[i] = static_cast<char16_t>(str[i]);
+    return i;
+}
+
+/** Gets length of the leading run of ASCII characters */
+size_t asciiSpan(const char16_t *str, size_t length)
+{
+    size_t i = 0;
+#ifdef METACPP_UNICODE_SSE2
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80)), zero = _mm_setzero_si128();
+    for (; length - i >= 16; i += 16)
+    {
+        __m128i v = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i + 8)));
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, nonAscii), zero)))
+            break;
+    }
+#endif
+    while (i < length && str[i] < 0x80) ++i;
+    return i;
+}
+
+/** Copies the leading run of ASCII characters narrowing them, returns length of the run */
+size_t narrowAscii(const char16_t *str, size_t length, char *dest)
+{
+    size_t i = 0;
+#ifdef METACPP_UNICODE_SSE2
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80)), zero = _mm_setzero_si128();
+    for (; length - i >= 16; i += 16)
+    {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i + 8));
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(lo, hi), nonAscii), zero)))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < length && str[i] < 0x80; ++i)
+        dest[i] = static_cast<char>(str[i]);
+    return i;
+}
+
+} // namespace
+
+size_t utf8Length(const char16_t *str, size_t length)
+{
+    size_t result = 0, i = 0;
+    while (i < length)
+    {
+        if (str[i] < 0x80)
+        {
+            size_t ascii = asciiSpan(str + i, length - i);
+            result += ascii;
+            i += ascii;
+            continue;
+        }
+        uint32_t ch = str[i++];
+        if (ch < 0x800)
+            result += 2;
+        else if (isHighSurrogate(ch) && i < length && isLowSurrogate(str[i]))
+        {
+            result += 4;
+            ++i;
+        }
+        else
+            result += 3; // unpaired surrogates take three bytes of U+FFFD
+    }
+    return result;
+}
+
+size_t utf8ToUtf16(const char *str, size_t length, char16_t *dest)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(str), *end = p + length;
+    char16_t *out = dest;
+    while (p != end)
+    {
+        if (*p < 0x80)
+        {
+            size_t ascii = widenAscii(reinterpret_cast<const char *>(p), end - p, out);
+            p += ascii;
+            out += ascii;
+            continue;
+        }
+        // valid ranges of the second byte depend on the lead one (see table 3-7 of the Unicode standard)
+        uint32_t lead = *p++, codePoint;
+        size_t trailing;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            trailing = 1;
+            codePoint = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            trailing = 2;
+            codePoint = lead & 0x0F;
+            if (lead == 0xE0) lo = 0xA0;        // overlong
+            else if (lead == 0xED) hi = 0x9F;   // surrogates
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            trailing = 3;
+            codePoint = lead & 0x07;
+            if (lead == 0xF0) lo = 0x90;        // overlong
+            else if (lead == 0xF4) hi = 0x8F;   // above U+10FFFF
+        }
+        else
+        {
+            *out++ = ReplacementCharacter;
+            continue;
+        }
+        size_t n = 0;
+        for (; n < trailing && p != end && *p >= lo && *p <= hi; ++n, ++p)
+        {
+            codePoint = (codePoint << 6) | (*p & 0x3F);
+            lo = 0x80;
+            hi = 0xBF;
+        }
+        if (n < trailing)
+        {
+            // the maximal ill-formed subpart consumed so far is replaced by a single character
+            *out++ = ReplacementCharacter;
+            continue;
+        }
+        if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            *out++ = static_cast<char16_t>(0xD800 | (codePoint >> 10));
+            *out++ = static_cast<char16_t>(0xDC00 | (codePoint & 0x3FF));
+        }
+        else
+            *out++ = static_cast<char16_t>(codePoint);
+    }
+    return out - dest;
+}
+
+size_t utf16ToUtf8(const char16_t *str, size_t length, char *dest)
+{
+    char *out = dest;
+    size_t i = 0;
+    while (i < length)
+    {
+        if (str[i] < 0x80)
+        {
+            size_t ascii = narrowAscii(str + i, length - i, out);
+            i += ascii;
+            out += ascii;
+            continue;
+        }
+        uint32_t ch = str[i++];
+        if (ch < 0x800)
+        {
+            *out++ = static_cast<char>(0xC0 | (ch >> 6));
+            *out++ = static_cast<char>(0x80 | (ch & 0x3F));
+        }
+        else if (isHighSurrogate(ch) && i < length && isLowSurrogate(str[i]))
+        {
+            uint32_t codePoint = 0x10000 + ((ch - 0xD800) << 10) + (str[i++] - 0xDC00);
+            *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            if (isHighSurrogate(ch) || isLowSurrogate(ch))
+                ch = ReplacementCharacter;
+            *out++ = static_cast<char>(0xE0 | (ch >> 12));
+            *out++ = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (ch & 0x3F));
+        }
+    }
+    return out - dest;
+}
+
+} // namespace detail
+} // namespace metacpp
@@ -0,0 +1,56 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef UNICODE_H
+#define UNICODE_H
+#include "config.h"
+#include <cstddef>
+
+namespace metacpp
+{
+namespace detail
+{
+
+/*
+ * UTF-8 <-> UTF-16 transcoding.
+ *
+ * Ill-formed input never stops the conversion: every maximal ill-formed subsequence
+ * of UTF-8 and every unpaired surrogate of UTF-16 is replaced with U+FFFD.
+ */
+
+/** \brief Gets the upper bound of UTF-16 code units produced from the UTF-8 text of the given length */
+inline size_t utf16MaxLength(size_t utf8Length) { return utf8Length; }
+
+/** \brief Gets the exact number of bytes needed to store the given UTF-16 text in UTF-8 */
+size_t utf8Length(const char16_t *str, size_t length);
+
+/** \brief Converts UTF-8 text into UTF-16
+ *
+ * \arg dest Destination buffer with room for at least utf16MaxLength(length) code units
+ * \returns number of code units written
+ */
+size_t utf8ToUtf16(const char *str, size_t length, char16_t *dest);
+
+/** \brief Converts UTF-16 text into UTF-8
+ *
+ * \arg dest Destination buffer with room for at least utf8Length(str, length) bytes
+ * \returns number of bytes written
+ */
+size_t utf16ToUtf8(const char16_t *str, size_t length, char *dest);
+
+} // namespace detail
+} // namespace metacpp
+
+#endif // UNICODE_H
@@ -35,7 +35,7 @@ public:
     UriBase(const UriBase&)=default;
     UriBase& operator=(const UriBase&)=default;
     /** \brief Construct a new instance of UriBase using specified uri string */
-    explicit UriBase(const StringBase<CharT>& uri)
+    explicit UriBase(const StringViewBase<CharT>& uri)
     {
         parseUri(uri);
     }
@@ -45,56 +45,58 @@ public:
     }
 
 private:
-    void parseUri(const StringBase<CharT>& uri)
+    void parseUri(const StringViewBase<CharT>& uri)
     {
-        const size_t npos = StringBase<CharT>::npos;
+        typedef StringViewBase<CharT> View;
+        const size_t npos = View::npos;
+        static const CharT schemeSeparator[] = { ':', '/', '/' };
         if (uri.isNullOrEmpty()) return;
-        size_t schemeEnd = uri.firstIndexOf("://");
-        auto hierarchyBegin = uri.begin();
+        size_t schemeEnd = uri.find(View(schemeSeparator, 3));
+        size_t hierarchyBegin = 0;
         if (npos != schemeEnd)
         {
-            hierarchyBegin += schemeEnd + 3;
-            m_schemeName = uri.substr(0, schemeEnd);
+            hierarchyBegin = schemeEnd + 3;
+            m_schemeName = uri.substr(0, schemeEnd).toString();
         }
-        auto hierarchyEnd = std::find(hierarchyBegin, uri.end(), '?');
-        m_hierarchy = StringBase<CharT>(hierarchyBegin, hierarchyEnd);
-        size_t authSepPos = m_hierarchy.lastIndexOf("@");
+        size_t hierarchyEnd = uri.find('?', hierarchyBegin);
+        View hierarchy = uri.substr(hierarchyBegin, npos != hierarchyEnd ? hierarchyEnd - hierarchyBegin : npos);
+        m_hierarchy = hierarchy.toString();
+        size_t authSepPos = hierarchy.rfind('@');
         if (npos != authSepPos)
         {
-            StringBase<CharT> authInfo = m_hierarchy.substr(0, authSepPos);
-            size_t passStart = authInfo.firstIndexOf(":");
+            View authInfo = hierarchy.substr(0, authSepPos);
+            size_t passStart = authInfo.find(':');
             if (npos != passStart)
             {
-                m_username = authInfo.substr(0, passStart);
-                m_password = authInfo.substr(passStart + 1);
+                m_username = authInfo.substr(0, passStart).toString();
+                m_password = authInfo.substr(passStart + 1).toString();
             }
             else
-                m_username = authInfo;
+                m_username = authInfo.toString();
         }
         size_t hostStart = npos != authSepPos ? authSepPos + 1 : 0;
-        size_t portStart = m_hierarchy.nextIndexOf(":", hostStart);
-        size_t pathStart = m_hierarchy.nextIndexOf("/", hostStart);
+        size_t portStart = hierarchy.find(':', hostStart);
+        size_t pathStart = hierarchy.find('/', hostStart);
         if (npos != portStart)
         {
-            pathStart = m_hierarchy.nextIndexOf("/", portStart + 1);
-            m_host = m_hierarchy.substr(hostStart, portStart - hostStart);
-            m_port = m_hierarchy.substr(portStart + 1, npos != pathStart ? pathStart - portStart - 1 : npos);
+            pathStart = hierarchy.find('/', portStart + 1);
+            m_host = hierarchy.substr(hostStart, portStart - hostStart).toString();
+            m_port = hierarchy.substr(portStart + 1, npos != pathStart ? pathStart - portStart - 1 : npos).toString();
         }
         else
-            m_host = m_hierarchy.substr(hostStart, npos != pathStart ? pathStart - hostStart : npos);
+            m_host = hierarchy.substr(hostStart, npos != pathStart ? pathStart - hostStart : npos).toString();
         if (npos != pathStart)
-            m_path = m_hierarchy.substr(pathStart + 1);
+            m_path = hierarchy.substr(pathStart + 1).toString();
 
-        if (hierarchyEnd != uri.end())
+        if (npos != hierarchyEnd)
         {
-            StringBase<CharT> paramsString(hierarchyEnd + 1, uri.end());
-            for (auto& param : paramsString.split('&'))
+            for (auto& param : uri.substr(hierarchyEnd + 1).split('&'))
             {
-                size_t nSep = param.firstIndexOf("=");
-                if (param.npos != nSep)
-                    m_params.push_back(std::make_pair(param.substr(0, nSep), param.substr(nSep + 1)));
+                size_t nSep = param.find('=');
+                if (npos != nSep)
+                    m_params.push_back(std::make_pair(param.substr(0, nSep).toString(), param.substr(nSep + 1).toString()));
                 else
-                    m_params.push_back(std::make_pair(param, StringBase<CharT>()));
+                    m_params.push_back(std::make_pair(param.toString(), StringBase<CharT>()));
             }
         }
     }
@@ -138,34 +140,29 @@ public:
      *
      * In the above example named parameters are key1=value1 and key2=value2
     */
-    StringBase<CharT> param(const StringBase<CharT>& key) const
+    StringBase<CharT> param(const StringViewBase<CharT>& key) const
     {
         auto it = std::find_if(m_params.begin(), m_params.end(),
-            [=](const std::pair<StringBase<CharT>, StringBase<CharT> >& param) { return param.first == key; });
+            [&](const std::pair<StringBase<CharT>, StringBase<CharT> >& param) { return param.first == key; });
         if (it != m_params.end())
             return it->second.urldecode();
         else
             return StringBase<CharT>::getNull();
     }
 
-    String toString() const
+    StringBase<CharT> toString() const
     {
-        StringStream os;
-        if (!m_schemeName.isNullOrEmpty()) os << m_schemeName << "://";
-        if (!m_username.isNullOrEmpty()) os << m_username;
-        if (!m_password.isNullOrEmpty()) os << ":" << m_password;
-        if (!m_username.isNullOrEmpty() || m_username.isNullOrEmpty()) os << "@";
-        if (!m_host.isNullOrEmpty()) os << m_host;
-        if (!m_port.isNullOrEmpty()) os << ":" << m_port;
-        if (!m_path.isNullOrEmpty()) os << "/" << m_path;
-        if (m_params.size())
-        {
-            auto assignments = m_params.template map<StringBase<CharT> >
-                    ([](const std::pair<StringBase<CharT>, StringBase<CharT> >& param) -> StringBase<CharT>
-                        { return param.first + "=" + param.second; });
-            os << "?" << join(assignments, "&");
-        }
-        return os.str();
+        StringBuilderBase<CharT> res(m_schemeName.size() + m_hierarchy.size() + 16);
+        if (!m_schemeName.isNullOrEmpty()) res.append(m_schemeName).append(CharT(':')).append(2, CharT('/'));
+        if (!m_username.isNullOrEmpty()) res.append(m_username);
+        if (!m_password.isNullOrEmpty()) res.append(CharT(':')).append(m_password);
+        if (!m_username.isNullOrEmpty() || !m_password.isNullOrEmpty()) res.append(CharT('@'));
+        if (!m_host.isNullOrEmpty()) res.append(m_host);
+        if (!m_port.isNullOrEmpty()) res.append(CharT(':')).append(m_port);
+        if (!m_path.isNullOrEmpty()) res.append(CharT('/')).append(m_path);
+        for (size_t i = 0; i < m_params.size(); ++i)
+            res.append(CharT(i ? '&' : '?')).append(m_params[i].first).append(CharT('=')).append(m_params[i].second);
+        return res.take();
     }
 private:
     StringBase<CharT> m_schemeName, m_hierarchy, m_host, m_port, m_username, m_password, m_path;
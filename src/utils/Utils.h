@@ -15,6 +15,8 @@
 ****************************************************************************/
 #ifndef UTILS_H
 #define UTILS_H
+#include <cstddef>
+#include <cstdint>
 
 namespace metacpp
 {
@@ -26,6 +28,46 @@ struct FactoryBase
     virtual TBaseEntityPtr createInstance(Args... args) = 0;
 };
 
+namespace detail
+{
+
+/** \brief Parameters of the FNV-1a hash of the given width (uint32_t or uint64_t) */
+template<typename T>
+struct Fnv1a;
+
+template<>
+struct Fnv1a<uint32_t>
+{
+    static constexpr uint32_t basis() { return 2166136261U; }
+    static constexpr uint32_t prime() { return 16777619U; }
+};
+
+template<>
+struct Fnv1a<uint64_t>
+{
+    static constexpr uint64_t basis() { return 14695981039346656037ULL; }
+    static constexpr uint64_t prime() { return 1099511628211ULL; }
+};
+
+/** \brief Mixes a single value (a byte, a character or another hash) into FNV-1a hash h */
+template<typename T>
+inline T fnv1aMix(T h, T value)
+{
+    return (h ^ value) * Fnv1a<T>::prime();
+}
+
+/** \brief Mixes bytes of the buffer into FNV-1a hash h */
+template<typename T>
+inline T fnv1aBytes(T h, const void *data, size_t size)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+        h = fnv1aMix<T>(h, p[i]);
+    return h;
+}
+
+} // namespace detail
+
 } // namespace metacpp
 
 #endif // UTILS_H
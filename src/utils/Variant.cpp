@@ -15,6 +15,7 @@
 ****************************************************************************/
 #include "Variant.h"
 #include <stdexcept>
+#include <cassert>
 #include "Object.h"
 
 namespace metacpp
@@ -22,108 +23,41 @@ namespace metacpp
 namespace detail
 {
 
-    VariantData::VariantData()
-        : m_type(eFieldVoid)
+    /** \brief Destroys objects through their metaobjects, so pooled instances are released properly */
+    struct ObjectDeleter
     {
-    }
-
-    VariantData::~VariantData()
-    {
-    }
-
-    VariantData::VariantData(bool v)
-        : m_type(eFieldBool)
-    {
-        m_storage.m_bool = v;
-    }
-
-    VariantData::VariantData(int32_t v)
-        : m_type(eFieldInt)
-    {
-        m_storage.m_int = v;
-    }
-
-    VariantData::VariantData(uint32_t v)
-        : m_type(eFieldUint)
-    {
-        m_storage.m_uint = v;
-    }
-
-    VariantData::VariantData(const int64_t &v)
-        : m_type(eFieldInt64)
-    {
-        m_storage.m_int64 = v;
-    }
-
-    VariantData::VariantData(const uint64_t &v)
-        : m_type(eFieldUint64)
-    {
-        m_storage.m_uint64 = v;
-    }
-
-    VariantData::VariantData(const float &v)
-        : m_type(eFieldFloat)
-    {
-        m_storage.m_float = v;
-    }
-
-    VariantData::VariantData(const double &v)
-        : m_type(eFieldDouble)
-    {
-        m_storage.m_double = v;
-    }
-
-    VariantData::VariantData(const String &v)
-        : m_type(eFieldString), m_string(v)
-    {
-    }
+        void operator()(Object *o) const
+        {
+            o->deleteThis();
+        }
+    };
 
-    VariantData::VariantData(const DateTime &v)
-        : m_type(eFieldDateTime), m_datetime(v)
+    VariantData::VariantData(Object *o)
+        : m_object(o, ObjectDeleter())
     {
     }
 
-    VariantData::VariantData(Object *o)
-        : m_type(eFieldObject)
+    VariantData::VariantData(const Array<Variant> &a)
+        : m_array(a)
     {
-        m_object.reset(o);
     }
 
-    VariantData::VariantData(const Array<Variant> &a)
-        : m_type(eFieldArray)
+    VariantData::~VariantData()
     {
-        m_array = a;
     }
 
-    EFieldType VariantData::type() const
+    Object *VariantData::object() const
     {
-        return m_type;
+        return m_object.get();
     }
 
-    void *VariantData::buffer()
+    Array<Variant> *VariantData::array()
     {
-        switch (m_type)
-        {
-        case eFieldBool: return &m_storage.m_bool;
-        case eFieldInt: return &m_storage.m_int;
-        case eFieldUint: return &m_storage.m_uint;
-        case eFieldInt64: return &m_storage.m_int64;
-        case eFieldUint64: return &m_storage.m_uint64;
-        case eFieldFloat: return &m_storage.m_float;
-        case eFieldDouble: return &m_storage.m_double;
-        case eFieldObject: return m_object.get();
-        case eFieldDateTime: return &m_datetime;
-        case eFieldArray: return &m_array;
-        case eFieldString: return &m_string;
-        default:
-            throw std::runtime_error("Unknown variant type");
-        }
+        return &m_array;
     }
 
     Object *VariantData::extractObject()
     {
-        if (m_type != eFieldObject)
-            throw std::runtime_error("Not an object variant");
         return m_object.extract();
     }
 
@@ -132,156 +66,166 @@ namespace detail
         throw std::runtime_error("VariantData is not clonable");
     }
 
-    template<>
-    bool VariantData::value<bool>() const
+} // namespace detail
+
+template<>
+bool Variant::convert<bool>() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldBool:
-            return m_storage.m_bool;
-        case eFieldInt:
-            return m_storage.m_int != 0;
-        case eFieldUint:
-            return m_storage.m_uint != 0;
-        case eFieldInt64:
-            return m_storage.m_int64 != 0;
-        case eFieldUint64:
-            return m_storage.m_uint64 != 0;
-        case eFieldFloat:
-            return m_storage.m_float != 0;
-        case eFieldDouble:
-            return m_storage.m_double != 0;
-        default:
-            throw std::invalid_argument("Variant is not convertible to bool");
-        }
+    case eFieldBool:
+        return m_storage.m_bool;
+    case eFieldInt:
+        return m_storage.m_int != 0;
+    case eFieldUint:
+        return m_storage.m_uint != 0;
+    case eFieldInt64:
+        return m_storage.m_int64 != 0;
+    case eFieldUint64:
+        return m_storage.m_uint64 != 0;
+    case eFieldFloat:
+        return m_storage.m_float != 0;
+    case eFieldDouble:
+        return m_storage.m_double != 0;
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant is not convertible to bool");
     }
+}
 
-    template<typename T>
-    T VariantData::arithmetic_convert() const
+template<typename T>
+T Variant::arithmeticConvert() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldBool:
-            return static_cast<T>(m_storage.m_bool);
-        case eFieldInt:
-            return static_cast<T>(m_storage.m_int);
-        case eFieldUint:
-            return static_cast<T>(m_storage.m_uint);
-        case eFieldInt64:
-            return static_cast<T>(m_storage.m_int64);
-        case eFieldUint64:
-            return static_cast<T>(m_storage.m_uint64);
-        case eFieldFloat:
-            return static_cast<T>(m_storage.m_float);
-        case eFieldDouble:
-            return static_cast<T>(m_storage.m_double);
-        default:
-            throw std::invalid_argument("Variant does not contain arithmetic type");
-        }
+    case eFieldBool:
+        return static_cast<T>(m_storage.m_bool);
+    case eFieldInt:
+        return static_cast<T>(m_storage.m_int);
+    case eFieldUint:
+        return static_cast<T>(m_storage.m_uint);
+    case eFieldInt64:
+        return static_cast<T>(m_storage.m_int64);
+    case eFieldUint64:
+        return static_cast<T>(m_storage.m_uint64);
+    case eFieldFloat:
+        return static_cast<T>(m_storage.m_float);
+    case eFieldDouble:
+        return static_cast<T>(m_storage.m_double);
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant does not contain arithmetic type");
     }
+}
 
-    template<> int8_t VariantData::value<int8_t>() const { return arithmetic_convert<int8_t>(); }
-    template<> uint8_t VariantData::value<uint8_t>() const { return arithmetic_convert<uint8_t>(); }
-    template<> int16_t VariantData::value<int16_t>() const { return arithmetic_convert<int16_t>(); }
-    template<> uint16_t VariantData::value<uint16_t>() const { return arithmetic_convert<uint16_t>(); }
-    template<> int32_t VariantData::value<int32_t>() const { return arithmetic_convert<int32_t>(); }
-    template<> uint32_t VariantData::value<uint32_t>() const { return arithmetic_convert<uint32_t>(); }
-    template<> int64_t VariantData::value<int64_t>() const { return arithmetic_convert<int64_t>(); }
-    template<> uint64_t VariantData::value<uint64_t>() const { return arithmetic_convert<uint64_t>(); }
-    template<> float VariantData::value<float>() const { return arithmetic_convert<float>(); }
-    template<> double VariantData::value<double>() const { return arithmetic_convert<double>(); }
-    template<> long double VariantData::value<long double>() const { return arithmetic_convert<long double>(); }
-
-    template<>
-    String VariantData::value<String>() const
+template<> int8_t Variant::convert<int8_t>() const { return arithmeticConvert<int8_t>(); }
+template<> uint8_t Variant::convert<uint8_t>() const { return arithmeticConvert<uint8_t>(); }
+template<> int16_t Variant::convert<int16_t>() const { return arithmeticConvert<int16_t>(); }
+template<> uint16_t Variant::convert<uint16_t>() const { return arithmeticConvert<uint16_t>(); }
+template<> int32_t Variant::convert<int32_t>() const { return arithmeticConvert<int32_t>(); }
+template<> uint32_t Variant::convert<uint32_t>() const { return arithmeticConvert<uint32_t>(); }
+template<> int64_t Variant::convert<int64_t>() const { return arithmeticConvert<int64_t>(); }
+template<> uint64_t Variant::convert<uint64_t>() const { return arithmeticConvert<uint64_t>(); }
+template<> float Variant::convert<float>() const { return arithmeticConvert<float>(); }
+template<> double Variant::convert<double>() const { return arithmeticConvert<double>(); }
+template<> long double Variant::convert<long double>() const { return arithmeticConvert<long double>(); }
+
+template<>
+String Variant::convert<String>() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldBool:
-            return String::fromValue(m_storage.m_bool);
-        case eFieldInt:
-            return String::fromValue(m_storage.m_int);
-        case eFieldUint:
-            return String::fromValue(m_storage.m_uint);
-        case eFieldInt64:
-            return String::fromValue(m_storage.m_int64);
-        case eFieldUint64:
-            return String::fromValue(m_storage.m_uint64);
-        case eFieldFloat:
-            return String::fromValue(m_storage.m_float);
-        case eFieldDouble:
-            return String::fromValue(m_storage.m_double);
-        case eFieldString:
-            return m_string;
-        case eFieldDateTime:
-            return String::fromValue(m_datetime);
-        default:
-            throw std::invalid_argument("Variant is not convertible to String");
-        }
+    case eFieldBool:
+        return String::fromValue(m_storage.m_bool);
+    case eFieldInt:
+        return String::fromValue(m_storage.m_int);
+    case eFieldUint:
+        return String::fromValue(m_storage.m_uint);
+    case eFieldInt64:
+        return String::fromValue(m_storage.m_int64);
+    case eFieldUint64:
+        return String::fromValue(m_storage.m_uint64);
+    case eFieldFloat:
+        return String::fromValue(m_storage.m_float);
+    case eFieldDouble:
+        return String::fromValue(m_storage.m_double);
+    case eFieldString:
+        return stringValue();
+    case eFieldDateTime:
+        return String::fromValue(dateTimeValue());
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant is not convertible to String");
     }
+}
 
-    template<>
-    DateTime VariantData::value<DateTime>() const
+template<>
+DateTime Variant::convert<DateTime>() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldString:
-            return DateTime::fromString(m_string.data());
-        case eFieldDateTime:
-            return m_datetime;
-        default:
-            throw std::invalid_argument("Variant is not convertible to DateTime");
-        }
+    case eFieldString:
+        return DateTime::fromString(stringValue().data());
+    case eFieldDateTime:
+        return dateTimeValue();
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant is not convertible to DateTime");
     }
+}
 
-    template<>
-    Object *VariantData::value<Object *>() const
+template<>
+Object *Variant::convert<Object *>() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldObject:
-            return m_object.get();
-        default:
-            throw std::invalid_argument("Variant is not of Object type");
-        }
+    case eFieldObject:
+        return m_storage.m_shared->object();
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant is not of Object type");
     }
+}
 
-    template<>
-    VariantArray VariantData::value<VariantArray>() const
+template<>
+VariantArray Variant::convert<VariantArray>() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldArray:
-            return m_array;
-        default:
-            throw std::invalid_argument("Variant is not of Array type");
-        }
+    case eFieldArray:
+        return *m_storage.m_shared->array();
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant is not of Array type");
     }
+}
 
-    template<>
-    void VariantData::value<void>() const
+template<>
+void Variant::convert<void>() const
+{
+    switch (type())
     {
-        switch (m_type)
-        {
-        case eFieldVoid:
-            return;
-        default:
-            throw std::invalid_argument("Variant is not void typed");
-        }
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::invalid_argument("Variant is not void typed");
     }
-} // namespace detail
+}
 
 bool Variant::valid() const
 {
-    detail::VariantData *data = this->data();
-    return data && eFieldVoid != data->type();
+    return eFieldVoid != type();
 }
 
 bool Variant::isIntegral() const
 {
-    detail::VariantData *data = this->data();
-    if (!data) return false;
-    switch (data->type())
+    switch (type())
     {
     case eFieldBool:
     case eFieldInt:
@@ -296,9 +240,7 @@ bool Variant::isIntegral() const
 
 bool Variant::isFloatingPoint() const
 {
-    detail::VariantData *data = this->data();
-    if (!data) return false;
-    switch (data->type())
+    switch (type())
     {
     case eFieldFloat:
     case eFieldDouble:
@@ -315,131 +257,271 @@ bool Variant::isArithmetic() const
 
 bool Variant::isString() const
 {
-    detail::VariantData *data = this->data();
-    if (!data) return false;
-    return data->type() == eFieldString;
+    return type() == eFieldString;
 }
 
 bool Variant::isDateTime() const
 {
-    detail::VariantData *data = this->data();
-    if (!data) return false;
-    return data->type() == eFieldDateTime;
+    return type() == eFieldDateTime;
 }
 
 bool Variant::isObject() const
 {
-    detail::VariantData *data = this->data();
-    if (!data) return false;
-    return data->type() == eFieldObject;
+    return type() == eFieldObject;
 }
 
 bool Variant::isArray() const
 {
-    detail::VariantData *data = this->data();
-    if (!data) return false;
-    return data->type() == eFieldArray;
+    return type() == eFieldArray;
 }
 
 const void *Variant::buffer() const
 {
-    detail::VariantData *data = this->getData();
-    return data->buffer();
+    switch (type())
+    {
+    case eFieldBool: return &m_storage.m_bool;
+    case eFieldInt: return &m_storage.m_int;
+    case eFieldUint: return &m_storage.m_uint;
+    case eFieldInt64: return &m_storage.m_int64;
+    case eFieldUint64: return &m_storage.m_uint64;
+    case eFieldFloat: return &m_storage.m_float;
+    case eFieldDouble: return &m_storage.m_double;
+    case eFieldObject: return m_storage.m_shared->object();
+    case eFieldDateTime: return &dateTimeValue();
+    case eFieldArray: return m_storage.m_shared->array();
+    case eFieldString: return &stringValue();
+    case eFieldVoid:
+        throw std::runtime_error("Variant is invalid");
+    default:
+        throw std::runtime_error("Unknown variant type");
+    }
 }
 
 Object *Variant::extractObject()
 {
     // NOTE: detach is not needed since we require invalidation of all instances
     // holding the same object
-    detail::VariantData *data = this->getData();
-    return data->extractObject();
+    if (type() == eFieldVoid)
+        throw std::runtime_error("Variant is invalid");
+    if (type() != eFieldObject)
+        throw std::runtime_error("Not an object variant");
+    return m_storage.m_shared->extractObject();
 }
 
-detail::VariantData *Variant::getData() const
+String &Variant::stringValue() const
 {
-    detail::VariantData *data = this->data();
-    if (!data)
-        throw std::runtime_error("Variant is invalid");
-    return data;
+    return *reinterpret_cast<String *>(const_cast<void *>(static_cast<const void *>(&m_storage.m_inline)));
+}
+
+DateTime &Variant::dateTimeValue() const
+{
+    return *reinterpret_cast<DateTime *>(const_cast<void *>(static_cast<const void *>(&m_storage.m_inline)));
+}
+
+detail::VariantData *Variant::sharedData() const
+{
+    return m_storage.m_shared;
+}
+
+void Variant::setType(EFieldType type)
+{
+    static_assert(sizeof(DateTime) < sizeof(String) && sizeof(detail::VariantData *) < sizeof(String) &&
+                  sizeof(uint64_t) < sizeof(String), "Type code must not overlap values stored inline");
+    static_assert(String::InlineCapacity < 'A', "Type codes must not collide with String tags");
+    unsigned char code;
+    switch (type)
+    {
+    case eFieldVoid: code = eCodeVoid; break;
+    case eFieldBool: code = eCodeBool; break;
+    case eFieldInt: code = eCodeInt; break;
+    case eFieldUint: code = eCodeUint; break;
+    case eFieldInt64: code = eCodeInt64; break;
+    case eFieldUint64: code = eCodeUint64; break;
+    case eFieldFloat: code = eCodeFloat; break;
+    case eFieldDouble: code = eCodeDouble; break;
+    case eFieldDateTime: code = eCodeDateTime; break;
+    case eFieldObject: code = eCodeObject; break;
+    case eFieldArray: code = eCodeArray; break;
+    default:
+        // strings keep their own tag
+        assert(false);
+        return;
+    }
+    m_storage.m_raw[sizeof(m_storage.m_raw) - 1] = code;
+}
+
+void Variant::copyFrom(const Variant &other)
+{
+    switch (other.type())
+    {
+    case eFieldString:
+        new (&m_storage.m_inline) String(other.stringValue());
+        break;
+    case eFieldDateTime:
+        new (&m_storage.m_inline) DateTime(other.dateTimeValue());
+        setType(eFieldDateTime);
+        break;
+    case eFieldObject:
+    case eFieldArray:
+        m_storage = other.m_storage;
+        m_storage.m_shared->ref();
+        break;
+    default:
+        m_storage = other.m_storage;
+    }
+}
+
+void Variant::moveFrom(Variant &other)
+{
+    switch (other.type())
+    {
+    case eFieldString:
+        new (&m_storage.m_inline) String(std::move(other.stringValue()));
+        other.clear();
+        break;
+    case eFieldDateTime:
+        copyFrom(other);
+        other.clear();
+        break;
+    default:
+        // shared data pointer is just taken over
+        m_storage = other.m_storage;
+        other.setType(eFieldVoid);
+    }
+}
+
+void Variant::clear()
+{
+    switch (type())
+    {
+    case eFieldString:
+        stringValue().~String();
+        break;
+    case eFieldDateTime:
+        dateTimeValue().~DateTime();
+        break;
+    case eFieldObject:
+    case eFieldArray:
+        if (!m_storage.m_shared->deref())
+            delete m_storage.m_shared;
+        break;
+    default:
+        break;
+    }
+    setType(eFieldVoid);
 }
 
 Variant::Variant(void)
 {
+    setType(eFieldVoid);
 }
 
 Variant::~Variant()
 {
+    clear();
 }
 
-Variant::Variant(bool v)
-    : SharedDataPointer(new detail::VariantData(v))
+Variant::Variant(const Variant &other)
 {
+    copyFrom(other);
+}
 
+Variant::Variant(Variant &&other) noexcept
+{
+    moveFrom(other);
 }
 
-Variant::Variant(int32_t v)
-    : SharedDataPointer(new detail::VariantData(v))
+Variant &Variant::operator=(const Variant &rhs)
+{
+    if (this != &rhs)
+    {
+        // rhs may be owned by the value being cleared (i.e. an element of our own array)
+        Variant copy(rhs);
+        clear();
+        moveFrom(copy);
+    }
+    return *this;
+}
+
+Variant &Variant::operator=(Variant &&rhs) noexcept
 {
+    if (this != &rhs)
+    {
+        Variant moved(std::move(rhs));
+        clear();
+        moveFrom(moved);
+    }
+    return *this;
+}
 
+Variant::Variant(bool v)
+{
+    m_storage.m_bool = v;
+    setType(eFieldBool);
 }
 
-Variant::Variant(uint32_t v)
-    : SharedDataPointer(new detail::VariantData(v))
+Variant::Variant(int32_t v)
 {
+    m_storage.m_int = v;
+    setType(eFieldInt);
+}
 
+Variant::Variant(uint32_t v)
+{
+    m_storage.m_uint = v;
+    setType(eFieldUint);
 }
 
 Variant::Variant(const int64_t &v)
-    : SharedDataPointer(new detail::VariantData(v))
 {
-
+    m_storage.m_int64 = v;
+    setType(eFieldInt64);
 }
 
 Variant::Variant(const uint64_t &v)
-    : SharedDataPointer(new detail::VariantData(v))
 {
-
+    m_storage.m_uint64 = v;
+    setType(eFieldUint64);
 }
 
 Variant::Variant(const float &v)
-    : SharedDataPointer(new detail::VariantData(v))
 {
-
+    m_storage.m_float = v;
+    setType(eFieldFloat);
 }
 
 Variant::Variant(const double &v)
-    : SharedDataPointer(new detail::VariantData(v))
 {
-
+    m_storage.m_double = v;
+    setType(eFieldDouble);
 }
 
 Variant::Variant(const char *v)
-    : SharedDataPointer(new detail::VariantData(String(v)))
 {
-
+    new (&m_storage.m_inline) String(v);
 }
 
 Variant::Variant(const String& v)
-    : SharedDataPointer(new detail::VariantData(v))
 {
-
+    new (&m_storage.m_inline) String(v);
 }
+
 Variant::Variant(const DateTime &v)
-    : SharedDataPointer(new detail::VariantData(v))
 {
-
+    new (&m_storage.m_inline) DateTime(v);
+    setType(eFieldDateTime);
 }
 
 Variant::Variant(Object *o)
-    : SharedDataPointer(new detail::VariantData(o))
 {
-
+    m_storage.m_shared = new detail::VariantData(o);
+    setType(eFieldObject);
 }
 
 Variant::Variant(const Array<Variant> &a)
-    : SharedDataPointer(new detail::VariantData(a))
 {
-
+    m_storage.m_shared = new detail::VariantData(a);
+    setType(eFieldArray);
 }
 
 std::basic_ostream<char> &operator<<(std::basic_ostream<char> &stream, const Variant &v)
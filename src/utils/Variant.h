@@ -45,51 +45,26 @@ namespace detail
     {
     };
 
+    /** \brief Shared heap storage of the variants holding objects and arrays
+     *
+     * Copies of such variants refer to the same instance of VariantData, so the object
+     * extracted from one of them is released from all others.
+     */
     class VariantData : public SharedDataBase
     {
     public:
-        VariantData();
-        ~VariantData();
-
-        explicit VariantData(bool v);
-        explicit VariantData(int32_t v);
-        explicit VariantData(uint32_t v);
-        explicit VariantData(const int64_t& v);
-        explicit VariantData(const uint64_t& v);
-        explicit VariantData(const float& v);
-        explicit VariantData(const double& v);
-        explicit VariantData(const String& v);
-        explicit VariantData(const DateTime& v);
         explicit VariantData(Object *o);
         explicit VariantData(const Array<Variant>& a);
+        ~VariantData();
 
-        EFieldType type() const;
-        template<typename T>
-        T value() const;
-        void *buffer();
+        Object *object() const;
+        Array<Variant> *array();
         Object *extractObject();
 
         SharedDataBase *clone() const override;
     private:
-        template<typename T>
-        T arithmetic_convert() const;
-    private:
-        EFieldType m_type;
-        // union storage for POD types
-        union
-        {
-            bool m_bool;
-            int32_t m_int;
-            uint32_t m_uint;
-            int64_t m_int64;
-            uint64_t m_uint64;
-            float m_float;
-            double m_double;
-        } m_storage;
-        String m_string;
-        DateTime m_datetime;
-        Array<Variant> m_array;
         SharedObjectPointer<Object> m_object;
+        Array<Variant> m_array;
     };
 } // namespace detail
 
@@ -110,12 +85,20 @@ namespace detail
     - metacpp::Object * (eFieldObject)
     - metacpp::Array<metacpp::Variant> (eFieldArray)
 */
-class Variant final : SharedDataPointer<detail::VariantData>
+class Variant final
 {
 public:
     /** \brief Constructs a new instance of the void (invalid) variant */
     Variant(void);
     ~Variant();
+    /** \brief Copies other variant, objects and arrays are shared between copies */
+    Variant(const Variant& other);
+    /** \brief Moves other variant leaving it invalid */
+    Variant(Variant&& other) noexcept;
+    /** \brief Assigns other variant to this one */
+    Variant& operator=(const Variant& rhs);
+    /** \brief Moves other variant into this one leaving it invalid */
+    Variant& operator=(Variant&& rhs) noexcept;
 
     /** \brief Constructs a new instance of the bool variant */
     Variant(bool v);
@@ -138,15 +121,32 @@ public:
     /** \brief Constructs a new instance of the metacpp::DateTime variant */
     Variant(const DateTime& v);
     /** \brief Constructs a new instance of the metacpp::Object * variant.
-     * Variant will take the ownership and will be responsible to delete the object with
-     * default deleter
+     * Variant will take the ownership and will be responsible to delete the object using
+     * Object::deleteThis
     */
     Variant(Object *o);
     /** \brief Constructs a new instance of the VariantArray variant */
     Variant(const Array<Variant>& a);
 
     /** \brief Gets a type of the stored value */
-    inline EFieldType type() const { return getData()->type(); }
+    inline EFieldType type() const
+    {
+        switch (typeCode())
+        {
+        case eCodeVoid: return eFieldVoid;
+        case eCodeBool: return eFieldBool;
+        case eCodeInt: return eFieldInt;
+        case eCodeUint: return eFieldUint;
+        case eCodeInt64: return eFieldInt64;
+        case eCodeUint64: return eFieldUint64;
+        case eCodeFloat: return eFieldFloat;
+        case eCodeDouble: return eFieldDouble;
+        case eCodeDateTime: return eFieldDateTime;
+        case eCodeObject: return eFieldObject;
+        case eCodeArray: return eFieldArray;
+        default: return eFieldString;
+        }
+    }
 
     /** \brief Gets the stored value of converted to the type T if needed.
      *
@@ -157,13 +157,13 @@ public:
                             !std::is_same<Variant, T>::value &&
                             !detail::IsObjectPtr<T>::value, T>::type value() const
     {
-        return getData()->value<T>();
+        return convert<T>();
     }
 
     template<typename T>
     typename std::enable_if<detail::IsObjectPtr<T>::value, T>::type value() const
     {
-        Object *o = getData()->value<Object *>();
+        Object *o = convert<Object *>();
         if (o)
         {
             T derived = dynamic_cast<T>(o);
@@ -211,7 +211,51 @@ public:
     /** \brief Extract an object holded by this Variant and invalidates it */
     Object *extractObject();
 private:
-    detail::VariantData *getData() const;
+    template<typename T>
+    T convert() const;
+    template<typename T>
+    T arithmeticConvert() const;
+    void copyFrom(const Variant& other);
+    void moveFrom(Variant& other);
+    void clear();
+    String& stringValue() const;
+    DateTime& dateTimeValue() const;
+    detail::VariantData *sharedData() const;
+    void setType(EFieldType type);
+
+    // The last byte of the storage is shared with the tag of the inline String (its length, HeapTag or NullTag),
+    // values of other types keep there one of these codes, which never collide with the String tags
+    enum : unsigned char
+    {
+        eCodeVoid = 'x',
+        eCodeBool = 'b',
+        eCodeInt = 'i',
+        eCodeUint = 'u',
+        eCodeInt64 = 'I',
+        eCodeUint64 = 'U',
+        eCodeFloat = 'f',
+        eCodeDouble = 'd',
+        eCodeDateTime = 't',
+        eCodeObject = 'o',
+        eCodeArray = 'a'
+    };
+
+    unsigned char typeCode() const { return m_storage.m_raw[sizeof(m_storage.m_raw) - 1]; }
+private:
+    // scalars, strings and datetimes are stored inline, objects and arrays are shared
+    union
+    {
+        bool m_bool;
+        int32_t m_int;
+        uint32_t m_uint;
+        int64_t m_int64;
+        uint64_t m_uint64;
+        float m_float;
+        double m_double;
+        detail::VariantData *m_shared;
+        typename std::aligned_storage<sizeof(String), alignof(String)>::type m_inline;
+        unsigned char m_raw[sizeof(String)];
+    } m_storage;
 };
 
 /** \brief Generalized form of getter for the stored value of v to the template type T.
@@ -225,6 +269,9 @@ T variant_cast(const Variant& v)
     return v.value<T>();
 }
 
+// Array relocates elements with std::move_if_noexcept, a throwing move would fall back to copying
+static_assert(std::is_nothrow_move_constructible<Variant>::value, "Variant must be nothrow move constructible");
+
 typedef Array<Variant> VariantArray;
 
 std::basic_ostream<char>& operator<<(std::basic_ostream<char>& stream, const Variant& v);
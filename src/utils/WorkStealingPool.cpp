@@ -0,0 +1,176 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace metacpp
+{
+
+namespace
+{
+
+/** \brief Pool whose task is executed by the current thread and the index of the executing worker */
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // anonymous namespace
+
+WorkStealingPool::WorkStealingPool(size_t numWorkers)
+    : m_task(nullptr), m_generation(0), m_active(0), m_stop(false)
+{
+    if (!numWorkers)
+        numWorkers = std::max(1U, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < numWorkers; ++i)
+        m_queues.emplace_back(new Queue());
+    for (size_t i = 1; i < numWorkers; ++i)
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> _guard(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+size_t WorkStealingPool::size() const
+{
+    return m_queues.size();
+}
+
+void WorkStealingPool::run(size_t count, size_t grainSize, const Task &task)
+{
+    if (!count)
+        return;
+    grainSize = std::max<size_t>(grainSize, 1);
+    if (currentPool == this)
+    {
+        // nested call from the task, other workers are busy with the outer run, so execute it inline
+        for (size_t begin = 0; begin < count; begin += grainSize)
+            task(currentWorker, begin, std::min(begin + grainSize, count));
+        return;
+    }
+    std::lock_guard<std::mutex> _runGuard(m_runMutex);
+    // deal chunks in contiguous blocks, so every worker starts with neighbouring items
+    size_t numChunks = (count + grainSize - 1) / grainSize;
+    size_t chunksPerWorker = (numChunks + size() - 1) / size();
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        size_t begin = i * grainSize;
+        m_queues[i / chunksPerWorker]->chunks.emplace_back(begin, std::min(begin + grainSize, count));
+    }
+    {
+        std::lock_guard<std::mutex> _guard(m_mutex);
+        m_task = &task;
+        m_error = nullptr;
+        m_active = m_threads.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    work(0);
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_done.wait(_lock, [this]() { return m_active == 0; });
+        m_task = nullptr;
+        std::swap(error, m_error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+WorkStealingPool &WorkStealingPool::defaultPool()
+{
+    static WorkStealingPool pool;
+    return pool;
+}
+
+void WorkStealingPool::workerLoop(size_t worker)
+{
+    size_t generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_wake.wait(_lock, [this, generation]() { return m_stop || m_generation != generation; });
+            if (m_stop)
+                return;
+            generation = m_generation;
+        }
+        work(worker);
+        {
+            std::lock_guard<std::mutex> _guard(m_mutex);
+            if (!--m_active)
+                m_done.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::work(size_t worker)
+{
+    const WorkStealingPool *outerPool = currentPool;
+    size_t outerWorker = currentWorker;
+    currentPool = this;
+    currentWorker = worker;
+    std::pair<size_t, size_t> chunk;
+    while (take(worker, chunk))
+    {
+        try
+        {
+            (*m_task)(worker, chunk.first, chunk.second);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> _guard(m_mutex);
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+    }
+    currentPool = outerPool;
+    currentWorker = outerWorker;
+}
+
+bool WorkStealingPool::take(size_t worker, std::pair<size_t, size_t> &chunk)
+{
+    {
+        Queue& own = *m_queues[worker];
+        std::lock_guard<std::mutex> _guard(own.mutex);
+        if (!own.chunks.empty())
+        {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < size(); ++i)
+    {
+        Queue& victim = *m_queues[(worker + i) % size()];
+        std::lock_guard<std::mutex> _guard(victim.mutex);
+        if (!victim.chunks.empty())
+        {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace metacpp
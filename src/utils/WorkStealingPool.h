@@ -0,0 +1,93 @@
+/****************************************************************************
+* Copyright 2014-2015 Trefilov Dmitrij                                      *
+*                                                                           *
+* Licensed under the Apache License, Version 2.0 (the "License");           *
+* you may not use this file except in compliance with the License.          *
+* You may obtain a copy of the License at                                   *
+*                                                                           *
+*    http://www.apache.org/licenses/LICENSE-2.0                             *
+*                                                                           *
+* Unless required by applicable law or agreed to in writing, software       *
+* distributed under the License is distributed on an "AS IS" BASIS,         *
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+* See the License for the specific language governing permissions and       *
+* limitations under the License.                                            *
+****************************************************************************/
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+#include "config.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <memory>
+
+namespace metacpp
+{
+
+/** \brief Pool of worker threads executing ranges of work with work stealing
+ *
+ * The range of work is split into chunks dealt in contiguous blocks to per-worker queues.
+ * Each worker takes chunks in order from the front of it's own queue and steals from the back
+ * of the queues of other workers once it's own queue is empty. The calling thread
+ * takes part in execution as the worker with index 0.
+ */
+class WorkStealingPool
+{
+public:
+    /** \brief Task executed for the chunk [begin, end) by the worker with given index */
+    typedef std::function<void (size_t worker, size_t begin, size_t end)> Task;
+
+    /** \brief Constructs a new pool with given number of workers (including the calling thread)
+     *
+     * If numWorkers is zero, the number of hardware threads is used
+     */
+    explicit WorkStealingPool(size_t numWorkers = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&)=delete;
+    WorkStealingPool& operator=(const WorkStealingPool&)=delete;
+
+    /** \brief Gets a number of workers including the calling thread */
+    size_t size() const;
+
+    /** \brief Executes the task over [0, count) splitting it into chunks of grainSize items
+     *
+     * Blocks until all chunks are processed. Concurrent calls are serialized.
+     * If the task throws, the first exception is rethrown after all workers finish.
+     * Nested calls made by the task itself are executed inline by the calling worker.
+     */
+    void run(size_t count, size_t grainSize, const Task& task);
+
+    /** \brief Gets a process-wide pool created on first use */
+    static WorkStealingPool& defaultPool();
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::pair<size_t, size_t> > chunks;
+    };
+
+    void workerLoop(size_t worker);
+    void work(size_t worker);
+    bool take(size_t worker, std::pair<size_t, size_t>& chunk);
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Queue> > m_queues;
+    std::mutex m_runMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const Task *m_task;
+    size_t m_generation;
+    size_t m_active;
+    bool m_stop;
+    std::exception_ptr m_error;
+};
+
+} // namespace metacpp
+
+#endif // WORKSTEALINGPOOL_H
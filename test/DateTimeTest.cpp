@@ -1,4 +1,8 @@
 #include "DateTimeTest.h"
+#include "TimeZone.h"
+#include <stdlib.h>
+#include <fstream>
+#include <limits>
 
 using metacpp::DateTime;
 
@@ -189,6 +193,18 @@ TEST_F(DateTimeTest, testAddDays)
     EXPECT_EQ(dt, DateTime::fromString("2003-11-29 14:25:16"));
 }
 
+TEST_F(DateTimeTest, testAddOutOfRange)
+{
+    DateTime dt(2004, metacpp::February, 1);
+    EXPECT_THROW(dt.addMicroseconds(std::numeric_limits<int64_t>::max()), std::invalid_argument);
+    EXPECT_THROW(dt.addMicroseconds(std::numeric_limits<int64_t>::min()), std::invalid_argument);
+    EXPECT_THROW(dt.addDays(std::numeric_limits<int>::max()), std::invalid_argument);
+    EXPECT_THROW(dt.addDays(-100000000), std::invalid_argument);
+    EXPECT_EQ(dt, DateTime(2004, metacpp::February, 1));
+    EXPECT_THROW(DateTime(200000, metacpp::December, 31, 23, 59, 59).addSeconds(1), std::invalid_argument);
+    EXPECT_NO_THROW(DateTime(-200000, metacpp::January, 1).addDays(100000000));
+}
+
 TEST_F(DateTimeTest, testAddHours)
 {
     DateTime dt;
@@ -239,3 +255,171 @@ TEST_F(DateTimeTest, testInvalid)
     DateTime dt;
     EXPECT_THROW(dt.year(), std::runtime_error);
 }
+
+#ifndef _MSC_VER
+TEST_F(DateTimeTest, testCivilArithmetic)
+{
+    // compare calendar decomposition with the C library in UTC for dates around and before the epoch
+    for (int64_t t = -2208988800LL; t < 4102444800LL; t += 86400 * 37 + 3607)
+    {
+        time_t stdTime = static_cast<time_t>(t);
+        struct tm tm;
+        gmtime_r(&stdTime, &tm);
+        DateTime dt = DateTime::fromMicrosecondsSinceEpoch(t * 1000000);
+        ASSERT_EQ(dt.year(), tm.tm_year + 1900);
+        ASSERT_EQ(dt.month(), static_cast<metacpp::EMonth>(tm.tm_mon));
+        ASSERT_EQ(dt.day(), tm.tm_mday);
+        ASSERT_EQ(dt.dayOfWeek(), static_cast<metacpp::EDayOfWeek>(tm.tm_wday));
+        ASSERT_EQ(dt.hours(), tm.tm_hour);
+        ASSERT_EQ(dt.minutes(), tm.tm_min);
+        ASSERT_EQ(dt.seconds(), tm.tm_sec);
+        ASSERT_EQ(DateTime(dt.year(), dt.month(), dt.day(), dt.hours(), dt.minutes(), dt.seconds()), dt);
+    }
+}
+#endif
+
+TEST_F(DateTimeTest, testMicroseconds)
+{
+    DateTime dt(1969, metacpp::December, 31, 23, 59, 59);
+    EXPECT_EQ(dt.toMicrosecondsSinceEpoch(), -1000000);
+    dt.addMicroseconds(999999);
+    EXPECT_EQ(dt.seconds(), 59);
+    EXPECT_EQ(dt.microseconds(), 999999);
+    dt.addMicroseconds(1);
+    EXPECT_EQ(dt, DateTime(1970, metacpp::January, 1));
+    EXPECT_THROW(dt.setMicroseconds(1000000), std::invalid_argument);
+    dt.setMicroseconds(250);
+    EXPECT_LT(DateTime(1970, metacpp::January, 1), dt);
+    EXPECT_GT(dt, DateTime());
+}
+
+TEST_F(DateTimeTest, testMonthClamping)
+{
+    DateTime dt(2004, metacpp::January, 31, 10);
+    dt.addMonths(1);
+    EXPECT_EQ(dt, DateTime(2004, metacpp::February, 29, 10));
+    dt.addYears(1);
+    EXPECT_EQ(dt, DateTime(2005, metacpp::February, 28, 10));
+    dt.addMonths(-14);
+    EXPECT_EQ(dt, DateTime(2003, metacpp::December, 28, 10));
+    EXPECT_THROW(dt.setDay(32), std::invalid_argument);
+    EXPECT_THROW(DateTime(2005, metacpp::February, 29), std::invalid_argument);
+    EXPECT_THROW(DateTime::fromString("2005-02-29 00:00:00"), std::invalid_argument);
+}
+
+TEST_F(DateTimeTest, testIsoFormat)
+{
+    char buf[metacpp::DateTimeBufferSize];
+    DateTime dt(2004, metacpp::February, 1, 14, 25, 16);
+    EXPECT_EQ(std::string(buf, metacpp::formatDateTime(buf, dt)), "2004-02-01 14:25:16");
+    dt.setMicroseconds(120000);
+    EXPECT_EQ(std::string(buf, metacpp::formatDateTime(buf, dt, 'T', 0)), "2004-02-01T14:25:16.120Z");
+    dt.setMicroseconds(5);
+    EXPECT_EQ(std::string(buf, metacpp::formatDateTime(buf, dt, 'T', -330)), "2004-02-01T14:25:16.000005-05:30");
+    EXPECT_EQ(DateTime::fromString(dt.toString().c_str()), dt);
+    dt.setYear(-12345);
+    EXPECT_EQ(std::string(buf, metacpp::formatDateTime(buf, dt)), "-12345-02-01 14:25:16.000005");
+}
+
+TEST_F(DateTimeTest, testIsoParse)
+{
+    using metacpp::parseDateTime;
+    DateTime dt;
+    int offset;
+    const char strict[] = "2004-02-01T14:25:16.1234567+03:00 tail";
+    const char *end = parseDateTime(strict, strict + sizeof(strict) - 1, dt, offset);
+    ASSERT_NE(end, nullptr);
+    EXPECT_STREQ(end, " tail");
+    EXPECT_EQ(dt.microseconds(), 123456);
+    EXPECT_EQ(offset, 180);
+    EXPECT_EQ(dt.hours(), 14);
+
+    auto parse = [&](const char *str, metacpp::EDateTimeParseMode mode) {
+        size_t length = strlen(str);
+        return parseDateTime(str, str + length, dt, offset, mode) == str + length;
+    };
+    EXPECT_TRUE(parse("2004-02-01 14:25:16Z", metacpp::eDateTimeStrict));
+    EXPECT_EQ(offset, 0);
+    EXPECT_TRUE(parse("2004-02-01 14:25:16", metacpp::eDateTimeStrict));
+    EXPECT_EQ(offset, metacpp::NoUtcOffset);
+    EXPECT_FALSE(parse("2004-2-1 4:25:16", metacpp::eDateTimeStrict));
+    EXPECT_TRUE(parse("2004-2-1 4:25:16", metacpp::eDateTimeLenient));
+    EXPECT_EQ(dt, DateTime(2004, metacpp::February, 1, 4, 25, 16));
+    EXPECT_FALSE(parse("2004-02-01t14:25:16,5z", metacpp::eDateTimeStrict));
+    EXPECT_TRUE(parse("2004-02-01t14:25:16,5z", metacpp::eDateTimeLenient));
+    EXPECT_EQ(dt.microseconds(), 500000);
+    EXPECT_FALSE(parse("2004-02-01T14:25:16-0130", metacpp::eDateTimeStrict));
+    EXPECT_TRUE(parse("2004-02-01T14:25:16-0130", metacpp::eDateTimeLenient));
+    EXPECT_EQ(offset, -90);
+    EXPECT_TRUE(parse("2004-02-01T14:25:16+05", metacpp::eDateTimeLenient));
+    EXPECT_EQ(offset, 300);
+    EXPECT_FALSE(parse("2004-02-01T14:25:16+24:00", metacpp::eDateTimeLenient));
+    EXPECT_FALSE(parse("2004-02-30T14:25:16", metacpp::eDateTimeLenient));
+    EXPECT_FALSE(parse("2004-02-01T14:25:16.", metacpp::eDateTimeLenient));
+    EXPECT_FALSE(parse("2004-02-01", metacpp::eDateTimeLenient));
+
+    // offsets are applied by DateTime::fromString
+    EXPECT_EQ(DateTime::fromString("2004-02-01T14:25:16+03:00"), DateTime(2004, metacpp::February, 1, 11, 25, 16));
+}
+
+TEST_F(DateTimeTest, testUtc)
+{
+    DateTime dt = DateTime::fromStdTimeUtc(1075645516);
+    EXPECT_EQ(dt, DateTime(2004, metacpp::February, 1, 14, 25, 16));
+    EXPECT_EQ(dt.toStdTimeUtc(), 1075645516);
+    EXPECT_EQ(DateTime::fromStdTimeUtc(-1).toString(), "1969-12-31 23:59:59");
+    EXPECT_EQ(metacpp::TimeZone::utc().toLocal(dt), dt);
+    // conversions through the local time zone are consistent
+    EXPECT_EQ(DateTime(static_cast<time_t>(1075645516)).toStdTime(), 1075645516);
+}
+
+#ifndef _WIN32
+static void checkTimeZone(const char *name, int64_t from = -2145916800LL)
+{
+    metacpp::TimeZone zone;
+    ASSERT_NO_THROW(zone = metacpp::TimeZone::fromName(name)) << name;
+    const char *oldTz = getenv("TZ");
+    std::string savedTz = oldTz ? oldTz : "";
+    setenv("TZ", name, 1);
+    tzset();
+    // up to 2100 including times beyond the transition table of the file
+    for (int64_t t = from; t < 4102444800LL; t += 86400 * 5 + 3671)
+    {
+        time_t stdTime = static_cast<time_t>(t);
+        struct tm tm;
+        localtime_r(&stdTime, &tm);
+        ASSERT_EQ(zone.offsetFromUtc(t), tm.tm_gmtoff) << name << " at " << t;
+        DateTime local = zone.toLocal(DateTime::fromStdTimeUtc(stdTime));
+        ASSERT_EQ(local, DateTime(tm.tm_year + 1900, static_cast<metacpp::EMonth>(tm.tm_mon), tm.tm_mday,
+                                  tm.tm_hour, tm.tm_min, tm.tm_sec)) << name << " at " << t;
+        // local times repeating at the end of daylight saving time map back to the earlier moment
+        ASSERT_EQ(zone.toLocal(zone.toUtc(local)), local) << name << " at " << t;
+    }
+    if (oldTz)
+        setenv("TZ", savedTz.c_str(), 1);
+    else
+        unsetenv("TZ");
+    tzset();
+}
+
+TEST_F(DateTimeTest, testTimeZones)
+{
+    if (!std::ifstream("/usr/share/zoneinfo/Europe/Berlin"))
+        return;
+    checkTimeZone("Europe/Berlin");
+    checkTimeZone("America/New_York");
+    checkTimeZone("Australia/Sydney");
+    checkTimeZone("Asia/Kolkata");
+    // glibc takes historical transitions of POSIX TZ strings from the posixrules file
+    checkTimeZone("EST5EDT,M3.2.0,M11.1.0", 1262304000LL);
+    checkTimeZone("<+0330>-3:30", 1262304000LL);
+
+    metacpp::TimeZone berlin = metacpp::TimeZone::fromName("Europe/Berlin");
+    EXPECT_EQ(berlin.name(), "Europe/Berlin");
+    // 02:30 happens twice on 2015-10-25, the earlier moment is taken
+    EXPECT_EQ(berlin.toUtc(DateTime(2015, metacpp::October, 25, 2, 30)), DateTime(2015, metacpp::October, 25, 0, 30));
+    // 02:30 is skipped on 2015-03-29
+    EXPECT_EQ(berlin.toUtc(DateTime(2015, metacpp::March, 29, 2, 30)), DateTime(2015, metacpp::March, 29, 1, 30));
+    EXPECT_THROW(metacpp::TimeZone::fromName("Nowhere/Atlantis"), std::invalid_argument);
+}
+#endif
@@ -1,9 +1,20 @@
 #include "ObjectTest.h"
 #include "Object.h"
 #include "TypeResolverFactory.h"
+#include "MetaObjectRegistry.h"
+#include "ObjectSnapshot.h"
+#include "ObjectArena.h"
+#include "BatchVisitorBase.h"
+#include "InitVisitor.h"
+#include "ObjectOperations.h"
+#include "ParallelVisit.h"
+#include <unordered_map>
 #include <string>
 #include <memory>
 #include <functional>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include "Variant.h"
 
 using namespace metacpp;
@@ -186,6 +197,45 @@ TEST_F(ObjectTest, MetaInfoTest)
 
 }
 
+TEST_F(ObjectTest, FieldByNameTest)
+{
+    const MetaObject *mo = TestStruct::staticMetaObject();
+    for (size_t i = 0; i < mo->totalFields(); ++i)
+    {
+        const MetaFieldBase *field = mo->field(i);
+        EXPECT_EQ(mo->fieldByName(field->name()), field);
+        std::string upperName(field->name());
+        std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+        EXPECT_EQ(mo->fieldByName(upperName.c_str(), false), field);
+    }
+    EXPECT_EQ(mo->fieldByName("id"), mo->field(0));
+    EXPECT_EQ(mo->fieldByName("OPTINTVALUE"), nullptr);
+    EXPECT_EQ(mo->fieldByName("OPTINTVALUE", false), mo->field(16));
+    EXPECT_EQ(mo->fieldByName(StringView("intValueXXX", 8)), mo->field(3));
+    EXPECT_EQ(mo->fieldByName(StringView("INTVALUEXXX", 8), false), mo->field(3));
+    EXPECT_EQ(mo->fieldByName(StringView("intValueXXX", 9)), nullptr);
+    // integral flags and strings select the overloads unambiguously
+    EXPECT_EQ(mo->fieldByName("INTVALUE", 0), mo->field(3));
+    EXPECT_EQ(mo->fieldByName(String("intValue"), 1), mo->field(3));
+    EXPECT_EQ(mo->fieldByName(""), nullptr);
+    EXPECT_EQ(mo->fieldByName("nonExistentField"), nullptr);
+}
+
+TEST_F(ObjectTest, MetaObjectRegistryTest)
+{
+    MetaObjectRegistry& registry = MetaObjectRegistry::instance();
+    EXPECT_EQ(registry.find("TestStruct"), TestStruct::staticMetaObject());
+    EXPECT_EQ(registry.find("TestSubStruct"), TestSubStruct::staticMetaObject());
+    EXPECT_EQ(registry.find("UnknownStruct"), nullptr);
+    EXPECT_EQ(registry.findByDescriptor(&REFLECTIBLE_DESCRIPTOR(TestBaseStruct)), TestBaseStruct::staticMetaObject());
+    registry.freeze();
+    EXPECT_TRUE(registry.frozen());
+    EXPECT_EQ(registry.find(String("TestBaseStruct")), TestBaseStruct::staticMetaObject());
+    // super class resolves to the registered instance rather than a private copy
+    EXPECT_EQ(TestStruct::staticMetaObject()->superMetaObject(), TestBaseStruct::staticMetaObject());
+    EXPECT_EQ(TestBaseStruct::staticMetaObject()->superMetaObject(), nullptr);
+}
+
 TEST_F(ObjectTest, InitVisitorTest)
 {
     TestStruct t;
@@ -216,6 +266,498 @@ TEST_F(ObjectTest, InitVisitorTest)
     EXPECT_FALSE(t.optVariantValue);
 }
 
+TEST_F(ObjectTest, InitPlanMatchesVisitorTest)
+{
+    TestStruct planned, visited;
+    for (TestStruct *t : { &planned, &visited })
+    {
+        t->id = 5;
+        t->intValue = 42;
+        t->strValue = "modified";
+        t->optIntValue.reset();
+        t->optFloatValue = 1.0f;
+        t->optDateTimeValue = DateTime(100);
+        t->arrValue.push_back(TestSubStruct("item"));
+        t->variantValue = 12;
+        t->substruct.name = "modified";
+    }
+    planned.init();
+    InitVisitor vis;
+    vis.visit(&visited);
+    auto stringify = [](const Variant& v) -> String {
+        if (!v.valid())
+            return "null";
+        if (v.type() == eFieldDateTime && !variant_cast<DateTime>(v).valid())
+            return "invalid";
+        return String::fromValue(v);
+    };
+    const MetaObject *mo = TestStruct::staticMetaObject();
+    for (size_t i = 0; i < mo->totalFields(); ++i)
+    {
+        const MetaFieldBase *field = mo->field(i);
+        if (field->type() == eFieldObject || field->type() == eFieldArray)
+            continue;
+        EXPECT_EQ(stringify(field->getValue(&planned)), stringify(field->getValue(&visited))) << field->name();
+    }
+    EXPECT_EQ(planned.substruct.name, "TestSubStruct");
+    EXPECT_TRUE(planned.arrValue.empty());
+    EXPECT_EQ(planned.id, 0);
+}
+
+namespace
+{
+    class StringifyVisitor : public FieldValueVisitor
+    {
+    public:
+        String result;
+
+        void visitNull() override { result = "null"; }
+        void visit(bool value) override { result = value ? "true" : "false"; }
+        void visit(int32_t value) override { result = String::fromValue(value); }
+        void visit(uint32_t value) override { result = String::fromValue(value); }
+        void visit(int64_t value) override { result = String::fromValue(value); }
+        void visit(uint64_t value) override { result = String::fromValue(value); }
+        void visit(float value) override { result = String::fromValue(value); }
+        void visit(double value) override { result = String::fromValue(value); }
+        void visit(const String& value) override { result = value; }
+        void visit(const DateTime& value) override { result = value.toString(); }
+        void visit(const Variant& value) override { result = "variant"; (void)value; }
+    };
+}
+
+TEST_F(ObjectTest, FieldVisitValueTest)
+{
+    TestStruct t;
+    t.init();
+    t.optUint64Value.reset();
+    auto visitField = [&](const char *name) {
+        StringifyVisitor visitor;
+        t.metaObject()->fieldByName(name)->visitValue(&t, visitor);
+        return visitor.result;
+    };
+    EXPECT_EQ(visitField("boolValue"), "true");
+    EXPECT_EQ(visitField("intValue"), "-1");
+    EXPECT_EQ(visitField("uintValue"), "123154");
+    EXPECT_EQ(visitField("strValue"), "testValue");
+    EXPECT_EQ(visitField("enumValue"), String::fromValue((uint32_t)eEnumValueUnk));
+    EXPECT_EQ(visitField("optIntValue"), "-1");
+    EXPECT_EQ(visitField("optUint64Value"), "null");
+    EXPECT_EQ(visitField("variantValue"), "variant");
+    StringifyVisitor visitor;
+    EXPECT_THROW(t.metaObject()->fieldByName("substruct")->visitValue(&t, visitor), std::runtime_error);
+}
+
+TEST_F(ObjectTest, FieldReadWriteTest)
+{
+    TestStruct t;
+    t.init();
+    auto mo = t.metaObject();
+
+    int32_t intValue = 0;
+    EXPECT_TRUE(mo->fieldByName("intValue")->readInto(&t, &intValue));
+    EXPECT_EQ(intValue, -1);
+    intValue = 42;
+    mo->fieldByName("intValue")->writeFrom(&t, &intValue);
+    EXPECT_EQ(t.intValue, 42);
+    EXPECT_THROW(mo->fieldByName("intValue")->writeFrom(&t, nullptr), std::invalid_argument);
+
+    String strValue;
+    EXPECT_TRUE(mo->fieldByName("strValue")->readInto(&t, &strValue));
+    EXPECT_EQ(strValue, "testValue");
+
+    double doubleValue = 1.5;
+    EXPECT_FALSE(mo->fieldByName("optDoubleValue")->readInto(&t, &doubleValue));
+    EXPECT_DOUBLE_EQ(doubleValue, 1.5);
+    mo->fieldByName("optDoubleValue")->writeFrom(&t, &doubleValue);
+    ASSERT_TRUE(t.optDoubleValue.isSet());
+    EXPECT_DOUBLE_EQ(*t.optDoubleValue, 1.5);
+    mo->fieldByName("optDoubleValue")->writeFrom(&t, nullptr);
+    EXPECT_FALSE(t.optDoubleValue.isSet());
+}
+
+namespace
+{
+    struct FieldNameCollector
+    {
+        Array<String> *names;
+
+        template<typename T>
+        void operator()(const FieldInfoDescriptor& descriptor, const T&)
+        {
+            names->push_back(descriptor.m_pszName);
+        }
+    };
+
+    struct IntIncrementer
+    {
+        void operator()(const FieldInfoDescriptor&, int32_t& value) { ++value; }
+
+        template<typename T>
+        void operator()(const FieldInfoDescriptor&, T&) { }
+    };
+}
+
+TEST_F(ObjectTest, ForEachFieldTest)
+{
+    TestStruct t;
+    t.init();
+
+    Array<String> names;
+    for_each_field(static_cast<const TestStruct&>(t), FieldNameCollector { &names });
+    const MetaObject *mo = t.metaObject();
+    ASSERT_EQ(names.size(), mo->totalFields());
+    EXPECT_EQ(names[0], "id");
+    EXPECT_EQ(names[1], "enumValue");
+    for (size_t i = 0; i < names.size(); ++i)
+        EXPECT_NE(mo->fieldByName(names[i]), nullptr);
+
+    t.id = 10;
+    for_each_field<TestStruct>(t, IntIncrementer());
+    EXPECT_EQ(t.id, 11);
+    EXPECT_EQ(t.intValue, 0);
+    EXPECT_EQ(t.uintValue, 123154u);
+}
+
+TEST_F(ObjectTest, ObjectEqualsHashTest)
+{
+    TestStruct a, b;
+    a.init();
+    b.init();
+    EXPECT_TRUE(objectEquals(a, b));
+    EXPECT_EQ(objectHash(a), objectHash(b));
+
+    a.intValue = 10;
+    EXPECT_FALSE(objectEquals(a, b));
+    b.intValue = 10;
+    EXPECT_TRUE(objectEquals(a, b));
+
+    a.optIntValue.reset();
+    EXPECT_FALSE(objectEquals(a, b));
+    b.optIntValue.reset();
+    a.arrValue.push_back(TestSubStruct("x"));
+    b.arrValue.push_back(TestSubStruct("x"));
+    a.variantValue = VariantArray { 1, "str" };
+    b.variantValue = VariantArray { 1, "str" };
+    EXPECT_TRUE(objectEquals(a, b));
+    EXPECT_EQ(objectHash(a), objectHash(b));
+
+    b.arrValue[0].name = "y";
+    EXPECT_FALSE(objectEquals(a, b));
+    b.arrValue[0].name = "x";
+    b.substruct.name = "other";
+    EXPECT_FALSE(objectEquals(a, b));
+    EXPECT_FALSE(objectEquals(a, a.substruct));
+
+    std::unordered_map<TestSubStruct, int, ObjectHash<TestSubStruct>, ObjectEqualTo<TestSubStruct> > cache;
+    cache[TestSubStruct("first")] = 1;
+    cache[TestSubStruct("second")] = 2;
+    EXPECT_EQ(cache.size(), 2U);
+    EXPECT_EQ(cache[TestSubStruct("first")], 1);
+}
+
+TEST_F(ObjectTest, ObjectCloneTest)
+{
+    TestStruct t;
+    t.init();
+    t.id = 3;
+    t.strValue = "cloned";
+    t.optDoubleValue = 1.5;
+    t.arrValue.push_back(TestSubStruct("item"));
+    t.variantValue = new TestSubStruct("variant");
+
+    TestStruct *clone = objectClone(t);
+    ASSERT_NE(clone, nullptr);
+    EXPECT_TRUE(objectEquals(*clone, t));
+    EXPECT_EQ(clone->id, 3);
+    EXPECT_EQ(clone->strValue, "cloned");
+    EXPECT_EQ(*clone->optDoubleValue, 1.5);
+    ASSERT_EQ(clone->arrValue.size(), 1U);
+    EXPECT_EQ(clone->arrValue[0].name, "item");
+    // objects in variants are cloned rather than shared
+    EXPECT_NE(variant_cast<TestSubStruct *>(clone->variantValue), variant_cast<TestSubStruct *>(t.variantValue));
+    EXPECT_EQ(variant_cast<TestSubStruct *>(clone->variantValue)->name, "variant");
+    clone->arrValue[0].name = "changed";
+    EXPECT_EQ(t.arrValue[0].name, "item");
+    clone->deleteThis();
+}
+
+struct VariantListStruct : public Object
+{
+    Array<Variant> values;
+    float weight;
+
+    META_INFO_DECLARE(VariantListStruct)
+};
+
+STRUCT_INFO_BEGIN(VariantListStruct)
+    FIELD(VariantListStruct, values)
+    FIELD(VariantListStruct, weight, 0.0f)
+STRUCT_INFO_END(VariantListStruct)
+
+METHOD_INFO_BEGIN(VariantListStruct)
+    CONSTRUCTOR(VariantListStruct)
+METHOD_INFO_END(VariantListStruct)
+
+REFLECTIBLE_FM(VariantListStruct)
+
+META_INFO(VariantListStruct)
+
+TEST_F(ObjectTest, ObjectCloneVariantArrayTest)
+{
+    VariantListStruct list;
+    list.init();
+    list.values.push_back(new TestSubStruct("element"));
+    list.values.push_back(VariantArray { 1, Variant(new TestSubStruct("nested")) });
+
+    VariantListStruct *clone = objectClone(list);
+    ASSERT_NE(clone, nullptr);
+    EXPECT_TRUE(objectEquals(*clone, list));
+    // objects referenced by the array elements are cloned rather than shared
+    auto element = variant_cast<TestSubStruct *>(clone->values[0]);
+    EXPECT_NE(element, variant_cast<TestSubStruct *>(list.values[0]));
+    element->name = "changed";
+    EXPECT_EQ(variant_cast<TestSubStruct *>(list.values[0])->name, "element");
+    auto nested = variant_cast<TestSubStruct *>(variant_cast<VariantArray>(clone->values[1])[1]);
+    EXPECT_NE(nested, variant_cast<TestSubStruct *>(variant_cast<VariantArray>(list.values[1])[1]));
+    EXPECT_EQ(nested->name, "nested");
+    EXPECT_FALSE(objectEquals(*clone, list));
+    clone->deleteThis();
+}
+
+TEST_F(ObjectTest, ObjectEqualsFloatingPointTest)
+{
+    TestStruct a, b;
+    a.init();
+    b.init();
+    a.doubleValue = 0.0;
+    b.doubleValue = -0.0;
+    a.optFloatValue = 0.0f;
+    b.optFloatValue = -0.0f;
+    EXPECT_TRUE(objectEquals(a, b));
+    EXPECT_EQ(objectHash(a), objectHash(b));
+
+    VariantListStruct x, y;
+    x.init();
+    y.init();
+    x.values.push_back(0.0);
+    y.values.push_back(-0.0);
+    EXPECT_TRUE(objectEquals(x, y));
+    EXPECT_EQ(objectHash(x), objectHash(y));
+
+    a.floatValue = std::numeric_limits<float>::quiet_NaN();
+    b.floatValue = a.floatValue;
+    EXPECT_FALSE(objectEquals(a, b));
+    x.weight = y.weight = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_FALSE(objectEquals(x, y));
+}
+
+class IntColumnSummator : public BatchVisitorBase
+{
+public:
+    IntColumnSummator(EBatchOrder order)
+        : BatchVisitorBase(order), m_sum(0), m_numFields(0), m_numColumns(0), m_numStructs(0)
+    {
+    }
+
+    int64_t m_sum;
+    size_t m_numFields, m_numColumns, m_numStructs;
+protected:
+    void previsitStruct(Object *) override
+    {
+        ++m_numStructs;
+    }
+
+    void visitField(Object *obj, const BatchField& field) override
+    {
+        ++m_numFields;
+        if (field.type == eFieldInt && !field.nullable)
+            m_sum += field.field->access<int32_t>(obj);
+    }
+
+    void visitColumn(const BatchColumn& column) override
+    {
+        ++m_numColumns;
+        BatchVisitorBase::visitColumn(column);
+    }
+};
+
+TEST_F(ObjectTest, BatchVisitorTest)
+{
+    Array<TestStruct> objects;
+    objects.resize(5);
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        objects[i].init();
+        objects[i].id = static_cast<int>(i);
+        objects[i].intValue = 10;
+    }
+    const size_t numFields = TestStruct::staticMetaObject()->totalFields();
+
+    IntColumnSummator objectMajor(eBatchObjectMajor);
+    objectMajor.visit(objects);
+    EXPECT_EQ(objectMajor.m_sum, 0 + 1 + 2 + 3 + 4 + 5 * 10);
+    EXPECT_EQ(objectMajor.m_numStructs, 5U);
+    EXPECT_EQ(objectMajor.m_numColumns, 0U);
+    EXPECT_EQ(objectMajor.m_numFields, 5 * numFields);
+
+    IntColumnSummator fieldMajor(eBatchFieldMajor);
+    fieldMajor.visit(objects);
+    EXPECT_EQ(fieldMajor.m_sum, objectMajor.m_sum);
+    EXPECT_EQ(fieldMajor.m_numStructs, 0U);
+    EXPECT_EQ(fieldMajor.m_numColumns, numFields);
+    EXPECT_EQ(fieldMajor.m_numFields, 5 * numFields);
+
+    const MetaFieldBase *intField = TestStruct::staticMetaObject()->fieldByName("intValue");
+    BatchField batchField { intField, intField->offset(), intField->size(), intField->type(), false };
+    BatchColumn column(batchField, objects.data(), objects.size(), sizeof(TestStruct));
+    column.at<int32_t>(3) = 20;
+    EXPECT_EQ(objects[3].intValue, 20);
+    EXPECT_EQ(column.object(2), &objects[2]);
+}
+
+class IdSummator : public VisitorBase
+{
+public:
+    IdSummator() : m_sum(0), m_count(0) { }
+
+    int64_t m_sum;
+    size_t m_count;
+protected:
+    void visitField(Object *obj, const MetaFieldBase *field) override
+    {
+        if (!strcmp(field->name(), "id"))
+        {
+            if (field->access<int>(obj) < 0)
+                throw std::invalid_argument("Negative id");
+            m_sum += field->access<int>(obj);
+            ++m_count;
+        }
+    }
+};
+
+TEST_F(ObjectTest, ParallelVisitTest)
+{
+    Array<TestStruct> objects;
+    objects.resize(1000);
+    Array<Object *> pointers;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        objects[i].init();
+        objects[i].id = static_cast<int>(i);
+        objects[i].intValue = 1;
+        pointers.push_back(&objects[i]);
+    }
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.size(), 4U);
+
+    int64_t sum = 0;
+    size_t count = 0;
+    std::vector<char> chunksVisited(1000 / 64 + 1);
+    ParallelVisit<IdSummator> parallel([]() { return std::unique_ptr<IdSummator>(new IdSummator()); }, &pool);
+    parallel.grainSize(64)
+            .chunk([&](IdSummator&, size_t begin, size_t) { chunksVisited[begin / 64] = 1; })
+            .merge([&](IdSummator& visitor) { sum += visitor.m_sum; count += visitor.m_count; });
+    parallel.visit(objects);
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+    EXPECT_EQ(count, 1000U);
+    EXPECT_EQ(std::count(chunksVisited.begin(), chunksVisited.end(), 1), (ptrdiff_t)chunksVisited.size());
+
+    sum = 0;
+    count = 0;
+    parallel.visit(pointers);
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+    EXPECT_EQ(count, 1000U);
+
+    objects[500].id = -1;
+    EXPECT_THROW(parallel.visit(objects), std::invalid_argument);
+
+    int64_t intSum = 0;
+    ParallelVisit<IntColumnSummator> batch([]() { return std::unique_ptr<IntColumnSummator>(
+                                               new IntColumnSummator(eBatchFieldMajor)); }, &pool);
+    batch.merge([&](IntColumnSummator& visitor) { intSum += visitor.m_sum; });
+    batch.visit(objects);
+    EXPECT_EQ(intSum, 999 * 1000 / 2 - 500 - 1 + 1000);
+}
+
+TEST_F(ObjectTest, WorkStealingPoolNestedRunTest)
+{
+    WorkStealingPool pool(4);
+    std::vector<int> counts(64 * 16);
+    pool.run(64, 4, [&](size_t worker, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            // nested run from the worker should not deadlock
+            pool.run(16, 3, [&, worker](size_t innerWorker, size_t innerBegin, size_t innerEnd)
+            {
+                EXPECT_EQ(innerWorker, worker);
+                for (size_t j = innerBegin; j < innerEnd; ++j)
+                    ++counts[i * 16 + j];
+            });
+        }
+    });
+    EXPECT_EQ(std::count(counts.begin(), counts.end(), 1), (ptrdiff_t)counts.size());
+    EXPECT_THROW(pool.run(4, 1, [&](size_t, size_t, size_t)
+        { pool.run(1, 1, [](size_t, size_t, size_t) { throw std::runtime_error("nested"); }); }),
+        std::runtime_error);
+}
+
+TEST_F(ObjectTest, ObjectSnapshotTest)
+{
+    TestStruct t;
+    t.init();
+    t.variantValue = VariantArray { 1, String("two"), Variant(new TestSubStruct("three")) };
+    const MetaObject *mo = t.metaObject();
+    ObjectSnapshot snapshot(&t);
+    ASSERT_TRUE(snapshot.valid());
+
+    FieldMask mask = snapshot.diff(&t);
+    ASSERT_EQ(mask.size(), mo->totalFields());
+    EXPECT_FALSE(mask.any());
+
+    auto indexOf = [mo](const char *name) {
+        for (size_t i = 0; i < mo->totalFields(); ++i)
+            if (!strcmp(mo->field(i)->name(), name)) return i;
+        return mo->totalFields();
+    };
+    t.intValue = 12;
+    t.strValue = "changed";
+    t.optDoubleValue = 2.0;
+    t.optDateTimeValue = DateTime(static_cast<time_t>(1000));
+    mask = snapshot.diff(&t);
+    EXPECT_EQ(mask.count(), 4);
+    EXPECT_TRUE(mask.test(indexOf("intValue")));
+    EXPECT_TRUE(mask.test(indexOf("strValue")));
+    EXPECT_TRUE(mask.test(indexOf("optDoubleValue")));
+    EXPECT_TRUE(mask.test(indexOf("optDateTimeValue")));
+    EXPECT_FALSE(mask.test(indexOf("uintValue")));
+
+    t.intValue = -1;
+    t.strValue = "testValue";
+    EXPECT_EQ(snapshot.diff(&t).count(), 2);
+
+    snapshot.take(&t);
+    EXPECT_FALSE(snapshot.diff(&t).any());
+
+    // objects, arrays and variants are compared by value
+    t.substruct.name = "changed";
+    t.arrValue.push_back(TestSubStruct("element"));
+    variant_cast<TestSubStruct *>(variant_cast<VariantArray>(t.variantValue)[2])->name = "four";
+    t.optVariantValue = Variant(5);
+    mask = snapshot.diff(&t);
+    EXPECT_EQ(mask.count(), 4);
+    EXPECT_TRUE(mask.test(indexOf("substruct")));
+    EXPECT_TRUE(mask.test(indexOf("arrValue")));
+    EXPECT_TRUE(mask.test(indexOf("variantValue")));
+    EXPECT_TRUE(mask.test(indexOf("optVariantValue")));
+
+    snapshot.take(&t);
+    EXPECT_FALSE(snapshot.diff(&t).any());
+
+    TestSubStruct other;
+    EXPECT_THROW(snapshot.diff(&other), std::invalid_argument);
+}
+
 TEST_F(ObjectTest, TypeResolverFailureTest)
 {
     metacpp::serialization::TypeResolverFactory factory({
@@ -237,6 +779,25 @@ TEST_F(ObjectTest, TypeResolverSuccessTest)
     std::dynamic_pointer_cast<TestStruct>(testStruct);
 }
 
+TEST_F(ObjectTest, TypeResolverNameCollisionTest)
+{
+    // a class registered first under the same short name must not hide the known type
+    MetaInfoDescriptor shadowDescriptor = REFLECTIBLE_DESCRIPTOR(TestBaseStruct);
+    shadowDescriptor.m_strucName = "CollidingStruct";
+    MetaInfoDescriptor knownDescriptor = REFLECTIBLE_DESCRIPTOR(TestSubStruct);
+    knownDescriptor.m_strucName = "CollidingStruct";
+    MetaObject shadow(&shadowDescriptor);
+    MetaObject known(&knownDescriptor);
+    EXPECT_EQ(MetaObjectRegistry::instance().find("CollidingStruct"), &shadow);
+
+    metacpp::serialization::TypeResolverFactory factory({ TestStruct::staticMetaObject(), &known });
+    Object *obj = factory.createInstance("CollidingStruct");
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(obj->metaObject(), TestSubStruct::staticMetaObject());
+    known.destroyInstance(obj);
+    EXPECT_THROW(factory.createInstance("TestBaseStruct"), std::invalid_argument);
+}
+
 #ifdef HAVE_JSONCPP
 TEST_F(ObjectTest, SerializationTest)
 {
@@ -356,6 +917,32 @@ TEST_F(ObjectTest, SerializationTestDateTimeValid)
     EXPECT_EQ(t2.datetimeValue, t.datetimeValue);
 }
 
+TEST_F(ObjectTest, SerializationTestMovedArrayField)
+{
+    TestStruct t;
+    t.init();
+    t.arrValue.push_back(TestSubStruct("first"));
+    t.arrValue.push_back(TestSubStruct("second"));
+    String json = t.toJson();
+
+    // moved-from array fields are still resized through reflection with their own element type
+    UniqueArray<TestSubStruct> unique(std::move(t.arrValue));
+    EXPECT_TRUE(t.arrValue.empty());
+    t.fromJson(json);
+    ASSERT_EQ(t.arrValue.size(), 2u);
+    EXPECT_EQ(t.arrValue[1].name, "second");
+
+    Array<TestSubStruct> moved;
+    moved = std::move(t.arrValue);
+    EXPECT_TRUE(t.arrValue.empty());
+    t.init();
+    t.fromJson(json);
+    ASSERT_EQ(t.arrValue.size(), 2u);
+    EXPECT_EQ(t.arrValue[0].name, "first");
+    EXPECT_EQ(moved.size(), 2u);
+    EXPECT_EQ(unique.size(), 2u);
+}
+
 TEST_F(ObjectTest, SerializationTestDateTimeInvalid)
 {
     TestStruct t, t2;
@@ -389,6 +976,25 @@ TEST_F(ObjectTest, TestDynamicProperty)
     ASSERT_EQ(s.getProperty("newProp").value<String>(), "value");
 }
 
+TEST_F(ObjectTest, TestDynamicPropertyCopy)
+{
+    TestStruct s;
+    s.init();
+    EXPECT_FALSE(s.getProperty("b").valid());
+    s.setProperty("b", 2);
+    s.setProperty("c", 3);
+    s.setProperty("a", 1);
+    s.setProperty("b", 20);
+    TestStruct copy(s);
+    s.setProperty("a", 10);
+    EXPECT_EQ(variant_cast<int>(copy.getProperty("a")), 1);
+    EXPECT_EQ(variant_cast<int>(copy.getProperty("b")), 20);
+    EXPECT_EQ(variant_cast<int>(copy.getProperty("c")), 3);
+    EXPECT_EQ(variant_cast<int>(s.getProperty("a")), 10);
+    copy = TestStruct();
+    EXPECT_FALSE(copy.getProperty("a").valid());
+}
+
 namespace
 {
     using namespace metacpp;
@@ -432,6 +1038,16 @@ namespace
             return String::fromValue(v);
         }
 
+        static String stamp(const DateTime& dt)
+        {
+            return "date " + dt.toString();
+        }
+
+        static String stamp(const String& str)
+        {
+            return "string " + str;
+        }
+
         static String objName(const MyObject *obj)
         {
             return obj->metaObject()->name();
@@ -452,6 +1068,8 @@ namespace
         SIGNATURE_METHOD(MyObject, bar, void (MyObject::*)(int))
         SIGNATURE_METHOD(MyObject, bar, String (MyObject::*)(const String&))
         METHOD(MyObject, test)
+        SIGNATURE_METHOD(MyObject, stamp, String (*)(const DateTime&))
+        SIGNATURE_METHOD(MyObject, stamp, String (*)(const String&))
         METHOD(MyObject, objName)
     METHOD_INFO_END(MyObject)
 
@@ -459,6 +1077,25 @@ namespace
 
     META_INFO(MyObject)
 
+    TEST_F(ObjectTest, methodByNameTest)
+    {
+        const MetaObject *mo = MyObject::staticMetaObject();
+        auto method = mo->methodByName("bar");
+        ASSERT_NE(method, nullptr);
+        EXPECT_EQ(String(method->name()), "bar");
+        EXPECT_EQ(method->numArguments(), 2);
+        EXPECT_EQ(mo->methodByName("BAR"), nullptr);
+        EXPECT_EQ(mo->methodByName("BAR", false), method);
+        EXPECT_EQ(mo->methodByName(StringView("objNameTest", 7)), mo->methodByName("objName"));
+        EXPECT_EQ(mo->methodByName("unknown"), nullptr);
+    }
+
+    TEST_F(ObjectTest, superMetaObjectTest)
+    {
+        EXPECT_EQ(MyObject::staticMetaObject()->superMetaObject(), Object::staticMetaObject());
+        EXPECT_EQ(Object::staticMetaObject()->superMetaObject(), nullptr);
+    }
+
     TEST_F(ObjectTest, invokeStaticTest)
     {
         ASSERT_EQ(30, MyObject::staticMetaObject()->invoke<int>("foo", 12, 2.5f));
@@ -510,6 +1147,62 @@ namespace
         ASSERT_EQ("MyObject", MyObject::staticMetaObject()->invoke<String>("objName", new MyObject()));
     }
 
+    TEST_F(ObjectTest, resolveStaticMethod)
+    {
+        auto foo = MyObject::staticMetaObject()->resolveMethod<int (int, const float&)>("foo");
+        ASSERT_TRUE(foo.valid());
+        EXPECT_EQ(foo(12, 2.5f), 30);
+        EXPECT_EQ(foo(2, 2.0f), 4);
+        auto fooVoid = MyObject::staticMetaObject()->resolveMethod<void ()>("foo");
+        ASSERT_TRUE(fooVoid.valid());
+        fooVoid();
+    }
+
+    TEST_F(ObjectTest, resolveOwnMethod)
+    {
+        MyObject obj(2);
+        auto constBar = MyObject::staticMetaObject()->resolveMethod<float (int, const double&)>("bar");
+        auto setBar = MyObject::staticMetaObject()->resolveMethod<void (int)>("bar");
+        auto strBar = MyObject::staticMetaObject()->resolveMethod<String (const String&)>("bar");
+        ASSERT_TRUE(constBar && setBar && strBar);
+        EXPECT_FLOAT_EQ(constBar(static_cast<const Object *>(&obj), 12, 2.5), 60.0f);
+        setBar(&obj, 3);
+        EXPECT_EQ(obj.x(), 3);
+        EXPECT_EQ(strBar(&obj, "prefix_"), "prefix_3");
+    }
+
+    TEST_F(ObjectTest, resolveMethodFailure)
+    {
+        EXPECT_FALSE(MyObject::staticMetaObject()->resolveMethod<int (int, float)>("foo").valid());
+        EXPECT_FALSE(MyObject::staticMetaObject()->resolveMethod<int (int, const float&)>("bar").valid());
+        EXPECT_FALSE(MyObject::staticMetaObject()->resolveMethod<void ()>("unknown").valid());
+    }
+
+    TEST_F(ObjectTest, invokeCachedOverload)
+    {
+        MyObject obj(2);
+        for (int i = 0; i < 3; ++i)
+        {
+            ASSERT_EQ(obj.invoke<String>("bar", "prefix_"), "prefix_2");
+            ASSERT_EQ(obj.invoke<float>("bar", 12, 2.5), 60.0f);
+        }
+        ASSERT_THROW(MyObject::staticMetaObject()->invoke<int>("foo", 12, "2.5f"), MethodNotFoundException);
+        ASSERT_EQ(MyObject::staticMetaObject()->invoke<int>("foo", 12, 2.5f), 30);
+        ASSERT_THROW(MyObject::staticMetaObject()->invoke<int>("foo", 12, "2.5f"), MethodNotFoundException);
+    }
+
+    TEST_F(ObjectTest, invokeCachedOverloadValueDependent)
+    {
+        const MetaObject *mo = MyObject::staticMetaObject();
+        // "abc" is not a date, so stamp(const String&) is chosen, but this must not be remembered for other strings
+        for (int i = 0; i < 2; ++i)
+        {
+            EXPECT_EQ(mo->invoke<String>("stamp", "abc"), "string abc");
+            EXPECT_EQ(mo->invoke<String>("stamp", "2015-04-01 12:00:00"), "date 2015-04-01 12:00:00");
+        }
+        EXPECT_EQ(mo->invoke<String>("stamp", DateTime(2015, April, 1)), "date 2015-04-01 00:00:00");
+    }
+
     TEST_F(ObjectTest, createInstanceDefault)
     {
         MyObject *obj = dynamic_cast<MyObject *>(MyObject::staticMetaObject()->createInstance());
@@ -529,4 +1222,33 @@ namespace
         EXPECT_THROW(MyObject::staticMetaObject()->createInstance("a string"),
                      MethodNotFoundException);
     }
+
+    TEST_F(ObjectTest, createInstanceVariantOwnership)
+    {
+        Object *obj = MyObject::staticMetaObject()->createInstance(1);
+        EXPECT_EQ(dynamic_cast<MyObject *>(obj)->x(), 1);
+        // objects put into Variant are released by it
+        Variant v(obj);
+        v = Variant();
+        MyObject *heapObj = new MyObject(3);
+        MyObject::staticMetaObject()->destroyInstance(heapObj);
+    }
+
+    TEST_F(ObjectTest, objectArenaTest)
+    {
+        ObjectArena arena;
+        MyObject *obj = dynamic_cast<MyObject *>(MyObject::staticMetaObject()->createInstance(arena, { 5 }));
+        ASSERT_TRUE(obj != nullptr);
+        EXPECT_EQ(obj->x(), 5);
+        MyObject *obj2 = arena.create<MyObject>(7);
+        EXPECT_EQ(obj2->x(), 7);
+        EXPECT_EQ(arena.size(), 2U);
+        EXPECT_THROW(arena.create(MyObject::staticMetaObject(), { "a string" }), MethodNotFoundException);
+        EXPECT_EQ(arena.size(), 2U);
+        arena.clear();
+        EXPECT_EQ(arena.size(), 0U);
+        // freed blocks are reused by the next allocations
+        MyObject *obj3 = arena.create<MyObject>(9);
+        EXPECT_TRUE(obj3 == obj || obj3 == obj2);
+    }
 }
@@ -507,6 +507,36 @@ TEST_P(SqlTest, testEqualOperator)
     EXPECT_TRUE(HasSmith(persons));
 }
 
+TEST_P(SqlTest, testFetchAllArena)
+{
+    SqlTransaction transaction;
+    ObjectArena arena;
+    auto persons = Storable<Person>::fetchAll(transaction, arena, COL(Person::name) == String("Smith"));
+
+    ASSERT_EQ(persons.size(), 1);
+    EXPECT_EQ(arena.size(), 1);
+    EXPECT_EQ(persons[0]->name, "Smith");
+}
+
+TEST_P(SqlTest, invalidDateTimeBindsNullTest)
+{
+    {
+        SqlTransaction transaction;
+        Storable<Person> person;
+        ASSERT_TRUE(person.select().where(COL(Person::name) == String("Smith")).fetchOne(transaction));
+        person.name = "Nobody";
+        person.birthday = DateTime();
+        ASSERT_TRUE(person.insertOne(transaction));
+        transaction.commit();
+    }
+    SqlTransaction transaction;
+    Storable<Person> person;
+    ASSERT_TRUE(person.select().where(COL(Person::name) == String("Nobody")).fetchOne(transaction));
+    EXPECT_EQ(person.birthday, nullptr);
+    EXPECT_EQ(Storable<Person>::fetchAll(transaction, COL(Person::name) == String("Nobody") &&
+                                         COL(Person::birthday).isNull()).size(), 1);
+}
+
 TEST_P(SqlTest, testNotEqualOperator)
 {
     SqlTransaction transaction;
@@ -862,6 +892,64 @@ TEST_P(SqlTest, updateOneTest)
     }
 }
 
+static size_t fieldIndex(const MetaObject *metaObject, const char *name)
+{
+    for (size_t i = 0; i < metaObject->totalFields(); ++i)
+        if (metaObject->field(i) == metaObject->fieldByName(name))
+            return i;
+    throw std::invalid_argument(name);
+}
+
+TEST_P(SqlTest, updateOneModifiedTest)
+{
+    const MetaObject *metaObject = Person::staticMetaObject();
+    {
+        SqlTransaction transaction;
+        std::shared_ptr<SqlStatementUpdate> statement;
+        {
+            Storable<Person> person;
+            person.setTrackChanges(true);
+            ASSERT_TRUE(person.select().where(COL(Person::name) == String("Pupkin")).fetchOne(transaction));
+            EXPECT_FALSE(person.modifiedFields().any());
+            // nothing changed, no statement is executed
+            ASSERT_TRUE(person.updateOne(transaction));
+
+            // concurrent change of another column should not be overwritten
+            ASSERT_EQ(person.update().set(COL(Person::cat_weight) = 3.0)
+                      .where(COL(Person::name) == String("Pupkin")).exec(transaction), 1);
+
+            person.name = "Pupkin Jr";
+            person.test_int32 = 42;
+            FieldMask modified = person.modifiedFields();
+            EXPECT_EQ(modified.count(), 2);
+            EXPECT_TRUE(modified.test(fieldIndex(metaObject, "name")));
+            EXPECT_TRUE(modified.test(fieldIndex(metaObject, "test_int32")));
+            ASSERT_TRUE(person.updateOne(transaction));
+            EXPECT_FALSE(person.modifiedFields().any());
+            statement = transaction.cachedUpdateStatement(metaObject, modified);
+            ASSERT_TRUE(statement != nullptr);
+        }
+
+        // same set of columns reuses the prepared statement, even from another storable
+        Storable<Person> person;
+        person.setTrackChanges(true);
+        ASSERT_TRUE(person.select().where(COL(Person::name) == String("Pupkin Jr")).fetchOne(transaction));
+        person.name = "Pupkin III";
+        person.test_int32 = 43;
+        FieldMask modified = person.modifiedFields();
+        ASSERT_TRUE(person.updateOne(transaction));
+        EXPECT_EQ(transaction.cachedUpdateStatement(metaObject, modified), statement);
+        transaction.commit();
+    }
+    {
+        SqlTransaction transaction;
+        Storable<Person> person;
+        ASSERT_TRUE(person.select().where(COL(Person::name) == String("Pupkin III")).fetchOne(transaction));
+        EXPECT_EQ(person.test_int32, 43);
+        EXPECT_EQ(person.cat_weight, 3.0);
+    }
+}
+
 TEST_P(SqlTest, transactionAutoCommitTest)
 {
     {
@@ -1086,6 +1174,33 @@ TEST_P(SqlTest, TestUnsatisfiedConstraint)
     EXPECT_THROW(person.insertOne(transaction), std::runtime_error);
 }
 
+TEST(SqlSchemaTest, postgresSchemaText)
+{
+    // the schema text is built without a connection to the server
+    StringArray statements = Storable<Order>::schemaStatements(SqlSyntaxPostgreSQL);
+    ASSERT_EQ(statements.size(), 3u);
+    EXPECT_EQ(statements[0], "CREATE TABLE IF NOT EXISTS \"Order\"(\"id\" SERIAL NOT NULL, "
+              "\"person_id\" INTEGER NOT NULL REFERENCES \"Person\"(\"id\"), \"title\" TEXT NOT NULL, "
+              "\"limit\" INTEGER NOT NULL CHECK (\"limit\" >= 0))");
+    EXPECT_EQ(statements[1], "DO $$ DECLARE index_exists boolean;BEGIN index_exists := FALSE;"
+              "SELECT TRUE INTO index_exists FROM pg_indexes WHERE indexname = lower('idx_Order_person_id') LIMIT 1;"
+              "IF NOT FOUND THEN CREATE INDEX idx_Order_person_id ON \"Order\"(\"person_id\");END IF;"
+              "END$$ LANGUAGE plpgsql");
+    EXPECT_EQ(statements[2], "DO $$ DECLARE index_exists boolean;BEGIN index_exists := FALSE;"
+              "SELECT TRUE INTO index_exists FROM pg_indexes WHERE indexname = lower('idx_Order_limit') LIMIT 1;"
+              "IF NOT FOUND THEN CREATE INDEX idx_Order_limit ON \"Order\"(\"limit\");END IF;"
+              "END$$ LANGUAGE plpgsql");
+
+    statements = Storable<City>::schemaStatements(SqlSyntaxPostgreSQL);
+    ASSERT_EQ(statements.size(), 2u);
+    EXPECT_EQ(statements[0], "CREATE TABLE IF NOT EXISTS \"City\"(\"id\" SERIAL NOT NULL, \"name\" TEXT NOT NULL, "
+              "\"country\" TEXT)");
+    EXPECT_EQ(statements[1], "DO $$ DECLARE index_exists boolean;BEGIN index_exists := FALSE;"
+              "SELECT TRUE INTO index_exists FROM pg_indexes WHERE indexname = lower('idx_City_id') LIMIT 1;"
+              "IF NOT FOUND THEN CREATE UNIQUE INDEX idx_City_id ON \"City\"(\"id\");END IF;"
+              "END$$ LANGUAGE plpgsql");
+}
+
 #ifdef HAVE_SQLITE3
 
 INSTANTIATE_TEST_CASE_P(SqliteTestInstantiation,
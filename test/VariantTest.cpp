@@ -41,6 +41,42 @@ TEST_F(VariantTest, ExtractObjectTest)
     obj->deleteThis();
 }
 
+TEST_F(VariantTest, ExtractObjectFromCopyTest)
+{
+    Variant v(MyObject::staticMetaObject()->createInstance());
+    Variant copy = v;
+    auto obj = dynamic_cast<MyObject *>(copy.extractObject());
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(variant_cast<Object *>(v), nullptr);
+    obj->deleteThis();
+}
+
+TEST_F(VariantTest, InlineStorageTest)
+{
+    EXPECT_LE(sizeof(Variant), 24u);
+    Variant s(String("some string"));
+    Variant s2 = s;
+    Variant s3(std::move(s));
+    EXPECT_FALSE(s.valid());
+    EXPECT_EQ(variant_cast<String>(s2), "some string");
+    EXPECT_EQ(variant_cast<String>(s3), "some string");
+    s2 = Variant(12);
+    EXPECT_EQ(variant_cast<int>(s2), 12);
+    EXPECT_EQ(variant_cast<String>(s3), "some string");
+    EXPECT_EQ(Variant(String()).type(), eFieldString);
+    EXPECT_EQ(Variant(String("a string which does not fit into the inline buffer")).type(), eFieldString);
+    EXPECT_EQ(Variant(int64_t(-1)).type(), eFieldInt64);
+    EXPECT_EQ(Variant(DateTime(2000, January, 1)).type(), eFieldDateTime);
+
+    Variant a(VariantArray { Variant(1), Variant("two") });
+    Variant a2 = a;
+    a = variant_cast<VariantArray>(a)[1];
+    EXPECT_EQ(variant_cast<String>(a), "two");
+    EXPECT_EQ(variant_cast<VariantArray>(a2).size(), 2u);
+    EXPECT_THROW(Variant().value<int>(), std::runtime_error);
+    EXPECT_THROW(Variant(1.5).value<DateTime>(), std::invalid_argument);
+}
+
 TEST_F(VariantTest, StreamTest)
 {
     std::ostringstream ss;